@@ -515,7 +515,8 @@ void Editor_rendering::render()
                         ? window->viewport()
                         : erhe::scene::Viewport{0, 0, 1920, 1080},
                     .mesh_spans           = { m_scene_root->content_layer()->meshes },
-                    .lights               = m_scene_root->light_layer()->lights
+                    .lights               = m_scene_root->light_layer()->lights,
+                    .spatial_index        = m_scene_root->content_layer()->spatial_index.get()
                 }
             );
             get<Debug_view_window>()->render();
@@ -665,7 +666,9 @@ void Editor_rendering::render_content(const Render_context& context)
                 .materials         = m_scene_root->materials(),
                 .passes            = { &renderpass },
                 .visibility_filter = content_not_selected_filter,
-                .ambient_light     = m_scene_root->light_layer()->ambient_light
+                .ambient_light     = m_scene_root->light_layer()->ambient_light,
+                .occlusion_culling = true,
+                .spatial_index     = m_scene_root->content_layer()->spatial_index.get()
             }
         );
         //gl::disable(gl::Enable_cap::polygon_offset_line);
@@ -689,7 +692,8 @@ void Editor_rendering::render_content(const Render_context& context)
                 .light_projections = m_shadow_renderer->light_projections(),
                 .materials         = m_scene_root->materials(),
                 .passes            = { &m_rp_edge_lines },
-                .visibility_filter = content_not_selected_filter
+                .visibility_filter = content_not_selected_filter,
+                .spatial_index     = m_scene_root->content_layer()->spatial_index.get()
             }
         );
         gl::disable(gl::Enable_cap::sample_alpha_to_coverage);
@@ -710,7 +714,8 @@ void Editor_rendering::render_content(const Render_context& context)
                 .light_projections = m_shadow_renderer->light_projections(),
                 .materials         = m_scene_root->materials(),
                 .passes            = { &m_rp_polygon_centroids },
-                .visibility_filter = content_not_selected_filter
+                .visibility_filter = content_not_selected_filter,
+                .spatial_index     = m_scene_root->content_layer()->spatial_index.get()
             }
         );
     }
@@ -730,7 +735,8 @@ void Editor_rendering::render_content(const Render_context& context)
                 .light_projections = m_shadow_renderer->light_projections(),
                 .materials         = m_scene_root->materials(),
                 .passes            = { &m_rp_corner_points },
-                .visibility_filter = content_not_selected_filter
+                .visibility_filter = content_not_selected_filter,
+                .spatial_index     = m_scene_root->content_layer()->spatial_index.get()
             }
         );
     }
@@ -786,7 +792,9 @@ void Editor_rendering::render_selection(const Render_context& context)
                 .materials         = m_scene_root->materials(),
                 .passes            = { &renderpass },
                 .visibility_filter = content_selected_filter,
-                .ambient_light     = m_scene_root->light_layer()->ambient_light
+                .ambient_light     = m_scene_root->light_layer()->ambient_light,
+                .occlusion_culling = true,
+                .spatial_index     = m_scene_root->content_layer()->spatial_index.get()
             }
         );
         //gl::disable(gl::Enable_cap::polygon_offset_line);
@@ -812,7 +820,8 @@ void Editor_rendering::render_selection(const Render_context& context)
                 .light_projections = m_shadow_renderer->light_projections(),
                 .materials         = m_scene_root->materials(),
                 .passes            = { &m_rp_edge_lines, &m_rp_line_hidden_blend },
-                .visibility_filter = content_selected_filter
+                .visibility_filter = content_selected_filter,
+                .spatial_index     = m_scene_root->content_layer()->spatial_index.get()
             }
         );
         gl::disable(gl::Enable_cap::sample_alpha_to_coverage);
@@ -836,7 +845,8 @@ void Editor_rendering::render_selection(const Render_context& context)
                 .light_projections = m_shadow_renderer->light_projections(),
                 .materials         = m_scene_root->materials(),
                 .passes            = { &m_rp_polygon_centroids },
-                .visibility_filter = content_selected_filter
+                .visibility_filter = content_selected_filter,
+                .spatial_index     = m_scene_root->content_layer()->spatial_index.get()
             }
         );
     }
@@ -857,7 +867,8 @@ void Editor_rendering::render_selection(const Render_context& context)
                 .light_projections = m_shadow_renderer->light_projections(),
                 .materials         = m_scene_root->materials(),
                 .passes            = { &m_rp_corner_points },
-                .visibility_filter = content_selected_filter
+                .visibility_filter = content_selected_filter,
+                .spatial_index     = m_scene_root->content_layer()->spatial_index.get()
             }
         );
     }
@@ -1,4 +1,5 @@
 #include "editor_rendering.hpp"
+#include "task_queue.hpp"
 #include "view_client.hpp"
 #include "graphics/icon_set.hpp"
 #include "graphics/image_transfer.hpp"
@@ -155,6 +156,7 @@ auto Application::initialize_components(int argc, char** argv) -> bool
         m_components.add(make_shared<editor::Viewport_config       >());
         m_components.add(make_shared<editor::Viewport_windows      >());
         m_components.add(make_shared<editor::View_client           >());
+        m_components.add(make_shared<editor::Worker_thread_pool    >());
 
 #if defined(ERHE_XR_LIBRARY_OPENXR)
         m_components.add(make_shared<Hand_tracker    >());
@@ -8,6 +8,7 @@
 #include "erhe/physics/icollision_shape.hpp"
 #include "erhe/primitive/primitive_builder.hpp"
 #include "erhe/scene/scene.hpp"
+#include "erhe/scene/spatial_index.hpp"
 
 #include <memory>
 #include <sstream>
@@ -15,6 +16,24 @@
 namespace editor
 {
 
+namespace
+{
+
+// Rigid body transforms can not contain scale
+auto without_scale(const glm::mat4& m) -> erhe::physics::Transform
+{
+    return erhe::physics::Transform{
+        glm::mat3{
+            glm::normalize(glm::vec3{m[0]}),
+            glm::normalize(glm::vec3{m[1]}),
+            glm::normalize(glm::vec3{m[2]})
+        },
+        glm::vec3{m[3]}
+    };
+}
+
+} // anonymous namespace
+
 // https://github.com/bulletphysics/bullet3/issues/1352
 //
 // The btRigidBody is aligned with the center of mass.
@@ -99,6 +118,7 @@ Merge_operation::Merge_operation(Parameters&& parameters)
 
     bool first_mesh                = true;
     mat4 reference_node_from_world = mat4{1};
+    erhe::physics::Transform reference_rigidbody_from_world;
     auto normal_style              = Normal_style::none;
     std::shared_ptr<erhe::primitive::Material> material;
 
@@ -127,6 +147,10 @@ Merge_operation::Merge_operation(Parameters&& parameters)
             m_state_before.collision_shape = collision_shape;
             m_state_before.mass            = node_physics ? node_physics->rigid_body()->get_mass()          : 0.0f;
             m_state_before.local_inertia   = node_physics ? node_physics->rigid_body()->get_local_inertia() : glm::mat4{0.0f};
+            m_state_before.rigidbody_from_node = node_physics ? node_physics->get_rigidbody_from_node() : erhe::physics::Transform{};
+            reference_rigidbody_from_world = node_physics
+                ? inverse(node_physics->get_world_from_rigidbody())
+                : inverse(without_scale(mesh->world_from_node()));
         }
         else
         {
@@ -139,9 +163,11 @@ Merge_operation::Merge_operation(Parameters&& parameters)
             //    collision_shape,
             //    erhe::physics::Transform{transform}
             //);
+            // Node transforms may contain scale, which is already
+            // applied to collision shapes; place children in rigid body space
             erhe::physics::Compound_child child{
                 .shape     = collision_shape,
-                .transform = erhe::physics::Transform{transform}
+                .transform = reference_rigidbody_from_world * node_physics->get_world_from_rigidbody()
             };
             compound_shape_create_info.children.push_back(child);
 
@@ -152,7 +178,7 @@ Merge_operation::Merge_operation(Parameters&& parameters)
 
         for (auto& primitive : mesh->mesh_data.primitives)
         {
-            const auto& geometry = primitive.source_geometry;
+            const auto geometry = primitive.get_geometry();
             if (!geometry)
             {
                 continue;
@@ -179,7 +205,6 @@ Merge_operation::Merge_operation(Parameters&& parameters)
         return;
     }
 
-    m_state_before.rigidbody_from_node = erhe::physics::Transform{};
     erhe::physics::Transform principal_axis_transform;
     m_state_after.collision_shape = erhe::physics::ICollision_shape::create_compound_shape_shared(compound_shape_create_info);
     //m_state_after.collision_shape->calculate_principal_axis_transform(
@@ -188,11 +213,12 @@ Merge_operation::Merge_operation(Parameters&& parameters)
     //    m_state_after.local_inertia
     //);
 
-    m_state_after.rigidbody_from_node = inverse(principal_axis_transform);
+    m_state_after.rigidbody_from_node = inverse(principal_axis_transform) * m_state_before.rigidbody_from_node;
 
     const erhe::geometry::Geometry::Weld_settings weld_settings;
     combined_geometry.weld(weld_settings);
     combined_geometry.build_edges();
+    erhe::primitive::prepare_geometry(combined_geometry, parameters.build_info.format);
 
     m_combined_primitive.material              = material;
     m_combined_primitive.gl_primitive_geometry = make_primitive(
@@ -245,6 +271,11 @@ void Merge_operation::execute(const Operation_context&)
             m_parameters.scene.remove(mesh);
         }
     }
+    if (m_parameters.layer.spatial_index)
+    {
+        // First mesh bounding box changes with combined primitive
+        m_parameters.layer.spatial_index->set_items_changed();
+    }
     m_parameters.selection_tool->set_selection(m_state_after.selection);
 
     m_parameters.scene.sanity_check();
@@ -290,6 +321,10 @@ void Merge_operation::undo(const Operation_context&)
         }
     }
     m_parameters.scene.nodes_sorted = false;
+    if (m_parameters.layer.spatial_index)
+    {
+        m_parameters.layer.spatial_index->set_items_changed();
+    }
     m_parameters.selection_tool->set_selection(m_state_before.selection);
 
     m_parameters.scene.sanity_check();
@@ -4,6 +4,7 @@
 #include "erhe/geometry/geometry.hpp"
 #include "erhe/primitive/primitive_builder.hpp"
 #include "erhe/scene/scene.hpp"
+#include "erhe/scene/spatial_index.hpp"
 
 #include <sstream>
 
@@ -46,6 +47,7 @@ void Mesh_operation::execute(const Operation_context&)
         entry.mesh->mesh_data = entry.after;
         m_parameters.scene.sanity_check();
     }
+    invalidate_spatial_index();
 }
 
 void Mesh_operation::undo(const Operation_context&)
@@ -56,6 +58,7 @@ void Mesh_operation::undo(const Operation_context&)
         entry.mesh->mesh_data = entry.before;
         m_parameters.scene.sanity_check();
     }
+    invalidate_spatial_index();
 }
 
 void Mesh_operation::make_entries(
@@ -83,7 +86,7 @@ void Mesh_operation::make_entries(
 
         for (auto& primitive : entry.after.primitives)
         {
-            const auto& geometry = primitive.source_geometry;
+            const auto geometry = primitive.get_geometry();
             auto* g = geometry.get();
             if (g == nullptr)
             {
@@ -95,6 +98,8 @@ void Mesh_operation::make_entries(
             primitive.source_geometry = std::make_shared<erhe::geometry::Geometry>(
                 std::move(result_geometry)
             );
+            primitive.source_triangle_soup.reset();
+            erhe::primitive::prepare_geometry(*primitive.source_geometry.get(), m_parameters.build_info.format);
             primitive.gl_primitive_geometry = make_primitive(
                 *primitive.source_geometry.get(),
                 m_parameters.build_info,
@@ -107,6 +112,15 @@ void Mesh_operation::make_entries(
     m_parameters.scene.sanity_check();
 }
 
+void Mesh_operation::invalidate_spatial_index()
+{
+    // Mesh bounding boxes change with mesh data
+    if (m_parameters.layer.spatial_index)
+    {
+        m_parameters.layer.spatial_index->set_items_changed();
+    }
+}
+
 void Mesh_operation::add_entry(Entry&& entry)
 {
     m_entries.emplace_back(entry);
@@ -73,6 +73,8 @@ protected:
     );
 
 private:
+    void invalidate_spatial_index();
+
     Selection_tool*    m_selection_tool{nullptr};
 
     Parameters         m_parameters;
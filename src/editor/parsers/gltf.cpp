@@ -4,18 +4,29 @@
 #include "scene/helpers.hpp"
 #include "scene/node_raytrace.hpp"
 #include "scene/scene_root.hpp"
+#include "task_queue.hpp"
 
 #include "erhe/geometry/geometry.hpp"
+#include "erhe/graphics/mipmapped_image.hpp"
+#include "erhe/graphics/png_loader.hpp"
+#include "erhe/graphics/sampler.hpp"
+#include "erhe/graphics/texture.hpp"
+#include "erhe/graphics/texture_transfer_queue.hpp"
 #include "erhe/log/log_glm.hpp"
+#include "erhe/scene/animation.hpp"
 #include "erhe/scene/camera.hpp"
 #include "erhe/scene/projection.hpp"
 #include "erhe/scene/mesh.hpp"
 #include "erhe/scene/light.hpp"
 #include "erhe/scene/scene.hpp"
+#include "erhe/scene/skin.hpp"
+#include "erhe/primitive/material.hpp"
 #include "erhe/primitive/primitive_builder.hpp"
+#include "erhe/primitive/triangle_soup.hpp"
 
 #include "erhe/toolkit/file.hpp"
 #include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
 
 extern "C" {
     #include "cgltf.h"
@@ -24,11 +35,15 @@ extern "C" {
 #include <gsl/gsl>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <cstring>
 #include <glm/glm.hpp>
 #include <fstream>
 #include <limits>
 #include <string>
+#include <string_view>
 
 namespace editor {
 
@@ -187,6 +202,125 @@ auto safe_str(const char* text)
     return (text != nullptr) ? text : "(null)";
 }
 
+// Returns pointer to first element of accessor, or nullptr if accessor
+// data is not available in memory.
+auto accessor_data(const cgltf_accessor* accessor) -> const uint8_t*
+{
+    const cgltf_buffer_view* buffer_view = accessor->buffer_view;
+    if (buffer_view == nullptr)
+    {
+        return nullptr;
+    }
+    if (buffer_view->data != nullptr)
+    {
+        return static_cast<const uint8_t*>(buffer_view->data) + accessor->offset;
+    }
+    if ((buffer_view->buffer == nullptr) || (buffer_view->buffer->data == nullptr))
+    {
+        return nullptr;
+    }
+    return static_cast<const uint8_t*>(buffer_view->buffer->data) + buffer_view->offset + accessor->offset;
+}
+
+// Reads float elements of accessor. Non-sparse float accessors are read
+// directly from buffer; other accessors use cgltf_accessor_read_float().
+class Accessor_reader
+{
+public:
+    explicit Accessor_reader(const cgltf_accessor* accessor)
+        : m_accessor       {accessor}
+        , m_data           {accessor->is_sparse ? nullptr : accessor_data(accessor)}
+        , m_stride         {accessor->stride}
+        , m_component_count{std::min(cgltf_size{4}, cgltf_num_components(accessor->type))}
+        , m_direct         {
+            (m_data != nullptr) &&
+            (accessor->component_type == cgltf_component_type::cgltf_component_type_r_32f)
+        }
+    {
+    }
+
+    [[nodiscard]] auto component_count() const -> cgltf_size
+    {
+        return m_component_count;
+    }
+
+    void read(const cgltf_size index, float* out) const
+    {
+        if (m_direct)
+        {
+            std::memcpy(out, m_data + index * m_stride, m_component_count * sizeof(float));
+        }
+        else
+        {
+            cgltf_accessor_read_float(m_accessor, index, out, m_component_count);
+        }
+    }
+
+private:
+    const cgltf_accessor* m_accessor       {nullptr};
+    const uint8_t*        m_data           {nullptr};
+    cgltf_size            m_stride         {0};
+    cgltf_size            m_component_count{0};
+    bool                  m_direct         {false};
+};
+
+// Sets value of every key; vertex_from_key[key] is the accessor element
+// for key. Property map storage is sized once.
+template <typename Key_type, typename Value_type>
+void read_property_values(
+    erhe::geometry::Property_map<Key_type, Value_type>* property_map,
+    const Accessor_reader&                              reader,
+    const std::vector<uint32_t>&                        vertex_from_key
+)
+{
+    static_assert(sizeof(Value_type) <= 4 * sizeof(float));
+
+    const std::size_t key_count = vertex_from_key.size();
+    property_map->values .resize(key_count);
+    property_map->present.assign(key_count, true);
+    for (std::size_t key = 0; key < key_count; ++key)
+    {
+        float v[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        reader.read(vertex_from_key[key], &v[0]);
+        std::memcpy(&property_map->values[key], &v[0], sizeof(Value_type));
+    }
+}
+
+// Reads every element of accessor; components which accessor does not
+// have are left to 0, except w which is left to 1.
+template <typename Value_type>
+void read_values(
+    const Accessor_reader&   reader,
+    const cgltf_size         count,
+    std::vector<Value_type>& out_values
+)
+{
+    static_assert(sizeof(Value_type) <= 4 * sizeof(float));
+
+    out_values.resize(count);
+    for (cgltf_size i = 0; i < count; ++i)
+    {
+        float v[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        reader.read(i, &v[0]);
+        std::memcpy(&out_values[i], &v[0], sizeof(Value_type));
+    }
+}
+
+template <typename Index_type>
+void read_indices(
+    const uint8_t*         data,
+    const cgltf_size       stride,
+    std::vector<uint32_t>& out_indices
+)
+{
+    for (std::size_t i = 0, end = out_indices.size(); i < end; ++i)
+    {
+        Index_type index;
+        std::memcpy(&index, data + i * stride, sizeof(Index_type));
+        out_indices[i] = static_cast<uint32_t>(index);
+    }
+}
+
 } // anonymous namespace
 
 using namespace glm;
@@ -205,6 +339,25 @@ auto to_erhe(const cgltf_light_type gltf_light_type) -> erhe::scene::Light_type
     }
 }
 
+// glTF sampler filter and wrap values are OpenGL enum values; 0 means
+// undefined
+auto to_erhe(const cgltf_sampler* sampler) -> std::shared_ptr<erhe::graphics::Sampler>
+{
+    const auto min_filter = (sampler->min_filter != 0)
+        ? static_cast<gl::Texture_min_filter>(sampler->min_filter)
+        : gl::Texture_min_filter::linear_mipmap_linear;
+    const auto mag_filter = (sampler->mag_filter != 0)
+        ? static_cast<gl::Texture_mag_filter>(sampler->mag_filter)
+        : gl::Texture_mag_filter::linear;
+
+    return std::make_shared<erhe::graphics::Sampler>(
+        min_filter,
+        mag_filter,
+        static_cast<gl::Texture_wrap_mode>(sampler->wrap_s),
+        static_cast<gl::Texture_wrap_mode>(sampler->wrap_t)
+    );
+}
+
 auto to_erhe(
     const cgltf_attribute_type gltf_attribute_type
 ) -> std::optional<erhe::geometry::Property_map_descriptor>
@@ -223,6 +376,28 @@ auto to_erhe(
     }
 }
 
+auto to_erhe(const cgltf_interpolation_type value) -> erhe::scene::Animation_interpolation_mode
+{
+    switch (value)
+    {
+        case cgltf_interpolation_type::cgltf_interpolation_type_step:         return erhe::scene::Animation_interpolation_mode::step;
+        case cgltf_interpolation_type::cgltf_interpolation_type_linear:       return erhe::scene::Animation_interpolation_mode::linear;
+        case cgltf_interpolation_type::cgltf_interpolation_type_cubic_spline: return erhe::scene::Animation_interpolation_mode::cubic_spline;
+        default:                                                              return erhe::scene::Animation_interpolation_mode::linear;
+    }
+}
+
+auto to_erhe(const cgltf_animation_path_type value) -> erhe::scene::Animation_path
+{
+    switch (value)
+    {
+        case cgltf_animation_path_type::cgltf_animation_path_type_translation: return erhe::scene::Animation_path::translation;
+        case cgltf_animation_path_type::cgltf_animation_path_type_rotation:    return erhe::scene::Animation_path::rotation;
+        case cgltf_animation_path_type::cgltf_animation_path_type_scale:       return erhe::scene::Animation_path::scale;
+        default:                                                               return erhe::scene::Animation_path::invalid;
+    }
+}
+
 class Gltf_parser
 {
 public:
@@ -231,13 +406,29 @@ public:
     Gltf_parser(
         const std::shared_ptr<Scene_root>& scene_root,
         erhe::primitive::Build_info&       build_info,
-        const fs::path&                    path
+        const fs::path&                               path,
+        erhe::concurrency::Thread_pool* const         thread_pool,
+        const Gltf_import_mode                        import_mode,
+        erhe::graphics::Texture_transfer_queue* const texture_transfer_queue
     )
-        : m_scene_root{scene_root}
-        , m_build_info{build_info}
+        : m_scene_root            {scene_root}
+        , m_build_info            {build_info}
+        , m_thread_pool           {thread_pool}
+        , m_import_mode           {import_mode}
+        , m_texture_transfer_queue{texture_transfer_queue}
+        , m_path                  {path}
     {
         m_scene_root->scene().nodes_sorted = false;
 
+        if (thread_pool != nullptr)
+        {
+            m_execution_queue = std::make_unique<Parallel_task_queue>(*thread_pool, "glTF primitives");
+        }
+        else
+        {
+            m_execution_queue = std::make_unique<Serial_task_queue>();
+        }
+
         if (!open(path))
         {
             return;
@@ -248,18 +439,26 @@ public:
 
     void parse_and_build()
     {
+        if (m_data == nullptr)
+        {
+            return;
+        }
+
+        // Images are decoded while mesh primitives are built
+        decode_images();
+
         m_materials.reserve(m_data->materials_count);
         for (cgltf_size i = 0; i < m_data->materials_count; ++i)
         {
             parse_material(&m_data->materials[i]);
         }
 
+        build_mesh_primitives();
+        create_textures();
+
         // TODO:
-        //  - images
-        //  - textures
-        //  - samplers
-        //  - animations
-        //  - skins
+        //  - textures other than base color
+        //  - morph targets
 
         for (cgltf_size i = 0; i < m_data->scenes_count; ++i)
         {
@@ -415,6 +614,220 @@ private:
             log_parsers->warn("Material PBR specular glossiness is not yet implemented");
         }
     }
+    // Returns image used as base color texture by material, or nullptr
+    [[nodiscard]] static auto get_base_color_image(const cgltf_material* material) -> const cgltf_image*
+    {
+        if (!material->has_pbr_metallic_roughness)
+        {
+            return nullptr;
+        }
+        const cgltf_texture* texture = material->pbr_metallic_roughness.base_color_texture.texture;
+        return (texture != nullptr) ? texture->image : nullptr;
+    }
+
+    // Enqueues decode of images used by materials. Only base color
+    // textures are used for now.
+    void decode_images()
+    {
+        if (m_texture_transfer_queue == nullptr)
+        {
+            return;
+        }
+
+        m_images.resize(m_data->images_count);
+        std::vector<bool> image_used(m_data->images_count, false);
+        for (cgltf_size i = 0; i < m_data->materials_count; ++i)
+        {
+            const cgltf_image* image = get_base_color_image(&m_data->materials[i]);
+            if (image != nullptr)
+            {
+                image_used[image - m_data->images] = true;
+            }
+        }
+
+        for (cgltf_size i = 0; i < m_data->images_count; ++i)
+        {
+            if (!image_used[i])
+            {
+                continue;
+            }
+            const cgltf_image* image = &m_data->images[i];
+            m_execution_queue->enqueue(
+                [this, image]()
+                {
+                    decode_image(image);
+                }
+            );
+        }
+    }
+
+    // Decodes image and makes its mipmaps. Only writes the image slot,
+    // so it can run concurrently for different images.
+    void decode_image(const cgltf_image* image)
+    {
+        ERHE_PROFILE_FUNCTION
+
+        const auto       start_time  = std::chrono::steady_clock::now();
+        const cgltf_size image_index = image - m_data->images;
+
+        nonstd::optional<std::string> file_contents;
+        gsl::span<const std::byte>    encoded;
+        if (image->buffer_view != nullptr)
+        {
+            const cgltf_buffer_view* buffer_view = image->buffer_view;
+            const uint8_t* data = (buffer_view->data != nullptr)
+                ? static_cast<const uint8_t*>(buffer_view->data)
+                : (buffer_view->buffer->data != nullptr)
+                    ? static_cast<const uint8_t*>(buffer_view->buffer->data) + buffer_view->offset
+                    : nullptr;
+            if (data != nullptr)
+            {
+                encoded = gsl::span<const std::byte>{reinterpret_cast<const std::byte*>(data), buffer_view->size};
+            }
+        }
+        else if ((image->uri != nullptr) && (std::strncmp(image->uri, "data:", 5) != 0))
+        {
+            std::string uri{image->uri};
+            uri.resize(cgltf_decode_uri(uri.data()));
+            file_contents = erhe::toolkit::read(m_path.parent_path() / uri);
+            if (file_contents.has_value())
+            {
+                encoded = gsl::span<const std::byte>{
+                    reinterpret_cast<const std::byte*>(file_contents.value().data()),
+                    file_contents.value().size()
+                };
+            }
+        }
+
+        if (encoded.empty())
+        {
+            log_parsers->warn("Image {} {}: data not available", image_index, safe_str(image->name));
+            return;
+        }
+
+        erhe::graphics::PNG_loader loader;
+        erhe::graphics::Image_info image_info;
+        if (
+            !loader.open(encoded, image_info) ||
+            (image_info.format != erhe::graphics::Image_format::srgb8_alpha8)
+        )
+        {
+            log_parsers->warn("Image {} {}: unsupported format {}", image_index, safe_str(image->name), safe_str(image->mime_type));
+            return;
+        }
+
+        auto mipmapped_image = std::make_shared<erhe::graphics::Mipmapped_image>();
+        mipmapped_image->allocate(image_info.width, image_info.height);
+        const bool ok = loader.load(mipmapped_image->level_span(0));
+        loader.close();
+        if (!ok)
+        {
+            log_parsers->warn("Image {} {}: decode failed", image_index, safe_str(image->name));
+            return;
+        }
+        mipmapped_image->generate_mipmaps();
+
+        m_images[image_index] = mipmapped_image;
+
+        const auto end_time = std::chrono::steady_clock::now();
+        m_image_decode_time_us += std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+        m_image_decode_byte_count += mipmapped_image->byte_count();
+    }
+
+    // Creates textures for decoded images and queues their upload.
+    // Materials get their textures when upload is complete.
+    void create_textures()
+    {
+        if (m_texture_transfer_queue == nullptr)
+        {
+            return;
+        }
+
+        ERHE_PROFILE_FUNCTION
+
+        class Texture_user
+        {
+        public:
+            std::shared_ptr<erhe::primitive::Material> material;
+            std::shared_ptr<erhe::graphics::Sampler>   sampler;
+        };
+        std::vector<std::vector<Texture_user>>                users   (m_data->images_count);
+        std::vector<std::shared_ptr<erhe::graphics::Sampler>> samplers(m_data->samplers_count);
+        for (cgltf_size i = 0; i < m_data->materials_count; ++i)
+        {
+            const cgltf_material* material = &m_data->materials[i];
+            const cgltf_image*    image    = get_base_color_image(material);
+            if (image == nullptr)
+            {
+                continue;
+            }
+            const cgltf_sampler* sampler = material->pbr_metallic_roughness.base_color_texture.texture->sampler;
+            std::shared_ptr<erhe::graphics::Sampler> erhe_sampler;
+            if (sampler != nullptr)
+            {
+                auto& slot = samplers.at(sampler - m_data->samplers);
+                if (!slot)
+                {
+                    slot = to_erhe(sampler);
+                    slot->set_debug_label(fmt::format("glTF sampler {}", safe_str(sampler->name)));
+                }
+                erhe_sampler = slot;
+            }
+            users.at(image - m_data->images).push_back(
+                Texture_user{
+                    .material = m_materials.at(i),
+                    .sampler  = erhe_sampler
+                }
+            );
+        }
+
+        std::size_t texture_count{0};
+        for (cgltf_size i = 0; i < m_data->images_count; ++i)
+        {
+            const auto& image = m_images.at(i);
+            if (!image || users.at(i).empty())
+            {
+                continue;
+            }
+
+            const erhe::graphics::Texture_create_info create_info{
+                .internal_format = gl::Internal_format::srgb8_alpha8,
+                .use_mipmaps     = (image->level_count() > 1),
+                .width           = image->levels.front().width,
+                .height          = image->levels.front().height,
+                .level_count     = image->level_count()
+            };
+            auto texture = std::make_shared<erhe::graphics::Texture>(create_info);
+            texture->set_debug_label(
+                (m_data->images[i].name != nullptr)
+                    ? std::string{m_data->images[i].name}
+                    : fmt::format("glTF image {}", i)
+            );
+
+            m_texture_transfer_queue->enqueue(
+                texture,
+                image,
+                [texture, texture_users = std::move(users.at(i))]()
+                {
+                    for (const auto& user : texture_users)
+                    {
+                        user.material->texture = texture;
+                        user.material->sampler = user.sampler;
+                    }
+                }
+            );
+            ++texture_count;
+        }
+        m_images.clear();
+
+        log_parsers->info(
+            "Decoded {} glTF textures, {} MB with mipmaps, in {} ms of task time",
+            texture_count,
+            m_image_decode_byte_count.load() / (1024 * 1024),
+            m_image_decode_time_us.load() / 1000
+        );
+    }
+
     void parse_node_transform(
         cgltf_node*                               node,
         const std::shared_ptr<erhe::scene::Node>& erhe_node
@@ -519,6 +932,13 @@ private:
 
     static const std::size_t max_vertex_valency = 10;
 
+    class Built_primitive
+    {
+    public:
+        erhe::primitive::Primitive          primitive;
+        std::shared_ptr<Raytrace_primitive> raytrace_primitive;
+    };
+
     class Primitive_context
     {
     public:
@@ -773,14 +1193,17 @@ private:
         log_parsers->trace("unique index count = {}", context.primitive_used_indices.size());
     }
 
-    void parse_primitive_make_points(Primitive_context& context)
+    // Returns position attribute with lowest set index
+    [[nodiscard]] static auto find_position_attribute(
+        cgltf_primitive* primitive
+    ) -> cgltf_attribute*
     {
         cgltf_attribute* position_attribute{nullptr};
         cgltf_int min_index = std::numeric_limits<cgltf_int>::max();
 
-        for (cgltf_size i = 0; i < context.primitive->attributes_count; ++i)
+        for (cgltf_size i = 0; i < primitive->attributes_count; ++i)
         {
-            cgltf_attribute* attribute = &context.primitive->attributes[i];
+            cgltf_attribute* attribute = &primitive->attributes[i];
             if (
                 (attribute->type == cgltf_attribute_type::cgltf_attribute_type_position) &&
                 (attribute->index < min_index)
@@ -790,6 +1213,12 @@ private:
                 min_index = attribute->index;
             }
         }
+        return position_attribute;
+    }
+
+    void parse_primitive_make_points(Primitive_context& context)
+    {
+        cgltf_attribute* position_attribute = find_position_attribute(context.primitive);
         if (position_attribute == nullptr)
         {
             log_parsers->error("No vertex position attribute found");
@@ -1055,12 +1484,419 @@ private:
     {
         log_parsers->error("parse_triangle_fan() - not yet implemented");
     }
-    void parse_primitive(
-        const std::shared_ptr<erhe::scene::Mesh>& erhe_mesh,
-        cgltf_mesh*                               mesh,
-        cgltf_primitive*                          primitive
+
+    // Fast path is used for indexed triangles with vec3 positions, and
+    // index data in memory.
+    [[nodiscard]] static auto can_build_triangles_fast(cgltf_primitive* primitive) -> bool
+    {
+        if (primitive->type != cgltf_primitive_type::cgltf_primitive_type_triangles)
+        {
+            return false;
+        }
+
+        const cgltf_accessor* index_accessor = primitive->indices;
+        if (
+            (index_accessor == nullptr) ||
+            index_accessor->is_sparse ||
+            (index_accessor->count < 3) ||
+            (accessor_data(index_accessor) == nullptr)
+        )
+        {
+            return false;
+        }
+        switch (index_accessor->component_type)
+        {
+            case cgltf_component_type::cgltf_component_type_r_8u:
+            case cgltf_component_type::cgltf_component_type_r_16u:
+            case cgltf_component_type::cgltf_component_type_r_32u:
+                break;
+            default:
+                return false;
+        }
+
+        const cgltf_attribute* position_attribute = find_position_attribute(primitive);
+        return
+            (position_attribute != nullptr) &&
+            (position_attribute->data->type == cgltf_type::cgltf_type_vec3);
+    }
+
+    template <typename Value_type>
+    void read_attribute(
+        Primitive_context&                             context,
+        const erhe::geometry::Property_map_descriptor& property_descriptor,
+        const bool                                     is_point_attribute,
+        const Accessor_reader&                         reader,
+        const std::vector<uint32_t>&                   vertex_from_key
     )
     {
+        auto& geometry = *context.erhe_geometry.get();
+        if (is_point_attribute)
+        {
+            read_property_values(geometry.point_attributes().create<Value_type>(property_descriptor), reader, vertex_from_key);
+        }
+        else
+        {
+            read_property_values(geometry.corner_attributes().create<Value_type>(property_descriptor), reader, vertex_from_key);
+        }
+    }
+
+    // Builds triangles without sorting vertices. Vertices which share
+    // position are merged to one point using a hash map. Corner i is
+    // made for index i, so corner attributes are read using indices as
+    // is. Returns false without touching geometry if primitive can not
+    // be built this way.
+    auto build_triangles_fast(Primitive_context& context) -> bool
+    {
+        ERHE_PROFILE_FUNCTION
+
+        const cgltf_accessor* index_accessor    = context.primitive->indices;
+        const cgltf_accessor* position_accessor = find_position_attribute(context.primitive)->data;
+        const cgltf_size      triangle_count    = index_accessor->count / 3;
+        const cgltf_size      corner_count      = triangle_count * 3;
+        if (corner_count > std::numeric_limits<Corner_id>::max())
+        {
+            return false;
+        }
+
+        std::vector<uint32_t> indices(corner_count);
+        const uint8_t* index_data = accessor_data(index_accessor);
+        switch (index_accessor->component_type)
+        {
+            case cgltf_component_type::cgltf_component_type_r_8u:  read_indices<uint8_t >(index_data, index_accessor->stride, indices); break;
+            case cgltf_component_type::cgltf_component_type_r_16u: read_indices<uint16_t>(index_data, index_accessor->stride, indices); break;
+            case cgltf_component_type::cgltf_component_type_r_32u: read_indices<uint32_t>(index_data, index_accessor->stride, indices); break;
+            default: return false;
+        }
+
+        const auto [min_index_i, max_index_i] = std::minmax_element(indices.begin(), indices.end());
+        const uint32_t min_index = *min_index_i;
+        const uint32_t max_index = *max_index_i;
+        for (cgltf_size i = 0; i < context.primitive->attributes_count; ++i)
+        {
+            if (context.primitive->attributes[i].data->count <= max_index)
+            {
+                log_parsers->warn("Index {} out of range for attribute {}", max_index, i);
+                return false;
+            }
+        }
+
+        // Vertices which share position share point; points are made in
+        // order of first use
+        auto& geometry = *context.erhe_geometry.get();
+        const uint32_t         vertex_count = max_index - min_index + 1;
+        std::vector<glm::vec3> positions(vertex_count);
+        const Accessor_reader  position_reader{position_accessor};
+        for (uint32_t vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            float v[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            position_reader.read(min_index + vertex, &v[0]);
+            positions[vertex] = glm::vec3{v[0], v[1], v[2]};
+        }
+        std::vector<uint32_t> point_from_vertex;
+        std::vector<uint32_t> vertex_from_point;
+        erhe::primitive::weld_vertex_positions(indices, min_index, positions, point_from_vertex, vertex_from_point);
+        ERHE_VERIFY(geometry.get_point_count() == 0);
+        geometry.reserve_points(vertex_from_point.size());
+        for (uint32_t& vertex : vertex_from_point)
+        {
+            geometry.make_point();
+            vertex += min_index; // Attribute readers use accessor element index
+        }
+
+        geometry.reserve_polygons(triangle_count);
+        geometry.corners        .reserve(corner_count);
+        geometry.polygon_corners.reserve(corner_count);
+        for (cgltf_size i = 0; i < corner_count; i += 3)
+        {
+            const Polygon_id polygon_id = geometry.make_polygon();
+            geometry.make_polygon_corner(polygon_id, point_from_vertex[indices[i    ] - min_index]);
+            geometry.make_polygon_corner(polygon_id, point_from_vertex[indices[i + 1] - min_index]);
+            geometry.make_polygon_corner(polygon_id, point_from_vertex[indices[i + 2] - min_index]);
+        }
+        ERHE_VERIFY(geometry.get_corner_count() == corner_count);
+
+        log_parsers->trace(
+            "fast path: index count = {}, vertex count = {}, point count = {}, triangle count = {}",
+            index_accessor->count,
+            vertex_count,
+            vertex_from_point.size(),
+            triangle_count
+        );
+
+        for (cgltf_size i = 0; i < context.primitive->attributes_count; ++i)
+        {
+            const cgltf_attribute* attribute               = &context.primitive->attributes[i];
+            const auto             property_descriptor_opt = to_erhe(attribute->type);
+            if (!property_descriptor_opt.has_value())
+            {
+                log_parsers->warn("Attribute {} not yet supported", c_str(attribute->type));
+                continue;
+            }
+
+            const auto&           property_descriptor = property_descriptor_opt.value();
+            const bool            is_point_attribute  = (attribute->type == cgltf_attribute_type::cgltf_attribute_type_position);
+            const auto&           vertex_from_key     = is_point_attribute ? vertex_from_point : indices;
+            const Accessor_reader reader{attribute->data};
+            switch (attribute->data->type)
+            {
+                case cgltf_type::cgltf_type_scalar: read_attribute<float    >(context, property_descriptor, is_point_attribute, reader, vertex_from_key); break;
+                case cgltf_type::cgltf_type_vec2:   read_attribute<glm::vec2>(context, property_descriptor, is_point_attribute, reader, vertex_from_key); break;
+                case cgltf_type::cgltf_type_vec3:   read_attribute<glm::vec3>(context, property_descriptor, is_point_attribute, reader, vertex_from_key); break;
+                case cgltf_type::cgltf_type_vec4:   read_attribute<glm::vec4>(context, property_descriptor, is_point_attribute, reader, vertex_from_key); break;
+                default:
+                {
+                    log_parsers->warn("Attribute type {} not yet supported", c_str(attribute->data->type));
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Reads triangles and attributes of primitive without making geometry.
+    // Returns nullptr if primitive is not a triangle list with vec3
+    // positions, or if indices are out of range.
+    [[nodiscard]] auto read_triangle_soup(
+        cgltf_primitive*       primitive,
+        const std::string_view name
+    ) -> std::shared_ptr<erhe::primitive::Triangle_soup>
+    {
+        ERHE_PROFILE_FUNCTION
+
+        if (primitive->type != cgltf_primitive_type::cgltf_primitive_type_triangles)
+        {
+            return {};
+        }
+        const cgltf_attribute* position_attribute = find_position_attribute(primitive);
+        if (
+            (position_attribute == nullptr) ||
+            (position_attribute->data->type != cgltf_type::cgltf_type_vec3)
+        )
+        {
+            return {};
+        }
+
+        auto soup = std::make_shared<erhe::primitive::Triangle_soup>(name);
+
+        // Non-indexed primitives use accessor elements in order
+        const cgltf_accessor* index_accessor = primitive->indices;
+        const cgltf_size      index_count    = (index_accessor != nullptr)
+            ? index_accessor->count
+            : position_attribute->data->count;
+        const cgltf_size      corner_count   = (index_count / 3) * 3;
+        if (corner_count > std::numeric_limits<uint32_t>::max())
+        {
+            return {};
+        }
+        soup->indices.resize(corner_count);
+        if (index_accessor == nullptr)
+        {
+            for (cgltf_size i = 0; i < corner_count; ++i)
+            {
+                soup->indices[i] = static_cast<uint32_t>(i);
+            }
+        }
+        else
+        {
+            const uint8_t* index_data = index_accessor->is_sparse ? nullptr : accessor_data(index_accessor);
+            switch ((index_data != nullptr) ? index_accessor->component_type : cgltf_component_type::cgltf_component_type_invalid)
+            {
+                case cgltf_component_type::cgltf_component_type_r_8u:  read_indices<uint8_t >(index_data, index_accessor->stride, soup->indices); break;
+                case cgltf_component_type::cgltf_component_type_r_16u: read_indices<uint16_t>(index_data, index_accessor->stride, soup->indices); break;
+                case cgltf_component_type::cgltf_component_type_r_32u: read_indices<uint32_t>(index_data, index_accessor->stride, soup->indices); break;
+                default:
+                {
+                    for (cgltf_size i = 0; i < corner_count; ++i)
+                    {
+                        soup->indices[i] = static_cast<uint32_t>(cgltf_accessor_read_index(index_accessor, i));
+                    }
+                    break;
+                }
+            }
+        }
+        if (corner_count == 0)
+        {
+            return {};
+        }
+
+        const uint32_t max_index = *std::max_element(soup->indices.begin(), soup->indices.end());
+        for (cgltf_size i = 0; i < primitive->attributes_count; ++i)
+        {
+            const cgltf_attribute* attribute = &primitive->attributes[i];
+            const cgltf_accessor*  accessor  = attribute->data;
+            if (accessor->count <= max_index)
+            {
+                log_parsers->warn("Index {} out of range for attribute {}", max_index, i);
+                return {};
+            }
+
+            const Accessor_reader reader{accessor};
+            switch (attribute->type)
+            {
+                case cgltf_attribute_type::cgltf_attribute_type_position:
+                {
+                    if (attribute == position_attribute)
+                    {
+                        read_values(reader, accessor->count, soup->positions);
+                    }
+                    break;
+                }
+                case cgltf_attribute_type::cgltf_attribute_type_normal:
+                {
+                    if ((attribute->index == 0) && (accessor->type == cgltf_type::cgltf_type_vec3))
+                    {
+                        read_values(reader, accessor->count, soup->normals);
+                    }
+                    break;
+                }
+                case cgltf_attribute_type::cgltf_attribute_type_tangent:
+                {
+                    if ((attribute->index == 0) && (accessor->type == cgltf_type::cgltf_type_vec4))
+                    {
+                        read_values(reader, accessor->count, soup->tangents);
+                    }
+                    break;
+                }
+                case cgltf_attribute_type::cgltf_attribute_type_texcoord:
+                {
+                    if ((attribute->index == 0) && (accessor->type == cgltf_type::cgltf_type_vec2))
+                    {
+                        read_values(reader, accessor->count, soup->texcoords);
+                    }
+                    break;
+                }
+                case cgltf_attribute_type::cgltf_attribute_type_color:
+                {
+                    if (
+                        (attribute->index == 0) &&
+                        (
+                            (accessor->type == cgltf_type::cgltf_type_vec3) ||
+                            (accessor->type == cgltf_type::cgltf_type_vec4)
+                        )
+                    )
+                    {
+                        read_values(reader, accessor->count, soup->colors);
+                    }
+                    break;
+                }
+                case cgltf_attribute_type::cgltf_attribute_type_joints:
+                {
+                    if ((attribute->index == 0) && (accessor->type == cgltf_type::cgltf_type_vec4))
+                    {
+                        soup->joints.resize(accessor->count);
+                        for (cgltf_size j = 0; j < accessor->count; ++j)
+                        {
+                            cgltf_accessor_read_uint(accessor, j, &soup->joints[j][0], 4);
+                        }
+                    }
+                    break;
+                }
+                case cgltf_attribute_type::cgltf_attribute_type_weights:
+                {
+                    if ((attribute->index == 0) && (accessor->type == cgltf_type::cgltf_type_vec4))
+                    {
+                        read_values(reader, accessor->count, soup->weights);
+                    }
+                    break;
+                }
+                default:
+                {
+                    log_parsers->warn("Attribute {} not yet supported", c_str(attribute->type));
+                    break;
+                }
+            }
+        }
+
+        // Skinning needs both joints and weights
+        if (soup->joints.size() != soup->weights.size())
+        {
+            soup->joints .clear();
+            soup->weights.clear();
+        }
+
+        log_parsers->trace(
+            "direct: vertex count = {}, triangle count = {}",
+            soup->vertex_count(),
+            soup->triangle_count()
+        );
+        return soup;
+    }
+
+    // Builds GPU and raytrace primitive from triangle soup. Geometry is
+    // made later, if some operation asks for it.
+    auto build_primitive_direct(
+        cgltf_mesh*            mesh,
+        cgltf_primitive*       primitive,
+        const std::string_view name
+    ) -> bool
+    {
+        const auto soup = read_triangle_soup(primitive, name);
+        if (!soup)
+        {
+            return false;
+        }
+
+        const cgltf_size mesh_index      = mesh - m_data->meshes;
+        const cgltf_size primitive_index = primitive - mesh->primitives;
+
+        auto raytrace_primitive = std::make_shared<Raytrace_primitive>(soup);
+
+        const auto normal_style = erhe::primitive::Normal_style::point_normals;
+        auto& built_primitive = m_mesh_primitives.at(mesh_index).at(primitive_index);
+        built_primitive.primitive = erhe::primitive::Primitive{
+            .material              = get_material(primitive),
+            .gl_primitive_geometry = make_primitive(*soup.get(), m_build_info, normal_style),
+            .rt_primitive_geometry = raytrace_primitive->primitive_geometry,
+            .rt_vertex_buffer      = raytrace_primitive->vertex_buffer,
+            .rt_index_buffer       = raytrace_primitive->index_buffer,
+            .source_geometry       = {},
+            .source_triangle_soup  = soup,
+            .normal_style          = normal_style
+        };
+        built_primitive.raytrace_primitive = raytrace_primitive;
+        return true;
+    }
+
+    [[nodiscard]] static auto is_skinned(const cgltf_primitive* primitive) -> bool
+    {
+        bool has_joints {false};
+        bool has_weights{false};
+        for (cgltf_size i = 0; i < primitive->attributes_count; ++i)
+        {
+            const cgltf_attribute& attribute = primitive->attributes[i];
+            if (attribute.index != 0)
+            {
+                continue;
+            }
+            has_joints  = has_joints  || (attribute.type == cgltf_attribute_type::cgltf_attribute_type_joints);
+            has_weights = has_weights || (attribute.type == cgltf_attribute_type::cgltf_attribute_type_weights);
+        }
+        return has_joints && has_weights;
+    }
+
+    [[nodiscard]] auto get_material(
+        const cgltf_primitive* primitive
+    ) const -> std::shared_ptr<erhe::primitive::Material>
+    {
+        if (primitive->material == nullptr)
+        {
+            return {};
+        }
+        const cgltf_size material_index = primitive->material - m_data->materials;
+        return m_materials.at(material_index);
+    }
+
+    // Builds geometry, GPU and raytrace primitive for one glTF primitive.
+    // Only reads parser state, so it can run concurrently for different
+    // primitives.
+    void build_primitive(
+        cgltf_mesh*      mesh,
+        cgltf_primitive* primitive
+    )
+    {
+        ERHE_PROFILE_FUNCTION
+
+        const cgltf_size mesh_index      = mesh - m_data->meshes;
         const cgltf_size primitive_index = primitive - mesh->primitives;
 
         auto name = (mesh->name != nullptr)
@@ -1069,6 +1905,17 @@ private:
 
         log_parsers->trace("Primitive type: {}", c_str(primitive->type));
 
+        // Skinned primitives are always built from triangle soup, which
+        // keeps bind pose vertices for skinning.
+        if (
+            ((m_import_mode == Gltf_import_mode::direct) || is_skinned(primitive)) &&
+            build_primitive_direct(mesh, primitive, name)
+        )
+        {
+            ++m_direct_primitive_count;
+            return;
+        }
+
         Primitive_context context
         {
             .mesh          = mesh,
@@ -1076,25 +1923,32 @@ private:
             .erhe_geometry = std::make_shared<erhe::geometry::Geometry>(name)
         };
 
-        parse_primitive_used_indices(context);
-        parse_primitive_make_points(context);
-
-        switch (context.primitive->type)
+        if (can_build_triangles_fast(primitive) && build_triangles_fast(context))
         {
-            case cgltf_primitive_type::cgltf_primitive_type_points:         parse_points        (); break;
-            case cgltf_primitive_type::cgltf_primitive_type_lines:          parse_lines         (); break;
-            case cgltf_primitive_type::cgltf_primitive_type_line_loop:      parse_line_loop     (); break;
-            case cgltf_primitive_type::cgltf_primitive_type_line_strip:     parse_line_strip    (); break;
-            case cgltf_primitive_type::cgltf_primitive_type_triangles:      parse_triangles     (context); break;
-            case cgltf_primitive_type::cgltf_primitive_type_triangle_strip: parse_triangle_strip(); break;
-            case cgltf_primitive_type::cgltf_primitive_type_triangle_fan:   parse_triangle_fan  (); break;
-            default:
-                break;
+            ++m_fast_path_primitive_count;
         }
-
-        for (cgltf_size i = 0; i < primitive->attributes_count; ++i)
+        else
         {
-            parse_primitive_attribute(context, &primitive->attributes[i]);
+            parse_primitive_used_indices(context);
+            parse_primitive_make_points(context);
+
+            switch (context.primitive->type)
+            {
+                case cgltf_primitive_type::cgltf_primitive_type_points:         parse_points        (); break;
+                case cgltf_primitive_type::cgltf_primitive_type_lines:          parse_lines         (); break;
+                case cgltf_primitive_type::cgltf_primitive_type_line_loop:      parse_line_loop     (); break;
+                case cgltf_primitive_type::cgltf_primitive_type_line_strip:     parse_line_strip    (); break;
+                case cgltf_primitive_type::cgltf_primitive_type_triangles:      parse_triangles     (context); break;
+                case cgltf_primitive_type::cgltf_primitive_type_triangle_strip: parse_triangle_strip(); break;
+                case cgltf_primitive_type::cgltf_primitive_type_triangle_fan:   parse_triangle_fan  (); break;
+                default:
+                    break;
+            }
+
+            for (cgltf_size i = 0; i < primitive->attributes_count; ++i)
+            {
+                parse_primitive_attribute(context, &primitive->attributes[i]);
+            }
         }
 
         context.erhe_geometry->make_point_corners();
@@ -1105,38 +1959,93 @@ private:
         context.erhe_geometry->compute_polygon_normals();
         context.erhe_geometry->compute_polygon_centroids();
         context.erhe_geometry->generate_polygon_texture_coordinates();
+        erhe::primitive::prepare_geometry(*context.erhe_geometry.get(), m_build_info.format);
+
+        auto raytrace_primitive = std::make_shared<Raytrace_primitive>(context.erhe_geometry);
 
-        std::shared_ptr<erhe::primitive::Material> material;
-        if (primitive->material != nullptr)
+        // Large primitives are built in polygon ranges on the shared pool
+        std::unique_ptr<erhe::concurrency::Concurrent_queue> build_queue;
+        if (m_thread_pool != nullptr)
         {
-            cgltf_size material_index = primitive->material - m_data->materials;
-            material = m_materials.at(material_index);
+            build_queue = std::make_unique<erhe::concurrency::Concurrent_queue>(*m_thread_pool, "glTF primitive");
         }
 
-        auto node_raytrace = std::make_shared<Node_raytrace>(context.erhe_geometry);
-        auto* raytrace_primitive = node_raytrace->raytrace_primitive();
-
         const auto normal_style = erhe::primitive::Normal_style::point_normals;
-        erhe_mesh->mesh_data.primitives.push_back(
-            erhe::primitive::Primitive{
-                .material              = material,
-                .gl_primitive_geometry = make_primitive(
-                    *context.erhe_geometry.get(),
-                    m_build_info,
-                    normal_style
-                ),
-                .rt_primitive_geometry = raytrace_primitive->primitive_geometry,
-                .rt_vertex_buffer      = raytrace_primitive->vertex_buffer,
-                .rt_index_buffer       = raytrace_primitive->index_buffer,
-                .source_geometry       = context.erhe_geometry,
-                .normal_style          = normal_style
+        auto& built_primitive = m_mesh_primitives.at(mesh_index).at(primitive_index);
+        built_primitive.primitive = erhe::primitive::Primitive{
+            .material              = get_material(primitive),
+            .gl_primitive_geometry = make_primitive(
+                *context.erhe_geometry.get(),
+                m_build_info,
+                normal_style,
+                build_queue.get()
+            ),
+            .rt_primitive_geometry = raytrace_primitive->primitive_geometry,
+            .rt_vertex_buffer      = raytrace_primitive->vertex_buffer,
+            .rt_index_buffer       = raytrace_primitive->index_buffer,
+            .source_geometry       = context.erhe_geometry,
+            .normal_style          = normal_style
+        };
+        built_primitive.raytrace_primitive = raytrace_primitive;
+    }
+
+    // Builds primitives of all meshes used by nodes as independent tasks.
+    // Scene graph is assembled afterwards, in node order.
+    void build_mesh_primitives()
+    {
+        ERHE_PROFILE_FUNCTION
+
+        const auto start_time = std::chrono::steady_clock::now();
+
+        m_mesh_node_count.assign(m_data->meshes_count, 0);
+        for (cgltf_size i = 0; i < m_data->nodes_count; ++i)
+        {
+            const cgltf_mesh* mesh = m_data->nodes[i].mesh;
+            if (mesh != nullptr)
+            {
+                ++m_mesh_node_count[mesh - m_data->meshes];
             }
-        );
+        }
+
+        // Result slots are allocated before tasks are started
+        m_mesh_primitives.resize(m_data->meshes_count);
+        for (cgltf_size mesh_index = 0; mesh_index < m_data->meshes_count; ++mesh_index)
+        {
+            if (m_mesh_node_count[mesh_index] > 0)
+            {
+                m_mesh_primitives[mesh_index].resize(m_data->meshes[mesh_index].primitives_count);
+            }
+        }
 
-        erhe_mesh->attach(node_raytrace);
-        add_to_raytrace_scene(
-            m_scene_root->raytrace_scene(),
-            node_raytrace
+        std::size_t primitive_count{0};
+        for (cgltf_size mesh_index = 0; mesh_index < m_data->meshes_count; ++mesh_index)
+        {
+            if (m_mesh_node_count[mesh_index] == 0)
+            {
+                continue;
+            }
+            cgltf_mesh* mesh = &m_data->meshes[mesh_index];
+            for (cgltf_size i = 0; i < mesh->primitives_count; ++i)
+            {
+                cgltf_primitive* primitive = &mesh->primitives[i];
+                m_execution_queue->enqueue(
+                    [this, mesh, primitive]()
+                    {
+                        build_primitive(mesh, primitive);
+                    }
+                );
+                ++primitive_count;
+            }
+        }
+        m_execution_queue->wait();
+
+        const auto end_time = std::chrono::steady_clock::now();
+        log_parsers->info(
+            "Built {} glTF primitives ({} direct, {} using fast path) in {} ms",
+            primitive_count,
+            m_direct_primitive_count.load(),
+            m_fast_path_primitive_count.load(),
+            std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count()
         );
     }
     void parse_mesh(cgltf_node* node)
@@ -1151,9 +2060,32 @@ private:
 
         auto erhe_mesh = std::make_shared<erhe::scene::Mesh>(mesh->name);
 
-        for (cgltf_size i = 0; i < mesh->primitives_count; ++i)
+        // Primitives were built by build_mesh_primitives(). Nodes which
+        // share mesh also share geometry and raytrace primitive. Skinned
+        // vertices are written to GPU buffer, so skinned nodes which share
+        // mesh need their own GPU primitive.
+        const bool own_gl_primitive = (node->skin != nullptr) && (m_mesh_node_count.at(mesh_index) > 1);
+        for (const auto& built_primitive : m_mesh_primitives.at(mesh_index))
         {
-            parse_primitive(erhe_mesh, mesh, &mesh->primitives[i]);
+            erhe_mesh->mesh_data.primitives.push_back(built_primitive.primitive);
+
+            auto& primitive = erhe_mesh->mesh_data.primitives.back();
+            if (own_gl_primitive && primitive.source_triangle_soup)
+            {
+                primitive.gl_primitive_geometry = make_primitive(
+                    *primitive.source_triangle_soup.get(),
+                    m_build_info,
+                    primitive.normal_style
+                );
+            }
+            auto node_raytrace = primitive.source_geometry
+                ? std::make_shared<Node_raytrace>(primitive.source_geometry,      built_primitive.raytrace_primitive)
+                : std::make_shared<Node_raytrace>(primitive.source_triangle_soup, built_primitive.raytrace_primitive);
+            erhe_mesh->attach(node_raytrace);
+            add_to_raytrace_scene(
+                m_scene_root->raytrace_scene(),
+                node_raytrace
+            );
         }
 
         erhe_mesh->set_visibility_mask(
@@ -1234,6 +2166,179 @@ private:
             fix_node_hierarchy(node->children[i]);
         }
     }
+    [[nodiscard]] auto make_skin(const cgltf_skin* skin) const -> std::shared_ptr<erhe::scene::Skin>
+    {
+        auto erhe_skin = std::make_shared<erhe::scene::Skin>(safe_str(skin->name));
+        erhe_skin->joints.resize(skin->joints_count);
+        erhe_skin->inverse_bind_matrices.resize(skin->joints_count, glm::mat4{1.0f});
+        for (cgltf_size i = 0; i < skin->joints_count; ++i)
+        {
+            const cgltf_size joint_node_index = skin->joints[i] - m_data->nodes;
+            erhe_skin->joints[i] = m_nodes.at(joint_node_index);
+            if (
+                (skin->inverse_bind_matrices != nullptr) &&
+                (i < skin->inverse_bind_matrices->count)
+            )
+            {
+                cgltf_accessor_read_float(
+                    skin->inverse_bind_matrices,
+                    i,
+                    &erhe_skin->inverse_bind_matrices[i][0][0],
+                    16
+                );
+            }
+        }
+        return erhe_skin;
+    }
+
+    // Attaches skins to mesh nodes of current scene
+    void parse_skins()
+    {
+        ERHE_PROFILE_FUNCTION
+
+        std::vector<std::shared_ptr<erhe::scene::Skin>> skins(m_data->skins_count);
+        for (cgltf_size node_index = 0; node_index < m_data->nodes_count; ++node_index)
+        {
+            const cgltf_node* node      = &m_data->nodes[node_index];
+            auto              erhe_mesh = erhe::scene::as_mesh(m_nodes.at(node_index));
+            if ((node->skin == nullptr) || !erhe_mesh)
+            {
+                continue;
+            }
+
+            const cgltf_size skin_index = node->skin - m_data->skins;
+            auto&            erhe_skin  = skins.at(skin_index);
+            if (!erhe_skin)
+            {
+                erhe_skin = make_skin(node->skin);
+            }
+            erhe_mesh->mesh_data.skin = erhe_skin;
+            m_scene_root->add_skinned_mesh(erhe_mesh);
+            log_parsers->trace(
+                "Skin: node = {}, skin = {}, joint count = {}",
+                safe_str(node->name),
+                safe_str(node->skin->name),
+                node->skin->joints_count
+            );
+        }
+    }
+
+    [[nodiscard]] auto make_animation(
+        const cgltf_animation* animation
+    ) const -> std::shared_ptr<erhe::scene::Animation>
+    {
+        auto erhe_animation = std::make_shared<erhe::scene::Animation>(safe_str(animation->name));
+
+        erhe_animation->samplers.resize(animation->samplers_count);
+        for (cgltf_size i = 0; i < animation->samplers_count; ++i)
+        {
+            const cgltf_animation_sampler& sampler      = animation->samplers[i];
+            auto&                          erhe_sampler = erhe_animation->samplers[i];
+            erhe_sampler.interpolation_mode = to_erhe(sampler.interpolation);
+
+            const Accessor_reader input_reader{sampler.input};
+            erhe_sampler.timestamps.resize(sampler.input->count);
+            for (cgltf_size key = 0; key < sampler.input->count; ++key)
+            {
+                input_reader.read(key, &erhe_sampler.timestamps[key]);
+            }
+
+            // Accessor reader handles normalized integer rotations
+            const Accessor_reader output_reader{sampler.output};
+            const cgltf_size      component_count = output_reader.component_count();
+            erhe_sampler.component_count = component_count;
+            erhe_sampler.data.resize(sampler.output->count * component_count);
+            for (cgltf_size j = 0; j < sampler.output->count; ++j)
+            {
+                output_reader.read(j, &erhe_sampler.data[j * component_count]);
+            }
+        }
+
+        // Each animated node gets one target slot, initialized to node rest pose
+        std::vector<std::size_t> target_from_node(m_data->nodes_count, null_index);
+        for (cgltf_size i = 0; i < animation->channels_count; ++i)
+        {
+            const cgltf_animation_channel& channel = animation->channels[i];
+            const auto                     path    = to_erhe(channel.target_path);
+            if ((channel.target_node == nullptr) || (path == erhe::scene::Animation_path::invalid))
+            {
+                log_parsers->warn(
+                    "Animation {} channel {} with path {} not supported",
+                    safe_str(animation->name),
+                    i,
+                    c_str(channel.target_path)
+                );
+                continue;
+            }
+            const cgltf_size node_index = channel.target_node - m_data->nodes;
+            const auto&      erhe_node  = m_nodes.at(node_index);
+            if (!erhe_node)
+            {
+                // Node is not part of current scene
+                continue;
+            }
+
+            auto& target_index = target_from_node[node_index];
+            if (target_index == null_index)
+            {
+                const cgltf_node* node = channel.target_node;
+                auto& rest_pose = erhe_animation->rest_pose;
+                target_index = erhe_animation->targets.size();
+                erhe_animation->targets.push_back(erhe_node);
+                rest_pose.translations.push_back(
+                    node->has_translation
+                        ? glm::vec3{node->translation[0], node->translation[1], node->translation[2]}
+                        : glm::vec3{0.0f}
+                );
+                rest_pose.rotations.push_back(
+                    node->has_rotation
+                        ? glm::quat{node->rotation[3], node->rotation[0], node->rotation[1], node->rotation[2]}
+                        : glm::quat{1.0f, 0.0f, 0.0f, 0.0f}
+                );
+                rest_pose.scales.push_back(
+                    node->has_scale
+                        ? glm::vec3{node->scale[0], node->scale[1], node->scale[2]}
+                        : glm::vec3{1.0f}
+                );
+            }
+
+            erhe_animation->channels.push_back(
+                erhe::scene::Animation_channel{
+                    .path          = path,
+                    .sampler_index = static_cast<std::size_t>(channel.sampler - animation->samplers),
+                    .target_index  = target_index
+                }
+            );
+        }
+        return erhe_animation;
+    }
+
+    // Creates one player for each animation which animates nodes of current scene
+    void parse_animations()
+    {
+        ERHE_PROFILE_FUNCTION
+
+        for (cgltf_size i = 0; i < m_data->animations_count; ++i)
+        {
+            const cgltf_animation* animation      = &m_data->animations[i];
+            auto                   erhe_animation = make_animation(animation);
+            if (erhe_animation->channels.empty())
+            {
+                continue;
+            }
+            log_parsers->info(
+                "Animation: name = {}, channel count = {}, target count = {}, duration = {}",
+                erhe_animation->name,
+                erhe_animation->channels.size(),
+                erhe_animation->targets.size(),
+                erhe_animation->duration()
+            );
+            m_scene_root->add_animation_player(
+                std::make_shared<erhe::scene::Animation_player>(erhe_animation)
+            );
+        }
+    }
+
     void parse_scene(cgltf_scene* scene)
     {
         const cgltf_size scene_index = scene - m_data->scenes;
@@ -1255,18 +2360,35 @@ private:
         {
             fix_node_hierarchy(scene->nodes[i]);
         }
+
+        // Skins and animations refer to nodes of this scene
+        parse_skins();
+        parse_animations();
+
         m_nodes  .clear();
         m_cameras.clear();
         m_lights .clear();
         m_meshes .clear();
     }
 
-    std::shared_ptr<Scene_root>  m_scene_root;
-    erhe::primitive::Build_info& m_build_info;
-
-    cgltf_data*                                             m_data{nullptr};
-
-    std::vector<std::shared_ptr<erhe::primitive::Material>> m_materials;
+    std::shared_ptr<Scene_root>             m_scene_root;
+    erhe::primitive::Build_info&            m_build_info;
+    erhe::concurrency::Thread_pool*         m_thread_pool{nullptr};
+    Gltf_import_mode                        m_import_mode{Gltf_import_mode::geometry};
+    erhe::graphics::Texture_transfer_queue* m_texture_transfer_queue{nullptr};
+    fs::path                                m_path;
+    std::unique_ptr<ITask_queue>            m_execution_queue;
+
+    cgltf_data*                                                   m_data{nullptr};
+
+    std::vector<std::shared_ptr<erhe::primitive::Material>>       m_materials;
+    std::vector<std::vector<Built_primitive>>                     m_mesh_primitives; // [mesh index][primitive index]
+    std::atomic<std::size_t>                                      m_fast_path_primitive_count{0};
+    std::atomic<std::size_t>                                      m_direct_primitive_count   {0};
+    std::vector<std::size_t>                                      m_mesh_node_count; // [mesh index]
+    std::vector<std::shared_ptr<erhe::graphics::Mipmapped_image>> m_images; // [image index]
+    std::atomic<int64_t>                                          m_image_decode_time_us     {0};
+    std::atomic<std::size_t>                                      m_image_decode_byte_count  {0};
 
     // Scene context
     std::vector<std::shared_ptr<erhe::scene::Node>>   m_nodes;
@@ -1276,12 +2398,15 @@ private:
 };
 
 void parse_gltf(
-    const std::shared_ptr<Scene_root>& scene_root,
-    erhe::primitive::Build_info&       build_info,
-    const fs::path&                    path
+    const std::shared_ptr<Scene_root>&      scene_root,
+    erhe::primitive::Build_info&            build_info,
+    const fs::path&                         path,
+    erhe::concurrency::Thread_pool*         thread_pool,
+    const Gltf_import_mode                  import_mode,
+    erhe::graphics::Texture_transfer_queue* texture_transfer_queue
 )
 {
-    Gltf_parser parser{scene_root, build_info, path};
+    Gltf_parser parser{scene_root, build_info, path, thread_pool, import_mode, texture_transfer_queue};
     parser.parse_and_build();
 }
 
@@ -4,6 +4,14 @@
 
 #include <memory>
 
+namespace erhe::concurrency {
+    class Thread_pool;
+};
+
+namespace erhe::graphics {
+    class Texture_transfer_queue;
+};
+
 namespace erhe::primitive {
     class Build_info;
 };
@@ -12,10 +20,22 @@ namespace editor {
 
 class Scene_root;
 
+enum class Gltf_import_mode : unsigned int
+{
+    geometry = 0, // build erhe::geometry::Geometry, then buffers from geometry
+    direct   = 1  // write triangles to buffers as is; geometry is built when needed
+};
+
+// Mesh primitives are built and images are decoded in parallel using
+// thread_pool if it is given. Images are only loaded if texture_transfer_queue is
+// given; materials get their textures once upload is complete.
 void parse_gltf(
-    const std::shared_ptr<Scene_root>& scene_root,
-    erhe::primitive::Build_info&       build_info,
-    const fs::path&                    path
+    const std::shared_ptr<Scene_root>&      scene_root,
+    erhe::primitive::Build_info&            build_info,
+    const fs::path&                         path,
+    erhe::concurrency::Thread_pool*         thread_pool,
+    const Gltf_import_mode                  import_mode            = Gltf_import_mode::geometry,
+    erhe::graphics::Texture_transfer_queue* texture_transfer_queue = nullptr
 );
 
 }
@@ -0,0 +1,261 @@
+#include "parsers/mesh_cache.hpp"
+#include "editor_log.hpp"
+
+#include "erhe/geometry/geometry.hpp"
+#include "erhe/toolkit/mapped_file.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <gsl/span>
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+namespace editor {
+
+namespace {
+
+// File layout, native byte order:
+//
+//   char[8] magic, uint32 version, uint32 geometry count, uint64 key
+//   per geometry: uint64 byte count, Geometry::serialize() output,
+//                 padding to multiple of 8 bytes
+constexpr char     c_magic[8]{'E', 'R', 'H', 'E', 'M', 'E', 'S', 'H'};
+constexpr uint32_t c_version{1};
+constexpr size_t   c_header_size{sizeof(c_magic) + 2 * sizeof(uint32_t) + sizeof(uint64_t)};
+
+// FNV-1a
+constexpr uint64_t c_hash_offset{0xcbf29ce484222325ull};
+constexpr uint64_t c_hash_prime {0x00000100000001b3ull};
+
+auto hash(uint64_t value, const void* data, const std::size_t byte_count) -> uint64_t
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < byte_count; ++i)
+    {
+        value = (value ^ bytes[i]) * c_hash_prime;
+    }
+    return value;
+}
+
+auto padded(const std::size_t byte_count) -> std::size_t
+{
+    return (byte_count + 7) & ~std::size_t{7};
+}
+
+template <typename T>
+void append(std::string& out, const T& value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+auto load(const std::string_view data, const std::size_t offset) -> T
+{
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+auto make_file_name(const std::string_view name, const uint64_t key) -> std::string
+{
+    std::string result;
+    for (const char c : name)
+    {
+        result.push_back(
+            std::isalnum(static_cast<unsigned char>(c))
+                ? c
+                : '_'
+        );
+    }
+    return fmt::format("{}-{:016x}.erhemesh", result, key);
+}
+
+} // anonymous namespace
+
+auto make_mesh_cache_key(
+    const fs::path&        source_path,
+    const std::string_view settings
+) -> uint64_t
+{
+    ERHE_PROFILE_FUNCTION
+
+    const erhe::toolkit::Mapped_file file{source_path};
+    if (!file.is_valid())
+    {
+        return 0;
+    }
+    const std::string_view text = file.text();
+    return make_mesh_cache_key(
+        hash(c_hash_offset, text.data(), text.size()),
+        settings
+    );
+}
+
+auto make_mesh_cache_key(
+    const uint64_t         source_key,
+    const std::string_view settings
+) -> uint64_t
+{
+    // Geometry format is part of key, so that files written by builds
+    // with different geometry layout are never read
+    const uint64_t format = erhe::geometry::Geometry::serialize_format();
+    const uint64_t key = hash(
+        hash(
+            hash(c_hash_offset, &format, sizeof(format)),
+            &source_key,
+            sizeof(source_key)
+        ),
+        settings.data(),
+        settings.size()
+    );
+    return (key != 0) ? key : 1;
+}
+
+auto read_mesh_cache(
+    const fs::path& path,
+    const uint64_t  key
+) -> std::vector<std::shared_ptr<erhe::geometry::Geometry>>
+{
+    ERHE_PROFILE_FUNCTION
+
+    std::error_code error_code;
+    if (!fs::exists(path, error_code))
+    {
+        return {};
+    }
+
+    const erhe::toolkit::Mapped_file file{path};
+    const std::string_view           data = file.text();
+    if (
+        (data.size() < c_header_size) ||
+        (std::memcmp(data.data(), c_magic, sizeof(c_magic)) != 0) ||
+        (load<uint32_t>(data, 8) != c_version) ||
+        (load<uint64_t>(data, 16) != key)
+    )
+    {
+        log_parsers->info("Mesh cache {} is not valid", path.string());
+        return {};
+    }
+
+    const uint32_t geometry_count = load<uint32_t>(data, 12);
+    std::vector<std::shared_ptr<erhe::geometry::Geometry>> result;
+    std::size_t offset = c_header_size;
+    for (uint32_t i = 0; i < geometry_count; ++i)
+    {
+        if (offset + sizeof(uint64_t) > data.size())
+        {
+            return {};
+        }
+        const uint64_t byte_count = load<uint64_t>(data, offset);
+        offset += sizeof(uint64_t);
+        if (byte_count > data.size() - offset)
+        {
+            return {};
+        }
+
+        auto geometry = std::make_shared<erhe::geometry::Geometry>();
+        const gsl::span<const std::byte> bytes{
+            reinterpret_cast<const std::byte*>(data.data() + offset),
+            static_cast<std::size_t>(byte_count)
+        };
+        if (!geometry->deserialize(bytes))
+        {
+            log_parsers->warn("Mesh cache {} geometry {} is not valid", path.string(), i);
+            return {};
+        }
+        result.push_back(geometry);
+        offset += padded(static_cast<std::size_t>(byte_count));
+    }
+    return result;
+}
+
+auto write_mesh_cache(
+    const fs::path&                                               path,
+    const uint64_t                                                key,
+    const std::vector<std::shared_ptr<erhe::geometry::Geometry>>& geometries
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION
+
+    std::string data;
+    data.append(c_magic, sizeof(c_magic));
+    append(data, c_version);
+    append(data, static_cast<uint32_t>(geometries.size()));
+    append(data, key);
+    for (const auto& geometry : geometries)
+    {
+        const std::vector<std::byte> bytes = geometry->serialize();
+#if !defined(NDEBUG)
+        // Round trip check: restored geometry must serialize to same bytes
+        {
+            erhe::geometry::Geometry restored;
+            ERHE_VERIFY(restored.deserialize(bytes));
+            ERHE_VERIFY(restored.serialize() == bytes);
+        }
+#endif
+        append(data, static_cast<uint64_t>(bytes.size()));
+        data.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        data.resize(padded(data.size()), '\0');
+    }
+
+    std::error_code error_code;
+    fs::create_directories(path.parent_path(), error_code);
+
+    // Write to temporary file first so that a partially written file
+    // never has the final name
+    fs::path temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream stream{temp_path, std::ios::binary | std::ios::trunc};
+        stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!stream.good())
+        {
+            log_parsers->warn("Could not write mesh cache {}", temp_path.string());
+            return false;
+        }
+    }
+    fs::rename(temp_path, path, error_code);
+    if (error_code)
+    {
+        log_parsers->warn("Could not write mesh cache {}: {}", path.string(), error_code.message());
+        fs::remove(temp_path, error_code);
+        return false;
+    }
+    return true;
+}
+
+auto load_geometries_cached(
+    const fs::path&        cache_directory,
+    const std::string_view name,
+    const uint64_t         key,
+    const std::function<std::vector<std::shared_ptr<erhe::geometry::Geometry>>()>& make_geometries
+) -> std::vector<std::shared_ptr<erhe::geometry::Geometry>>
+{
+    ERHE_PROFILE_FUNCTION
+
+    if (key == 0)
+    {
+        return make_geometries();
+    }
+
+    const fs::path path = cache_directory / make_file_name(name, key);
+    auto geometries = read_mesh_cache(path, key);
+    if (!geometries.empty())
+    {
+        log_parsers->trace("Loaded {} geometries from mesh cache {}", geometries.size(), path.string());
+        return geometries;
+    }
+
+    geometries = make_geometries();
+    if (!geometries.empty())
+    {
+        write_mesh_cache(path, key, geometries);
+    }
+    return geometries;
+}
+
+}
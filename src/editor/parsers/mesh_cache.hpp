@@ -0,0 +1,59 @@
+#pragma once
+
+namespace erhe::geometry
+{
+    class Geometry;
+}
+
+#include "erhe/toolkit/filesystem.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace editor {
+
+// Geometries can be stored to .erhemesh files in cache directory so
+// that next time they can be loaded without parsing and processing
+// source files. Cache file is identified by key which is hash of
+// source file contents and settings used to make geometries; when
+// either changes, geometries are made again and new file is written.
+
+// Returns 0 if source file can not be read
+[[nodiscard]] auto make_mesh_cache_key(
+    const fs::path&        source_path,
+    const std::string_view settings
+) -> uint64_t;
+
+// Derives key for one of many meshes made from same source
+[[nodiscard]] auto make_mesh_cache_key(
+    const uint64_t         source_key,
+    const std::string_view settings
+) -> uint64_t;
+
+// Returns empty vector if file does not exist, key does not match or
+// file is not valid
+[[nodiscard]] auto read_mesh_cache(
+    const fs::path& path,
+    const uint64_t  key
+) -> std::vector<std::shared_ptr<erhe::geometry::Geometry>>;
+
+auto write_mesh_cache(
+    const fs::path&                                               path,
+    const uint64_t                                                key,
+    const std::vector<std::shared_ptr<erhe::geometry::Geometry>>& geometries
+) -> bool;
+
+// Reads geometries from cache file, or calls make_geometries and
+// writes the result to cache file. make_geometries is called without
+// cache if key is 0.
+[[nodiscard]] auto load_geometries_cached(
+    const fs::path&        cache_directory,
+    const std::string_view name,
+    const uint64_t         key,
+    const std::function<std::vector<std::shared_ptr<erhe::geometry::Geometry>>()>& make_geometries
+) -> std::vector<std::shared_ptr<erhe::geometry::Geometry>>;
+
+}
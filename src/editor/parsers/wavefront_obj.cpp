@@ -1,18 +1,23 @@
 #include "parsers/wavefront_obj.hpp"
 #include "editor_log.hpp"
+#include "task_queue.hpp"
 
 #include "erhe/geometry/geometry.hpp"
-#include "erhe/toolkit/file.hpp"
+#include "erhe/toolkit/mapped_file.hpp"
 #include "erhe/toolkit/profile.hpp"
 #include "erhe/toolkit/verify.hpp"
 
-#include <gsl/gsl>
-
 #include <algorithm>
-#include <cctype>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <glm/glm.hpp>
 #include <limits>
 #include <string>
+#include <string_view>
 
 namespace editor {
 
@@ -28,6 +33,8 @@ using erhe::geometry::c_corner_texcoords;
 // http://www.martinreddy.net/gfx/3d/OBJ.spec
 // https://www.marxentlabs.com/obj-files/
 
+namespace {
+
 enum class Command : unsigned int
 {
     Unknown = 0,
@@ -68,7 +75,7 @@ enum class Command : unsigned int
     Vertex_normal,
 };
 
-Command tokenize(const std::string& text)
+auto tokenize(const std::string_view text) -> Command
 {
     // Vertex data
     if (text == "v")          return Command::Vertex_position;
@@ -125,380 +132,805 @@ Command tokenize(const std::string& text)
 // vn -1.64188e-16 -0.284002 0.958824
 // f 1/1/1 2/2/2 3/3/3 4/4/4
 
-auto parse_obj_geometry(
-    const fs::path& path
-) -> std::vector<std::shared_ptr<erhe::geometry::Geometry>>
+// Splits line to tokens without copying
+class Line_tokenizer
 {
-    ERHE_PROFILE_FUNCTION
+public:
+    explicit Line_tokenizer(const std::string_view line)
+        : m_line{line}
+    {
+    }
 
-    log_parsers->trace("path = {}", path.generic_string());
+    [[nodiscard]] auto next() -> std::string_view
+    {
+        skip_delimiters();
+        const std::size_t start = m_pos;
+        while ((m_pos < m_line.size()) && !is_delimiter(m_line[m_pos]))
+        {
+            ++m_pos;
+        }
+        return m_line.substr(start, m_pos - start);
+    }
 
-    std::vector<std::shared_ptr<erhe::geometry::Geometry>> result;
-    const auto opt_text = erhe::toolkit::read(path);
-
-    // I dislike this big scope, I'd prefer just to
-    // return {} but unfortunately having more than
-    // one return kills named return value optimization.
-    if (opt_text.has_value())
-    {
-        const std::string& text = opt_text.value();
-
-        std::shared_ptr<erhe::geometry::Geometry> geometry{};
-        erhe::geometry::Property_map<erhe::geometry::Point_id,  glm::vec3>* point_positions {nullptr};
-        erhe::geometry::Property_map<erhe::geometry::Point_id,  glm::vec3>* point_colors    {nullptr};
-        erhe::geometry::Property_map<erhe::geometry::Corner_id, glm::vec3>* corner_normals  {nullptr};
-        erhe::geometry::Property_map<erhe::geometry::Corner_id, glm::vec2>* corner_texcoords{nullptr};
-
-        const std::string delimiters  = " \t\v";
-        const std::string end_of_line = "\n";
-        const std::string slash       = "/\r";
-        const std::string comment     = "#";
-
-        std::string::size_type line_last_pos = text.find_first_not_of(end_of_line, 0);
-        std::string::size_type line_pos      = text.find_first_of(end_of_line, line_last_pos);
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec3> colors;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec2> texcoords;
-
-        // Mapping from OBJ point id to erhe::geometry::Geometry::Point_Id
-        std::vector<Point_id>  obj_point_to_geometry_point;
-
-        bool has_vertex_colors = false;
-
-        while (
-            (line_pos != std::string::npos) ||
-            (line_last_pos != std::string::npos)
-        )
-        {
-            auto line = text.substr(line_last_pos, line_pos - line_last_pos);
-            line.erase(
-                std::remove(
-                    line.begin(),
-                    line.end(),
-                    '\r'
-                ),
-                line.end()
-            );
+    // Rest of line without leading and trailing delimiters
+    [[nodiscard]] auto rest() -> std::string_view
+    {
+        skip_delimiters();
+        std::size_t end = m_line.size();
+        while ((end > m_pos) && is_delimiter(m_line[end - 1]))
+        {
+            --end;
+        }
+        const auto result = m_line.substr(m_pos, end - m_pos);
+        m_pos = m_line.size();
+        return result;
+    }
+
+private:
+    [[nodiscard]] static auto is_delimiter(const char c) -> bool
+    {
+        return (c == ' ') || (c == '\t') || (c == '\v') || (c == '\r');
+    }
+
+    void skip_delimiters()
+    {
+        while ((m_pos < m_line.size()) && is_delimiter(m_line[m_pos]))
+        {
+            ++m_pos;
+        }
+    }
+
+    std::string_view m_line;
+    std::size_t      m_pos{0};
+};
+
+// Fallback for forms which parse_float() does not handle, like inf and nan
+auto parse_float_slow(const std::string_view text, float& out) -> bool
+{
+    std::array<char, 64> buffer;
+    if (text.size() >= buffer.size())
+    {
+        return false;
+    }
+    std::memcpy(buffer.data(), text.data(), text.size());
+    buffer[text.size()] = '\0';
+    char* end{nullptr};
+    out = std::strtof(buffer.data(), &end);
+    return end == buffer.data() + text.size();
+}
+
+// Parses decimal floating point number. Up to 19 significant digits are
+// accumulated to integer mantissa, which is then scaled by power of ten
+// in double precision; result is within one ulp of correctly rounded
+// float. Exact parsing is not needed for mesh data, and this is several
+// times faster than strtof(), which also needs null terminated input.
+auto parse_float(const std::string_view text, float& out) -> bool
+{
+    static constexpr double exact_powers_of_ten[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char*       p   = text.data();
+    const char* const end = p + text.size();
 
-            // Drop comments
-            const auto coment_pos = line.find_first_of(comment);
-            if (coment_pos != std::string::npos)
+    bool negative{false};
+    if ((p != end) && ((*p == '-') || (*p == '+')))
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    uint64_t mantissa   {0};
+    int      exponent   {0};
+    int      digit_count{0};
+    bool     any_digits {false};
+    while ((p != end) && (*p >= '0') && (*p <= '9'))
+    {
+        if (digit_count < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            digit_count += (mantissa != 0) ? 1 : 0;
+        }
+        else
+        {
+            ++exponent;
+        }
+        any_digits = true;
+        ++p;
+    }
+    if ((p != end) && (*p == '.'))
+    {
+        ++p;
+        while ((p != end) && (*p >= '0') && (*p <= '9'))
+        {
+            if (digit_count < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                digit_count += (mantissa != 0) ? 1 : 0;
+                --exponent;
+            }
+            any_digits = true;
+            ++p;
+        }
+    }
+    if (!any_digits)
+    {
+        return parse_float_slow(text, out);
+    }
+    if ((p != end) && ((*p == 'e') || (*p == 'E')))
+    {
+        ++p;
+        bool negative_exponent{false};
+        if ((p != end) && ((*p == '-') || (*p == '+')))
+        {
+            negative_exponent = (*p == '-');
+            ++p;
+        }
+        if ((p == end) || (*p < '0') || (*p > '9'))
+        {
+            return parse_float_slow(text, out);
+        }
+        int explicit_exponent{0};
+        while ((p != end) && (*p >= '0') && (*p <= '9'))
+        {
+            if (explicit_exponent < 10000)
             {
-                line.erase(line.begin() + coment_pos, line.end());
+                explicit_exponent = explicit_exponent * 10 + (*p - '0');
             }
+            ++p;
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+    if (p != end)
+    {
+        return parse_float_slow(text, out);
+    }
 
-            //log_parsers->trace("line: {}", line);
-            if (line.length() == 0)
+    double value = static_cast<double>(mantissa);
+    if (mantissa != 0)
+    {
+        if ((exponent >= 0) && (exponent <= 22))
+        {
+            value *= exact_powers_of_ten[exponent];
+        }
+        else if ((exponent < 0) && (exponent >= -22))
+        {
+            value /= exact_powers_of_ten[-exponent];
+        }
+        else
+        {
+            value *= std::pow(10.0, static_cast<double>(exponent));
+        }
+    }
+    out = static_cast<float>(negative ? -value : value);
+    return true;
+}
+
+template <std::size_t N>
+auto parse_floats(Line_tokenizer& tokenizer, std::array<float, N>& out) -> std::size_t
+{
+    std::size_t count{0};
+    while (count < N)
+    {
+        const auto token = tokenizer.next();
+        if (token.empty() || !parse_float(token, out[count]))
+        {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
+// Vertex indices of face corner. Positive OBJ indices are global; they
+// are stored zero based. Negative OBJ indices are relative to number of
+// vertices read so far, which is not known until chunks are merged;
+// they are stored relative to first vertex of chunk.
+class Obj_corner
+{
+public:
+    static constexpr int32_t c_no_index      = std::numeric_limits<int32_t>::min();
+    static constexpr uint8_t c_position_bit  = 1u;
+    static constexpr uint8_t c_texcoord_bit  = 2u;
+    static constexpr uint8_t c_normal_bit    = 4u;
+
+    int32_t position     {c_no_index};
+    int32_t texcoord     {c_no_index};
+    int32_t normal       {c_no_index};
+    uint8_t relative_bits{0};
+};
+
+class Obj_group
+{
+public:
+    std::string name;
+    std::size_t first_face{0}; // chunk local face index
+};
+
+// Contents of one range of lines
+class Obj_chunk
+{
+public:
+    std::string_view        text;
+    std::vector<glm::vec3>  positions;
+    std::vector<glm::vec3>  colors; // empty, or one per position
+    std::vector<glm::vec3>  normals;
+    std::vector<glm::vec2>  texcoords;
+    std::vector<Obj_corner> corners;
+    std::vector<uint32_t>   face_corner_counts;
+    std::vector<Obj_group>  groups;
+    std::size_t             bad_index_count{0};
+};
+
+auto parse_index(
+    const std::string_view text,
+    const std::size_t      chunk_vertex_count,
+    const uint8_t          bit,
+    Obj_corner&            corner
+) -> int32_t
+{
+    int32_t value{0};
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if ((ec != std::errc{}) || (value == 0))
+    {
+        return Obj_corner::c_no_index;
+    }
+    if (value > 0)
+    {
+        return value - 1;
+    }
+    corner.relative_bits |= bit;
+    return static_cast<int32_t>(chunk_vertex_count) + value;
+}
+
+void parse_face(Line_tokenizer& tokenizer, Obj_chunk& chunk)
+{
+    uint32_t corner_count{0};
+    for (;;)
+    {
+        const auto token = tokenizer.next();
+        if (token.empty())
+        {
+            break;
+        }
+
+        // position/texcoord/normal, texcoord and normal are optional
+        Obj_corner       corner;
+        std::string_view fields[3];
+        std::size_t      field_count{0};
+        std::size_t      start      {0};
+        for (;;)
+        {
+            const std::size_t slash = token.find('/', start);
+            fields[field_count++] = token.substr(start, (slash == std::string_view::npos) ? std::string_view::npos : slash - start);
+            if ((slash == std::string_view::npos) || (field_count == 3))
             {
-                line_last_pos = text.find_first_not_of(end_of_line, line_pos);
-                line_pos      = text.find_first_of(end_of_line, line_last_pos);
-                continue;
+                break;
             }
+            start = slash + 1;
+        }
 
-            //const erhe::log::Indenter scope_indent;
+        corner.position = parse_index(fields[0], chunk.positions.size(), Obj_corner::c_position_bit, corner);
+        if (corner.position == Obj_corner::c_no_index)
+        {
+            ++chunk.bad_index_count;
+            continue;
+        }
+        if ((field_count > 1) && !fields[1].empty())
+        {
+            corner.texcoord = parse_index(fields[1], chunk.texcoords.size(), Obj_corner::c_texcoord_bit, corner);
+        }
+        if ((field_count > 2) && !fields[2].empty())
+        {
+            corner.normal = parse_index(fields[2], chunk.normals.size(), Obj_corner::c_normal_bit, corner);
+        }
+        chunk.corners.push_back(corner);
+        ++corner_count;
+    }
+    if (corner_count > 0)
+    {
+        chunk.face_corner_counts.push_back(corner_count);
+    }
+}
+
+void parse_line(std::string_view line, Obj_chunk& chunk)
+{
+    // Drop comments
+    const auto comment_pos = line.find('#');
+    if (comment_pos != std::string_view::npos)
+    {
+        line = line.substr(0, comment_pos);
+    }
+
+    Line_tokenizer tokenizer{line};
+    const auto command_text = tokenizer.next();
+    if (command_text.empty())
+    {
+        return;
+    }
 
-            // process line
-            std::string::size_type token_last_pos = line.find_first_not_of(delimiters, 0);
-            std::string::size_type token_pos      = line.find_first_of    (delimiters, token_last_pos);
-            if (token_last_pos == std::string::npos || token_pos == std::string::npos)
+    switch (tokenize(command_text))
+    {
+        //using enum Command;
+        case Command::Vertex_position:
+        {
+            // Three required variables: x, y, and z
+            // Some applications support colors; if they are available, add RBG values after the variables.
+            std::array<float, 6> v;
+            const auto count = parse_floats(tokenizer, v);
+            if (count < 3)
             {
-                line_last_pos = text.find_first_not_of(end_of_line, line_pos);
-                line_pos      = text.find_first_of(end_of_line, line_last_pos);
-                continue;
+                break;
+            }
+            if (count >= 6)
+            {
+                chunk.colors.resize(chunk.positions.size(), glm::vec3{1.0f});
+                chunk.colors.emplace_back(v[3], v[4], v[5]);
             }
+            else if (!chunk.colors.empty())
+            {
+                chunk.colors.emplace_back(1.0f);
+            }
+            chunk.positions.emplace_back(v[0], v[1], v[2]);
+            break;
+        }
 
-            const auto command_text = line.substr(token_last_pos, token_pos - token_last_pos);
-            const auto command      = tokenize(command_text);
+        case Command::Vertex_normal:
+        {
+            // Three required variables: x, y, and z
+            std::array<float, 3> v;
+            if (parse_floats(tokenizer, v) == 3)
+            {
+                chunk.normals.emplace_back(v[0], v[1], v[2]);
+            }
+            break;
+        }
 
-            //log_parsers->trace("command: {}", command_text);
-            std::vector<float> float_args;
-            std::vector<int>   int_args;
-            std::vector<int>   face_vertex_position_indices;
-            std::vector<int>   face_vertex_texcoord_indices;
-            std::vector<int>   face_vertex_normal_indices;
-            while ((token_pos != std::string::npos) || (token_last_pos != std::string::npos))
+        case Command::Vertex_texture_coordinate:
+        {
+            // One required variable: u
+            // Two optional variables: v and w
+            // The default is 0.
+            std::array<float, 3> v{0.0f, 0.0f, 0.0f};
+            if (parse_floats(tokenizer, v) >= 1)
             {
-                switch (command)
-                {
-                    //using enum Command;
-                    case Command::Object_name:
-                    {
-                        // TODO Choose Geometry splitting based on o / g / s / mg
-                        //      Currently fixed to use g
-                        token_last_pos = line.find_first_not_of(end_of_line, token_pos);
-                        token_pos      = line.find_first_of    (end_of_line, token_last_pos);
-                        if (token_last_pos != std::string::npos || token_pos != std::string::npos)
-                        {
-                            const auto arg_text = line.substr(token_last_pos, token_pos - token_last_pos);
-                            geometry         = std::make_shared<erhe::geometry::Geometry>(arg_text);
-                            point_positions  = geometry->point_attributes().create<glm::vec3>(c_point_locations);
-                            point_colors     = geometry->point_attributes().create<glm::vec3>(c_point_colors);
-                            corner_normals   = geometry->corner_attributes().create<glm::vec3>(c_corner_normals);
-                            corner_texcoords = geometry->corner_attributes().create<glm::vec2>(c_corner_texcoords);
-                            result.push_back(geometry);
-                            obj_point_to_geometry_point.clear();
-                            log_parsers->trace("arg: {}", arg_text);
-                        }
-                        break;
-                    }
+                chunk.texcoords.emplace_back(v[0], v[1]);
+            }
+            break;
+        }
 
-                    case Command::Group_name:
-                    {
-                        token_last_pos = line.find_first_not_of(delimiters, token_pos);
-                        token_pos      = line.find_first_of(end_of_line, token_last_pos);
-                        if (token_last_pos != std::string::npos || token_pos != std::string::npos)
-                        {
-                            const auto arg_text = line.substr(token_last_pos, token_pos - token_last_pos);
-                            geometry         = std::make_shared<erhe::geometry::Geometry>(arg_text);
-                            point_positions  = geometry->point_attributes().create<glm::vec3>(c_point_locations);
-                            point_colors     = geometry->point_attributes().create<glm::vec3>(c_point_colors);
-                            corner_normals   = geometry->corner_attributes().create<glm::vec3>(c_corner_normals);
-                            corner_texcoords = geometry->corner_attributes().create<glm::vec2>(c_corner_texcoords);
-                            result.push_back(geometry);
-                            obj_point_to_geometry_point.clear();
-                            //log_parsers->trace("arg: {}", arg_text);
-                        }
-                        //token_pos = text.find_first_of(end_of_line, token_last_pos);
-                        break;
-                    }
+        case Command::Face:
+        {
+            parse_face(tokenizer, chunk);
+            break;
+        }
 
-                    case Command::Use_material:
-                    case Command::Unknown:
-                    case Command::Material_library:
-                    {
-                        // consume rest of the line for now
-                        token_last_pos = line.find_first_not_of(end_of_line, token_pos);
-                        token_pos      = line.find_first_of    (end_of_line, token_last_pos);
-                        if (token_last_pos != std::string::npos || token_pos != std::string::npos)
-                        {
-                            const auto arg_text = line.substr(token_last_pos, token_pos - token_last_pos);
-                            //log_parsers->trace("arg: {}", arg_text);
-                        }
-                        //token_last_pos = line.find_first_not_of(end_of_line, token_pos);
-                        //token_pos = text.find_first_of(end_of_line, token_last_pos);
-                        break;
+        case Command::Object_name:
+        case Command::Group_name:
+        {
+            // TODO Choose Geometry splitting based on o / g / s / mg
+            const auto name = tokenizer.rest();
+            if (!name.empty())
+            {
+                chunk.groups.push_back(
+                    Obj_group{
+                        .name       = std::string{name},
+                        .first_face = chunk.face_corner_counts.size()
                     }
+                );
+            }
+            break;
+        }
 
-                    case Command::Vertex_position:
-                    // Three required variables: x, y, and z
-                    // One optional variable: w
-                    // Some applications support colors; if they are available, add RBG values after the variables.
-                    // The default is 1.
+        case Command::Vertex_parameter_space:
+        case Command::Use_material:
+        case Command::Material_library:
+        case Command::Unknown:
+        default:
+        {
+            break;
+        }
+    }
+}
 
-                    case Command::Vertex_normal:
-                    // If a UV (vt) or vertex normal (vn) are defined for one vertex in a shape, they must be defined for all.
-                    // Three required variables: x, y, and z
+void parse_chunk(Obj_chunk& chunk)
+{
+    ERHE_PROFILE_FUNCTION
 
-                    case Command::Vertex_texture_coordinate:
-                    // If a UV (vt) or vertex normal (vn) are defined for one vertex in a shape, they must be defined for all.
-                    // One required variable: u
-                    // Two optional variables: v and w
-                    // The default is 0.
+    const std::string_view text = chunk.text;
+    std::size_t pos{0};
+    while (pos < text.size())
+    {
+        std::size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos)
+        {
+            end = text.size();
+        }
+        parse_line(text.substr(pos, end - pos), chunk);
+        pos = end + 1;
+    }
+    if (!chunk.colors.empty())
+    {
+        chunk.colors.resize(chunk.positions.size(), glm::vec3{1.0f});
+    }
+}
 
-                    case Command::Vertex_parameter_space:
-                    // Use u for curve points
-                    // Use u and v for surface points and non-rational trimming curve control points
-                    // Use u, v, and w for rational trimming curve control points
+// Splits text to chunks at line boundaries
+auto make_chunks(
+    const std::string_view text,
+    const std::size_t      chunk_count
+) -> std::vector<Obj_chunk>
+{
+    std::vector<Obj_chunk> chunks(chunk_count);
+    std::size_t start{0};
+    for (std::size_t i = 0; i < chunk_count; ++i)
+    {
+        std::size_t end = (i + 1 == chunk_count)
+            ? text.size()
+            : std::max(start, (text.size() / chunk_count) * (i + 1));
+        if (end < text.size())
+        {
+            end = text.find('\n', end);
+            end = (end == std::string_view::npos) ? text.size() : end + 1;
+        }
+        chunks[i].text = text.substr(start, end - start);
+        start = end;
+    }
+    return chunks;
+}
 
-                    {
-                        token_last_pos = line.find_first_not_of(delimiters, token_pos);
-                        token_pos      = line.find_first_of    (delimiters, token_last_pos);
-                        if (token_last_pos != std::string::npos || token_pos != std::string::npos)
-                        {
-                            const auto  arg_text = line.substr(token_last_pos, token_pos - token_last_pos);
-                            const float value    = std::stof(arg_text);
-                            //log_parsers->trace("arg: {}", arg_text);
-                            float_args.push_back(value);
-                        }
-                        //token_last_pos = line.find_first_not_of(delimiters, token_pos);
-                        break;
-                    }
+// Concatenates vertex data of chunks and builds one geometry per group,
+// visiting chunks in file order.
+class Obj_geometry_builder
+{
+public:
+    Obj_geometry_builder(
+        std::vector<Obj_chunk>& chunks,
+        const std::string_view  default_name
+    )
+        : m_chunks      {chunks}
+        , m_default_name{default_name}
+    {
+    }
 
-                    case Command::Face:
-                    {
-                        token_last_pos = line.find_first_not_of(delimiters, token_pos);
-                        token_pos      = line.find_first_of    (delimiters, token_last_pos);
-                        if (token_last_pos != std::string::npos || token_pos != std::string::npos)
-                        {
-                            const auto arg_text = line.substr(token_last_pos, token_pos - token_last_pos);
-                            //log_parsers->trace("arg: {}", arg_text);
-                            std::string::size_type subtoken_last_pos = arg_text.find_first_not_of(slash, 0);
-                            std::string::size_type subtoken_pos      = arg_text.find_first_of(slash, subtoken_last_pos);
-                            int subtoken_slot = 0;
-                            while ((subtoken_pos != std::string::npos) || (subtoken_last_pos != std::string::npos))
-                            {
-                                const auto subtoken_text = arg_text.substr(subtoken_last_pos, subtoken_pos - subtoken_last_pos);
-                                //log_parsers->trace("subtoken: {}", subtoken_text);
-                                if (arg_text.length() > 0)
-                                {
-                                    const int value = std::stoi(subtoken_text);
-                                    switch (subtoken_slot)
-                                    {
-                                        case 0: face_vertex_position_indices.push_back(value); break;
-                                        case 1: face_vertex_texcoord_indices.push_back(value); break;
-                                        case 2: face_vertex_normal_indices  .push_back(value); break;
-                                        default:
-                                        {
-                                            //ERHE_FATAL("bad subtoken slot for wavefront obj parser face command");
-                                            break;
-                                        }
-                                    }
-                                }
-                                subtoken_last_pos = arg_text.find_first_not_of(slash, subtoken_pos);
-                                subtoken_pos      = arg_text.find_first_of    (slash, subtoken_last_pos);
-                                subtoken_slot++;
-                            }
-                        }
-                        //token_last_pos = line.find_first_not_of(delimiters, token_pos);
-                        break;
-                    }
+    [[nodiscard]] auto build() -> std::vector<std::shared_ptr<erhe::geometry::Geometry>>
+    {
+        ERHE_PROFILE_FUNCTION
+
+        merge_vertices();
+        for (std::size_t i = 0, end = m_chunks.size(); i < end; ++i)
+        {
+            build_chunk(i);
+        }
+        if (m_bad_index_count > 0)
+        {
+            log_parsers->warn("{} face corners with invalid vertex index were skipped", m_bad_index_count);
+        }
+        if (m_degenerate_face_count > 0)
+        {
+            log_parsers->warn("{} faces with less than three valid corners were skipped", m_degenerate_face_count);
+        }
+        return std::move(m_result);
+    }
+
+private:
+    class Bases
+    {
+    public:
+        std::size_t position{0};
+        std::size_t texcoord{0};
+        std::size_t normal  {0};
+    };
+
+    void merge_vertices()
+    {
+        std::size_t position_count{0};
+        std::size_t texcoord_count{0};
+        std::size_t normal_count  {0};
+        bool        has_colors    {false};
+        m_bases.resize(m_chunks.size());
+        for (std::size_t i = 0, end = m_chunks.size(); i < end; ++i)
+        {
+            const auto& chunk = m_chunks[i];
+            m_bases[i] = Bases{position_count, texcoord_count, normal_count};
+            position_count += chunk.positions.size();
+            texcoord_count += chunk.texcoords.size();
+            normal_count   += chunk.normals  .size();
+            has_colors = has_colors || !chunk.colors.empty();
+        }
+
+        m_positions.reserve(position_count);
+        m_texcoords.reserve(texcoord_count);
+        m_normals  .reserve(normal_count);
+        if (has_colors)
+        {
+            m_colors.reserve(position_count);
+        }
+        for (auto& chunk : m_chunks)
+        {
+            m_positions.insert(m_positions.end(), chunk.positions.begin(), chunk.positions.end());
+            m_texcoords.insert(m_texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+            m_normals  .insert(m_normals  .end(), chunk.normals  .begin(), chunk.normals  .end());
+            if (has_colors)
+            {
+                if (chunk.colors.empty())
+                {
+                    m_colors.resize(m_colors.size() + chunk.positions.size(), glm::vec3{1.0f});
+                }
+                else
+                {
+                    m_colors.insert(m_colors.end(), chunk.colors.begin(), chunk.colors.end());
                 }
             }
+            chunk.positions = {};
+            chunk.texcoords = {};
+            chunk.normals   = {};
+            chunk.colors    = {};
+        }
+        m_obj_point_to_geometry_point.resize(m_positions.size(), c_null_point);
+    }
 
-            switch (command)
+    void begin_geometry(const std::string_view name)
+    {
+        // Vertex indices in OBJ file are global.
+        // Each erhe::geometry Geometry has it's own namespace for Point_id.
+        for (const uint32_t position_index : m_used_positions)
+        {
+            m_obj_point_to_geometry_point[position_index] = c_null_point;
+        }
+        m_used_positions.clear();
+
+        m_geometry         = std::make_shared<erhe::geometry::Geometry>(name);
+        m_point_positions  = m_geometry->point_attributes ().create<glm::vec3>(c_point_locations);
+        m_point_colors     = m_geometry->point_attributes ().create<glm::vec3>(c_point_colors);
+        m_corner_normals   = m_geometry->corner_attributes().create<glm::vec3>(c_corner_normals);
+        m_corner_texcoords = m_geometry->corner_attributes().create<glm::vec2>(c_corner_texcoords);
+        m_result.push_back(m_geometry);
+    }
+
+    [[nodiscard]] static auto resolve(
+        const int32_t     index,
+        const bool        relative,
+        const std::size_t base,
+        const std::size_t count
+    ) -> std::size_t
+    {
+        if (index == Obj_corner::c_no_index)
+        {
+            return std::numeric_limits<std::size_t>::max();
+        }
+        const int64_t resolved = relative
+            ? static_cast<int64_t>(base) + index
+            : static_cast<int64_t>(index);
+        return ((resolved >= 0) && (static_cast<std::size_t>(resolved) < count))
+            ? static_cast<std::size_t>(resolved)
+            : std::numeric_limits<std::size_t>::max();
+    }
+
+    void build_chunk(const std::size_t chunk_index)
+    {
+        ERHE_PROFILE_FUNCTION
+
+        constexpr auto invalid = std::numeric_limits<std::size_t>::max();
+
+        const auto& chunk = m_chunks[chunk_index];
+        const auto& bases = m_bases[chunk_index];
+        m_bad_index_count += chunk.bad_index_count;
+
+        std::size_t group_index {0};
+        std::size_t corner_index{0};
+        const std::size_t face_count = chunk.face_corner_counts.size();
+        for (std::size_t face = 0; face <= face_count; ++face)
+        {
+            while ((group_index < chunk.groups.size()) && (chunk.groups[group_index].first_face == face))
+            {
+                begin_geometry(chunk.groups[group_index].name);
+                ++group_index;
+            }
+            if (face == face_count)
             {
-                //using enum Command;
-                case Command::Group_name:
-                case Command::Use_material:
-                case Command::Unknown:
-                case Command::Material_library:
-                default:
-                    break;
-                case Command::Vertex_position:
+                break;
+            }
+            if (!m_geometry)
+            {
+                begin_geometry(m_default_name);
+            }
+
+            // Validate indices before making polygon; faces with less than
+            // three valid corners are dropped
+            const uint32_t          corner_count = chunk.face_corner_counts[face];
+            const Obj_corner* const face_corners = chunk.corners.data() + corner_index;
+            corner_index += corner_count;
+            m_face_positions.clear();
+            for (uint32_t i = 0; i < corner_count; ++i)
+            {
+                const Obj_corner& corner         = face_corners[i];
+                const std::size_t position_index = resolve(corner.position, (corner.relative_bits & Obj_corner::c_position_bit) != 0, bases.position, m_positions.size());
+                if (position_index == invalid)
                 {
-                    //ZoneScopedN("position");
-                    if (float_args.size() >= 3)
-                    {
-                        Expects(geometry);
-                        if (float_args.size() >= 6)
-                        {
-                            while (colors.size() < positions.size())
-                            {
-                                colors.emplace_back(1.0f, 1.0f, 1.0f);
-                            }
-                            colors.emplace_back(float_args[3], float_args[4], float_args[5]);
-                            has_vertex_colors = true;
-                            //point_colors->put(point_id, glm::vec3{float_args[3], float_args[4], float_args[5]});
-                        }
-
-                        positions.emplace_back(float_args[0], float_args[1], float_args[2]);
-                    }
-                    //else
-                    //{
-                    //    ERHE_FATAL("unsupported vertex dimension");
-                    //}
-                    break;
+                    ++m_bad_index_count;
+                }
+                m_face_positions.push_back(position_index);
+            }
+            const auto valid_corner_count = std::count_if(
+                m_face_positions.begin(),
+                m_face_positions.end(),
+                [](const std::size_t position_index)
+                {
+                    return position_index != invalid;
                 }
+            );
+            if (valid_corner_count < 3)
+            {
+                ++m_degenerate_face_count;
+                continue;
+            }
 
-                case Command::Vertex_normal:
+            const Polygon_id polygon_id = m_geometry->make_polygon();
+            for (uint32_t i = 0; i < corner_count; ++i)
+            {
+                const Obj_corner& corner         = face_corners[i];
+                const std::size_t position_index = m_face_positions[i];
+                if (position_index == invalid)
                 {
-                    //ZoneScopedN("normal");
-                    if (float_args.size() == 3)
-                    {
-                        normals.emplace_back(float_args[0], float_args[1], float_args[2]);
-                    }
-                    //else
-                    //{
-                    //    ERHE_FATAL("unsupported normal dimension");
-                    //}
-                    break;
+                    continue;
                 }
-                case Command::Vertex_texture_coordinate:
+
+                Point_id& point_id = m_obj_point_to_geometry_point[position_index];
+                if (point_id == c_null_point)
                 {
-                    //ZoneScopedN("texcoord");
-                    // TODO support 1 / 3
-                    if (float_args.size() == 2)
+                    point_id = m_geometry->make_point();
+                    m_used_positions.push_back(static_cast<uint32_t>(position_index));
+                    m_point_positions->put(point_id, m_positions[position_index]);
+                    if (!m_colors.empty())
                     {
-                        texcoords.emplace_back(float_args[0], float_args[1]);
+                        m_point_colors->put(point_id, m_colors[position_index]);
                     }
-                    //else
-                    //{
-                    //    ERHE_FATAL("unsupported texcoord dimension");
-                    //}
-                    break;
                 }
-                case Command::Face:
+
+                const Corner_id corner_id = m_geometry->make_polygon_corner(polygon_id, point_id);
+
+                const std::size_t texcoord_index = resolve(corner.texcoord, (corner.relative_bits & Obj_corner::c_texcoord_bit) != 0, bases.texcoord, m_texcoords.size());
+                if (texcoord_index != invalid)
                 {
-                    //ZoneScopedN("face");
-                    Expects(geometry);
+                    m_corner_texcoords->put(corner_id, m_texcoords[texcoord_index]);
+                }
 
-                    const Polygon_id polygon_id   = geometry->make_polygon();
-                    const int        corner_count = static_cast<int>(face_vertex_position_indices.size());
-                    for (int i = 0; i < corner_count; ++i)
-                    {
-                        const int obj_vertex_index = face_vertex_position_indices[i];
-                        const int position_index =
-                            (obj_vertex_index > 0)
-                                ? obj_vertex_index - 1
-                                : obj_vertex_index + static_cast<int>(positions.size());
-
-                        // Vertex indices in OBJ file are global.
-                        // Each erhe::geometry Geometry has it's own namespace for Point_id.
-                        // This maps OBJ vertex indices to geometry Point_id.
-                        constexpr auto null_point = std::numeric_limits<Point_id>::max();
-                        while (static_cast<int>(obj_point_to_geometry_point.size()) <= position_index)
-                        {
-                            obj_point_to_geometry_point.push_back(null_point);
-                        }
-                        if (obj_point_to_geometry_point[position_index] == null_point)
-                        {
-                            obj_point_to_geometry_point[position_index] = geometry->make_point();
-                        }
-
-                        const Point_id  point_id  = obj_point_to_geometry_point[position_index];
-                        const Corner_id corner_id = geometry->make_polygon_corner(polygon_id, point_id);
-                        ERHE_VERIFY(position_index >= 0);
-                        ERHE_VERIFY(position_index < static_cast<int>(positions.size()));
-
-                        point_positions->put(point_id, positions[position_index]);
-
-                        if (has_vertex_colors)
-                        {
-                            point_colors->put(point_id, colors[position_index]);
-                        }
-
-                        if (i < static_cast<int>(face_vertex_texcoord_indices.size()))
-                        {
-                            const int obj_texcoord_index = face_vertex_texcoord_indices[i];
-                            const int texcoord_index =
-                                (obj_texcoord_index > 0)
-                                    ? obj_texcoord_index - 1
-                                    : obj_texcoord_index + static_cast<int>(texcoords.size());
-                            ERHE_VERIFY(texcoord_index < static_cast<int>(texcoords.size()));
-                            corner_texcoords->put(corner_id, texcoords[texcoord_index]);
-                        }
-
-                        if (i < static_cast<int>(face_vertex_normal_indices.size()))
-                        {
-                            const int obj_normal_index = face_vertex_normal_indices[i];
-                            const int normal_index =
-                                (obj_normal_index > 0)
-                                    ? obj_normal_index - 1
-                                    : obj_normal_index + static_cast<int>(normals.size());
-                            ERHE_VERIFY(normal_index < static_cast<int>(normals.size()));
-                            corner_normals->put(corner_id, normals[normal_index]);
-                        }
-                    }
+                const std::size_t normal_index = resolve(corner.normal, (corner.relative_bits & Obj_corner::c_normal_bit) != 0, bases.normal, m_normals.size());
+                if (normal_index != invalid)
+                {
+                    m_corner_normals->put(corner_id, m_normals[normal_index]);
                 }
             }
-
-            line_last_pos = text.find_first_not_of(end_of_line, line_pos);
-            line_pos = text.find_first_of(end_of_line, line_last_pos);
         }
+    }
 
-        for (auto g : result)
-        {
-            ERHE_PROFILE_SCOPE("post processing");
+    static constexpr Point_id c_null_point = std::numeric_limits<Point_id>::max();
+
+    std::vector<Obj_chunk>&  m_chunks;
+    std::string              m_default_name;
+    std::vector<Bases>       m_bases;
+    std::vector<glm::vec3>   m_positions;
+    std::vector<glm::vec3>   m_colors;
+    std::vector<glm::vec3>   m_normals;
+    std::vector<glm::vec2>   m_texcoords;
+    std::vector<Point_id>    m_obj_point_to_geometry_point;
+    std::vector<uint32_t>    m_used_positions; // positions mapped in current geometry
+    std::vector<std::size_t> m_face_positions; // resolved position indices of current face
+    std::size_t              m_bad_index_count{0};
+    std::size_t              m_degenerate_face_count{0};
+
+    std::shared_ptr<erhe::geometry::Geometry>                           m_geometry;
+    erhe::geometry::Property_map<erhe::geometry::Point_id,  glm::vec3>* m_point_positions {nullptr};
+    erhe::geometry::Property_map<erhe::geometry::Point_id,  glm::vec3>* m_point_colors    {nullptr};
+    erhe::geometry::Property_map<erhe::geometry::Corner_id, glm::vec3>* m_corner_normals  {nullptr};
+    erhe::geometry::Property_map<erhe::geometry::Corner_id, glm::vec2>* m_corner_texcoords{nullptr};
+    std::vector<std::shared_ptr<erhe::geometry::Geometry>>              m_result;
+};
+
+} // anonymous namespace
+
+// File is memory mapped and split to chunks at line boundaries. Chunks
+// are tokenized concurrently without copying text, and merged in file
+// order to geometries. Geometries are post processed concurrently.
+auto parse_obj_geometry(
+    const fs::path&                 path,
+    erhe::concurrency::Thread_pool* thread_pool
+) -> std::vector<std::shared_ptr<erhe::geometry::Geometry>>
+{
+    ERHE_PROFILE_FUNCTION
+
+    log_parsers->trace("path = {}", path.generic_string());
+
+    const erhe::toolkit::Mapped_file file{path};
+    if (!file.is_valid())
+    {
+        log_parsers->warn("Could not read '{}'", path.generic_string());
+        return {};
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // Chunks are large enough that task overhead does not matter
+    constexpr std::size_t min_chunk_size = 4 * 1024 * 1024;
+    const std::size_t thread_count = (thread_pool != nullptr)
+        ? static_cast<std::size_t>(std::max(thread_pool->size(), 1))
+        : 1;
+    const std::size_t chunk_count = std::clamp(
+        file.size() / min_chunk_size,
+        std::size_t{1},
+        4 * thread_count
+    );
+
+    std::unique_ptr<ITask_queue> execution_queue;
+    if ((thread_count > 1) && (chunk_count > 1))
+    {
+        execution_queue = std::make_unique<Parallel_task_queue>(*thread_pool, "obj parser");
+    }
+    else
+    {
+        execution_queue = std::make_unique<Serial_task_queue>();
+    }
 
-            g->make_point_corners();
+    auto chunks = make_chunks(file.text(), chunk_count);
+    for (auto& chunk : chunks)
+    {
+        execution_queue->enqueue(
+            [&chunk]()
+            {
+                parse_chunk(chunk);
+            }
+        );
+    }
+    execution_queue->wait();
+
+    Obj_geometry_builder builder{chunks, path.stem().string()};
+    auto result = builder.build();
+
+    const auto post_process = [](
+        erhe::geometry::Geometry&            geometry,
+        erhe::concurrency::Concurrent_queue* tangent_queue
+    )
+    {
+        ERHE_PROFILE_SCOPE("post processing");
 
-            g->build_edges();
-            g->generate_polygon_texture_coordinates();
-            g->compute_tangents();
+        geometry.make_point_corners();
+        geometry.build_edges();
+        geometry.generate_polygon_texture_coordinates();
+        geometry.compute_tangents(true, true, false, false, true, false, tangent_queue);
+    };
+
+    if (result.size() == 1)
+    {
+        // Single geometry is processed here and only tangent generation
+        // is split to tasks
+        post_process(*result.front().get(), execution_queue->concurrent_queue());
+    }
+    else
+    {
+        for (auto& geometry : result)
+        {
+            execution_queue->enqueue(
+                [&geometry, &post_process]()
+                {
+                    post_process(*geometry.get(), nullptr);
+                }
+            );
         }
+        execution_queue->wait();
     }
 
+    const auto end_time = std::chrono::steady_clock::now();
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    log_parsers->info(
+        "Parsed {}: {} bytes, {} chunks, {} geometries in {} ms",
+        path.generic_string(),
+        file.size(),
+        chunk_count,
+        result.size(),
+        duration.count()
+    );
     return result;
 }
 
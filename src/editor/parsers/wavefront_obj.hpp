@@ -1,5 +1,10 @@
 #pragma once
 
+namespace erhe::concurrency
+{
+    class Thread_pool;
+}
+
 namespace erhe::geometry
 {
     class Geometry;
@@ -13,8 +18,11 @@ namespace erhe::geometry
 
 namespace editor {
 
+// Chunks are parsed and geometries post processed in parallel using
+// thread_pool if it is given.
 [[nodiscard]] auto parse_obj_geometry(
-    const fs::path& path
+    const fs::path&                 path,
+    erhe::concurrency::Thread_pool* thread_pool = nullptr
 ) -> std::vector<std::shared_ptr<erhe::geometry::Geometry>>;
 
 }
@@ -3,6 +3,7 @@
 #include "renderers/draw_indirect_buffer.hpp"
 #include "renderers/programs.hpp"
 #include "renderers/program_interface.hpp"
+#include "renderers/render_queue.hpp"
 #include "editor_log.hpp"
 
 #include "erhe/gl/draw_indirect.hpp"
@@ -46,34 +47,26 @@ auto Draw_indirect_buffer::update(
         m_writer.write_offset
     );
 
-    auto&             buffer     = current_buffer();
     const std::size_t entry_size = sizeof(gl::Draw_elements_indirect_command);
+    std::size_t       max_draw_count{0};
+    for (const auto& mesh : meshes)
+    {
+        max_draw_count += mesh->mesh_data.primitives.size();
+    }
+    begin_write(max_draw_count * entry_size);
+
+    auto&             buffer     = current_buffer();
     const auto        gpu_data   = buffer.map();
     uint32_t          instance_count     {1};
-    uint32_t          base_instance      {0};
     std::size_t       draw_indirect_count{0};
-    m_writer.begin(buffer.target());
     for (const auto& mesh : meshes)
     {
-        if ((m_writer.write_offset + entry_size) > buffer.capacity_byte_count())
-        {
-            log_render->critical("draw indirect buffer capacity {} exceeded", buffer.capacity_byte_count());
-            ERHE_FATAL("draw indirect buffer capacity exceeded");
-            break;
-        }
-
         if (!visibility_filter(mesh->get_visibility_mask()))
         {
             continue;
         }
         for (auto& primitive : mesh->mesh_data.primitives)
         {
-            if ((m_writer.write_offset + entry_size) > buffer.capacity_byte_count())
-            {
-                log_render->critical("draw indirect buffer capacity {} exceeded", buffer.capacity_byte_count());
-                ERHE_FATAL("draw indirect buffer capacity exceeded");
-                break;
-            }
             const auto& primitive_geometry = primitive.gl_primitive_geometry;
             const auto  index_range        = primitive_geometry.index_range(primitive_mode);
             if (index_range.index_count == 0)
@@ -87,9 +80,10 @@ auto Draw_indirect_buffer::update(
                 index_count = std::min(index_count, static_cast<uint32_t>(m_max_index_count));
             }
 
-            const uint32_t base_index  = primitive_geometry.base_index();
-            const uint32_t first_index = static_cast<uint32_t>(index_range.first_index + base_index);
-            const uint32_t base_vertex = primitive_geometry.base_vertex();
+            const uint32_t base_index    = primitive_geometry.base_index();
+            const uint32_t first_index   = static_cast<uint32_t>(index_range.first_index + base_index);
+            const uint32_t base_vertex   = primitive_geometry.base_vertex();
+            const uint32_t base_instance = static_cast<uint32_t>(draw_indirect_count); // shaders index primitives with gl_BaseInstance
 
             const gl::Draw_elements_indirect_command draw_command{
                 index_count,
@@ -106,15 +100,125 @@ auto Draw_indirect_buffer::update(
             );
 
             m_writer.write_offset += entry_size;
-            ERHE_VERIFY(m_writer.write_offset <= buffer.capacity_byte_count());
+            ERHE_VERIFY(m_writer.write_offset <= write_end());
             ++draw_indirect_count;
         }
     }
 
-    m_writer.end();
+    SPDLOG_LOGGER_TRACE(log_draw, "wrote {} entries to draw indirect buffer", draw_indirect_count);
+    return { end_write(), draw_indirect_count };
+}
+
+auto Draw_indirect_buffer::update(
+    const gsl::span<const Render_item>& render_items,
+    erhe::primitive::Primitive_mode     primitive_mode,
+    const gsl::span<const uint32_t>     primitive_slots
+) -> Draw_indirect_buffer_range
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto range = reserve(render_items.size() * sizeof(gl::Draw_elements_indirect_command));
+    return write(range, render_items, primitive_mode, primitive_slots);
+}
+
+auto Draw_indirect_buffer::write(
+    const erhe::application::Buffer_range& range,
+    const gsl::span<const Render_item>&    render_items,
+    erhe::primitive::Primitive_mode        primitive_mode,
+    const gsl::span<const uint32_t>        primitive_slots
+) const -> Draw_indirect_buffer_range
+{
+    ERHE_PROFILE_FUNCTION
+
+    ERHE_VERIFY(primitive_slots.empty() || (primitive_slots.size() == render_items.size()));
+
+    const std::size_t entry_size = sizeof(gl::Draw_elements_indirect_command);
+    ERHE_VERIFY(range.buffer != nullptr);
+
+    const auto        gpu_data   = range.buffer->map();
+    const std::size_t end_offset = range.first_byte_offset + range.byte_count;
+    std::size_t       offset     = range.first_byte_offset;
+    std::size_t       draw_indirect_count{0};
+    gl::Draw_elements_indirect_command draw_command{0, 0, 0, 0, 0};
+
+    const auto flush = [&]() -> bool
+    {
+        if (draw_command.instance_count == 0)
+        {
+            return true;
+        }
+        if ((offset + entry_size) > end_offset)
+        {
+            log_render->critical("draw indirect buffer range {} exceeded", range.byte_count);
+            ERHE_FATAL("draw indirect buffer range exceeded");
+            draw_command.instance_count = 0;
+            return false;
+        }
+        erhe::graphics::write(
+            gpu_data,
+            offset,
+            erhe::graphics::as_span(draw_command)
+        );
+        offset += entry_size;
+        ++draw_indirect_count;
+        return true;
+    };
+
+    for (std::size_t i = 0, end = render_items.size(); i < end; ++i)
+    {
+        const auto& item               = render_items[i];
+        const auto& primitive          = item.mesh->mesh_data.primitives[item.primitive_index];
+        const auto& primitive_geometry = primitive.gl_primitive_geometry;
+        const auto  index_range        = primitive_geometry.index_range(primitive_mode);
+        ERHE_VERIFY(index_range.index_count > 0);
+
+        uint32_t index_count = static_cast<uint32_t>(index_range.index_count);
+        if (m_max_index_count_enable)
+        {
+            index_count = std::min(index_count, static_cast<uint32_t>(m_max_index_count));
+        }
+
+        const uint32_t first_index   = static_cast<uint32_t>(index_range.first_index + primitive_geometry.base_index());
+        const uint32_t base_vertex   = primitive_geometry.base_vertex();
+        const uint32_t base_instance = primitive_slots.empty()
+            ? static_cast<uint32_t>(i)
+            : primitive_slots[i];
+
+        if (
+            (draw_command.instance_count > 0) &&
+            (draw_command.index_count    == index_count) &&
+            (draw_command.first_index    == first_index) &&
+            (draw_command.base_vertex    == base_vertex) &&
+            (draw_command.base_instance + draw_command.instance_count == base_instance)
+        )
+        {
+            ++draw_command.instance_count;
+            continue;
+        }
+
+        if (!flush())
+        {
+            break;
+        }
+        draw_command = gl::Draw_elements_indirect_command{
+            index_count,
+            1,
+            first_index,
+            base_vertex,
+            base_instance
+        };
+    }
+    flush();
 
     SPDLOG_LOGGER_TRACE(log_draw, "wrote {} entries to draw indirect buffer", draw_indirect_count);
-    return { m_writer.range, draw_indirect_count };
+    return Draw_indirect_buffer_range{
+        .range = erhe::application::Buffer_range{
+            .first_byte_offset = range.first_byte_offset,
+            .byte_count        = draw_indirect_count * entry_size,
+            .buffer            = range.buffer
+        },
+        .draw_indirect_count = draw_indirect_count
+    };
 }
 
 void Draw_indirect_buffer::debug_properties_window()
@@ -11,6 +11,8 @@ namespace erhe::scene
 namespace editor
 {
 
+class Render_item;
+
 class Draw_indirect_buffer_range
 {
 public:
@@ -31,6 +33,29 @@ public:
         const erhe::scene::Visibility_filter&                      visibility_filter
     ) -> Draw_indirect_buffer_range;
 
+    // Writes draw commands for render items, in render item order.
+    // Render items must have non-empty index range for primitive_mode.
+    // Base instance selects primitive entry; if primitive slots are not
+    // given, entries are expected in render item order.
+    //
+    // Consecutive render items which share draw range, and which have
+    // consecutive primitive entries, are merged into one instanced command.
+    auto update(
+        const gsl::span<const Render_item>& render_items,
+        erhe::primitive::Primitive_mode     primitive_mode,
+        const gsl::span<const uint32_t>     primitive_slots = {}
+    ) -> Draw_indirect_buffer_range;
+
+    // As update(), but writes into range returned by reserve(). Does not
+    // modify buffer state, so disjoint ranges can be written by worker
+    // threads. Range must have space for one command per render item.
+    [[nodiscard]] auto write(
+        const erhe::application::Buffer_range& range,
+        const gsl::span<const Render_item>&    render_items,
+        erhe::primitive::Primitive_mode        primitive_mode,
+        const gsl::span<const uint32_t>        primitive_slots = {}
+    ) const -> Draw_indirect_buffer_range;
+
     void debug_properties_window();
 
 private:
@@ -5,9 +5,11 @@
 #include "renderers/programs.hpp"
 #include "renderers/shadow_renderer.hpp"
 #include "editor_log.hpp"
+#include "task_queue.hpp"
 
 #include "erhe/application/configuration.hpp"
 #include "erhe/application/graphics/gl_context_provider.hpp"
+#include "erhe/concurrency/concurrent_queue.hpp"
 #include "erhe/gl/draw_indirect.hpp"
 #include "erhe/gl/wrapper_functions.hpp"
 #include "erhe/graphics/buffer.hpp"
@@ -30,6 +32,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
 #include <functional>
 
 namespace editor
@@ -59,6 +62,7 @@ void Forward_renderer::declare_required_components()
     m_mesh_memory   = require<Mesh_memory>();
     m_programs      = require<Programs   >();
     require<Program_interface>();
+    require<Worker_thread_pool>();
 }
 
 static constexpr std::string_view c_forward_renderer_initialize_component{"Forward_renderer::initialize_component()"};
@@ -78,8 +82,20 @@ void Forward_renderer::initialize_component()
     m_camera_buffers        = std::make_unique<Camera_buffer       >(shader_resources.camera_interface);
     m_draw_indirect_buffers = std::make_unique<Draw_indirect_buffer>(m_configuration->renderer.max_draw_count);
     m_primitive_buffers     = std::make_unique<Primitive_buffer    >(shader_resources.primitive_interface);
+    if (m_configuration->renderer.persistent_primitive_buffer)
+    {
+        m_persistent_primitive_buffer = std::make_unique<Persistent_primitive_buffer>(shader_resources.primitive_interface);
+    }
 
     m_dummy_texture = erhe::graphics::create_dummy_texture();
+
+    if (m_configuration->threading.parallel_draw_lists)
+    {
+        m_concurrent_queue = std::make_unique<erhe::concurrency::Concurrent_queue>(
+            get<Worker_thread_pool>()->thread_pool(),
+            "draw lists"
+        );
+    }
 }
 
 void Forward_renderer::post_initialize()
@@ -101,6 +117,36 @@ void Forward_renderer::next_frame()
     m_camera_buffers       ->next_frame();
     m_draw_indirect_buffers->next_frame();
     m_primitive_buffers    ->next_frame();
+    if (m_persistent_primitive_buffer)
+    {
+        m_persistent_primitive_buffer->next_frame();
+    }
+}
+
+void Forward_renderer::for_each_parallel(
+    const std::size_t                       count,
+    const std::function<void(std::size_t)>& func
+)
+{
+    if (!m_concurrent_queue || (count < 2))
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            func(i);
+        }
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        m_concurrent_queue->enqueue(
+            [&func, i]()
+            {
+                func(i);
+            }
+        );
+    }
+    m_concurrent_queue->wait();
 }
 
 auto Forward_renderer::primitive_settings() const -> Primitive_interface_settings&
@@ -155,6 +201,24 @@ void Forward_renderer::render(const Render_parameters& parameters)
         m_light_buffers->bind_light_buffer();
     }
 
+    // Shaders read light cluster buffer even when there are no lights,
+    // or no camera; then all clusters are empty.
+    if (m_configuration->renderer.light_clusters)
+    {
+        ERHE_PROFILE_SCOPE("light clusters");
+
+        if (camera != nullptr)
+        {
+            m_light_clusters.update(*camera, viewport, lights, parameters.light_projections);
+        }
+        else
+        {
+            m_light_clusters.clear();
+        }
+        m_light_buffers->update_clusters(m_light_clusters);
+        m_light_buffers->bind_cluster_buffer();
+    }
+
     if (erhe::graphics::Instance::info.use_bindless_texture)
     {
         ERHE_PROFILE_SCOPE("make textures resident");
@@ -178,16 +242,197 @@ void Forward_renderer::render(const Render_parameters& parameters)
         erhe::graphics::s_texture_unit_cache.bind(fallback_texture_handle);
     }
 
-    for (auto& pass : passes)
+    // Draw lists are built on worker threads: culling per mesh span, and
+    // render queue and draw commands per pass. Only persistent primitive
+    // buffer update, buffer range reservation and GL calls stay on this thread.
+    const std::size_t span_count = mesh_spans.size();
+    const std::size_t pass_count = passes.size();
+
+    // Culling is done once for all passes
+    const bool      enable_frustum_culling = m_configuration->renderer.cpu_frustum_culling && (camera != nullptr);
+    const glm::mat4 clip_from_world        = (camera != nullptr)
+        ? camera->projection_transforms(viewport).clip_from_world.matrix()
+        : glm::mat4{1.0f};
+    if (enable_frustum_culling)
     {
-        const auto& pipeline = pass->pipeline;
+        ERHE_PROFILE_SCOPE("frustum culling");
+
+        const erhe::toolkit::Frustum frustum{clip_from_world};
+        m_frustum_cullers.resize(span_count);
+        m_visible_meshes .resize(span_count);
+        for_each_parallel(
+            span_count,
+            [this, &frustum, &mesh_spans, &visibility_filter, &parameters](const std::size_t span_index)
+            {
+                m_frustum_cullers[span_index].cull(
+                    frustum,
+                    *(mesh_spans.begin() + span_index),
+                    visibility_filter,
+                    (span_index == 0) ? parameters.spatial_index : nullptr,
+                    m_visible_meshes[span_index]
+                );
+            }
+        );
+    }
+
+    // Occluders are chosen from meshes which passed frustum culling.
+    // Blending passes draw what is behind opaque meshes, so they are
+    // never occlusion culled.
+    const bool enable_occlusion_culling =
+        enable_frustum_culling &&
+        parameters.occlusion_culling &&
+        m_configuration->renderer.cpu_occlusion_culling &&
+        std::none_of(
+            passes.begin(),
+            passes.end(),
+            [](const Renderpass* pass)
+            {
+                return pass->pipeline.data.color_blend.enabled;
+            }
+        );
+    if (enable_occlusion_culling)
+    {
+        ERHE_PROFILE_SCOPE("occlusion culling");
+
+        m_occlusion_culler.begin(clip_from_world, m_configuration->graphics.reverse_depth);
+        for (const auto& visible_meshes : m_visible_meshes)
+        {
+            m_occlusion_culler.add_occluder_candidates(visible_meshes);
+        }
+        m_occlusion_culler.end();
+        for_each_parallel(
+            span_count,
+            [this](const std::size_t span_index)
+            {
+                m_occlusion_culler.remove_occluded(m_visible_meshes[span_index]);
+            }
+        );
+    }
+
+    // Render queue is built and sorted separately for each pass
+    m_pass_draw_lists.resize(pass_count);
+    {
+        ERHE_PROFILE_SCOPE("render queues");
+
+        const glm::vec3 view_position_in_world = (camera != nullptr)
+            ? glm::vec3{camera->position_in_world()}
+            : glm::vec3{0.0f};
+
+        for_each_parallel(
+            pass_count,
+            [this, &passes, &mesh_spans, &visibility_filter, view_position_in_world, enable_frustum_culling](const std::size_t pass_index)
+            {
+                const Renderpass* pass         = *(passes.begin() + pass_index);
+                auto&             render_queue = m_pass_draw_lists[pass_index].render_queue;
+                render_queue.clear();
+                if (!pass->pipeline.data.shader_stages)
+                {
+                    return;
+                }
+                const bool back_to_front = pass->pipeline.data.color_blend.enabled;
+                uint32_t   span_index    = 0;
+                for (const auto& span_meshes : mesh_spans)
+                {
+                    const gsl::span<const std::shared_ptr<erhe::scene::Mesh>> meshes = enable_frustum_culling
+                        ? gsl::span<const std::shared_ptr<erhe::scene::Mesh>>{m_visible_meshes[span_index]}
+                        : span_meshes;
+                    render_queue.add(
+                        static_cast<uint32_t>(pass_index),
+                        span_index,
+                        meshes,
+                        pass->primitive_mode,
+                        visibility_filter,
+                        view_position_in_world,
+                        back_to_front
+                    );
+                    ++span_index;
+                }
+                render_queue.sort();
+            }
+        );
+    }
+
+    // Persistent primitive buffer writes only changed entries. It does not
+    // support all settings; fall back to writing all entries. Buffer ranges
+    // are reserved here, and written by worker threads below.
+    {
+        ERHE_PROFILE_SCOPE("reserve draw lists");
+
+        for (auto& draw_list : m_pass_draw_lists)
+        {
+            const auto& items = draw_list.render_queue.items();
+            draw_list.persistent_primitives = false;
+            draw_list.primitive_slots.clear();
+            draw_list.draw_indirect_range = Draw_indirect_buffer_range{};
+            if (items.empty())
+            {
+                continue;
+            }
+            draw_list.persistent_primitives =
+                m_persistent_primitive_buffer &&
+                m_persistent_primitive_buffer->update(items, m_primitive_buffers->settings, draw_list.primitive_slots);
+            if (!draw_list.persistent_primitives)
+            {
+                draw_list.primitive_range = m_primitive_buffers->reserve(items.size() * m_primitive_buffers->entry_size());
+            }
+            draw_list.draw_indirect_reserve = m_draw_indirect_buffers->reserve(items.size() * sizeof(gl::Draw_elements_indirect_command));
+        }
+    }
+
+    {
+        ERHE_PROFILE_SCOPE("write draw lists");
+
+        for_each_parallel(
+            pass_count,
+            [this, &passes](const std::size_t pass_index)
+            {
+                const Renderpass* pass      = *(passes.begin() + pass_index);
+                auto&             draw_list = m_pass_draw_lists[pass_index];
+                gsl::span<const Render_item> draw_items = draw_list.render_queue.items();
+                if (draw_items.empty())
+                {
+                    return;
+                }
+                if (draw_list.persistent_primitives)
+                {
+                    // Instances of shared geometry need consecutive slots to be
+                    // merged into one draw command. Blending passes keep depth order.
+                    if (!pass->pipeline.data.color_blend.enabled)
+                    {
+                        Render_queue::order_instances_by_slot(
+                            draw_items,
+                            draw_list.primitive_slots,
+                            draw_list.instance_items,
+                            draw_list.instance_slots
+                        );
+                        draw_list.primitive_slots.swap(draw_list.instance_slots);
+                        draw_items = draw_list.instance_items;
+                    }
+                }
+                else
+                {
+                    m_primitive_buffers->write(draw_list.primitive_range, draw_items);
+                }
+                draw_list.draw_indirect_range = m_draw_indirect_buffers->write(
+                    draw_list.draw_indirect_reserve,
+                    draw_items,
+                    pass->primitive_mode,
+                    draw_list.primitive_slots
+                );
+            }
+        );
+    }
+
+    for (std::size_t pass_index = 0; pass_index < pass_count; ++pass_index)
+    {
+        auto&       pass      = *(passes.begin() + pass_index);
+        const auto& pipeline  = pass->pipeline;
+        const auto& draw_list = m_pass_draw_lists[pass_index];
         if (!pipeline.data.shader_stages)
         {
             continue;
         }
 
-        const auto primitive_mode = pass->primitive_mode; //select_primitive_mode(pass);
-
         if (pass->begin)
         {
             ERHE_PROFILE_SCOPE("pass begin");
@@ -198,27 +443,29 @@ void Forward_renderer::render(const Render_parameters& parameters)
 
         m_pipeline_state_tracker->execute(pipeline);
 
-        for (const auto& meshes : mesh_spans)
+        // All items of the pass share pipeline, so they are drawn with one multi draw
+        if (draw_list.draw_indirect_range.draw_indirect_count > 0)
         {
-            ERHE_PROFILE_SCOPE("mesh span");
+            ERHE_PROFILE_SCOPE("pass items");
             ERHE_PROFILE_GPU_SCOPE(c_forward_renderer_render);
 
-            m_primitive_buffers->update(meshes, visibility_filter);
-            const auto draw_indirect_buffer_range = m_draw_indirect_buffers->update(meshes, primitive_mode, visibility_filter);
-            if (draw_indirect_buffer_range.draw_indirect_count == 0)
+            if (draw_list.persistent_primitives)
             {
-                continue;
+                m_persistent_primitive_buffer->bind();
+            }
+            else
+            {
+                m_primitive_buffers->bind(draw_list.primitive_range);
             }
-            m_primitive_buffers->bind();
-            m_draw_indirect_buffers->bind();
+            m_draw_indirect_buffers->bind(draw_list.draw_indirect_range.range);
 
             {
                 ERHE_PROFILE_SCOPE("mdi");
                 gl::multi_draw_elements_indirect(
                     pipeline.data.input_assembly.primitive_topology,
                     m_mesh_memory->gl_index_type(),
-                    reinterpret_cast<const void *>(draw_indirect_buffer_range.range.first_byte_offset),
-                    static_cast<GLsizei>(draw_indirect_buffer_range.draw_indirect_count),
+                    reinterpret_cast<const void *>(draw_list.draw_indirect_range.range.first_byte_offset),
+                    static_cast<GLsizei>(draw_list.draw_indirect_range.draw_indirect_count),
                     static_cast<GLsizei>(sizeof(gl::Draw_elements_indirect_command))
                 );
             }
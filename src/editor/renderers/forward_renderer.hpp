@@ -5,7 +5,11 @@
 #include "renderers/light_buffer.hpp"
 #include "renderers/camera_buffer.hpp"
 #include "renderers/draw_indirect_buffer.hpp"
+#include "renderers/frustum_culler.hpp"
+#include "renderers/occlusion_culler.hpp"
+#include "renderers/persistent_primitive_buffer.hpp"
 #include "renderers/primitive_buffer.hpp"
+#include "renderers/render_queue.hpp"
 
 #include "erhe/components/components.hpp"
 #include "erhe/graphics/pipeline.hpp"
@@ -19,6 +23,11 @@
 #include <memory>
 #include <vector>
 
+namespace erhe::concurrency
+{
+    class Concurrent_queue;
+}
+
 namespace erhe::graphics
 {
     class OpenGL_state_tracker;
@@ -33,6 +42,7 @@ namespace erhe::scene
     class Light_layer;
     class Mesh;
     class Mesh_layer;
+    class Mesh_spatial_index;
     class Node;
     class Visibility_filter;
 }
@@ -82,6 +92,8 @@ public:
         const std::initializer_list<Renderpass* const>                     passes;
         const erhe::scene::Visibility_filter                               visibility_filter{};
         const glm::vec3                                                    ambient_light    {0.0f};
+        const bool                                                         occlusion_culling{false}; // for opaque content passes
+        const erhe::scene::Mesh_spatial_index*                             spatial_index    {nullptr}; // Optional, for frustum culling of first mesh span
     };
 
     void render(const Render_parameters& parameters);
@@ -96,6 +108,27 @@ public:
     auto primitive_settings() const -> Primitive_interface_settings&;
 
 private:
+    // Draw list of one pass
+    class Pass_draw_list
+    {
+    public:
+        Render_queue                    render_queue;
+        bool                            persistent_primitives{false};
+        std::vector<uint32_t>           primitive_slots;
+        std::vector<Render_item>        instance_items;
+        std::vector<uint32_t>           instance_slots;
+        erhe::application::Buffer_range primitive_range;
+        erhe::application::Buffer_range draw_indirect_reserve;
+        Draw_indirect_buffer_range      draw_indirect_range;
+    };
+
+    // Calls func for indices 0 .. count - 1 on worker threads, and waits
+    // for them to complete. Runs serially if parallel draw lists are disabled.
+    void for_each_parallel(
+        const std::size_t                       count,
+        const std::function<void(std::size_t)>& func
+    );
+
     // Component dependencies
     std::shared_ptr<erhe::application::Configuration>     m_configuration;
     std::shared_ptr<erhe::graphics::OpenGL_state_tracker> m_pipeline_state_tracker;
@@ -103,12 +136,21 @@ private:
     std::shared_ptr<Shadow_renderer>                      m_shadow_renderer;
     std::shared_ptr<Programs>                             m_programs;
 
-    std::unique_ptr<Material_buffer     >    m_material_buffers;
-    std::unique_ptr<Light_buffer        >    m_light_buffers;
-    std::unique_ptr<Camera_buffer       >    m_camera_buffers;
-    std::unique_ptr<Draw_indirect_buffer>    m_draw_indirect_buffers;
-    std::unique_ptr<Primitive_buffer    >    m_primitive_buffers;
-    std::shared_ptr<erhe::graphics::Texture> m_dummy_texture;
+    std::unique_ptr<Material_buffer            > m_material_buffers;
+    std::unique_ptr<Light_buffer               > m_light_buffers;
+    std::unique_ptr<Camera_buffer              > m_camera_buffers;
+    std::unique_ptr<Draw_indirect_buffer       > m_draw_indirect_buffers;
+    std::unique_ptr<Primitive_buffer           > m_primitive_buffers;
+    std::unique_ptr<Persistent_primitive_buffer> m_persistent_primitive_buffer;
+    std::shared_ptr<erhe::graphics::Texture    > m_dummy_texture;
+
+    std::unique_ptr<erhe::concurrency::Concurrent_queue> m_concurrent_queue;
+
+    Light_clusters                                               m_light_clusters;
+    std::vector<Frustum_culler>                                  m_frustum_cullers; // Per mesh span
+    Occlusion_culler                                             m_occlusion_culler;
+    std::vector<std::vector<std::shared_ptr<erhe::scene::Mesh>>> m_visible_meshes;  // Per mesh span
+    std::vector<Pass_draw_list>                                  m_pass_draw_lists; // Per pass
 };
 
 } // namespace editor
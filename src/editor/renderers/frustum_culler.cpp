@@ -0,0 +1,109 @@
+#include "renderers/frustum_culler.hpp"
+
+#include "erhe/scene/mesh.hpp"
+#include "erhe/scene/node.hpp"
+#include "erhe/scene/spatial_index.hpp"
+#include "erhe/toolkit/profile.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace editor
+{
+
+void Frustum_culler::cull(
+    const erhe::toolkit::Frustum&                              frustum,
+    const gsl::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
+    const erhe::scene::Visibility_filter&                      visibility_filter,
+    const erhe::scene::Mesh_spatial_index*                     spatial_index,
+    std::vector<std::shared_ptr<erhe::scene::Mesh>>&           out_visible_meshes
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    out_visible_meshes.clear();
+
+    if (
+        (spatial_index != nullptr) &&
+        !spatial_index->is_items_changed() &&
+        (spatial_index->item_count() == meshes.size())
+    )
+    {
+        // Index returns meshes in leaf order, sort to keep mesh order stable
+        spatial_index->query_frustum(frustum, m_query_indices);
+        std::sort(m_query_indices.begin(), m_query_indices.end());
+        for (const uint32_t mesh_index : m_query_indices)
+        {
+            const auto& mesh = meshes[mesh_index];
+            if (visibility_filter(mesh->get_visibility_mask()))
+            {
+                out_visible_meshes.push_back(mesh);
+            }
+        }
+        return;
+    }
+
+    m_candidates.clear();
+    m_center_x  .clear();
+    m_center_y  .clear();
+    m_center_z  .clear();
+    m_extent_x  .clear();
+    m_extent_y  .clear();
+    m_extent_z  .clear();
+
+    for (const auto& mesh : meshes)
+    {
+        if (!visibility_filter(mesh->get_visibility_mask()))
+        {
+            continue;
+        }
+        const auto      bounding_box = erhe::scene::get_world_bounding_box(*mesh.get());
+        const glm::vec3 center       = bounding_box.center();
+        const glm::vec3 extent       = bounding_box.diagonal() * 0.5f;
+        m_candidates.push_back(&mesh);
+        m_center_x  .push_back(center.x);
+        m_center_y  .push_back(center.y);
+        m_center_z  .push_back(center.z);
+        m_extent_x  .push_back(extent.x);
+        m_extent_y  .push_back(extent.y);
+        m_extent_z  .push_back(extent.z);
+    }
+
+    const std::size_t count = m_candidates.size();
+    m_visible.assign(count, 1);
+
+    const float* const center_x = m_center_x.data();
+    const float* const center_y = m_center_y.data();
+    const float* const center_z = m_center_z.data();
+    const float* const extent_x = m_extent_x.data();
+    const float* const extent_y = m_extent_y.data();
+    const float* const extent_z = m_extent_z.data();
+    uint8_t*     const visible  = m_visible.data();
+    for (const auto& plane : frustum.planes)
+    {
+        const float nx     = plane.x;
+        const float ny     = plane.y;
+        const float nz     = plane.z;
+        const float d      = plane.w;
+        const float abs_nx = std::abs(nx);
+        const float abs_ny = std::abs(ny);
+        const float abs_nz = std::abs(nz);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            // Signed distance of box center, and box projected radius
+            const float distance = nx * center_x[i] + ny * center_y[i] + nz * center_z[i] + d;
+            const float radius   = abs_nx * extent_x[i] + abs_ny * extent_y[i] + abs_nz * extent_z[i];
+            visible[i] &= static_cast<uint8_t>(distance + radius >= 0.0f);
+        }
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (visible[i] != 0)
+        {
+            out_visible_meshes.push_back(*m_candidates[i]);
+        }
+    }
+}
+
+} // namespace editor
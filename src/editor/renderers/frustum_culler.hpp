@@ -0,0 +1,52 @@
+#pragma once
+
+#include "erhe/toolkit/math_util.hpp"
+
+#include <gsl/gsl>
+
+#include <memory>
+#include <vector>
+
+namespace erhe::scene
+{
+    class Mesh;
+    class Mesh_spatial_index;
+    class Visibility_filter;
+}
+
+namespace editor
+{
+
+// Tests world space mesh bounding boxes against frustum planes.
+//
+// Boxes are gathered into separate center and extent arrays, so that
+// the plane tests run as simple loops over many meshes, which the
+// compiler can vectorize.
+class Frustum_culler
+{
+public:
+    // Clears out_visible_meshes, and then adds meshes which pass visibility
+    // filter, and have bounding box which intersects the frustum.
+    // If spatial index of meshes is given and up to date, candidates are
+    // queried from it instead of testing every mesh.
+    void cull(
+        const erhe::toolkit::Frustum&                              frustum,
+        const gsl::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
+        const erhe::scene::Visibility_filter&                      visibility_filter,
+        const erhe::scene::Mesh_spatial_index*                     spatial_index,
+        std::vector<std::shared_ptr<erhe::scene::Mesh>>&           out_visible_meshes
+    );
+
+private:
+    std::vector<const std::shared_ptr<erhe::scene::Mesh>*> m_candidates;
+    std::vector<float>                                     m_center_x;
+    std::vector<float>                                     m_center_y;
+    std::vector<float>                                     m_center_z;
+    std::vector<float>                                     m_extent_x;
+    std::vector<float>                                     m_extent_y;
+    std::vector<float>                                     m_extent_z;
+    std::vector<uint8_t>                                   m_visible;
+    std::vector<uint32_t>                                  m_query_indices;
+};
+
+} // namespace editor
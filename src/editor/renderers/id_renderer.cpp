@@ -32,6 +32,8 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace editor
 {
@@ -76,26 +78,22 @@ Id_renderer::Id_frame_resources::Id_frame_resources(const std::size_t slot)
 
 Id_renderer::Id_frame_resources::Id_frame_resources(Id_frame_resources&& other) noexcept
     : pixel_pack_buffer{std::move(other.pixel_pack_buffer)}
-    , data             {std::move(other.data)}
-    , time             {other.time}
+    , info             {other.info}
+    , id_ranges        {std::move(other.id_ranges)}
     , sync             {other.sync}
-    , clip_from_world  {other.clip_from_world}
-    , x_offset         {other.x_offset}
-    , y_offset         {other.y_offset}
     , state            {other.state}
 {
+    other.sync = nullptr;
 }
 
 auto Id_renderer::Id_frame_resources::operator=(Id_frame_resources&& other) noexcept -> Id_frame_resources&
 {
     pixel_pack_buffer = std::move(other.pixel_pack_buffer);
-    data              = std::move(other.data);
-    time              = other.time;
+    info              = other.info;
+    id_ranges         = std::move(other.id_ranges);
     sync              = other.sync;
-    clip_from_world   = other.clip_from_world;
-    x_offset          = other.x_offset;
-    y_offset          = other.y_offset;
     state             = other.state;
+    other.sync = nullptr;
     return *this;
 }
 
@@ -183,6 +181,15 @@ void Id_renderer::create_id_frame_resources()
     {
         m_id_frame_resources.emplace_back(slot);
     }
+
+    m_ids  .resize(s_pixel_count);
+    m_depth.resize(s_pixel_count);
+    for (std::size_t level = 1; level < s_depth_level_count; ++level)
+    {
+        const std::size_t extent = s_extent >> level;
+        m_min_depth[level].resize(extent * extent);
+        m_max_depth[level].resize(extent * extent);
+    }
 }
 
 
@@ -197,7 +204,105 @@ void Id_renderer::next_frame()
     m_draw_indirect_buffers->next_frame();
     m_primitive_buffers    ->next_frame();
 
+    poll_readbacks();
+
     m_current_id_frame_resource_slot = (m_current_id_frame_resource_slot + 1) % s_frame_resources_count;
+    ++m_frame_number;
+}
+
+void Id_renderer::poll_readbacks()
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Visit slots from newest to oldest. Fences are signaled in order,
+    // so once the newest signaled readback is found, older readbacks are
+    // complete, too, and can be dropped without reading.
+    bool        found{false};
+    std::size_t slot = m_current_id_frame_resource_slot;
+    for (std::size_t i = 0; i < m_id_frame_resources.size(); ++i)
+    {
+        auto& idr = m_id_frame_resources[slot];
+        slot = (slot + s_frame_resources_count - 1) % s_frame_resources_count;
+
+        if (idr.state != Id_frame_resources::State::Waiting_for_read)
+        {
+            continue;
+        }
+
+        if (!found)
+        {
+            GLint sync_status = GL_UNSIGNALED;
+            gl::get_sync_iv(idr.sync, gl::Sync_parameter_name::sync_status, 1, nullptr, &sync_status);
+            if (sync_status != GL_SIGNALED)
+            {
+                continue;
+            }
+            complete_readback(idr);
+            found = true;
+        }
+
+        gl::delete_sync(idr.sync);
+        idr.sync  = nullptr;
+        idr.state = Id_frame_resources::State::Unused;
+    }
+}
+
+void Id_renderer::complete_readback(Id_frame_resources& idr)
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto           gpu_data = idr.pixel_pack_buffer.map();
+    const uint8_t* const color    = reinterpret_cast<const uint8_t*>(gpu_data.data());
+    const std::byte*     depth    = gpu_data.data() + s_pixel_count * 4;
+
+    // Plain loop over contiguous pixels, so that compiler can vectorize it
+    uint32_t* const ids = m_ids.data();
+    for (std::size_t i = 0; i < s_pixel_count; ++i)
+    {
+        ids[i] =
+            (static_cast<uint32_t>(color[i * 4 + 0]) << 16u) |
+            (static_cast<uint32_t>(color[i * 4 + 1]) <<  8u) |
+             static_cast<uint32_t>(color[i * 4 + 2]);
+    }
+    memcpy(m_depth.data(), depth, s_pixel_count * sizeof(float));
+
+    build_depth_pyramid();
+
+    m_readback_info = idr.info;
+    m_readback_id_ranges.swap(idr.id_ranges);
+}
+
+void Id_renderer::build_depth_pyramid()
+{
+    ERHE_PROFILE_FUNCTION
+
+    for (std::size_t level = 1; level < s_depth_level_count; ++level)
+    {
+        const std::size_t  extent        = s_extent >> level;
+        const std::size_t  source_extent = extent * 2;
+        const float* const source_min    = (level == 1) ? m_depth.data() : m_min_depth[level - 1].data();
+        const float* const source_max    = (level == 1) ? m_depth.data() : m_max_depth[level - 1].data();
+        float* const       min_depth     = m_min_depth[level].data();
+        float* const       max_depth     = m_max_depth[level].data();
+        for (std::size_t y = 0; y < extent; ++y)
+        {
+            const float* const min_row0 = source_min + (y * 2) * source_extent;
+            const float* const min_row1 = min_row0 + source_extent;
+            const float* const max_row0 = source_max + (y * 2) * source_extent;
+            const float* const max_row1 = max_row0 + source_extent;
+            for (std::size_t x = 0; x < extent; ++x)
+            {
+                min_depth[y * extent + x] = std::min(
+                    std::min(min_row0[x * 2], min_row0[x * 2 + 1]),
+                    std::min(min_row1[x * 2], min_row1[x * 2 + 1])
+                );
+                max_depth[y * extent + x] = std::max(
+                    std::max(max_row0[x * 2], max_row0[x * 2 + 1]),
+                    std::max(max_row1[x * 2], max_row1[x * 2 + 1])
+                );
+            }
+        }
+    }
 }
 
 void Id_renderer::update_framebuffer(const erhe::scene::Viewport viewport)
@@ -367,10 +472,23 @@ void Id_renderer::render(const Render_parameters& parameters)
     const mat4 clip_from_world       = projection_transforms.clip_from_world.matrix();
 
     auto& idr = current_id_frame_resources();
-    idr.time            = time;
-    idr.x_offset        = std::max(x - (static_cast<int>(s_extent / 2)), 0);
-    idr.y_offset        = std::max(y - (static_cast<int>(s_extent / 2)), 0);
-    idr.clip_from_world = clip_from_world;
+    if (idr.state == Id_frame_resources::State::Waiting_for_read)
+    {
+        // GPU is more than s_frame_resources_count frames behind; drop
+        // the oldest readback instead of waiting for it.
+        gl::delete_sync(idr.sync);
+        idr.sync  = nullptr;
+        idr.state = Id_frame_resources::State::Unused;
+    }
+    idr.info = Readback_info{
+        .frame_number    = m_frame_number,
+        .time            = time,
+        .viewport        = viewport,
+        .clip_from_world = clip_from_world,
+        .x_offset        = std::max(x - (static_cast<int>(s_extent / 2)), 0),
+        .y_offset        = std::max(y - (static_cast<int>(s_extent / 2)), 0),
+        .valid           = true
+    };
 
     m_primitive_buffers->settings.color_source = Primitive_color_source::id_offset;
 
@@ -412,7 +530,7 @@ void Id_renderer::render(const Render_parameters& parameters)
         gl::clear      (gl::Clear_buffer_mask::color_buffer_bit | gl::Clear_buffer_mask::depth_buffer_bit);
         if (m_use_scissor)
         {
-            gl::scissor(idr.x_offset, idr.y_offset, s_extent, s_extent);
+            gl::scissor(idr.info.x_offset, idr.info.y_offset, s_extent, s_extent);
             gl::enable (gl::Enable_cap::scissor_test);
         }
     }
@@ -459,10 +577,10 @@ void Id_renderer::render(const Render_parameters& parameters)
         }
         gl::bind_buffer(gl::Buffer_target::pixel_pack_buffer, idr.pixel_pack_buffer.gl_name());
         void* const color_offset = nullptr;
-        void* const depth_offset = reinterpret_cast<void*>(s_extent * s_extent * 4);
+        void* const depth_offset = reinterpret_cast<void*>(s_pixel_count * 4);
         gl::read_pixels(
-            idr.x_offset,
-            idr.y_offset,
+            idr.info.x_offset,
+            idr.info.y_offset,
             s_extent,
             s_extent,
             gl::Pixel_format::rgba,
@@ -470,8 +588,8 @@ void Id_renderer::render(const Render_parameters& parameters)
             color_offset
         );
         gl::read_pixels(
-            idr.x_offset,
-            idr.y_offset,
+            idr.info.x_offset,
+            idr.info.y_offset,
             s_extent,
             s_extent,
             gl::Pixel_format::depth_component,
@@ -479,20 +597,38 @@ void Id_renderer::render(const Render_parameters& parameters)
             depth_offset
         );
         gl::bind_buffer(gl::Buffer_target::pixel_pack_buffer, 0);
-        idr.sync = gl::fence_sync(gl::Sync_condition::sync_gpu_commands_complete, 0);
+        idr.id_ranges = m_primitive_buffers->id_ranges();
+        idr.sync      = gl::fence_sync(gl::Sync_condition::sync_gpu_commands_complete, 0);
         idr.state = Id_frame_resources::State::Waiting_for_read;
     }
 
     gl::enable(gl::Enable_cap::framebuffer_srgb);
 }
 
-template<typename T>
-inline T read_as(uint8_t const* raw_memory)
+auto Id_renderer::readback_info() const -> const Readback_info&
 {
-    static_assert(std::is_trivially_copyable<T>());
-    T result;
-    memcpy(&result, raw_memory, sizeof(T));
-    return result;
+    return m_readback_info;
+}
+
+auto Id_renderer::frame_number() const -> uint64_t
+{
+    return m_frame_number;
+}
+
+auto Id_renderer::get_region(
+    const int x0,
+    const int y0,
+    const int x1,
+    const int y1
+) const -> Region
+{
+    const int extent = static_cast<int>(s_extent);
+    return Region{
+        .x0 = std::clamp(std::min(x0, x1)     - m_readback_info.x_offset, 0, extent),
+        .y0 = std::clamp(std::min(y0, y1)     - m_readback_info.y_offset, 0, extent),
+        .x1 = std::clamp(std::max(x0, x1) + 1 - m_readback_info.x_offset, 0, extent),
+        .y1 = std::clamp(std::max(y0, y1) + 1 - m_readback_info.y_offset, 0, extent)
+    };
 }
 
 auto Id_renderer::get(
@@ -500,67 +636,55 @@ auto Id_renderer::get(
     const int y,
     uint32_t& id,
     float&    depth
-) -> bool
+) const -> bool
 {
-    if (m_id_frame_resources.empty())
+    if (!m_readback_info.valid)
     {
         return false;
     }
-    int slot = static_cast<int>(m_current_id_frame_resource_slot);
 
-    for (size_t i = 0; i < s_frame_resources_count; ++i)
+    const int x_ = x - m_readback_info.x_offset;
+    const int y_ = y - m_readback_info.y_offset;
+    if (
+        (x_ < 0) ||
+        (y_ < 0) ||
+        (static_cast<std::size_t>(x_) >= s_extent) ||
+        (static_cast<std::size_t>(y_) >= s_extent)
+    )
     {
-        --slot;
-        if (slot < 0)
-        {
-            slot = s_frame_resources_count - 1;
-        }
-
-        auto& idr = m_id_frame_resources[slot];
-
-        if (idr.state == Id_frame_resources::State::Waiting_for_read)
-        {
-            GLint sync_status = GL_UNSIGNALED;
-            gl::get_sync_iv(idr.sync, gl::Sync_parameter_name::sync_status, 4, nullptr, &sync_status);
-
-            if (sync_status == GL_SIGNALED)
-            {
-                gl::bind_buffer(gl::Buffer_target::pixel_pack_buffer, idr.pixel_pack_buffer.gl_name());
-
-                auto gpu_data = idr.pixel_pack_buffer.map();
+        return false;
+    }
 
-                memcpy(&idr.data[0], gpu_data.data(), gpu_data.size_bytes());
-                idr.state = Id_frame_resources::State::Read_complete;
-            }
-        }
+    const std::size_t index = static_cast<std::size_t>(x_) + static_cast<std::size_t>(y_) * s_extent;
+    id    = m_ids  [index];
+    depth = m_depth[index];
+    return true;
+}
 
-        if (idr.state == Id_frame_resources::State::Read_complete)
+auto Id_renderer::find_id_range(const uint32_t id) const -> const Primitive_buffer::Id_range*
+{
+    // Id ranges are allocated in increasing offset order
+    auto i = std::upper_bound(
+        m_readback_id_ranges.begin(),
+        m_readback_id_ranges.end(),
+        id,
+        [](const uint32_t lhs, const Primitive_buffer::Id_range& rhs)
         {
-            if ((x >= idr.x_offset) && (y >= idr.y_offset))
-            {
-                const int x_ = x - idr.x_offset;
-                const int y_ = y - idr.y_offset;
-                if ((static_cast<size_t>(x_) < s_extent) && (static_cast<size_t>(y_) < s_extent))
-                {
-                    const uint32_t       stride    = s_extent * 4;
-                    const uint8_t        r         = idr.data[x_ * 4 + y_ * stride + 0];
-                    const uint8_t        g         = idr.data[x_ * 4 + y_ * stride + 1];
-                    const uint8_t        b         = idr.data[x_ * 4 + y_ * stride + 2];
-                    const uint8_t* const depth_ptr = &idr.data[s_extent * s_extent * 4 + x_ * 4 + y_ * stride];
-                    id                             = (r << 16) | (g << 8) | b;
-                    depth                          = read_as<float>(depth_ptr);
-                    return true;
-                }
-            }
+            return lhs < rhs.offset;
         }
+    );
+    if (i == m_readback_id_ranges.begin())
+    {
+        return nullptr;
     }
-    return false;
+    --i;
+    return (id < i->offset + i->length) ? &*i : nullptr;
 }
 
 auto Id_renderer::get(
     const int x,
     const int y
-) -> Id_query_result
+) const -> Id_query_result
 {
     Id_query_result result;
     const bool ok = get(x, y, result.id, result.depth);
@@ -570,21 +694,216 @@ auto Id_renderer::get(
     }
     result.valid = true;
 
-    for (auto& r : m_primitive_buffers->id_ranges())
+    const auto* const range = find_id_range(result.id);
+    if (range != nullptr)
     {
+        result.mesh                 = range->mesh;
+        result.mesh_primitive_index = range->primitive_index;
+        result.local_index          = result.id - range->offset;
+    }
+
+    return result;
+}
+
+void Id_renderer::reduce_depth(
+    const std::size_t level,
+    const int         cell_x,
+    const int         cell_y,
+    const Region&     region,
+    Depth_range&      depth_range
+) const
+{
+    const int size = 1 << level;
+    const int x0   = cell_x * size;
+    const int y0   = cell_y * size;
+    const int x1   = x0 + size;
+    const int y1   = y0 + size;
+    if ((x1 <= region.x0) || (x0 >= region.x1) || (y1 <= region.y0) || (y0 >= region.y1))
+    {
+        return;
+    }
+
+    if (level == 0)
+    {
+        const float depth = m_depth[static_cast<std::size_t>(x0) + static_cast<std::size_t>(y0) * s_extent];
+        depth_range.min_depth = std::min(depth_range.min_depth, depth);
+        depth_range.max_depth = std::max(depth_range.max_depth, depth);
+        return;
+    }
+
+    if ((x0 >= region.x0) && (x1 <= region.x1) && (y0 >= region.y0) && (y1 <= region.y1))
+    {
+        const std::size_t extent = s_extent >> level;
+        const std::size_t index  = static_cast<std::size_t>(cell_x) + static_cast<std::size_t>(cell_y) * extent;
+        depth_range.min_depth = std::min(depth_range.min_depth, m_min_depth[level][index]);
+        depth_range.max_depth = std::max(depth_range.max_depth, m_max_depth[level][index]);
+        return;
+    }
+
+    // Partially covered cell
+    for (int child = 0; child < 4; ++child)
+    {
+        reduce_depth(level - 1, cell_x * 2 + (child & 1), cell_y * 2 + (child >> 1), region, depth_range);
+    }
+}
+
+auto Id_renderer::get_depth_range(
+    const int x0,
+    const int y0,
+    const int x1,
+    const int y1
+) const -> Depth_range
+{
+    ERHE_PROFILE_FUNCTION
+
+    Depth_range depth_range;
+    if (!m_readback_info.valid)
+    {
+        return depth_range;
+    }
+
+    // Cells fully inside region use pyramid values, so only cells along
+    // region edges are visited at finer levels.
+    const Region region = get_region(x0, y0, x1, y1);
+    if ((region.x0 >= region.x1) || (region.y0 >= region.y1))
+    {
+        return depth_range;
+    }
+    reduce_depth(s_depth_level_count - 1, 0, 0, region, depth_range);
+    depth_range.valid = true;
+    return depth_range;
+}
+
+void Id_renderer::append_row_ids(
+    const int              y,
+    const int              x0,
+    const int              x1,
+    std::vector<uint32_t>& ids
+) const
+{
+    if (x0 >= x1)
+    {
+        return;
+    }
+
+    // Neighbor pixels mostly come from same triangle; skip repeats
+    const uint32_t* const row      = m_ids.data() + static_cast<std::size_t>(y) * s_extent;
+    uint32_t              previous = row[x0];
+    ids.push_back(previous);
+    for (int x = x0 + 1; x < x1; ++x)
+    {
+        const uint32_t id = row[x];
+        if (id != previous)
+        {
+            ids.push_back(id);
+            previous = id;
+        }
+    }
+}
+
+auto Id_renderer::meshes_from_ids(std::vector<uint32_t>& ids) const -> std::vector<std::shared_ptr<erhe::scene::Mesh>>
+{
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    // Background and ids without range (such as clear color) are skipped
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> meshes;
+    for (const uint32_t id : ids)
+    {
+        const auto* const range = find_id_range(id);
         if (
-            (result.id >= r.offset) &&
-            (result.id < (r.offset + r.length))
+            (range == nullptr) ||
+            !range->mesh ||
+            (std::find(meshes.begin(), meshes.end(), range->mesh) != meshes.end())
         )
         {
-            result.mesh                 = r.mesh;
-            result.mesh_primitive_index = r.primitive_index;
-            result.local_index          = result.id - r.offset;
-            return result;
+            continue;
         }
+        meshes.push_back(range->mesh);
     }
+    return meshes;
+}
 
-    return result;
+auto Id_renderer::get_meshes_in_rectangle(
+    const int x0,
+    const int y0,
+    const int x1,
+    const int y1
+) const -> std::vector<std::shared_ptr<erhe::scene::Mesh>>
+{
+    ERHE_PROFILE_FUNCTION
+
+    if (!m_readback_info.valid)
+    {
+        return {};
+    }
+
+    const Region          region = get_region(x0, y0, x1, y1);
+    std::vector<uint32_t> ids;
+    for (int y = region.y0; y < region.y1; ++y)
+    {
+        append_row_ids(y, region.x0, region.x1, ids);
+    }
+    return meshes_from_ids(ids);
+}
+
+auto Id_renderer::get_meshes_in_lasso(
+    const gsl::span<const glm::vec2> points
+) const -> std::vector<std::shared_ptr<erhe::scene::Mesh>>
+{
+    ERHE_PROFILE_FUNCTION
+
+    if (!m_readback_info.valid || (points.size() < 3))
+    {
+        return {};
+    }
+
+    glm::vec2 min_corner = points[0];
+    glm::vec2 max_corner = points[0];
+    for (const auto& point : points)
+    {
+        min_corner = glm::min(min_corner, point);
+        max_corner = glm::max(max_corner, point);
+    }
+    const Region region = get_region(
+        static_cast<int>(std::floor(min_corner.x)),
+        static_cast<int>(std::floor(min_corner.y)),
+        static_cast<int>(std::ceil (max_corner.x)),
+        static_cast<int>(std::ceil (max_corner.y))
+    );
+
+    // Scanline fill with even-odd rule; pixel is inside if its center is
+    std::vector<uint32_t> ids;
+    std::vector<float>    crossings;
+    const std::size_t     point_count = points.size();
+    for (int y = region.y0; y < region.y1; ++y)
+    {
+        const float sample_y = static_cast<float>(y + m_readback_info.y_offset) + 0.5f;
+        crossings.clear();
+        for (std::size_t i = 0; i < point_count; ++i)
+        {
+            const glm::vec2 a = points[i];
+            const glm::vec2 b = points[(i + 1) % point_count];
+            if ((a.y <= sample_y) != (b.y <= sample_y))
+            {
+                const float t = (sample_y - a.y) / (b.y - a.y);
+                crossings.push_back(a.x + t * (b.x - a.x));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (std::size_t i = 0; i + 1 < crossings.size(); i += 2)
+        {
+            const int span_x0 = static_cast<int>(std::ceil(crossings[i    ] - 0.5f)) - m_readback_info.x_offset;
+            const int span_x1 = static_cast<int>(std::ceil(crossings[i + 1] - 0.5f)) - m_readback_info.x_offset;
+            append_row_ids(
+                y,
+                std::max(span_x0, region.x0),
+                std::min(span_x1, region.x1),
+                ids
+            );
+        }
+    }
+    return meshes_from_ids(ids);
 }
 
 } // namespace editor
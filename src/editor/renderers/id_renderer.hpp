@@ -11,6 +11,8 @@
 #include <fmt/format.h>
 #include <glm/glm.hpp>
 
+#include <array>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -53,6 +55,28 @@ public:
         bool                               valid               {false};
     };
 
+    // Describes id buffer region of the most recent completed readback.
+    // Readbacks complete some frames after they were rendered.
+    class Readback_info
+    {
+    public:
+        uint64_t              frame_number   {0}; // frame in which region was rendered
+        double                time           {0.0};
+        erhe::scene::Viewport viewport       {0, 0, 0, 0, true};
+        glm::mat4             clip_from_world{1.0f};
+        int                   x_offset       {0};
+        int                   y_offset       {0};
+        bool                  valid          {false};
+    };
+
+    class Depth_range
+    {
+    public:
+        float min_depth{std::numeric_limits<float>::max()};
+        float max_depth{std::numeric_limits<float>::lowest()};
+        bool  valid    {false};
+    };
+
     static constexpr std::string_view c_label{"Id_renderer"};
     static constexpr uint32_t hash = compiletime_xxhash::xxh32(c_label.data(), c_label.size(), {});
 
@@ -79,15 +103,31 @@ public:
     };
     void render(const Render_parameters& parameters);
 
-    [[nodiscard]] auto get(const int x, const int y, uint32_t& id, float& depth) -> bool;
-    [[nodiscard]] auto get(const int x, const int y) -> Id_query_result;
+    // Queries use the most recent completed readback; they never wait
+    // for the GPU. Coordinates are window coordinates, as in render().
+    // Pixels outside the read back region are ignored.
+    [[nodiscard]] auto get(const int x, const int y, uint32_t& id, float& depth) const -> bool;
+    [[nodiscard]] auto get(const int x, const int y) const -> Id_query_result;
 
+    // Minimum and maximum depth in rectangle with corners x0, y0 and x1, y1 (inclusive)
+    [[nodiscard]] auto get_depth_range(const int x0, const int y0, const int x1, const int y1) const -> Depth_range;
+
+    // Meshes with visible pixels in rectangle, or inside lasso polygon
+    [[nodiscard]] auto get_meshes_in_rectangle(const int x0, const int y0, const int x1, const int y1) const -> std::vector<std::shared_ptr<erhe::scene::Mesh>>;
+    [[nodiscard]] auto get_meshes_in_lasso    (const gsl::span<const glm::vec2> points) const -> std::vector<std::shared_ptr<erhe::scene::Mesh>>;
+
+    [[nodiscard]] auto readback_info() const -> const Readback_info&;
+    [[nodiscard]] auto frame_number () const -> uint64_t;
+
+    // Collects completed readbacks, and moves to next frame resources
     void next_frame();
 
 private:
     static constexpr std::size_t s_frame_resources_count = 4;
     static constexpr std::size_t s_extent                = 256;
-    static constexpr std::size_t s_id_buffer_size        = s_extent * s_extent * 8; // RGBA + depth
+    static constexpr std::size_t s_pixel_count           = s_extent * s_extent;
+    static constexpr std::size_t s_id_buffer_size        = s_pixel_count * 8; // RGBA + depth
+    static constexpr std::size_t s_depth_level_count     = 9;                 // 256 x 256 .. 1 x 1
 
     class Id_frame_resources
     {
@@ -95,8 +135,7 @@ private:
         enum class State : unsigned int
         {
             Unused = 0,
-            Waiting_for_read,
-            Read_complete
+            Waiting_for_read
         };
 
         explicit Id_frame_resources(const std::size_t slot);
@@ -107,19 +146,41 @@ private:
         Id_frame_resources(Id_frame_resources&& other) noexcept;
         auto operator=(Id_frame_resources&& other) noexcept -> Id_frame_resources&;
 
-        erhe::graphics::Buffer                pixel_pack_buffer;
-        std::array<uint8_t, s_id_buffer_size> data;
-        double                                time           {0.0};
-        GLsync                                sync           {0};
-        glm::mat4                             clip_from_world{1.0f};
-        int                                   x_offset       {0};
-        int                                   y_offset       {0};
-        State                                 state          {State::Unused};
+        erhe::graphics::Buffer                  pixel_pack_buffer;
+        Readback_info                           info;
+        std::vector<Primitive_buffer::Id_range> id_ranges;
+        GLsync                                  sync {nullptr};
+        State                                   state{State::Unused};
+    };
+
+    // Readback region in pixels, relative to region origin; x1 and y1 are exclusive
+    class Region
+    {
+    public:
+        int x0{0};
+        int y0{0};
+        int x1{0};
+        int y1{0};
     };
 
     [[nodiscard]] auto current_id_frame_resources() -> Id_frame_resources&;
     void create_id_frame_resources();
     void update_framebuffer       (const erhe::scene::Viewport viewport);
+    void poll_readbacks           ();
+    void complete_readback        (Id_frame_resources& id_frame_resources);
+    void build_depth_pyramid      ();
+
+    [[nodiscard]] auto get_region     (const int x0, const int y0, const int x1, const int y1) const -> Region;
+    [[nodiscard]] auto find_id_range  (const uint32_t id) const -> const Primitive_buffer::Id_range*;
+    [[nodiscard]] auto meshes_from_ids(std::vector<uint32_t>& ids) const -> std::vector<std::shared_ptr<erhe::scene::Mesh>>;
+    void append_row_ids(const int y, const int x0, const int x1, std::vector<uint32_t>& ids) const;
+    void reduce_depth(
+        const std::size_t level,
+        const int         cell_x,
+        const int         cell_y,
+        const Region&     region,
+        Depth_range&      depth_range
+    ) const;
 
     erhe::scene::Viewport                 m_viewport{0, 0, 0, 0, true};
 
@@ -137,6 +198,17 @@ private:
     std::unique_ptr<erhe::graphics::Framebuffer>          m_framebuffer;
     std::vector<Id_frame_resources>                       m_id_frame_resources;
     std::size_t                                           m_current_id_frame_resource_slot{0};
+    uint64_t                                              m_frame_number{0};
+
+    // Most recent completed readback; ids are decoded from RGBA8, and
+    // depth is reduced to min / max pyramid where level n has cells of
+    // 2^n x 2^n pixels. Level 0 is m_depth.
+    Readback_info                                         m_readback_info;
+    std::vector<Primitive_buffer::Id_range>               m_readback_id_ranges;
+    std::vector<uint32_t>                                 m_ids;
+    std::vector<float>                                    m_depth;
+    std::array<std::vector<float>, s_depth_level_count>   m_min_depth;
+    std::array<std::vector<float>, s_depth_level_count>   m_max_depth;
     std::unique_ptr<erhe::graphics::Gpu_timer>            m_gpu_timer;
 
     class Range
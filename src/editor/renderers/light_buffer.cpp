@@ -4,12 +4,15 @@
 #include "renderers/program_interface.hpp"
 #include "editor_log.hpp"
 
+#include "erhe/graphics/configuration.hpp"
 #include "erhe/log/log_glm.hpp"
 #include "erhe/scene/light.hpp"
 #include "erhe/scene/projection.hpp"
 #include "erhe/scene/transform.hpp"
 #include "erhe/toolkit/profile.hpp"
 
+#include <algorithm>
+
 namespace editor
 {
 
@@ -25,6 +28,11 @@ Light_interface::Light_interface(std::size_t max_light_count)
         erhe::graphics::Shader_resource::Type::uniform_block
     }
     , light_struct{"Light"}
+    , light_cluster_block{
+        "light_cluster_block",
+        5,
+        erhe::graphics::Shader_resource::Type::shader_storage_block
+    }
     , offsets     {
         .shadow_texture          = light_block.add_uvec2("shadow_texture"         )->offset_in_parent(),
         .reserved_1              = light_block.add_uvec2("reserved_1"             )->offset_in_parent(),
@@ -43,6 +51,12 @@ Light_interface::Light_interface(std::size_t max_light_count)
         },
         .light_struct            = light_block.add_struct("lights", &light_struct, max_light_count)->offset_in_parent()
     }
+    , cluster_offsets{
+        .grid_size     = light_cluster_block.add_uvec4("grid_size"                                     )->offset_in_parent(),
+        .depth_params  = light_cluster_block.add_vec4 ("depth_params"                                  )->offset_in_parent(),
+        .clusters      = light_cluster_block.add_uvec2("clusters",      Light_clusters::s_cluster_count)->offset_in_parent(),
+        .light_indices = light_cluster_block.add_uint ("light_indices", 0                              )->offset_in_parent()
+    }
     , light_index_offset{
         light_control_block.add_uint("light_index")->offset_in_parent()
     }
@@ -54,6 +68,7 @@ Light_buffer::Light_buffer(const Light_interface& light_interface)
     : m_light_interface{light_interface}
     , m_light_buffer   {"light"}
     , m_control_buffer {"light_control"}
+    , m_cluster_buffer {"light_cluster"}
 {
     m_light_buffer.allocate(
         gl::Buffer_target::uniform_buffer,
@@ -68,6 +83,17 @@ Light_buffer::Light_buffer(const Light_interface& light_interface)
         m_light_interface.light_control_block.size_bytes() * 40,
         "light control"
     );
+
+    // Room for a few cluster updates per frame, each with full light index list
+    const std::size_t cluster_update_size =
+        m_light_interface.cluster_offsets.light_indices +
+        Light_clusters::s_max_light_index_count * sizeof(uint32_t);
+    m_cluster_buffer.allocate(
+        gl::Buffer_target::shader_storage_buffer,
+        m_light_interface.light_cluster_block.binding_point(),
+        cluster_update_size * 4,
+        "light cluster"
+    );
 }
 
 Light_projections::Light_projections()
@@ -150,10 +176,13 @@ auto Light_buffer::update(
         m_light_buffer.writer().write_offset
     );
 
-    auto&          buffer            = m_light_buffer.current_buffer();
-    auto&          writer            = m_light_buffer.writer();
     const auto     light_struct_size = m_light_interface.light_struct.size_bytes();
     const auto&    offsets           = m_light_interface.offsets;
+    const auto     max_light_count   = std::max(lights.size(), light_projections.light_projection_transforms.size());
+    m_light_buffer.begin_write(offsets.light_struct + max_light_count * light_struct_size);
+
+    auto&          buffer            = m_light_buffer.current_buffer();
+    auto&          writer            = m_light_buffer.writer();
     const auto     light_gpu_data    = buffer.map();
     uint32_t       directional_light_count{0u};
     uint32_t       spot_light_count       {0u};
@@ -170,13 +199,12 @@ auto Light_buffer::update(
     using erhe::graphics::as_span;
     using erhe::graphics::write;
 
-    writer.begin(buffer.target());
-
     const std::size_t common_offset = writer.write_offset;
 
     writer.write_offset += offsets.light_struct;
     const std::size_t light_array_offset = writer.write_offset;
-    std::size_t max_light_index{0};
+    std::size_t max_light_index    {0};
+    std::size_t written_light_count{0};
 
     for (const auto& light : lights)
     {
@@ -214,7 +242,7 @@ auto Light_buffer::update(
 
         const auto& texture_from_world   = light_projection_transforms->texture_from_world;
         const vec3  direction            = vec3{light->world_from_node() * vec4{0.0f, 0.0f, 1.0f, 0.0f}};
-        const vec3  position             = vec3{light_projection_transforms->world_from_light_camera.matrix() * vec4{0.0f, 0.0f, 1.0f, 0.0f}};
+        const vec3  position             = vec3{light_projection_transforms->world_from_light_camera.matrix() * vec4{0.0f, 0.0f, 0.0f, 1.0f}};
         const vec4  radiance             = vec4{light->intensity * light->color, light->range};
         const auto  inner_spot_cos       = std::cos(light->inner_spot_angle * 0.5f);
         const auto  outer_spot_cos       = std::cos(light->outer_spot_angle * 0.5f);
@@ -222,8 +250,9 @@ auto Light_buffer::update(
         const vec4  direction_outer_spot = vec4{glm::normalize(vec3{direction}), outer_spot_cos};
         const auto  light_index          = light_projection_transforms->index;
         const auto  light_offset         = light_array_offset + light_index * light_struct_size;
-        ERHE_VERIFY(light_offset < buffer.capacity_byte_count());
+        ERHE_VERIFY(light_offset + light_struct_size <= m_light_buffer.write_end());
         max_light_index = std::max(max_light_index, light_index);
+        ++written_light_count;
         //log_render->info(
         //    "light {} index = {} light_offset = {} color = {}",
         //    light->name(),
@@ -238,7 +267,10 @@ auto Light_buffer::update(
         write(light_gpu_data, light_offset + offsets.light.direction_and_outer_spot_cos, as_span(direction_outer_spot));
         write(light_gpu_data, light_offset + offsets.light.radiance_and_range,           as_span(radiance));
     }
-    writer.write_offset += max_light_index * light_struct_size;
+    if (written_light_count > 0)
+    {
+        writer.write_offset += (max_light_index + 1) * light_struct_size;
+    }
 
     // Late write to begin of buffer to full in light counts
     write(light_gpu_data, common_offset + offsets.shadow_texture,          as_span(shadow_map_texture_handle_uvec2));
@@ -250,24 +282,22 @@ auto Light_buffer::update(
     write(light_gpu_data, common_offset + offsets.ambient_light,           as_span(ambient_light)            );
     write(light_gpu_data, common_offset + offsets.reserved_2,              as_span(uvec4_zero)               );
 
-    writer.end();
-
     SPDLOG_LOGGER_TRACE(log_draw, "wrote up to {} entries to light buffer", max_light_index);
 
-    return writer.range;
+    return m_light_buffer.end_write();
 }
 
 auto Light_buffer::update_control(std::size_t light_index) -> erhe::application::Buffer_range
 {
     ERHE_PROFILE_FUNCTION
 
+    const auto entry_size = m_light_interface.light_control_block.size_bytes();
+    m_control_buffer.begin_write(entry_size);
+
     auto&      buffer     = m_control_buffer.current_buffer();
     auto&      writer     = m_control_buffer.writer();
-    const auto entry_size = m_light_interface.light_control_block.size_bytes();
     const auto gpu_data   = buffer.map();
 
-    writer.begin(buffer.target());
-
     using erhe::graphics::as_span;
     using erhe::graphics::write;
 
@@ -275,15 +305,54 @@ auto Light_buffer::update_control(std::size_t light_index) -> erhe::application:
     write(gpu_data, writer.range.first_byte_offset + 0, as_span(uint_light_index));
     writer.write_offset += entry_size;
 
-    writer.end();
+    return m_control_buffer.end_write();
+}
+
+auto Light_buffer::update_clusters(const Light_clusters& light_clusters) -> erhe::application::Buffer_range
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto& offsets       = m_light_interface.cluster_offsets;
+    const auto& clusters      = light_clusters.clusters();
+    const auto& light_indices = light_clusters.light_indices();
+
+    // Unsized array needs at least one element
+    const std::size_t light_index_count = std::max(light_indices.size(), std::size_t{1});
+    const std::size_t byte_count        = offsets.light_indices + light_index_count * sizeof(uint32_t);
+    m_cluster_buffer.begin_write(byte_count);
+
+    using erhe::graphics::as_span;
+    using erhe::graphics::write;
 
-    return writer.range;
+    auto&      buffer   = m_cluster_buffer.current_buffer();
+    auto&      writer   = m_cluster_buffer.writer();
+    const auto gpu_data = buffer.map();
+
+    const std::size_t common_offset = writer.write_offset;
+    const uint32_t    grid_size[4]
+    {
+        Light_clusters::s_grid_size_x,
+        Light_clusters::s_grid_size_y,
+        Light_clusters::s_grid_size_z,
+        0u
+    };
+    const glm::vec4 depth_params{light_clusters.depth_scale(), light_clusters.depth_bias(), 0.0f, 0.0f};
+    static_assert(sizeof(Light_cluster) == 2 * sizeof(uint32_t));
+
+    write(gpu_data, common_offset + offsets.grid_size,     as_span(grid_size));
+    write(gpu_data, common_offset + offsets.depth_params,  as_span(depth_params));
+    write(gpu_data, common_offset + offsets.clusters,      gsl::span<const Light_cluster>{clusters});
+    write(gpu_data, common_offset + offsets.light_indices, gsl::span<const uint32_t     >{light_indices});
+    writer.write_offset += byte_count;
+
+    return m_cluster_buffer.end_write();
 }
 
 void Light_buffer::next_frame()
 {
     m_light_buffer.next_frame();
     m_control_buffer.next_frame();
+    m_cluster_buffer.next_frame();
 }
 
 void Light_buffer::bind_light_buffer()
@@ -296,4 +365,9 @@ void Light_buffer::bind_control_buffer()
     m_control_buffer.bind();
 }
 
+void Light_buffer::bind_cluster_buffer()
+{
+    m_cluster_buffer.bind();
+}
+
 } // namespace editor
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "renderers/light_clusters.hpp"
 #include "renderers/multi_buffer.hpp"
 
 #include "erhe/graphics/shader_resource.hpp"
@@ -39,6 +40,15 @@ public:
     std::size_t  light_struct;
 };
 
+class Light_cluster_block
+{
+public:
+    std::size_t grid_size;     // uvec4 (x, y, z, padding)
+    std::size_t depth_params;  // vec4 (scale, bias, padding, padding)
+    std::size_t clusters;      // uvec2 (offset, count) per cluster
+    std::size_t light_indices; // uint, unsized array
+};
+
 class Light_interface
 {
 public:
@@ -47,7 +57,9 @@ public:
     erhe::graphics::Shader_resource light_block;
     erhe::graphics::Shader_resource light_control_block{"light_control_block", 1, erhe::graphics::Shader_resource::Type::uniform_block};
     erhe::graphics::Shader_resource light_struct       {"Light"};
+    erhe::graphics::Shader_resource light_cluster_block;
     Light_block                     offsets            {};
+    Light_cluster_block             cluster_offsets    {};
     std::size_t                     light_index_offset {};
     std::size_t                     max_light_count;
 };
@@ -95,15 +107,21 @@ public:
         std::size_t light_index
     ) -> erhe::application::Buffer_range;
 
+    auto update_clusters(
+        const Light_clusters& light_clusters
+    ) -> erhe::application::Buffer_range;
+
     void next_frame         ();
     void bind_light_buffer  ();
     void bind_control_buffer();
+    void bind_cluster_buffer();
 
 private:
     const Light_interface& m_light_interface;
 
     Multi_buffer           m_light_buffer;
     Multi_buffer           m_control_buffer;
+    Multi_buffer           m_cluster_buffer;
 };
 
 } // namespace editor
@@ -0,0 +1,356 @@
+#include "renderers/light_clusters.hpp"
+#include "renderers/light_buffer.hpp"
+#include "editor_log.hpp"
+
+#include "erhe/scene/camera.hpp"
+#include "erhe/scene/light.hpp"
+#include "erhe/scene/projection.hpp"
+#include "erhe/scene/transform.hpp"
+#include "erhe/toolkit/profile.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace editor
+{
+
+Light_clusters::Light_clusters()
+{
+    m_depth_slices        .resize(s_grid_size_z + 1);
+    m_min_x               .resize(s_cluster_count);
+    m_min_y               .resize(s_cluster_count);
+    m_min_z               .resize(s_cluster_count);
+    m_max_x               .resize(s_cluster_count);
+    m_max_y               .resize(s_cluster_count);
+    m_max_z               .resize(s_cluster_count);
+    m_tile_hits           .resize(s_tile_count);
+    m_cluster_light_counts.resize(s_cluster_count);
+    m_cluster_lights      .resize(s_cluster_count * s_max_lights_per_cluster);
+    m_clusters            .resize(s_cluster_count);
+    m_light_indices       .reserve(s_max_light_index_count);
+}
+
+void Light_clusters::clear()
+{
+    m_depth_scale = 0.0f;
+    m_depth_bias  = 0.0f;
+    std::fill(m_cluster_light_counts.begin(), m_cluster_light_counts.end(), 0u);
+    std::fill(m_clusters.begin(), m_clusters.end(), Light_cluster{});
+    m_light_indices.clear();
+}
+
+auto Light_clusters::cluster_index(const uint32_t x, const uint32_t y, const uint32_t z) const -> uint32_t
+{
+    return x + s_grid_size_x * (y + s_grid_size_y * z);
+}
+
+auto Light_clusters::slice(const float view_depth) const -> uint32_t
+{
+    if (view_depth <= 0.0f)
+    {
+        return 0;
+    }
+    const float slice = std::floor(std::log(view_depth) * m_depth_scale + m_depth_bias);
+    return static_cast<uint32_t>(
+        std::clamp(slice, 0.0f, static_cast<float>(s_grid_size_z - 1))
+    );
+}
+
+auto Light_clusters::clusters() const -> const std::vector<Light_cluster>&
+{
+    return m_clusters;
+}
+
+auto Light_clusters::light_indices() const -> const std::vector<uint32_t>&
+{
+    return m_light_indices;
+}
+
+auto Light_clusters::depth_scale() const -> float
+{
+    return m_depth_scale;
+}
+
+auto Light_clusters::depth_bias() const -> float
+{
+    return m_depth_bias;
+}
+
+void Light_clusters::update_cluster_bounds(
+    const glm::mat4& view_from_clip,
+    const float      z_near,
+    const float      z_far
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Slices are distributed exponentially between near and far
+    const float log_depth_ratio = std::log(z_far / z_near);
+    m_depth_scale = static_cast<float>(s_grid_size_z) / log_depth_ratio;
+    m_depth_bias  = -std::log(z_near) * m_depth_scale;
+    for (uint32_t z = 0; z <= s_grid_size_z; ++z)
+    {
+        m_depth_slices[z] = z_near * std::pow(z_far / z_near, static_cast<float>(z) / static_cast<float>(s_grid_size_z));
+    }
+
+    // Tile corner lines in view space. Two points are unprojected from
+    // depths which stay finite with infinite far and with reverse depth,
+    // so this works for both perspective and orthographic projections.
+    class Line
+    {
+    public:
+        glm::vec3 a;
+        glm::vec3 b;
+    };
+    constexpr uint32_t corner_count_x = s_grid_size_x + 1;
+    constexpr uint32_t corner_count_y = s_grid_size_y + 1;
+    std::array<Line, corner_count_x * corner_count_y> corner_lines;
+    for (uint32_t y = 0; y < corner_count_y; ++y)
+    {
+        const float ndc_y = -1.0f + 2.0f * static_cast<float>(y) / static_cast<float>(s_grid_size_y);
+        for (uint32_t x = 0; x < corner_count_x; ++x)
+        {
+            const float     ndc_x = -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(s_grid_size_x);
+            const glm::vec4 a     = view_from_clip * glm::vec4{ndc_x, ndc_y, 0.25f, 1.0f};
+            const glm::vec4 b     = view_from_clip * glm::vec4{ndc_x, ndc_y, 0.75f, 1.0f};
+            corner_lines[x + y * corner_count_x] = Line{
+                .a = glm::vec3{a} / a.w,
+                .b = glm::vec3{b} / b.w
+            };
+        }
+    }
+
+    // View space looks towards negative z; view depth is -z
+    const auto point_at_depth = [](const Line& line, const float depth) -> glm::vec3
+    {
+        const float depth_a = -line.a.z;
+        const float depth_b = -line.b.z;
+        const float t       = (depth - depth_a) / (depth_b - depth_a);
+        return line.a + (line.b - line.a) * t;
+    };
+
+    for (uint32_t z = 0; z < s_grid_size_z; ++z)
+    {
+        const float depth_0 = m_depth_slices[z];
+        const float depth_1 = m_depth_slices[z + 1];
+        for (uint32_t y = 0; y < s_grid_size_y; ++y)
+        {
+            for (uint32_t x = 0; x < s_grid_size_x; ++x)
+            {
+                glm::vec3 min_corner{std::numeric_limits<float>::max()};
+                glm::vec3 max_corner{std::numeric_limits<float>::lowest()};
+                for (uint32_t corner = 0; corner < 4; ++corner)
+                {
+                    const uint32_t corner_x = x + (corner & 1u);
+                    const uint32_t corner_y = y + (corner >> 1u);
+                    const Line&    line     = corner_lines[corner_x + corner_y * corner_count_x];
+                    const glm::vec3 p0 = point_at_depth(line, depth_0);
+                    const glm::vec3 p1 = point_at_depth(line, depth_1);
+                    min_corner = glm::min(min_corner, glm::min(p0, p1));
+                    max_corner = glm::max(max_corner, glm::max(p0, p1));
+                }
+                const uint32_t i = cluster_index(x, y, z);
+                m_min_x[i] = min_corner.x;
+                m_min_y[i] = min_corner.y;
+                m_min_z[i] = min_corner.z;
+                m_max_x[i] = max_corner.x;
+                m_max_y[i] = max_corner.y;
+                m_max_z[i] = max_corner.z;
+            }
+        }
+    }
+}
+
+void Light_clusters::add_light_to_cluster(const uint32_t cluster_index, const uint32_t light_index)
+{
+    uint32_t& count = m_cluster_light_counts[cluster_index];
+    if (count >= s_max_lights_per_cluster)
+    {
+        if (!m_overflow_reported)
+        {
+            log_render->warn("light cluster capacity {} exceeded", s_max_lights_per_cluster);
+            m_overflow_reported = true;
+        }
+        m_overflow = true;
+        return;
+    }
+    m_cluster_lights[cluster_index * s_max_lights_per_cluster + count] = static_cast<uint16_t>(light_index);
+    ++count;
+}
+
+void Light_clusters::add_light_to_all_clusters(const uint32_t light_index)
+{
+    for (uint32_t i = 0; i < s_cluster_count; ++i)
+    {
+        add_light_to_cluster(i, light_index);
+    }
+}
+
+void Light_clusters::add_light(
+    const uint32_t  light_index,
+    const glm::vec3 position_in_view,
+    const glm::vec3 axis_in_view,
+    const float     range,
+    const float     cos_half_angle,
+    const float     sin_half_angle
+)
+{
+    const float depth = -position_in_view.z;
+    if (
+        (depth + range < m_depth_slices.front()) ||
+        (depth - range > m_depth_slices.back())
+    )
+    {
+        return;
+    }
+
+    const uint32_t first_slice  = slice(depth - range);
+    const uint32_t last_slice   = slice(depth + range);
+    const float    range_sq     = range * range;
+    const bool     use_cone     = cos_half_angle > 0.0f;
+    const float    cx           = position_in_view.x;
+    const float    cy           = position_in_view.y;
+    const float    cz           = position_in_view.z;
+    uint8_t* const tile_hits    = m_tile_hits.data();
+
+    for (uint32_t z = first_slice; z <= last_slice; ++z)
+    {
+        const uint32_t     base  = z * s_tile_count;
+        const float* const min_x = m_min_x.data() + base;
+        const float* const min_y = m_min_y.data() + base;
+        const float* const min_z = m_min_z.data() + base;
+        const float* const max_x = m_max_x.data() + base;
+        const float* const max_y = m_max_y.data() + base;
+        const float* const max_z = m_max_z.data() + base;
+
+        // Sphere - box test for all tiles of the slice
+        for (uint32_t i = 0; i < s_tile_count; ++i)
+        {
+            const float dx = std::max(std::max(min_x[i] - cx, cx - max_x[i]), 0.0f);
+            const float dy = std::max(std::max(min_y[i] - cy, cy - max_y[i]), 0.0f);
+            const float dz = std::max(std::max(min_z[i] - cz, cz - max_z[i]), 0.0f);
+            tile_hits[i] = static_cast<uint8_t>(dx * dx + dy * dy + dz * dz <= range_sq);
+        }
+
+        for (uint32_t i = 0; i < s_tile_count; ++i)
+        {
+            if (tile_hits[i] == 0)
+            {
+                continue;
+            }
+            if (use_cone)
+            {
+                // Cone - sphere test against cluster bounding sphere
+                const glm::vec3 box_min       {min_x[i], min_y[i], min_z[i]};
+                const glm::vec3 box_max       {max_x[i], max_y[i], max_z[i]};
+                const glm::vec3 sphere_center = (box_min + box_max) * 0.5f;
+                const float     sphere_radius = glm::length(box_max - box_min) * 0.5f;
+                const glm::vec3 v             = sphere_center - position_in_view;
+                const float     v_length_sq   = glm::dot(v, v);
+                const float     v1_length     = glm::dot(v, axis_in_view);
+                const float     distance      =
+                    cos_half_angle * std::sqrt(std::max(v_length_sq - v1_length * v1_length, 0.0f)) -
+                    v1_length * sin_half_angle;
+                if (
+                    (distance  >  sphere_radius) ||
+                    (v1_length >  sphere_radius + range) ||
+                    (v1_length < -sphere_radius)
+                )
+                {
+                    continue;
+                }
+            }
+            add_light_to_cluster(base + i, light_index);
+        }
+    }
+}
+
+void Light_clusters::update(
+    const erhe::scene::Camera&                                  camera,
+    const erhe::scene::Viewport&                                viewport,
+    const gsl::span<const std::shared_ptr<erhe::scene::Light>>& lights,
+    const Light_projections&                                    light_projections
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto* projection = camera.projection();
+    const float z_near     = std::max(projection->z_near, 0.0001f);
+    const float z_far      = std::max(projection->z_far,  z_near * 2.0f);
+    const auto  clip_from_view = projection->clip_from_node_transform(viewport);
+    update_cluster_bounds(clip_from_view.inverse_matrix(), z_near, z_far);
+
+    std::fill(m_cluster_light_counts.begin(), m_cluster_light_counts.end(), 0u);
+    m_overflow = false;
+
+    const glm::mat4 view_from_world = camera.node_from_world();
+    for (const auto& light : lights)
+    {
+        if (light->type != erhe::scene::Light_type::spot)
+        {
+            continue;
+        }
+        const auto* light_projection_transforms = light_projections.get_light_projection_transforms_for_light(light.get());
+        if (light_projection_transforms == nullptr)
+        {
+            continue;
+        }
+        const uint32_t light_index = static_cast<uint32_t>(light_projection_transforms->index);
+
+        // Negative range means unlimited
+        if (light->range <= 0.0f)
+        {
+            add_light_to_all_clusters(light_index);
+            continue;
+        }
+
+        // Spot light shines towards negative z axis of the light node
+        const glm::vec3 position = glm::vec3{view_from_world * light->position_in_world()};
+        const glm::vec3 axis     = glm::normalize(glm::vec3{view_from_world * -light->direction_in_world()});
+        const float     half_angle = light->outer_spot_angle * 0.5f;
+        add_light(
+            light_index,
+            position,
+            axis,
+            light->range,
+            (half_angle < glm::half_pi<float>()) ? std::cos(half_angle) : 0.0f,
+            std::sin(half_angle)
+        );
+    }
+
+    // Compact per cluster lists
+    m_light_indices.clear();
+    for (uint32_t i = 0; i < s_cluster_count; ++i)
+    {
+        const uint32_t offset    = static_cast<uint32_t>(m_light_indices.size());
+        const uint32_t available = s_max_light_index_count - offset;
+        const uint32_t count     = std::min(m_cluster_light_counts[i], available);
+        if (count < m_cluster_light_counts[i])
+        {
+            if (!m_overflow_reported)
+            {
+                log_render->warn("light cluster index list capacity {} exceeded", s_max_light_index_count);
+                m_overflow_reported = true;
+            }
+            m_overflow = true;
+        }
+        const uint16_t* cluster_lights = m_cluster_lights.data() + i * s_max_lights_per_cluster;
+        m_light_indices.insert(m_light_indices.end(), cluster_lights, cluster_lights + count);
+        m_clusters[i] = Light_cluster{
+            .offset = offset,
+            .count  = count
+        };
+    }
+
+    // Lights fit capacity again; report the next overflow
+    if (!m_overflow)
+    {
+        m_overflow_reported = false;
+    }
+}
+
+} // namespace editor
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "erhe/scene/viewport.hpp"
+
+#include <glm/glm.hpp>
+
+#include <gsl/gsl>
+
+#include <memory>
+#include <vector>
+
+namespace erhe::scene
+{
+    class Camera;
+    class Light;
+}
+
+namespace editor
+{
+
+class Light_projections;
+
+class Light_cluster
+{
+public:
+    uint32_t offset{0}; // First entry in light index list
+    uint32_t count {0};
+};
+
+// Bins spot lights into a view space grid of clusters (froxels).
+//
+// Clusters split viewport to tiles in x and y, and view depth
+// to exponentially distributed slices in z. Each cluster gets
+// a list of light indices (to light block) of spot lights which
+// may affect fragments inside the cluster.
+//
+// Light spheres are tested against cluster boxes for one depth
+// slice at a time, using separate arrays for box bounds, so that
+// the test loop can be vectorized. Spot lights are then tested
+// with a cone test against cluster bounding spheres.
+//
+// Binning is done on the CPU and does not need a graphics context.
+class Light_clusters
+{
+public:
+    static constexpr uint32_t s_grid_size_x            = 16;
+    static constexpr uint32_t s_grid_size_y            = 8;
+    static constexpr uint32_t s_grid_size_z            = 24;
+    static constexpr uint32_t s_tile_count             = s_grid_size_x * s_grid_size_y;
+    static constexpr uint32_t s_cluster_count          = s_tile_count * s_grid_size_z;
+    static constexpr uint32_t s_max_lights_per_cluster = 64;
+    static constexpr uint32_t s_max_light_index_count  = 65536;
+
+    Light_clusters();
+
+    void update(
+        const erhe::scene::Camera&                                  camera,
+        const erhe::scene::Viewport&                                viewport,
+        const gsl::span<const std::shared_ptr<erhe::scene::Light>>& lights,
+        const Light_projections&                                    light_projections
+    );
+
+    // Leaves all clusters empty, for when there is no camera to bin lights for
+    void clear();
+
+    [[nodiscard]] auto cluster_index(const uint32_t x, const uint32_t y, const uint32_t z) const -> uint32_t;
+    [[nodiscard]] auto slice        (const float view_depth) const -> uint32_t;
+    [[nodiscard]] auto clusters     () const -> const std::vector<Light_cluster>&;
+    [[nodiscard]] auto light_indices() const -> const std::vector<uint32_t>&;
+    [[nodiscard]] auto depth_scale  () const -> float;
+    [[nodiscard]] auto depth_bias   () const -> float;
+
+private:
+    void update_cluster_bounds(
+        const glm::mat4& view_from_clip,
+        const float      z_near,
+        const float      z_far
+    );
+
+    void add_light(
+        const uint32_t  light_index,
+        const glm::vec3 position_in_view,
+        const glm::vec3 axis_in_view,
+        const float     range,
+        const float     cos_half_angle,
+        const float     sin_half_angle
+    );
+
+    void add_light_to_all_clusters(const uint32_t light_index);
+
+    void add_light_to_cluster(const uint32_t cluster_index, const uint32_t light_index);
+
+    float                      m_depth_scale{0.0f};
+    float                      m_depth_bias {0.0f};
+    std::vector<float>         m_depth_slices; // View depth at start of each slice, and far depth
+
+    // Cluster view space bounds, in cluster index order
+    std::vector<float>         m_min_x;
+    std::vector<float>         m_min_y;
+    std::vector<float>         m_min_z;
+    std::vector<float>         m_max_x;
+    std::vector<float>         m_max_y;
+    std::vector<float>         m_max_z;
+    std::vector<uint8_t>       m_tile_hits;
+
+    std::vector<uint32_t>      m_cluster_light_counts;
+    std::vector<uint16_t>      m_cluster_lights; // s_max_lights_per_cluster per cluster
+    std::vector<Light_cluster> m_clusters;
+    std::vector<uint32_t>      m_light_indices;
+    bool                       m_overflow         {false}; // Set when lights were dropped in current update
+    bool                       m_overflow_reported{false};
+};
+
+} // namespace editor
@@ -57,21 +57,16 @@ auto Material_buffer::update(
         m_writer.write_offset
     );
 
+    const auto entry_size = m_material_interface.material_struct.size_bytes();
+    begin_write(materials.size() * entry_size);
+
     auto&       buffer         = current_buffer();
-    const auto  entry_size     = m_material_interface.material_struct.size_bytes();
     const auto& offsets        = m_material_interface.offsets;
     const auto  gpu_data       = buffer.map();
     std::size_t material_index = 0;
-    m_writer.begin(buffer.target());
     m_used_handles.clear();
     for (const auto& material : materials)
     {
-        if ((m_writer.write_offset + entry_size) > buffer.capacity_byte_count())
-        {
-            log_render->critical("material buffer capacity {} exceeded", buffer.capacity_byte_count());
-            ERHE_FATAL("material buffer capacity exceeded");
-            break;
-        }
         memset(reinterpret_cast<uint8_t*>(gpu_data.data()) + m_writer.write_offset, 0, entry_size);
         using erhe::graphics::as_span;
         using erhe::graphics::write;
@@ -112,14 +107,12 @@ auto Material_buffer::update(
 
 
         m_writer.write_offset += entry_size;
-        ERHE_VERIFY(m_writer.write_offset <= buffer.capacity_byte_count());
         ++material_index;
     }
-    m_writer.end();
 
     SPDLOG_LOGGER_TRACE(log_draw, "wrote {} entries to material buffer", material_index);
 
-    return m_writer.range;
+    return end_write();
 }
 
 [[nodiscard]] auto Material_buffer::used_handles() const -> const std::set<uint64_t>&
@@ -9,10 +9,87 @@
 #include "erhe/gl/wrapper_functions.hpp"
 #include "erhe/graphics/configuration.hpp"
 #include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
 
 namespace editor
 {
 
+Gl_fence_source::~Gl_fence_source() noexcept
+{
+    for (const auto& fence : m_fences)
+    {
+        gl::delete_sync(fence.sync);
+    }
+}
+
+auto Gl_fence_source::insert_fence() -> uint64_t
+{
+    m_fences.push_back(
+        Fence{
+            .serial = ++m_last_serial,
+            .sync   = gl::fence_sync(gl::Sync_condition::sync_gpu_commands_complete, 0)
+        }
+    );
+    return m_last_serial;
+}
+
+void Gl_fence_source::release_oldest_fence()
+{
+    m_signaled_serial = m_fences.front().serial;
+    gl::delete_sync(m_fences.front().sync);
+    m_fences.pop_front();
+}
+
+auto Gl_fence_source::is_signaled(const uint64_t fence) -> bool
+{
+    while ((fence > m_signaled_serial) && !m_fences.empty())
+    {
+        GLint sync_status = GL_UNSIGNALED;
+        gl::get_sync_iv(m_fences.front().sync, gl::Sync_parameter_name::sync_status, 1, nullptr, &sync_status);
+        if (sync_status != GL_SIGNALED)
+        {
+            break;
+        }
+        release_oldest_fence();
+    }
+    return fence <= m_signaled_serial;
+}
+
+void Gl_fence_source::wait(const uint64_t fence)
+{
+    ERHE_PROFILE_FUNCTION
+
+    static constexpr GLuint64 timeout_ns = 1'000'000'000;
+
+    while ((fence > m_signaled_serial) && !m_fences.empty())
+    {
+        const auto result = gl::client_wait_sync(
+            m_fences.front().sync,
+            gl::Sync_object_mask::sync_flush_commands_bit,
+            timeout_ns
+        );
+        if (result == gl::Sync_status::timeout_expired)
+        {
+            continue;
+        }
+        if (result == gl::Sync_status::wait_failed)
+        {
+            log_render->error("fence wait failed");
+        }
+        release_oldest_fence();
+    }
+}
+
+Multi_buffer::Multi_buffer(const std::string_view name)
+    : m_ring_allocator{m_fence_source, 0}
+    , m_name          {name}
+{
+}
+
+Multi_buffer::~Multi_buffer() noexcept = default;
+
 auto Multi_buffer::writer() -> erhe::application::Buffer_writer&
 {
     return m_writer;
@@ -25,6 +102,7 @@ void Multi_buffer::allocate(
     const std::string&      name
 )
 {
+    m_target        = target;
     m_binding_point = binding_point;
 
     log_render->info("{}: binding = {} size = {}", name, binding_point, size);
@@ -41,63 +119,198 @@ void Multi_buffer::allocate(
         gl::Map_buffer_access_mask::map_write_bit
     };
 
-    for (std::size_t slot = 0; slot < s_frame_resources_count; ++slot)
+    m_buffer = std::make_unique<erhe::graphics::Buffer>(
+        target,
+        size,
+        storage_mask,
+        access_mask,
+        name
+    );
+    m_ring_allocator.reset(size);
+}
+
+void Multi_buffer::grow(const std::size_t min_byte_count)
+{
+    ERHE_PROFILE_FUNCTION
+
+    const std::size_t capacity = std::max(
+        2 * m_ring_allocator.capacity(),
+        min_byte_count + alignment()
+    );
+
+    log_render->info("{}: growing ring buffer from {} to {} bytes", m_name, m_ring_allocator.capacity(), capacity);
+
+    // Ranges in previous buffer may still be in use by this frame and by GPU
+    m_retired_buffers.push_back(
+        Retired_buffer{
+            .buffer = std::move(m_buffer),
+            .fence  = {}
+        }
+    );
+    allocate(m_target, m_binding_point, capacity, m_name);
+}
+
+[[nodiscard]] auto Multi_buffer::current_buffer() -> erhe::graphics::Buffer&
+{
+    ERHE_VERIFY(m_buffer);
+    return *m_buffer.get();
+}
+
+auto Multi_buffer::alignment() const -> std::size_t
+{
+    switch (m_target)
     {
-        m_buffers.emplace_back(
-            target,
-            size,
-            storage_mask,
-            access_mask,
-            fmt::format("{} {}", name, slot)
-        );
+        case gl::Buffer_target::shader_storage_buffer:
+        {
+            return static_cast<std::size_t>(erhe::graphics::Instance::implementation_defined.shader_storage_buffer_offset_alignment);
+        }
+        case gl::Buffer_target::uniform_buffer:
+        {
+            return static_cast<std::size_t>(erhe::graphics::Instance::implementation_defined.uniform_buffer_offset_alignment);
+        }
+        default:
+        {
+            return sizeof(uint32_t);
+        }
     }
 }
 
-[[nodiscard]] auto Multi_buffer::current_buffer() -> erhe::graphics::Buffer&
+auto Multi_buffer::remaining_byte_count() -> std::size_t
+{
+    m_ring_allocator.retire();
+    const std::size_t free_byte_count = m_ring_allocator.free_byte_count();
+    return (free_byte_count > alignment())
+        ? free_byte_count - alignment()
+        : 0;
+}
+
+auto Multi_buffer::reserve(const std::size_t byte_count) -> erhe::application::Buffer_range
+{
+    if (byte_count == 0)
+    {
+        m_writer.range = erhe::application::Buffer_range{
+            .first_byte_offset = 0,
+            .byte_count        = 0,
+            .buffer            = m_buffer.get()
+        };
+        m_writer.write_offset = 0;
+        m_write_end           = 0;
+        return m_writer.range;
+    }
+
+    std::optional<std::size_t> offset = m_ring_allocator.allocate(byte_count, alignment());
+    if (!offset.has_value())
+    {
+        m_ring_allocator.retire();
+        offset = m_ring_allocator.allocate(byte_count, alignment());
+    }
+    if (!offset.has_value())
+    {
+        grow(byte_count);
+        offset = m_ring_allocator.allocate(byte_count, alignment());
+    }
+    ERHE_VERIFY(offset.has_value());
+
+    m_writer.range = erhe::application::Buffer_range{
+        .first_byte_offset = offset.value(),
+        .byte_count        = byte_count,
+        .buffer            = m_buffer.get()
+    };
+    m_writer.write_offset = offset.value() + byte_count;
+    m_write_end           = m_writer.write_offset;
+    return m_writer.range;
+}
+
+void Multi_buffer::begin_write(const std::size_t max_byte_count)
+{
+    const auto range = reserve(max_byte_count);
+    m_writer.write_offset = range.first_byte_offset;
+    m_write_end           = range.first_byte_offset + range.byte_count;
+}
+
+auto Multi_buffer::end_write() -> erhe::application::Buffer_range
+{
+    ERHE_VERIFY(m_writer.write_offset <= m_write_end);
+    m_writer.end();
+    m_ring_allocator.trim(m_writer.range.first_byte_offset, m_writer.range.byte_count);
+    m_write_end = m_writer.write_offset;
+    return m_writer.range;
+}
+
+auto Multi_buffer::write_end() const -> std::size_t
 {
-    return m_buffers.at(m_current_slot);
+    return m_write_end;
 }
 
 void Multi_buffer::next_frame()
 {
-    m_current_slot = (m_current_slot + 1) % s_frame_resources_count;
+    ERHE_PROFILE_FUNCTION
+
+    m_ring_allocator.fence_allocations(s_frame_resources_count - 1);
+
+    for (auto& retired_buffer : m_retired_buffers)
+    {
+        if (!retired_buffer.fence.has_value())
+        {
+            retired_buffer.fence = m_fence_source.insert_fence();
+        }
+    }
+    m_retired_buffers.erase(
+        std::remove_if(
+            m_retired_buffers.begin(),
+            m_retired_buffers.end(),
+            [this](const Retired_buffer& retired_buffer)
+            {
+                return m_fence_source.is_signaled(retired_buffer.fence.value());
+            }
+        ),
+        m_retired_buffers.end()
+    );
 
     m_writer.reset();
+    m_write_end = 0;
 
     SPDLOG_LOGGER_TRACE(
         log_render,
-        "{} next_frame() - current slot is now {}",
+        "{} next_frame() - {} bytes in use",
         m_name,
-        m_current_slot
+        m_ring_allocator.used_byte_count()
     );
 }
 
 void Multi_buffer::bind()
+{
+    bind(m_writer.range);
+}
+
+void Multi_buffer::bind(const erhe::application::Buffer_range& range)
 {
     ERHE_PROFILE_FUNCTION
 
-    if (m_writer.range.byte_count == 0)
+    if (range.byte_count == 0)
     {
         return;
     }
 
-    const auto& buffer = current_buffer();
+    const auto& buffer = (range.buffer != nullptr)
+        ? *range.buffer
+        : current_buffer();
 
     SPDLOG_LOGGER_TRACE(
         log_draw,
         "binding {} {} buffer offset = {} byte count = {}",
         m_name,
         m_binding_point,
-        m_writer.range.first_byte_offset,
-        m_writer.range.byte_count
+        range.first_byte_offset,
+        range.byte_count
     );
 
     ERHE_VERIFY(
         (buffer.target() != gl::Buffer_target::uniform_buffer) ||
-        (m_writer.range.byte_count <= static_cast<std::size_t>(erhe::graphics::Instance::limits.max_uniform_block_size))
+        (range.byte_count <= static_cast<std::size_t>(erhe::graphics::Instance::limits.max_uniform_block_size))
     );
     ERHE_VERIFY(
-        m_writer.range.first_byte_offset + m_writer.range.byte_count <= buffer.capacity_byte_count()
+        range.first_byte_offset + range.byte_count <= buffer.capacity_byte_count()
     );
 
     if (buffer.target() == gl::Buffer_target::draw_indirect_buffer)
@@ -110,10 +323,10 @@ void Multi_buffer::bind()
             buffer.target(),
             static_cast<GLuint>    (m_binding_point),
             static_cast<GLuint>    (buffer.gl_name()),
-            static_cast<GLintptr>  (m_writer.range.first_byte_offset),
-            static_cast<GLsizeiptr>(m_writer.range.byte_count)
+            static_cast<GLintptr>  (range.first_byte_offset),
+            static_cast<GLsizeiptr>(range.byte_count)
         );
     }
 }
 
-}
\ No newline at end of file
+}
@@ -1,12 +1,18 @@
 #pragma once
 
+#include "renderers/ring_allocator.hpp"
+
 #include "erhe/application/renderers/buffer_writer.hpp"
 #include "erhe/graphics/buffer.hpp"
 #include "erhe/primitive/enums.hpp"
 
 #include <gsl/span>
 
+#include <deque>
 #include <memory>
+#include <optional>
+
+typedef struct __GLsync *GLsync;
 
 namespace erhe::primitive
 {
@@ -20,19 +26,55 @@ class Programs;
 class Program_interface;
 class Shader_resources;
 
+// Fence source which uses OpenGL sync objects
+class Gl_fence_source
+    : public IFence_source
+{
+public:
+    ~Gl_fence_source() noexcept override;
+
+    // Implements IFence_source
+    [[nodiscard]] auto insert_fence() -> uint64_t override;
+    [[nodiscard]] auto is_signaled (const uint64_t fence) -> bool override;
+    void wait(const uint64_t fence) override;
+
+private:
+    class Fence
+    {
+    public:
+        uint64_t serial{0};
+        GLsync   sync  {nullptr};
+    };
+
+    void release_oldest_fence();
+
+    std::deque<Fence> m_fences;
+    uint64_t          m_last_serial    {0};
+    uint64_t          m_signaled_serial{0};
+};
+
+// Persistently mapped ring buffer for per frame GPU data.
+//
+// Ranges are allocated from one buffer with Ring_allocator. Allocations
+// of a frame are fenced in next_frame(), and reused once the GPU has
+// passed the fence. If the ring has no room, a larger buffer replaces
+// it; the previous buffer is kept until the GPU is done with it. Ranges
+// record the buffer they were allocated from, so ranges allocated
+// before the buffer was replaced can still be bound.
 class Multi_buffer
 {
 public:
+    // Maximum number of frames GPU may be behind CPU
     static constexpr std::size_t s_frame_resources_count = 4;
 
-    explicit Multi_buffer(const std::string_view name)
-        : m_name{name}
-    {
-    }
+    explicit Multi_buffer(const std::string_view name);
+    ~Multi_buffer() noexcept;
 
     void next_frame();
-    void bind();
+    void bind      ();
+    void bind      (const erhe::application::Buffer_range& range);
 
+    // Creates ring buffer with initial capacity of size bytes
     void allocate(
         const gl::Buffer_target target,
         const unsigned int      binding_point,
@@ -40,18 +82,43 @@ public:
         const std::string&      name
     );
 
-    [[nodiscard]] auto writer        () -> erhe::application::Buffer_writer&;
-    [[nodiscard]] auto current_buffer() -> erhe::graphics::Buffer&;
+    // Reserves byte range from current buffer, for writing later. Ranges
+    // reserved in one frame are disjoint, so they can be written by
+    // different threads.
+    [[nodiscard]] auto reserve(const std::size_t byte_count) -> erhe::application::Buffer_range;
+
+    // Reserves up to max_byte_count bytes for writing with writer(), and
+    // moves writer to start of the range. end_write() returns unused
+    // bytes to the ring.
+    void begin_write(const std::size_t max_byte_count);
+    auto end_write  () -> erhe::application::Buffer_range;
+
+    [[nodiscard]] auto write_end           () const -> std::size_t;
+    [[nodiscard]] auto writer              () -> erhe::application::Buffer_writer&;
+    [[nodiscard]] auto current_buffer      () -> erhe::graphics::Buffer&;
+    [[nodiscard]] auto remaining_byte_count() -> std::size_t; // without growing
 
 protected:
-    //std::size_t                         m_stride{0};
-    //std::size_t                         m_max_entry_count{0};
-
-    unsigned int                        m_binding_point{0};
-    std::vector<erhe::graphics::Buffer> m_buffers;
-    std::size_t                         m_current_slot{0};
-    erhe::application::Buffer_writer    m_writer;
-    std::string                         m_name;
+    [[nodiscard]] auto alignment() const -> std::size_t;
+
+    void grow(const std::size_t min_byte_count);
+
+    class Retired_buffer
+    {
+    public:
+        std::unique_ptr<erhe::graphics::Buffer> buffer;
+        std::optional<uint64_t>                 fence;
+    };
+
+    gl::Buffer_target                       m_target       {gl::Buffer_target::array_buffer};
+    unsigned int                            m_binding_point{0};
+    std::unique_ptr<erhe::graphics::Buffer> m_buffer;
+    std::vector<Retired_buffer>             m_retired_buffers;
+    Gl_fence_source                         m_fence_source;
+    Ring_allocator                          m_ring_allocator;
+    erhe::application::Buffer_writer        m_writer;
+    std::size_t                             m_write_end    {0};
+    std::string                             m_name;
 };
 
 } // namespace editor
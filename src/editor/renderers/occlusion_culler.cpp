@@ -0,0 +1,446 @@
+#include "renderers/occlusion_culler.hpp"
+
+#include "erhe/geometry/geometry.hpp"
+#include "erhe/primitive/primitive.hpp"
+#include "erhe/scene/mesh.hpp"
+#include "erhe/scene/node.hpp"
+#include "erhe/toolkit/profile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace editor
+{
+
+void Occlusion_culler::begin(const glm::mat4& clip_from_world, const bool reverse_depth)
+{
+    m_clip_from_world = clip_from_world;
+    m_reverse_depth   = reverse_depth;
+    m_occluder_count  = 0;
+    m_candidates.clear();
+
+    for (std::size_t level = 0; level < s_level_count; ++level)
+    {
+        const std::size_t cell_count = static_cast<std::size_t>(s_width >> level) * static_cast<std::size_t>(s_height >> level);
+        m_max_depth[level].assign(cell_count, std::numeric_limits<float>::max());
+    }
+}
+
+auto Occlusion_culler::occluder_count() const -> std::size_t
+{
+    return m_occluder_count;
+}
+
+auto Occlusion_culler::depth_buffer() const -> const std::vector<float>&
+{
+    return m_max_depth[0];
+}
+
+auto Occlusion_culler::to_depth(const glm::vec4& clip) const -> float
+{
+    const float depth = clip.z / clip.w;
+    return m_reverse_depth ? 1.0f - depth : depth;
+}
+
+auto Occlusion_culler::to_screen(const glm::vec4& clip) const -> Screen_vertex
+{
+    return Screen_vertex{
+        .x     = (clip.x / clip.w * 0.5f + 0.5f) * static_cast<float>(s_width),
+        .y     = (clip.y / clip.w * 0.5f + 0.5f) * static_cast<float>(s_height),
+        .depth = to_depth(clip)
+    };
+}
+
+auto Occlusion_culler::project(
+    const erhe::toolkit::Bounding_box& bounding_box,
+    Screen_rectangle&                  out_rectangle
+) const -> bool
+{
+    out_rectangle = Screen_rectangle{};
+    for (int i = 0; i < 8; ++i)
+    {
+        const glm::vec3 corner{
+            ((i & 1) != 0) ? bounding_box.max.x : bounding_box.min.x,
+            ((i & 2) != 0) ? bounding_box.max.y : bounding_box.min.y,
+            ((i & 4) != 0) ? bounding_box.max.z : bounding_box.min.z
+        };
+        const glm::vec4 clip = m_clip_from_world * glm::vec4{corner, 1.0f};
+
+        // Corners outside depth range would need clipping
+        if ((clip.w <= 0.0f) || (clip.z < 0.0f) || (clip.z > clip.w))
+        {
+            return false;
+        }
+        const Screen_vertex vertex = to_screen(clip);
+        out_rectangle.min_x         = std::min(out_rectangle.min_x, vertex.x);
+        out_rectangle.min_y         = std::min(out_rectangle.min_y, vertex.y);
+        out_rectangle.max_x         = std::max(out_rectangle.max_x, vertex.x);
+        out_rectangle.max_y         = std::max(out_rectangle.max_y, vertex.y);
+        out_rectangle.nearest_depth = std::min(out_rectangle.nearest_depth, vertex.depth);
+    }
+    return true;
+}
+
+void Occlusion_culler::add_occluder_candidates(
+    const gsl::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    constexpr float screen_area = static_cast<float>(s_width * s_height);
+
+    for (const auto& mesh : meshes)
+    {
+        uint32_t polygon_count{0};
+        bool     has_geometry {true};
+        for (const auto& primitive : mesh->mesh_data.primitives)
+        {
+            const auto geometry = primitive.get_geometry();
+            if (!geometry)
+            {
+                has_geometry = false;
+                break;
+            }
+            polygon_count += geometry->get_polygon_count();
+        }
+        if (!has_geometry || (polygon_count == 0) || (polygon_count > s_max_occluder_polygon_count))
+        {
+            continue;
+        }
+
+        const auto bounding_box = erhe::scene::get_world_bounding_box(*mesh.get());
+        if (!bounding_box.is_valid())
+        {
+            continue;
+        }
+
+        // Meshes which extend past near plane are large on screen
+        Screen_rectangle rectangle;
+        float            area_fraction{1.0f};
+        if (project(bounding_box, rectangle))
+        {
+            const float width  = std::clamp(rectangle.max_x, 0.0f, static_cast<float>(s_width )) - std::clamp(rectangle.min_x, 0.0f, static_cast<float>(s_width ));
+            const float height = std::clamp(rectangle.max_y, 0.0f, static_cast<float>(s_height)) - std::clamp(rectangle.min_y, 0.0f, static_cast<float>(s_height));
+            area_fraction = (width * height) / screen_area;
+        }
+        if (area_fraction < s_min_occluder_screen_area)
+        {
+            continue;
+        }
+
+        m_candidates.push_back(
+            Occluder_candidate{
+                .mesh        = mesh.get(),
+                .screen_area = area_fraction
+            }
+        );
+    }
+}
+
+void Occlusion_culler::end()
+{
+    ERHE_PROFILE_FUNCTION
+
+    const std::size_t count = std::min(m_candidates.size(), s_max_occluder_count);
+    std::partial_sort(
+        m_candidates.begin(),
+        m_candidates.begin() + count,
+        m_candidates.end(),
+        [](const Occluder_candidate& lhs, const Occluder_candidate& rhs)
+        {
+            return lhs.screen_area > rhs.screen_area;
+        }
+    );
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        add_occluder(*m_candidates[i].mesh);
+    }
+
+    build_pyramid();
+}
+
+void Occlusion_culler::add_occluder(const erhe::scene::Mesh& mesh)
+{
+    ERHE_PROFILE_FUNCTION
+
+    using namespace erhe::geometry;
+
+    const glm::mat4 clip_from_node = m_clip_from_world * mesh.world_from_node();
+    for (const auto& primitive : mesh.mesh_data.primitives)
+    {
+        const auto geometry = primitive.get_geometry();
+        if (geometry == nullptr)
+        {
+            continue;
+        }
+        const auto* const point_locations = geometry->point_attributes().find<glm::vec3>(c_point_locations);
+        if (point_locations == nullptr)
+        {
+            continue;
+        }
+
+        for (Polygon_id polygon_id = 0, end = geometry->get_polygon_count(); polygon_id < end; ++polygon_id)
+        {
+            const Polygon& polygon = geometry->polygons[polygon_id];
+            bool           valid{true};
+            m_clip_polygon.clear();
+            for (
+                Polygon_corner_id polygon_corner_id = polygon.first_polygon_corner_id,
+                corner_end = polygon.first_polygon_corner_id + polygon.corner_count;
+                polygon_corner_id < corner_end;
+                ++polygon_corner_id
+            )
+            {
+                const Corner_id corner_id = geometry->polygon_corners[polygon_corner_id];
+                const Point_id  point_id  = geometry->corners[corner_id].point_id;
+                if (!point_locations->has(point_id))
+                {
+                    valid = false;
+                    break;
+                }
+                m_clip_polygon.push_back(clip_from_node * glm::vec4{point_locations->get(point_id), 1.0f});
+            }
+            if (valid)
+            {
+                rasterize_clip_polygon();
+            }
+        }
+    }
+
+    ++m_occluder_count;
+}
+
+void Occlusion_culler::rasterize_polygon(const gsl::span<const glm::vec3> polygon_in_world)
+{
+    m_clip_polygon.clear();
+    for (const auto& position : polygon_in_world)
+    {
+        m_clip_polygon.push_back(m_clip_from_world * glm::vec4{position, 1.0f});
+    }
+    rasterize_clip_polygon();
+    ++m_occluder_count;
+}
+
+void Occlusion_culler::rasterize_clip_polygon()
+{
+    // Clip against 0 <= z <= w; this removes parts behind near plane,
+    // which do not occlude anything.
+    for (int plane = 0; plane < 2; ++plane)
+    {
+        const std::size_t count = m_clip_polygon.size();
+        if (count < 3)
+        {
+            return;
+        }
+        m_clip_scratch.clear();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const glm::vec4& p  = m_clip_polygon[i];
+            const glm::vec4& q  = m_clip_polygon[(i + 1) % count];
+            const float      dp = (plane == 0) ? p.z : p.w - p.z;
+            const float      dq = (plane == 0) ? q.z : q.w - q.z;
+            if (dp >= 0.0f)
+            {
+                m_clip_scratch.push_back(p);
+            }
+            if ((dp >= 0.0f) != (dq >= 0.0f))
+            {
+                const float t = dp / (dp - dq);
+                m_clip_scratch.push_back(p + t * (q - p));
+            }
+        }
+        m_clip_polygon.swap(m_clip_scratch);
+    }
+
+    const std::size_t count = m_clip_polygon.size();
+    if (count < 3)
+    {
+        return;
+    }
+    for (const auto& clip : m_clip_polygon)
+    {
+        if (clip.w <= 0.0f)
+        {
+            return;
+        }
+    }
+
+    // Polygons are convex, triangulate as fan
+    const Screen_vertex first = to_screen(m_clip_polygon[0]);
+    for (std::size_t i = 1; i + 1 < count; ++i)
+    {
+        rasterize_triangle(first, to_screen(m_clip_polygon[i]), to_screen(m_clip_polygon[i + 1]));
+    }
+}
+
+void Occlusion_culler::rasterize_triangle(
+    const Screen_vertex& a,
+    const Screen_vertex& b_in,
+    const Screen_vertex& c_in
+)
+{
+    // Only front faces occlude, so that open or single sided occluders
+    // seen from behind do not hide anything. Front face winding matches
+    // Rasterization_state::cull_mode_back_ccw(reverse_depth) used by fill
+    // passes: counterclockwise, or clockwise with reverse depth. Vertices
+    // are then ordered counterclockwise.
+    Screen_vertex b    = b_in;
+    Screen_vertex c    = c_in;
+    float         area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+    if (m_reverse_depth)
+    {
+        std::swap(b, c);
+        area = -area;
+    }
+    if (!(area > 0.0f))
+    {
+        return;
+    }
+
+    const int x0 = std::max(static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))), 0);
+    const int y0 = std::max(static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))), 0);
+    const int x1 = std::min(static_cast<int>(std::ceil (std::max({a.x, b.x, c.x}))), s_width  - 1);
+    const int y1 = std::min(static_cast<int>(std::ceil (std::max({a.y, b.y, c.y}))), s_height - 1);
+    if ((x0 > x1) || (y0 > y1))
+    {
+        return;
+    }
+
+    // Depth plane. Depth is taken at farthest point of pixel, so that
+    // occluders never appear closer than they are.
+    const float dzdx = ((b.depth - a.depth) * (c.y - a.y) - (c.depth - a.depth) * (b.y - a.y)) / area;
+    const float dzdy = ((c.depth - a.depth) * (b.x - a.x) - (b.depth - a.depth) * (c.x - a.x)) / area;
+    const float bias = 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+
+    // Edge functions are positive inside; step per pixel in x
+    const float e0_dx = -(b.y - a.y);
+    const float e1_dx = -(c.y - b.y);
+    const float e2_dx = -(a.y - c.y);
+
+    float* const depth_buffer = m_max_depth[0].data();
+    const float  px0          = static_cast<float>(x0) + 0.5f;
+    for (int y = y0; y <= y1; ++y)
+    {
+        const float  py        = static_cast<float>(y) + 0.5f;
+        const float  e0_row    = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px0 - a.x);
+        const float  e1_row    = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px0 - b.x);
+        const float  e2_row    = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px0 - c.x);
+        const float  depth_row = a.depth + dzdx * (px0 - a.x) + dzdy * (py - a.y) + bias;
+        float* const row       = depth_buffer + static_cast<std::size_t>(y) * s_width;
+
+        // Branch free, so that compiler can vectorize it
+        for (int x = x0; x <= x1; ++x)
+        {
+            const float dx     = static_cast<float>(x - x0);
+            const bool  inside = (e0_row + dx * e0_dx >= 0.0f) & (e1_row + dx * e1_dx >= 0.0f) & (e2_row + dx * e2_dx >= 0.0f);
+            const float depth  = depth_row + dx * dzdx;
+            row[x] = (inside & (depth < row[x])) ? depth : row[x];
+        }
+    }
+}
+
+void Occlusion_culler::build_pyramid()
+{
+    ERHE_PROFILE_FUNCTION
+
+    for (std::size_t level = 1; level < s_level_count; ++level)
+    {
+        const std::size_t  width        = static_cast<std::size_t>(s_width  >> level);
+        const std::size_t  height       = static_cast<std::size_t>(s_height >> level);
+        const std::size_t  source_width = width * 2;
+        const float* const source       = m_max_depth[level - 1].data();
+        float* const       destination  = m_max_depth[level].data();
+        for (std::size_t y = 0; y < height; ++y)
+        {
+            const float* const row0 = source + (y * 2) * source_width;
+            const float* const row1 = row0 + source_width;
+            for (std::size_t x = 0; x < width; ++x)
+            {
+                destination[y * width + x] = std::max(
+                    std::max(row0[x * 2], row0[x * 2 + 1]),
+                    std::max(row1[x * 2], row1[x * 2 + 1])
+                );
+            }
+        }
+    }
+}
+
+auto Occlusion_culler::is_occluded(const erhe::toolkit::Bounding_box& bounding_box) const -> bool
+{
+    if ((m_occluder_count == 0) || !bounding_box.is_valid())
+    {
+        return false;
+    }
+
+    Screen_rectangle rectangle;
+    if (!project(bounding_box, rectangle))
+    {
+        return false;
+    }
+    if (
+        (rectangle.max_x < 0.0f) || (rectangle.min_x > static_cast<float>(s_width )) ||
+        (rectangle.max_y < 0.0f) || (rectangle.min_y > static_cast<float>(s_height))
+    )
+    {
+        return false;
+    }
+
+    // Occluders cover pixels by their centers, so they may extend up to
+    // half a pixel past their true edges. Grow rectangle by one pixel.
+    const int x0 = std::clamp(static_cast<int>(std::floor(rectangle.min_x)) - 1, 0, s_width  - 1);
+    const int y0 = std::clamp(static_cast<int>(std::floor(rectangle.min_y)) - 1, 0, s_height - 1);
+    const int x1 = std::clamp(static_cast<int>(std::floor(rectangle.max_x)) + 1, 0, s_width  - 1);
+    const int y1 = std::clamp(static_cast<int>(std::floor(rectangle.max_y)) + 1, 0, s_height - 1);
+
+    // Use level where rectangle spans at most two cells in each direction
+    std::size_t level = 0;
+    while (
+        (level + 1 < s_level_count) &&
+        (
+            ((x1 >> level) - (x0 >> level) > 1) ||
+            ((y1 >> level) - (y0 >> level) > 1)
+        )
+    )
+    {
+        ++level;
+    }
+
+    const auto&       max_depth = m_max_depth[level];
+    const std::size_t width     = static_cast<std::size_t>(s_width >> level);
+    for (int y = (y0 >> level), y_end = (y1 >> level); y <= y_end; ++y)
+    {
+        for (int x = (x0 >> level), x_end = (x1 >> level); x <= x_end; ++x)
+        {
+            if (rectangle.nearest_depth <= max_depth[static_cast<std::size_t>(y) * width + static_cast<std::size_t>(x)])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Occlusion_culler::remove_occluded(std::vector<std::shared_ptr<erhe::scene::Mesh>>& meshes) const
+{
+    ERHE_PROFILE_FUNCTION
+
+    if (m_occluder_count == 0)
+    {
+        return;
+    }
+
+    meshes.erase(
+        std::remove_if(
+            meshes.begin(),
+            meshes.end(),
+            [this](const std::shared_ptr<erhe::scene::Mesh>& mesh)
+            {
+                return is_occluded(erhe::scene::get_world_bounding_box(*mesh.get()));
+            }
+        ),
+        meshes.end()
+    );
+}
+
+} // namespace editor
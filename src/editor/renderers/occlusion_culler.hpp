@@ -0,0 +1,123 @@
+#pragma once
+
+#include "erhe/toolkit/math_util.hpp"
+
+#include <glm/glm.hpp>
+
+#include <gsl/gsl>
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace erhe::scene
+{
+    class Mesh;
+}
+
+namespace editor
+{
+
+// Occlusion culling with software rasterized occluders.
+//
+// Large meshes with few polygons, such as floors and walls, are chosen
+// as occluders and rasterized to a low resolution depth buffer. Only
+// front faces are rasterized, with the same winding as fill passes.
+// The depth buffer is reduced to a pyramid of maximum depths, where each
+// level halves resolution. Mesh bounding boxes are tested against the
+// pyramid level where the box covers at most a few cells. A box is
+// occluded if its nearest depth is behind the farthest occluder depth
+// in its screen rectangle.
+//
+// Depth is normalized device depth, flipped for reverse depth, so that
+// smaller values are closer to the viewer. Depth is affine in screen
+// space for both perspective and orthographic projections.
+//
+// There is no GPU dependency.
+class Occlusion_culler
+{
+public:
+    static constexpr int         s_width                      = 256;
+    static constexpr int         s_height                     = 128;
+    static constexpr std::size_t s_level_count                = 8;     // 256 x 128 .. 2 x 1
+    static constexpr std::size_t s_max_occluder_count         = 16;
+    static constexpr uint32_t    s_max_occluder_polygon_count = 256;
+    static constexpr float       s_min_occluder_screen_area   = 0.02f; // fraction of viewport
+
+    // Clears depth buffer and occluder candidates
+    void begin(const glm::mat4& clip_from_world, const bool reverse_depth);
+
+    // Adds meshes which are large and simple enough as occluder candidates
+    void add_occluder_candidates(const gsl::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes);
+
+    // Rasterizes largest occluder candidates, and builds depth pyramid
+    void end();
+
+    // Rasterizes convex polygon given in world space; counts as one occluder.
+    // Only the front facing side occludes, as with meshes.
+    void rasterize_polygon(const gsl::span<const glm::vec3> polygon_in_world);
+
+    // Builds depth pyramid from depth buffer; called by end()
+    void build_pyramid();
+
+    [[nodiscard]] auto is_occluded     (const erhe::toolkit::Bounding_box& bounding_box) const -> bool;
+    [[nodiscard]] auto occluder_count  () const -> std::size_t; // rasterized meshes and polygons
+    [[nodiscard]] auto depth_buffer    () const -> const std::vector<float>&;
+
+    // Removes occluded meshes; safe to call from several threads at once
+    void remove_occluded(std::vector<std::shared_ptr<erhe::scene::Mesh>>& meshes) const;
+
+private:
+    class Occluder_candidate
+    {
+    public:
+        const erhe::scene::Mesh* mesh       {nullptr};
+        float                    screen_area{0.0f};
+    };
+
+    class Screen_vertex
+    {
+    public:
+        float x    {0.0f};
+        float y    {0.0f};
+        float depth{0.0f};
+    };
+
+    class Screen_rectangle
+    {
+    public:
+        float min_x        {std::numeric_limits<float>::max()};
+        float min_y        {std::numeric_limits<float>::max()};
+        float max_x        {std::numeric_limits<float>::lowest()};
+        float max_y        {std::numeric_limits<float>::lowest()};
+        float nearest_depth{std::numeric_limits<float>::max()};
+    };
+
+    [[nodiscard]] auto to_depth (const glm::vec4& clip) const -> float;
+    [[nodiscard]] auto to_screen(const glm::vec4& clip) const -> Screen_vertex;
+
+    // Returns false if some box corner is outside depth range
+    [[nodiscard]] auto project(
+        const erhe::toolkit::Bounding_box& bounding_box,
+        Screen_rectangle&                  out_rectangle
+    ) const -> bool;
+
+    void add_occluder          (const erhe::scene::Mesh& mesh);
+    void rasterize_clip_polygon(); // m_clip_polygon
+    void rasterize_triangle(
+        const Screen_vertex& a,
+        const Screen_vertex& b,
+        const Screen_vertex& c
+    );
+
+    glm::mat4                                     m_clip_from_world{1.0f};
+    bool                                          m_reverse_depth  {false};
+    std::size_t                                   m_occluder_count {0};
+    std::vector<Occluder_candidate>               m_candidates;
+    std::vector<glm::vec4>                        m_clip_polygon;
+    std::vector<glm::vec4>                        m_clip_scratch;
+    std::array<std::vector<float>, s_level_count> m_max_depth; // level 0 is depth buffer
+};
+
+} // namespace editor
@@ -0,0 +1,406 @@
+#include "renderers/persistent_primitive_buffer.hpp"
+#include "renderers/render_queue.hpp"
+#include "editor_log.hpp"
+
+#include "erhe/gl/enum_bit_mask_operators.hpp"
+#include "erhe/gl/wrapper_functions.hpp"
+#include "erhe/primitive/material.hpp"
+#include "erhe/primitive/primitive.hpp"
+#include "erhe/scene/mesh.hpp"
+#include "erhe/scene/node.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace editor
+{
+
+Persistent_primitive_buffer::Persistent_primitive_buffer(const Primitive_interface& primitive_interface)
+    : m_name               {"persistent primitive"}
+    , m_primitive_interface{primitive_interface}
+    , m_entry_size         {primitive_interface.primitive_struct.size_bytes()}
+    , m_slot_count         {static_cast<uint32_t>(primitive_interface.max_primitive_count)}
+{
+    static constexpr gl::Buffer_storage_mask storage_mask{
+        gl::Buffer_storage_mask::map_coherent_bit   |
+        gl::Buffer_storage_mask::map_persistent_bit |
+        gl::Buffer_storage_mask::map_write_bit
+    };
+
+    static constexpr gl::Map_buffer_access_mask access_mask{
+        gl::Map_buffer_access_mask::map_coherent_bit   |
+        gl::Map_buffer_access_mask::map_persistent_bit |
+        gl::Map_buffer_access_mask::map_write_bit
+    };
+
+    for (std::size_t slot = 0; slot < s_frame_resources_count; ++slot)
+    {
+        m_buffers.emplace_back(
+            gl::Buffer_target::shader_storage_buffer,
+            m_primitive_interface.primitive_block.size_bytes(),
+            storage_mask,
+            access_mask,
+            fmt::format("{} {}", m_name, slot)
+        );
+    }
+
+    m_slot_data        .resize(m_slot_count);
+    m_slot_initialized .resize(m_slot_count, 0);
+    m_slot_pending_mask.resize(m_slot_count, 0);
+    m_slot_used_frame  .resize(m_slot_count, std::numeric_limits<uint64_t>::max());
+    m_free_ranges.push_back(Slot_range{.first = 0, .count = m_slot_count});
+}
+
+auto Persistent_primitive_buffer::get_variant(const Primitive_interface_settings& settings) -> Variant*
+{
+    for (auto& variant : m_variants)
+    {
+        if (
+            (variant.settings.color_source   == settings.color_source  ) &&
+            (variant.settings.constant_color == settings.constant_color) &&
+            (variant.settings.size_source    == settings.size_source   ) &&
+            (variant.settings.constant_size  == settings.constant_size )
+        )
+        {
+            return &variant;
+        }
+    }
+
+    if (m_variants.size() == s_max_variant_count)
+    {
+        // Evict least recently used variant, unless it may still be in use by GPU
+        auto lru = std::min_element(
+            m_variants.begin(),
+            m_variants.end(),
+            [](const Variant& lhs, const Variant& rhs)
+            {
+                return lhs.last_used_frame < rhs.last_used_frame;
+            }
+        );
+        if (lru->last_used_frame + s_frame_resources_count >= m_frame)
+        {
+            return nullptr;
+        }
+        release_variant(*lru);
+        m_variants.erase(lru);
+    }
+
+    auto& variant = m_variants.emplace_back();
+    variant.settings = settings;
+    return &variant;
+}
+
+auto Persistent_primitive_buffer::allocate_slots(const uint32_t count) -> std::optional<Slot_range>
+{
+    for (auto i = m_free_ranges.begin(), end = m_free_ranges.end(); i != end; ++i)
+    {
+        if (i->count < count)
+        {
+            continue;
+        }
+        const Slot_range range{.first = i->first, .count = count};
+        i->first += count;
+        i->count -= count;
+        if (i->count == 0)
+        {
+            m_free_ranges.erase(i);
+        }
+        for (uint32_t slot = range.first, slot_end = range.first + range.count; slot < slot_end; ++slot)
+        {
+            m_slot_initialized[slot] = 0;
+        }
+        return range;
+    }
+    return {};
+}
+
+void Persistent_primitive_buffer::release_slots(const Slot_range& range)
+{
+    if (range.count == 0)
+    {
+        return;
+    }
+
+    // Keep free ranges sorted, and merge with neighbors
+    auto next = std::lower_bound(
+        m_free_ranges.begin(),
+        m_free_ranges.end(),
+        range.first,
+        [](const Slot_range& free_range, const uint32_t first)
+        {
+            return free_range.first < first;
+        }
+    );
+    auto i = m_free_ranges.insert(next, range);
+    if ((std::next(i) != m_free_ranges.end()) && (i->first + i->count == std::next(i)->first))
+    {
+        i->count += std::next(i)->count;
+        m_free_ranges.erase(std::next(i));
+    }
+    if ((i != m_free_ranges.begin()) && (std::prev(i)->first + std::prev(i)->count == i->first))
+    {
+        std::prev(i)->count += i->count;
+        m_free_ranges.erase(i);
+    }
+}
+
+void Persistent_primitive_buffer::release_variant(Variant& variant)
+{
+    for (const auto& [id, mesh_slots] : variant.meshes)
+    {
+        release_slots(mesh_slots.slots);
+    }
+    variant.meshes.clear();
+}
+
+void Persistent_primitive_buffer::collect_garbage(const uint64_t max_unused_frame_count)
+{
+    ERHE_PROFILE_FUNCTION
+
+    for (auto& variant : m_variants)
+    {
+        for (auto i = variant.meshes.begin(); i != variant.meshes.end();)
+        {
+            if (i->second.last_used_frame + max_unused_frame_count < m_frame)
+            {
+                release_slots(i->second.slots);
+                i = variant.meshes.erase(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+}
+
+auto Persistent_primitive_buffer::get_mesh_slots(
+    Variant&                 variant,
+    const erhe::scene::Mesh& mesh
+) -> const Mesh_slots*
+{
+    const uint32_t primitive_count = static_cast<uint32_t>(mesh.mesh_data.primitives.size());
+    auto&          mesh_slots      = variant.meshes[mesh.get_id()];
+    const bool     used_this_frame = (mesh_slots.slots.count > 0) && (mesh_slots.last_used_frame == m_frame);
+    mesh_slots.last_used_frame = m_frame;
+    if (mesh_slots.slots.count == primitive_count)
+    {
+        return &mesh_slots;
+    }
+
+    // New mesh, or primitive count has changed. Slots used by draws in
+    // this frame are released in next_frame().
+    if (used_this_frame)
+    {
+        m_released_this_frame.push_back(mesh_slots.slots);
+    }
+    else
+    {
+        release_slots(mesh_slots.slots);
+    }
+    mesh_slots.slots = Slot_range{};
+    auto range = allocate_slots(primitive_count);
+    if (!range.has_value())
+    {
+        // Release slots of meshes which have not been drawn recently
+        collect_garbage(s_frame_resources_count);
+        range = allocate_slots(primitive_count);
+    }
+    if (!range.has_value())
+    {
+        if (!m_capacity_reported)
+        {
+            log_render->warn("persistent primitive buffer capacity {} exceeded", m_slot_count);
+            m_capacity_reported = true;
+        }
+        variant.meshes.erase(mesh.get_id());
+        return nullptr;
+    }
+    mesh_slots.slots = range.value();
+    return &mesh_slots;
+}
+
+auto Persistent_primitive_buffer::make_slot_data(
+    const Primitive_interface_settings& settings,
+    const erhe::scene::Mesh&            mesh,
+    const erhe::primitive::Primitive&   primitive
+) const -> Slot_data
+{
+    return Slot_data{
+        .world_from_node = mesh.world_from_node(),
+        .color           = (settings.color_source == Primitive_color_source::mesh_wireframe_color)
+            ? mesh.node_data.wireframe_color
+            : settings.constant_color,
+        .material_index  = (primitive.material != nullptr)
+            ? static_cast<uint32_t>(primitive.material->index)
+            : 0u,
+        .size            =
+            (settings.size_source == Primitive_size_source::mesh_point_size) ? mesh.mesh_data.point_size :
+            (settings.size_source == Primitive_size_source::mesh_line_width) ? mesh.mesh_data.line_width :
+                                                                               settings.constant_size
+    };
+}
+
+void Persistent_primitive_buffer::write_slot(erhe::graphics::Buffer& buffer, const uint32_t slot)
+{
+    using erhe::graphics::as_span;
+    using erhe::graphics::write;
+
+    const auto&       offsets   = m_primitive_interface.offsets;
+    const auto        gpu_data  = buffer.map();
+    const Slot_data&  slot_data = m_slot_data[slot];
+    const std::size_t offset    = slot * m_entry_size;
+    const uint32_t    zero      = 0;
+    write(gpu_data, offset + offsets.world_from_node, as_span(slot_data.world_from_node));
+    write(gpu_data, offset + offsets.color,           as_span(slot_data.color          ));
+    write(gpu_data, offset + offsets.material_index,  as_span(slot_data.material_index ));
+    write(gpu_data, offset + offsets.size,            as_span(slot_data.size           ));
+    write(gpu_data, offset + offsets.extra2,          as_span(zero                     ));
+    write(gpu_data, offset + offsets.extra3,          as_span(zero                     ));
+}
+
+auto Persistent_primitive_buffer::update_slot(const uint32_t slot, const Slot_data& slot_data) -> bool
+{
+    const bool used_this_frame = (m_slot_used_frame[slot] == m_frame);
+    m_slot_used_frame[slot] = m_frame;
+    if ((m_slot_initialized[slot] != 0) && (m_slot_data[slot] == slot_data))
+    {
+        return true;
+    }
+
+    // Draws submitted earlier in this frame may still read the slot
+    if (used_this_frame && (m_slot_initialized[slot] != 0))
+    {
+        return false;
+    }
+
+    m_slot_data       [slot] = slot_data;
+    m_slot_initialized[slot] = 1;
+
+    // Write to current frame buffer now, and to other frame buffers
+    // when they become current.
+    write_slot(m_buffers.at(m_current_slot), slot);
+    for (std::size_t i = 0; i < s_frame_resources_count; ++i)
+    {
+        const uint8_t bit = static_cast<uint8_t>(1u << i);
+        if ((i == m_current_slot) || ((m_slot_pending_mask[slot] & bit) != 0))
+        {
+            continue;
+        }
+        m_slot_pending_mask[slot] |= bit;
+        m_pending_slots[i].push_back(slot);
+    }
+    return true;
+}
+
+auto Persistent_primitive_buffer::update(
+    const gsl::span<const Render_item>& render_items,
+    const Primitive_interface_settings& settings,
+    std::vector<uint32_t>&              out_slots
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION
+
+    out_slots.clear();
+
+    if (settings.color_source == Primitive_color_source::id_offset)
+    {
+        return false;
+    }
+
+    Variant* variant = get_variant(settings);
+    if (variant == nullptr)
+    {
+        return false;
+    }
+    variant->last_used_frame = m_frame;
+
+    for (const auto& item : render_items)
+    {
+        const erhe::scene::Mesh& mesh       = *item.mesh;
+        const Mesh_slots*        mesh_slots = get_mesh_slots(*variant, mesh);
+        if (mesh_slots == nullptr)
+        {
+            out_slots.clear();
+            return false;
+        }
+        const uint32_t slot = mesh_slots->slots.first + item.primitive_index;
+        if (!update_slot(slot, make_slot_data(settings, mesh, mesh.mesh_data.primitives[item.primitive_index])))
+        {
+            out_slots.clear();
+            return false;
+        }
+        out_slots.push_back(slot);
+    }
+    return true;
+}
+
+void Persistent_primitive_buffer::next_frame()
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Draws of ending frame are done when fence is signaled
+    m_buffer_fences[m_current_slot] = m_fence_source.insert_fence();
+
+    m_current_slot = (m_current_slot + 1) % s_frame_resources_count;
+    ++m_frame;
+
+    // GPU may still read this buffer for draws of an earlier frame
+    auto& fence = m_buffer_fences[m_current_slot];
+    if (fence.has_value())
+    {
+        m_fence_source.wait(fence.value());
+        fence.reset();
+    }
+
+    for (const auto& range : m_released_this_frame)
+    {
+        release_slots(range);
+    }
+    m_released_this_frame.clear();
+
+    // Bring current frame buffer up to date
+    auto&         buffer  = m_buffers.at(m_current_slot);
+    auto&         pending = m_pending_slots[m_current_slot];
+    const uint8_t bit     = static_cast<uint8_t>(1u << m_current_slot);
+    for (const uint32_t slot : pending)
+    {
+        write_slot(buffer, slot);
+        m_slot_pending_mask[slot] &= ~bit;
+    }
+    pending.clear();
+
+    if ((m_frame % s_garbage_collect_frames) == 0)
+    {
+        collect_garbage(s_garbage_collect_frames);
+        m_variants.erase(
+            std::remove_if(
+                m_variants.begin(),
+                m_variants.end(),
+                [this](const Variant& variant)
+                {
+                    return variant.meshes.empty() && (variant.last_used_frame + s_garbage_collect_frames < m_frame);
+                }
+            ),
+            m_variants.end()
+        );
+    }
+}
+
+void Persistent_primitive_buffer::bind()
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto& buffer = m_buffers.at(m_current_slot);
+    gl::bind_buffer_range(
+        buffer.target(),
+        static_cast<GLuint>    (m_primitive_interface.primitive_block.binding_point()),
+        static_cast<GLuint>    (buffer.gl_name()),
+        static_cast<GLintptr>  (0),
+        static_cast<GLsizeiptr>(m_slot_count * m_entry_size)
+    );
+}
+
+} // namespace editor
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "renderers/multi_buffer.hpp"
+#include "renderers/primitive_buffer.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace erhe::primitive
+{
+    class Primitive;
+}
+
+namespace erhe::scene
+{
+    class Mesh;
+}
+
+namespace editor
+{
+
+class Render_item;
+
+// Primitive buffer where each mesh primitive owns a stable slot.
+//
+// Slot contents are mirrored on the CPU. An entry is written to GPU
+// buffer only when its contents differ from the mirror, so per frame
+// write cost follows what changed, not scene size. Changed slots are
+// written to the current frame buffer immediately, and queued for the
+// other frame buffers, which are written when they become current.
+//
+// Entry color and size depend on Primitive_interface_settings, so
+// slots are allocated separately for each distinct settings value
+// (variant). Draw commands select the slot with base instance.
+//
+// ID offset color source assigns offsets per update, and can not be
+// stored persistently; update() returns false for it, as well as when
+// slots run out. The caller then falls back to Primitive_buffer.
+//
+// Unlike Multi_buffer, slots need stable locations, so each frame has
+// its own copy of the buffer. Each copy is fenced when its frame ends,
+// and next_frame() waits for the fence before the copy is written
+// again. Within a frame, draws already submitted may still read the
+// current copy, so a slot which has been used in this frame is not
+// rewritten with different contents (update() returns false), and
+// slots released in this frame are not reused before next frame.
+class Persistent_primitive_buffer
+{
+public:
+    static constexpr std::size_t s_frame_resources_count = Multi_buffer::s_frame_resources_count;
+
+    explicit Persistent_primitive_buffer(const Primitive_interface& primitive_interface);
+
+    // Clears out_slots, and then adds slot for each render item
+    [[nodiscard]] auto update(
+        const gsl::span<const Render_item>& render_items,
+        const Primitive_interface_settings& settings,
+        std::vector<uint32_t>&              out_slots
+    ) -> bool;
+
+    void next_frame();
+    void bind      ();
+
+private:
+    static constexpr std::size_t s_max_variant_count     = 8;
+    static constexpr uint64_t    s_garbage_collect_frames = 64;
+
+    class Slot_data
+    {
+    public:
+        glm::mat4 world_from_node{1.0f};
+        glm::vec4 color          {0.0f};
+        uint32_t  material_index {0};
+        float     size           {0.0f};
+
+        auto operator==(const Slot_data& other) const -> bool = default;
+    };
+
+    class Slot_range
+    {
+    public:
+        uint32_t first{0};
+        uint32_t count{0};
+    };
+
+    class Mesh_slots
+    {
+    public:
+        Slot_range slots;
+        uint64_t   last_used_frame{0};
+    };
+
+    class Variant
+    {
+    public:
+        Primitive_interface_settings                settings;
+        std::unordered_map<std::size_t, Mesh_slots> meshes; // key is mesh node id
+        uint64_t                                    last_used_frame{0};
+    };
+
+    [[nodiscard]] auto get_variant   (const Primitive_interface_settings& settings) -> Variant*;
+    [[nodiscard]] auto get_mesh_slots(Variant& variant, const erhe::scene::Mesh& mesh) -> const Mesh_slots*;
+    [[nodiscard]] auto allocate_slots(const uint32_t count) -> std::optional<Slot_range>;
+    [[nodiscard]] auto make_slot_data(
+        const Primitive_interface_settings& settings,
+        const erhe::scene::Mesh&            mesh,
+        const erhe::primitive::Primitive&   primitive
+    ) const -> Slot_data;
+
+    [[nodiscard]] auto update_slot(const uint32_t slot, const Slot_data& slot_data) -> bool;
+
+    void release_slots  (const Slot_range& range);
+    void release_variant(Variant& variant);
+    void collect_garbage(const uint64_t max_unused_frame_count);
+    void write_slot     (erhe::graphics::Buffer& buffer, const uint32_t slot);
+
+    std::string                         m_name;
+    std::vector<erhe::graphics::Buffer> m_buffers;
+    std::size_t                         m_current_slot{0};
+    Gl_fence_source                     m_fence_source;
+    std::array<std::optional<uint64_t>, s_frame_resources_count> m_buffer_fences;
+
+    const Primitive_interface& m_primitive_interface;
+    std::size_t                m_entry_size{0};
+    uint32_t                   m_slot_count{0};
+    uint64_t                   m_frame     {0};
+    std::vector<Variant>       m_variants;
+    std::vector<Slot_range>    m_free_ranges; // sorted by first slot
+    std::vector<Slot_data>     m_slot_data;
+    std::vector<uint8_t>       m_slot_initialized;
+    std::vector<uint8_t>       m_slot_pending_mask; // bit per frame buffer
+    std::vector<uint64_t>      m_slot_used_frame;
+    std::vector<Slot_range>    m_released_this_frame;
+    std::array<std::vector<uint32_t>, s_frame_resources_count> m_pending_slots;
+    bool                       m_capacity_reported{false};
+};
+
+} // namespace editor
@@ -2,6 +2,7 @@
 
 #include "renderers/primitive_buffer.hpp"
 #include "renderers/program_interface.hpp"
+#include "renderers/render_queue.hpp"
 #include "editor_log.hpp"
 
 #include "erhe/primitive/primitive.hpp"
@@ -47,6 +48,11 @@ void Primitive_buffer::reset_id_ranges()
     m_id_ranges.clear();
 }
 
+auto Primitive_buffer::entry_size() const -> std::size_t
+{
+    return m_primitive_interface.primitive_struct.size_bytes();
+}
+
 auto Primitive_buffer::id_offset() const -> uint32_t
 {
     return m_id_offset;
@@ -57,6 +63,42 @@ auto Primitive_buffer::id_ranges() const -> const std::vector<Id_range>&
     return m_id_ranges;
 }
 
+void Primitive_buffer::write_entry(
+    const gsl::span<std::byte>&       primitive_gpu_data,
+    const std::size_t                 offset,
+    const erhe::scene::Mesh&          mesh,
+    const erhe::primitive::Primitive& primitive
+) const
+{
+    const auto&     offsets         = m_primitive_interface.offsets;
+    const auto&     node_data       = mesh.node_data;
+    const auto&     mesh_data       = mesh.mesh_data;
+    const glm::vec3 id_offset_vec3  = erhe::toolkit::vec3_from_uint(m_id_offset);
+    const glm::vec4 id_offset_vec4  = glm::vec4{id_offset_vec3, 0.0f};
+    const glm::mat4 world_from_node = mesh.world_from_node();
+    const uint32_t  material_index  = (primitive.material != nullptr) ? static_cast<uint32_t>(primitive.material->index) : 0u;
+    const uint32_t  extra2          = 0;
+    const uint32_t  extra3          = 0;
+
+    using erhe::graphics::as_span;
+    const auto color_span =
+        (settings.color_source == Primitive_color_source::id_offset           ) ? as_span(id_offset_vec4           ) :
+        (settings.color_source == Primitive_color_source::mesh_wireframe_color) ? as_span(node_data.wireframe_color) :
+                                                                                  as_span(settings.constant_color);
+    const auto size_span =
+        (settings.size_source == Primitive_size_source::mesh_point_size) ? as_span(mesh_data.point_size   ) :
+        (settings.size_source == Primitive_size_source::mesh_line_width) ? as_span(mesh_data.line_width   ) :
+                                                                           as_span(settings.constant_size);
+
+    using erhe::graphics::write;
+    write(primitive_gpu_data, offset + offsets.world_from_node, as_span(world_from_node));
+    write(primitive_gpu_data, offset + offsets.color,           color_span              );
+    write(primitive_gpu_data, offset + offsets.material_index,  as_span(material_index ));
+    write(primitive_gpu_data, offset + offsets.size,            size_span               );
+    write(primitive_gpu_data, offset + offsets.extra2,          as_span(extra2         ));
+    write(primitive_gpu_data, offset + offsets.extra3,          as_span(extra3         ));
+}
+
 auto Primitive_buffer::update(
     const gsl::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
     const erhe::scene::Visibility_filter&                      visibility_filter,
@@ -72,40 +114,28 @@ auto Primitive_buffer::update(
         m_writer.write_offset
     );
 
+    const auto  entry_size = m_primitive_interface.primitive_struct.size_bytes();
+    std::size_t max_primitive_count{0};
+    for (const auto& mesh : meshes)
+    {
+        max_primitive_count += mesh->mesh_data.primitives.size();
+    }
+    begin_write(max_primitive_count * entry_size);
+
     auto&       buffer             = current_buffer();
-    const auto  entry_size         = m_primitive_interface.primitive_struct.size_bytes();
-    const auto& offsets            = m_primitive_interface.offsets;
     const auto  primitive_gpu_data = buffer.map();
     std::size_t primitive_index    = 0;
-    m_writer.begin(buffer.target());
     for (const auto& mesh : meshes)
     {
-        if ((m_writer.write_offset + entry_size) > buffer.capacity_byte_count())
-        {
-            log_render->critical("primitive buffer capacity {} exceeded", buffer.capacity_byte_count());
-            ERHE_FATAL("primitive buffer capacity exceeded");
-            break;
-        }
-
         ERHE_VERIFY(mesh);
         if (!visibility_filter(mesh->get_visibility_mask()))
         {
             continue;
         }
 
-        const auto& node_data = mesh->node_data;
-        const auto& mesh_data = mesh->mesh_data;
-
         std::size_t mesh_primitive_index{0};
-        for (const auto& primitive : mesh_data.primitives)
+        for (const auto& primitive : mesh->mesh_data.primitives)
         {
-            if ((m_writer.write_offset + entry_size) > buffer.capacity_byte_count())
-            {
-                log_render->critical("primitive buffer capacity {} exceeded", buffer.capacity_byte_count());
-                ERHE_FATAL("primitive buffer capacity exceeded");
-                break;
-            }
-
             const auto&    primitive_geometry = primitive.gl_primitive_geometry;
             const uint32_t count              = static_cast<uint32_t>(primitive_geometry.triangle_fill_indices.index_count);
             const uint32_t power_of_two       = erhe::toolkit::next_power_of_two(count);
@@ -117,36 +147,9 @@ auto Primitive_buffer::update(
                 m_id_offset += add;
             }
 
-            const glm::vec3 id_offset_vec3  = erhe::toolkit::vec3_from_uint(m_id_offset);
-            const glm::vec4 id_offset_vec4  = glm::vec4{id_offset_vec3, 0.0f};
-            const glm::mat4 world_from_node = mesh->world_from_node();
-            const uint32_t  material_index  = (primitive.material != nullptr) ? static_cast<uint32_t>(primitive.material->index) : 0u;
-            const uint32_t  extra2          = 0;
-            const uint32_t  extra3          = 0;
-
-            using erhe::graphics::as_span;
-            const auto color_span =
-                (settings.color_source == Primitive_color_source::id_offset           ) ? as_span(id_offset_vec4           ) :
-                (settings.color_source == Primitive_color_source::mesh_wireframe_color) ? as_span(node_data.wireframe_color) :
-                                                                                          as_span(settings.constant_color);
-            const auto size_span =
-                (settings.size_source == Primitive_size_source::mesh_point_size) ? as_span(mesh_data.point_size   ) :
-                (settings.size_source == Primitive_size_source::mesh_line_width) ? as_span(mesh_data.line_width   ) :
-                                                                                   as_span(settings.constant_size);
-            //memset(reinterpret_cast<uint8_t*>(model_gpu_data.data()) + offset, 0, entry_size);
-            {
-                //ZoneScopedN("write");
-                using erhe::graphics::write;
-                write(primitive_gpu_data, m_writer.write_offset + offsets.world_from_node, as_span(world_from_node));
-                write(primitive_gpu_data, m_writer.write_offset + offsets.color,           color_span              );
-                write(primitive_gpu_data, m_writer.write_offset + offsets.material_index,  as_span(material_index ));
-                write(primitive_gpu_data, m_writer.write_offset + offsets.size,            size_span               );
-                write(primitive_gpu_data, m_writer.write_offset + offsets.extra2,          as_span(extra2         ));
-                write(primitive_gpu_data, m_writer.write_offset + offsets.extra3,          as_span(extra3         ));
-
-            }
+            write_entry(primitive_gpu_data, m_writer.write_offset, *mesh.get(), primitive);
             m_writer.write_offset += entry_size;
-            ERHE_VERIFY(m_writer.write_offset <= buffer.capacity_byte_count());
+            ERHE_VERIFY(m_writer.write_offset <= write_end());
 
             if (use_id_ranges)
             {
@@ -166,11 +169,49 @@ auto Primitive_buffer::update(
         }
     }
 
-    m_writer.end();
-
     SPDLOG_LOGGER_TRACE(log_draw, "wrote {} entries to primitive buffer", primitive_index);
 
-    return m_writer.range;
+    return end_write();
 }
 
-}
\ No newline at end of file
+auto Primitive_buffer::update(
+    const gsl::span<const Render_item>& render_items
+) -> erhe::application::Buffer_range
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto range = reserve(render_items.size() * entry_size());
+    write(range, render_items);
+    return range;
+}
+
+void Primitive_buffer::write(
+    const erhe::application::Buffer_range& range,
+    const gsl::span<const Render_item>&    render_items
+) const
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto  entry_size         = m_primitive_interface.primitive_struct.size_bytes();
+    ERHE_VERIFY(range.buffer != nullptr);
+
+    const auto  primitive_gpu_data = range.buffer->map();
+    const auto  end_offset         = range.first_byte_offset + range.byte_count;
+    std::size_t offset             = range.first_byte_offset;
+    for (const auto& item : render_items)
+    {
+        if ((offset + entry_size) > end_offset)
+        {
+            log_render->critical("primitive buffer range {} exceeded", range.byte_count);
+            ERHE_FATAL("primitive buffer range exceeded");
+            break;
+        }
+
+        write_entry(primitive_gpu_data, offset, *item.mesh, item.mesh->mesh_data.primitives[item.primitive_index]);
+        offset += entry_size;
+    }
+
+    SPDLOG_LOGGER_TRACE(log_draw, "wrote {} entries to primitive buffer", render_items.size());
+}
+
+}
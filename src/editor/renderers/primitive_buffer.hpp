@@ -6,6 +6,11 @@
 
 #include <vector>
 
+namespace erhe::primitive
+{
+    class Primitive;
+}
+
 namespace erhe::scene
 {
     class Mesh;
@@ -16,6 +21,8 @@ namespace erhe::scene
 namespace editor
 {
 
+class Render_item;
+
 class Primitive_struct
 {
 public:
@@ -92,6 +99,19 @@ public:
         bool                                                       use_id_ranges = false
     ) -> erhe::application::Buffer_range;
 
+    // Writes one entry per render item, in render item order
+    auto update(
+        const gsl::span<const Render_item>& render_items
+    ) -> erhe::application::Buffer_range;
+
+    // Writes one entry per render item into range returned by reserve().
+    // Does not modify buffer state, so disjoint ranges can be written by
+    // worker threads.
+    void write(
+        const erhe::application::Buffer_range& range,
+        const gsl::span<const Render_item>&    render_items
+    ) const;
+
     class Id_range
     {
     public:
@@ -102,12 +122,20 @@ public:
     };
 
     void reset_id_ranges();
+    [[nodiscard]] auto entry_size() const -> std::size_t;
     [[nodiscard]] auto id_offset() const -> uint32_t;
     [[nodiscard]] auto id_ranges() const -> const std::vector<Id_range>&;
 
     Primitive_interface_settings settings;
 
 private:
+    void write_entry(
+        const gsl::span<std::byte>&       primitive_gpu_data,
+        const std::size_t                 offset,
+        const erhe::scene::Mesh&          mesh,
+        const erhe::primitive::Primitive& primitive
+    ) const;
+
     const Primitive_interface& m_primitive_interface;
     uint32_t                   m_id_offset{0};
     std::vector<Id_range>      m_id_ranges;
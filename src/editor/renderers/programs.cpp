@@ -172,6 +172,7 @@ auto Programs::make_program(
     create_info.add_interface_block(&shader_resources.material_interface.material_block);
     create_info.add_interface_block(&shader_resources.light_interface.light_block);
     create_info.add_interface_block(&shader_resources.light_interface.light_control_block);
+    create_info.add_interface_block(&shader_resources.light_interface.light_cluster_block);
     create_info.add_interface_block(&shader_resources.camera_interface.camera_block);
     create_info.add_interface_block(&shader_resources.primitive_interface.primitive_block);
     create_info.struct_types.push_back(&shader_resources.material_interface.material_struct);
@@ -188,6 +189,10 @@ auto Programs::make_program(
     {
         create_info.defines.emplace_back("ERHE_SIMPLER_SHADERS", "1");
     }
+    if (config->renderer.light_clusters)
+    {
+        create_info.defines.emplace_back("ERHE_LIGHT_CLUSTERS", "1");
+    }
 
     if (erhe::graphics::Instance::info.use_bindless_texture)
     {
@@ -0,0 +1,202 @@
+#include "renderers/render_queue.hpp"
+
+#include "erhe/primitive/material.hpp"
+#include "erhe/primitive/primitive.hpp"
+#include "erhe/scene/mesh.hpp"
+#include "erhe/scene/node.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace editor
+{
+
+void Render_queue::clear()
+{
+    m_items.clear();
+}
+
+auto Render_queue::items() const -> const std::vector<Render_item>&
+{
+    return m_items;
+}
+
+auto Render_queue::make_sort_key(
+    const uint32_t pass_index,
+    const uint32_t span_index,
+    const uint32_t material_index,
+    const uint32_t geometry_key,
+    const float    view_distance_squared,
+    const bool     back_to_front
+) -> uint64_t
+{
+    // Bit pattern of non-negative float increases with value; drop low
+    // mantissa bits to fit 24 (or 16) bits.
+    const uint32_t distance_bits = std::bit_cast<uint32_t>(std::max(view_distance_squared, 0.0f));
+    const uint64_t material      = std::min(material_index, 0xffffu);
+    const uint64_t pass          = pass_index;
+    const uint64_t span          = span_index;
+    if (back_to_front)
+    {
+        const uint64_t depth = 0xffffffu - (distance_bits >> 7u);
+        return (pass << 56u) | (span << 48u) | (depth << 24u) | (material << 8u);
+    }
+    const uint64_t geometry = geometry_key & 0xffffu;
+    const uint64_t depth    = distance_bits >> 15u;
+    return (pass << 56u) | (span << 48u) | (material << 32u) | (geometry << 16u) | depth;
+}
+
+void Render_queue::add(
+    const uint32_t                                             pass_index,
+    const uint32_t                                             span_index,
+    const gsl::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
+    const erhe::primitive::Primitive_mode                      primitive_mode,
+    const erhe::scene::Visibility_filter&                      visibility_filter,
+    const glm::vec3                                            view_position_in_world,
+    const bool                                                 back_to_front
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    ERHE_VERIFY(pass_index < s_max_pass_count);
+    ERHE_VERIFY(span_index < s_max_span_count);
+
+    for (const auto& mesh : meshes)
+    {
+        if (!visibility_filter(mesh->get_visibility_mask()))
+        {
+            continue;
+        }
+
+        const auto      bounding_box = erhe::scene::get_world_bounding_box(*mesh.get());
+        const glm::vec3 center       = bounding_box.is_valid()
+            ? bounding_box.center()
+            : glm::vec3{mesh->position_in_world()};
+        const glm::vec3 view_to_mesh          = center - view_position_in_world;
+        const float     view_distance_squared = glm::dot(view_to_mesh, view_to_mesh);
+
+        const auto& primitives = mesh->mesh_data.primitives;
+        for (uint32_t primitive_index = 0, end = static_cast<uint32_t>(primitives.size()); primitive_index < end; ++primitive_index)
+        {
+            const auto& primitive          = primitives[primitive_index];
+            const auto& primitive_geometry = primitive.gl_primitive_geometry;
+            const auto  index_range        = primitive_geometry.index_range(primitive_mode);
+            if (index_range.index_count == 0)
+            {
+                continue;
+            }
+            const uint32_t material_index = (primitive.material != nullptr)
+                ? static_cast<uint32_t>(primitive.material->index)
+                : 0u;
+            const uint32_t first_index    = static_cast<uint32_t>(index_range.first_index) + primitive_geometry.base_index();
+            const uint32_t geometry_hash  = (primitive_geometry.base_vertex() * 2654435761u) ^ first_index;
+            const uint32_t geometry_key   = (geometry_hash >> 16u) ^ geometry_hash;
+            m_items.push_back(
+                Render_item{
+                    .sort_key        = make_sort_key(pass_index, span_index, material_index, geometry_key, view_distance_squared, back_to_front),
+                    .mesh            = mesh.get(),
+                    .primitive_index = primitive_index
+                }
+            );
+        }
+    }
+}
+
+void Render_queue::sort()
+{
+    ERHE_PROFILE_FUNCTION
+
+    const std::size_t count = m_items.size();
+    if (count < 2)
+    {
+        return;
+    }
+
+    constexpr std::size_t digit_count = sizeof(uint64_t);
+    std::array<std::array<std::size_t, 256>, digit_count> histograms{};
+    for (const auto& item : m_items)
+    {
+        for (std::size_t digit = 0; digit < digit_count; ++digit)
+        {
+            ++histograms[digit][(item.sort_key >> (digit * 8u)) & 0xffu];
+        }
+    }
+
+    m_scratch.resize(count);
+    Render_item* source      = m_items.data();
+    Render_item* destination = m_scratch.data();
+    for (std::size_t digit = 0; digit < digit_count; ++digit)
+    {
+        const std::size_t shift     = digit * 8u;
+        auto&             histogram = histograms[digit];
+
+        // Skip digits which are the same for all keys
+        if (histogram[(source[0].sort_key >> shift) & 0xffu] == count)
+        {
+            continue;
+        }
+
+        std::size_t offset{0};
+        for (auto& bucket : histogram)
+        {
+            const std::size_t bucket_count = bucket;
+            bucket = offset;
+            offset += bucket_count;
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            destination[histogram[(source[i].sort_key >> shift) & 0xffu]++] = source[i];
+        }
+        std::swap(source, destination);
+    }
+
+    if (source != m_items.data())
+    {
+        m_items.swap(m_scratch);
+    }
+}
+
+void Render_queue::order_instances_by_slot(
+    const gsl::span<const Render_item>& items,
+    const gsl::span<const uint32_t>     slots,
+    std::vector<Render_item>&           out_items,
+    std::vector<uint32_t>&              out_slots
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    ERHE_VERIFY(items.size() == slots.size());
+
+    // Items are sorted by key, so sorting by instance group and slot
+    // keeps order of instance groups.
+    std::vector<uint32_t> order(items.size());
+    for (uint32_t i = 0, end = static_cast<uint32_t>(items.size()); i < end; ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(
+        order.begin(),
+        order.end(),
+        [&items, &slots](const uint32_t lhs, const uint32_t rhs)
+        {
+            const uint64_t lhs_group = items[lhs].sort_key & s_instance_group_mask;
+            const uint64_t rhs_group = items[rhs].sort_key & s_instance_group_mask;
+            return (lhs_group != rhs_group)
+                ? (lhs_group < rhs_group)
+                : (slots[lhs] < slots[rhs]);
+        }
+    );
+
+    out_items.clear();
+    out_slots.clear();
+    for (const uint32_t i : order)
+    {
+        out_items.push_back(items[i]);
+        out_slots.push_back(slots[i]);
+    }
+}
+
+} // namespace editor
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "erhe/primitive/enums.hpp"
+
+#include <glm/glm.hpp>
+
+#include <gsl/gsl>
+
+#include <memory>
+#include <vector>
+
+namespace erhe::scene
+{
+    class Mesh;
+    class Visibility_filter;
+}
+
+namespace editor
+{
+
+// One primitive of one mesh, drawn in one pass
+class Render_item
+{
+public:
+    uint64_t                 sort_key       {0};
+    const erhe::scene::Mesh* mesh           {nullptr};
+    uint32_t                 primitive_index{0};
+};
+
+// Collects primitives to be drawn by a sequence of passes, and sorts
+// them by packed 64-bit keys.
+//
+// Key layout, from most significant bits:
+//
+//   opaque passes:    pass (8) | span (8) | material (16) | geometry (16) | depth (16)
+//   blending passes:  pass (8) | span (8) | inverted depth (24) | material (16) | unused (8)
+//
+// Pass index selects pipeline and primitive mode, so items of one pass
+// form one contiguous run which can be drawn with one multi draw. Span
+// index keeps mesh span order within a pass. Opaque passes are drawn
+// front to back within a material and geometry, blending passes are
+// drawn back to front.
+//
+// Geometry is a hash of the primitive draw range. It places primitives
+// which share geometry next to each other, so that they can be drawn
+// as instances of one draw command.
+class Render_queue
+{
+public:
+    static constexpr uint32_t s_max_pass_count = 256;
+    static constexpr uint32_t s_max_span_count = 256;
+
+    void clear();
+
+    void add(
+        const uint32_t                                             pass_index,
+        const uint32_t                                             span_index,
+        const gsl::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
+        const erhe::primitive::Primitive_mode                      primitive_mode,
+        const erhe::scene::Visibility_filter&                      visibility_filter,
+        const glm::vec3                                            view_position_in_world,
+        const bool                                                 back_to_front
+    );
+
+    // Stable LSD radix sort, 8 bits per digit
+    void sort();
+
+    [[nodiscard]] auto items() const -> const std::vector<Render_item>&;
+
+    [[nodiscard]] static auto make_sort_key(
+        const uint32_t pass_index,
+        const uint32_t span_index,
+        const uint32_t material_index,
+        const uint32_t geometry_key,
+        const float    view_distance_squared,
+        const bool     back_to_front
+    ) -> uint64_t;
+
+    // Reorders items of opaque pass so that items with same instance group
+    // (pass, span, material and geometry) are ordered by primitive slot.
+    // Slots are first allocated in item order, so instances which share
+    // geometry get consecutive slots. Ordering by slot keeps them next to
+    // each other when their depth order changes in later frames.
+    static void order_instances_by_slot(
+        const gsl::span<const Render_item>& items,
+        const gsl::span<const uint32_t>     slots,
+        std::vector<Render_item>&           out_items,
+        std::vector<uint32_t>&              out_slots
+    );
+
+private:
+    static constexpr uint64_t s_instance_group_mask = ~uint64_t{0xffffu}; // opaque key without depth
+
+    std::vector<Render_item> m_items;
+    std::vector<Render_item> m_scratch;
+};
+
+} // namespace editor
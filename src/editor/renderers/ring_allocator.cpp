@@ -0,0 +1,220 @@
+#include "renderers/ring_allocator.hpp"
+
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
+
+namespace editor
+{
+
+IFence_source::~IFence_source() noexcept = default;
+
+Ring_allocator::Ring_allocator(IFence_source& fence_source, const std::size_t capacity)
+    : m_fence_source{fence_source}
+    , m_capacity    {capacity}
+{
+}
+
+auto Ring_allocator::allocate(
+    const std::size_t byte_count,
+    const std::size_t alignment
+) -> std::optional<std::size_t>
+{
+    ERHE_VERIFY(alignment > 0);
+
+    if ((byte_count > m_capacity) || (m_used == m_capacity))
+    {
+        return {};
+    }
+    if (m_used == 0)
+    {
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    const std::size_t aligned_head = ((m_head + alignment - 1) / alignment) * alignment;
+    std::size_t offset{0};
+    if (m_head >= m_tail)
+    {
+        // Free ranges are [head, capacity) and [0, tail)
+        if (aligned_head + byte_count <= m_capacity)
+        {
+            offset = aligned_head;
+        }
+        else if (byte_count <= m_tail)
+        {
+            offset = 0;
+        }
+        else
+        {
+            return {};
+        }
+    }
+    else
+    {
+        // Free range is [head, tail)
+        if (aligned_head + byte_count <= m_tail)
+        {
+            offset = aligned_head;
+        }
+        else
+        {
+            return {};
+        }
+    }
+
+    const std::size_t consumed = (offset >= m_head)
+        ? offset + byte_count - m_head
+        : m_capacity - m_head + byte_count;
+    m_used           += consumed;
+    m_unfenced       += consumed;
+    m_head            = offset + byte_count;
+    m_last_offset     = offset;
+    m_last_byte_count = byte_count;
+#ifndef NDEBUG
+    sanity_check();
+#endif
+    return offset;
+}
+
+void Ring_allocator::trim(const std::size_t offset, const std::size_t used_byte_count)
+{
+    if (
+        (offset != m_last_offset) ||
+        (m_head != m_last_offset + m_last_byte_count) ||
+        (used_byte_count > m_last_byte_count)
+    )
+    {
+        return;
+    }
+    const std::size_t release = m_last_byte_count - used_byte_count;
+    m_head            -= release;
+    m_used            -= release;
+    m_unfenced        -= release;
+    m_last_byte_count  = used_byte_count;
+#ifndef NDEBUG
+    sanity_check();
+#endif
+}
+
+void Ring_allocator::fence_allocations(const std::size_t max_groups_in_flight)
+{
+    if (m_unfenced > 0)
+    {
+        m_in_flight.push_back(
+            Fenced_group{
+                .fence      = m_fence_source.insert_fence(),
+                .end        = m_head,
+                .byte_count = m_unfenced
+            }
+        );
+        m_unfenced        = 0;
+        m_last_byte_count = 0;
+    }
+
+    retire();
+
+    while (m_in_flight.size() > max_groups_in_flight)
+    {
+        m_fence_source.wait(m_in_flight.front().fence);
+        release_oldest_group();
+    }
+#ifndef NDEBUG
+    sanity_check();
+#endif
+}
+
+void Ring_allocator::retire()
+{
+    while (!m_in_flight.empty() && m_fence_source.is_signaled(m_in_flight.front().fence))
+    {
+        release_oldest_group();
+    }
+}
+
+void Ring_allocator::release_oldest_group()
+{
+    const Fenced_group& group = m_in_flight.front();
+    ERHE_VERIFY(group.byte_count <= m_used);
+    m_tail  = group.end;
+    m_used -= group.byte_count;
+    m_in_flight.pop_front();
+    if (m_used == 0)
+    {
+        m_head = 0;
+        m_tail = 0;
+    }
+}
+
+void Ring_allocator::reset(const std::size_t capacity)
+{
+    m_capacity        = capacity;
+    m_head            = 0;
+    m_tail            = 0;
+    m_used            = 0;
+    m_unfenced        = 0;
+    m_last_offset     = 0;
+    m_last_byte_count = 0;
+    m_in_flight.clear();
+}
+
+auto Ring_allocator::capacity() const -> std::size_t
+{
+    return m_capacity;
+}
+
+auto Ring_allocator::used_byte_count() const -> std::size_t
+{
+    return m_used;
+}
+
+auto Ring_allocator::free_byte_count() const -> std::size_t
+{
+    if (m_used == 0)
+    {
+        return m_capacity;
+    }
+    if (m_used == m_capacity)
+    {
+        return 0;
+    }
+    return (m_head >= m_tail)
+        ? std::max(m_capacity - m_head, m_tail)
+        : m_tail - m_head;
+}
+
+auto Ring_allocator::groups_in_flight() const -> std::size_t
+{
+    return m_in_flight.size();
+}
+
+void Ring_allocator::sanity_check() const
+{
+    ERHE_VERIFY(m_used <= m_capacity);
+    ERHE_VERIFY(m_head <= m_capacity);
+    ERHE_VERIFY(m_tail <= m_capacity);
+    ERHE_VERIFY(m_unfenced <= m_used);
+
+    // Used bytes are exactly fenced groups and unfenced allocations
+    std::size_t fenced_byte_count{0};
+    uint64_t    previous_fence   {0};
+    for (const auto& group : m_in_flight)
+    {
+        ERHE_VERIFY(group.fence > previous_fence);
+        ERHE_VERIFY(group.end <= m_capacity);
+        previous_fence     = group.fence;
+        fenced_byte_count += group.byte_count;
+    }
+    ERHE_VERIFY(fenced_byte_count + m_unfenced == m_used);
+
+    // Used range [tail, head) may wrap around
+    if ((m_used > 0) && (m_used < m_capacity))
+    {
+        const std::size_t span = (m_head >= m_tail)
+            ? m_head - m_tail
+            : m_capacity - m_tail + m_head;
+        ERHE_VERIFY(span == m_used);
+    }
+}
+
+} // namespace editor
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace editor
+{
+
+// Source of GPU fences for Ring_allocator. Fences are identified by
+// serial numbers, which increase in insertion order; a signaled fence
+// implies that all earlier fences are signaled, too.
+class IFence_source
+{
+public:
+    virtual ~IFence_source() noexcept;
+
+    // Inserts fence after commands issued so far, returns its serial
+    [[nodiscard]] virtual auto insert_fence() -> uint64_t = 0;
+
+    // Returns true if GPU has passed the fence; does not block
+    [[nodiscard]] virtual auto is_signaled(const uint64_t fence) -> bool = 0;
+
+    // Blocks until GPU has passed the fence
+    virtual void wait(const uint64_t fence) = 0;
+};
+
+// Bookkeeping for a ring buffer which is shared with the GPU.
+//
+// Allocations are made from the head of the ring. Allocations made
+// between calls to fence_allocations() form a group, which is released
+// when its fence is signaled. The allocator does not touch any GPU
+// memory itself, so it can be driven by a fake fence source.
+class Ring_allocator
+{
+public:
+    Ring_allocator(IFence_source& fence_source, const std::size_t capacity);
+
+    // Returns offset of byte_count bytes aligned to alignment, or empty if
+    // there is no room without waiting for the GPU.
+    [[nodiscard]] auto allocate(
+        const std::size_t byte_count,
+        const std::size_t alignment
+    ) -> std::optional<std::size_t>;
+
+    // Returns unused tail of the most recent allocation to the ring
+    void trim(const std::size_t offset, const std::size_t used_byte_count);
+
+    // Inserts fence for allocations made since previous call. Waits for
+    // the oldest group if more than max_groups_in_flight groups remain.
+    void fence_allocations(const std::size_t max_groups_in_flight);
+
+    // Releases allocation groups which have signaled fences
+    void retire();
+
+    // Forgets all allocations and sets new capacity. Caller must keep
+    // previous storage alive until its allocations are no longer used.
+    void reset(const std::size_t capacity);
+
+    [[nodiscard]] auto capacity         () const -> std::size_t;
+    [[nodiscard]] auto used_byte_count  () const -> std::size_t;
+    [[nodiscard]] auto free_byte_count  () const -> std::size_t; // largest contiguous free range
+    [[nodiscard]] auto groups_in_flight () const -> std::size_t;
+
+    // Verifies bookkeeping invariants; called after each change in debug builds
+    void sanity_check() const;
+
+private:
+    void release_oldest_group();
+
+    class Fenced_group
+    {
+    public:
+        uint64_t    fence     {0};
+        std::size_t end       {0}; // head when fence was inserted
+        std::size_t byte_count{0}; // includes alignment and wrap padding
+    };
+
+    IFence_source&           m_fence_source;
+    std::size_t              m_capacity       {0};
+    std::size_t              m_head           {0};
+    std::size_t              m_tail           {0};
+    std::size_t              m_used           {0};
+    std::size_t              m_unfenced       {0};
+    std::size_t              m_last_offset    {0};
+    std::size_t              m_last_byte_count{0};
+    std::deque<Fenced_group> m_in_flight;
+};
+
+} // namespace editor
@@ -196,6 +196,19 @@ void Shadow_renderer::next_frame()
     m_primitive_buffers    ->next_frame();
 }
 
+auto Shadow_renderer::has_room_for_draws(const std::size_t draw_count) -> bool
+{
+    // Include room for buffer offset alignment
+    const std::size_t alignment = static_cast<std::size_t>(
+        erhe::graphics::Instance::implementation_defined.shader_storage_buffer_offset_alignment
+    );
+    const std::size_t primitive_byte_count     = draw_count * m_primitive_buffers->entry_size() + alignment;
+    const std::size_t draw_indirect_byte_count = draw_count * sizeof(gl::Draw_elements_indirect_command);
+    return
+        (m_primitive_buffers    ->remaining_byte_count() >= primitive_byte_count) &&
+        (m_draw_indirect_buffers->remaining_byte_count() >= draw_indirect_byte_count);
+}
+
 auto Shadow_renderer::light_projections() const -> const Light_projections&
 {
     return m_light_projections;
@@ -249,60 +262,124 @@ auto Shadow_renderer::render(const Render_parameters& parameters) -> const Light
     );
     m_light_buffers->bind_light_buffer();
 
+    // All shadow casters of each mesh span are written once. Lights use
+    // these ranges when caster culling does not reduce draw count, or
+    // when buffers do not have room for a light specific range.
+    m_caster_draw_ranges.clear();
     for (const auto& meshes : mesh_spans)
     {
-        m_primitive_buffers->update(meshes, shadow_filter);
-        const auto draw_indirect_buffer_range = m_draw_indirect_buffers->update(
+        const auto primitive_range     = m_primitive_buffers->update(meshes, shadow_filter);
+        const auto draw_indirect_range = m_draw_indirect_buffers->update(
             meshes,
             erhe::primitive::Primitive_mode::polygon_fill,
             shadow_filter
         );
-        if (draw_indirect_buffer_range.draw_indirect_count == 0)
+        m_caster_draw_ranges.push_back(
+            Caster_draw_ranges{
+                .primitive_range     = primitive_range,
+                .draw_indirect_range = draw_indirect_range
+            }
+        );
+    }
+
+    const bool enable_caster_culling = m_configuration->renderer.cpu_frustum_culling;
+
+    for (const auto& light : lights)
+    {
+        if (!light->cast_shadow)
         {
             continue;
         }
 
-        m_primitive_buffers->bind();
-        m_draw_indirect_buffers->bind();
+        auto* light_projection_transform = m_light_projections.get_light_projection_transforms_for_light(light.get());
+        if (light_projection_transform == nullptr)
+        {
+            log_render->warn("Light {} has no light projection transforms", light->name());
+            continue;
+        }
+        const std::size_t light_index = light_projection_transform->index;
+        m_light_buffers->update_control(light_index);
+        m_light_buffers->bind_control_buffer();
+
+        //Frustum_tiler frustum_tiler{*m_texture.get()};
+        //frustum_tiler.update(
+        //    light_index,
+        //    m_light_projections.projection_transforms[light_index].clip_from_world.matrix(),
+        //    parameters.view_camera,
+        //    parameters.view_camera_viewport
+        //);
 
-        for (const auto& light : lights)
         {
-            if (!light->cast_shadow)
-            {
-                continue;
-            }
+            ERHE_PROFILE_SCOPE("bind fbo");
+            gl::bind_framebuffer(gl::Framebuffer_target::draw_framebuffer, m_framebuffers[light_index]->gl_name());
+        }
+
+        {
+            static constexpr std::string_view c_id_clear{"clear"};
+
+            ERHE_PROFILE_SCOPE("clear fbo");
+            ERHE_PROFILE_GPU_SCOPE(c_id_clear);
+
+            gl::clear_buffer_fv(gl::Buffer::depth, 0, m_configuration->depth_clear_value_pointer());
+        }
 
-            auto* light_projection_transform = m_light_projections.get_light_projection_transforms_for_light(light.get());
-            if (light_projection_transform == nullptr)
+        // Light clip volume already is fitted to view camera when
+        // Light::tight_frustum_fit is set, so casters are only tested
+        // against the light clip volume.
+        const erhe::toolkit::Frustum light_frustum{light_projection_transform->clip_from_world.matrix()};
+
+        std::size_t span_index = 0;
+        for (const auto& meshes : mesh_spans)
+        {
+            const bool  is_first_span       = (span_index == 0);
+            const auto& caster_draw_ranges  = m_caster_draw_ranges[span_index++];
+            auto        primitive_range     = caster_draw_ranges.primitive_range;
+            auto        draw_indirect_range = caster_draw_ranges.draw_indirect_range;
+            if (draw_indirect_range.draw_indirect_count == 0)
             {
-                log_render->warn("Light {} has no light projection transforms", light->name());
                 continue;
             }
-            const std::size_t light_index = light_projection_transform->index;
-            m_light_buffers->update_control(light_index);
-            m_light_buffers->bind_control_buffer();
-
-            //Frustum_tiler frustum_tiler{*m_texture.get()};
-            //frustum_tiler.update(
-            //    light_index,
-            //    m_light_projections.projection_transforms[light_index].clip_from_world.matrix(),
-            //    parameters.view_camera,
-            //    parameters.view_camera_viewport
-            //);
 
+            if (enable_caster_culling)
             {
-                ERHE_PROFILE_SCOPE("bind fbo");
-                gl::bind_framebuffer(gl::Framebuffer_target::draw_framebuffer, m_framebuffers[light_index]->gl_name());
+                ERHE_PROFILE_SCOPE("caster culling");
+
+                m_frustum_culler.cull(
+                    light_frustum,
+                    meshes,
+                    shadow_filter,
+                    is_first_span ? parameters.spatial_index : nullptr,
+                    m_visible_meshes
+                );
+                if (m_visible_meshes.empty())
+                {
+                    continue;
+                }
+                std::size_t visible_primitive_count{0};
+                for (const auto& mesh : m_visible_meshes)
+                {
+                    visible_primitive_count += mesh->mesh_data.primitives.size();
+                }
+                if (
+                    (visible_primitive_count < draw_indirect_range.draw_indirect_count) &&
+                    has_room_for_draws(visible_primitive_count)
+                )
+                {
+                    primitive_range     = m_primitive_buffers->update(m_visible_meshes, shadow_filter);
+                    draw_indirect_range = m_draw_indirect_buffers->update(
+                        m_visible_meshes,
+                        erhe::primitive::Primitive_mode::polygon_fill,
+                        shadow_filter
+                    );
+                    if (draw_indirect_range.draw_indirect_count == 0)
+                    {
+                        continue;
+                    }
+                }
             }
 
-            {
-                static constexpr std::string_view c_id_clear{"clear"};
-
-                ERHE_PROFILE_SCOPE("clear fbo");
-                ERHE_PROFILE_GPU_SCOPE(c_id_clear);
-
-                gl::clear_buffer_fv(gl::Buffer::depth, 0, m_configuration->depth_clear_value_pointer());
-            }
+            m_primitive_buffers    ->bind(primitive_range);
+            m_draw_indirect_buffers->bind(draw_indirect_range.range);
 
             {
                 static constexpr std::string_view c_id_mdi{"mdi"};
@@ -312,8 +389,8 @@ auto Shadow_renderer::render(const Render_parameters& parameters) -> const Light
                 gl::multi_draw_elements_indirect(
                     m_pipeline.data.input_assembly.primitive_topology,
                     m_mesh_memory->gl_index_type(),
-                    reinterpret_cast<const void *>(draw_indirect_buffer_range.range.first_byte_offset),
-                    static_cast<GLsizei>(draw_indirect_buffer_range.draw_indirect_count),
+                    reinterpret_cast<const void *>(draw_indirect_range.range.first_byte_offset),
+                    static_cast<GLsizei>(draw_indirect_range.draw_indirect_count),
                     static_cast<GLsizei>(sizeof(gl::Draw_elements_indirect_command))
                 );
             }
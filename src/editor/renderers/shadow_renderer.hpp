@@ -2,6 +2,7 @@
 
 #include "renderers/light_buffer.hpp"
 #include "renderers/draw_indirect_buffer.hpp"
+#include "renderers/frustum_culler.hpp"
 #include "renderers/primitive_buffer.hpp"
 
 #include "erhe/graphics/pipeline.hpp"
@@ -32,6 +33,7 @@ namespace erhe::scene
     class Light;
     class Mesh;
     class Mesh_layer;
+    class Mesh_spatial_index;
 }
 
 namespace editor
@@ -67,6 +69,7 @@ public:
             >
         >&                                                         mesh_spans;
         const gsl::span<const std::shared_ptr<erhe::scene::Light>> lights;
+        const erhe::scene::Mesh_spatial_index*                     spatial_index{nullptr}; // Optional, for caster culling of first mesh span
     };
 
     auto light_projections() const -> const Light_projections&;
@@ -79,6 +82,15 @@ public:
     [[nodiscard]] auto viewport() const -> erhe::scene::Viewport;
 
 private:
+    class Caster_draw_ranges
+    {
+    public:
+        erhe::application::Buffer_range primitive_range;
+        Draw_indirect_buffer_range      draw_indirect_range;
+    };
+
+    [[nodiscard]] auto has_room_for_draws(const std::size_t draw_count) -> bool;
+
     // Component dependencies
     std::shared_ptr<erhe::application::Configuration>     m_configuration;
     std::shared_ptr<erhe::graphics::OpenGL_state_tracker> m_pipeline_state_tracker;
@@ -96,6 +108,10 @@ private:
     std::unique_ptr<Light_buffer        > m_light_buffers;
     std::unique_ptr<Draw_indirect_buffer> m_draw_indirect_buffers;
     std::unique_ptr<Primitive_buffer    > m_primitive_buffers;
+
+    Frustum_culler                                  m_frustum_culler;
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> m_visible_meshes;
+    std::vector<Caster_draw_ranges>                 m_caster_draw_ranges; // Per mesh span, all casters
 };
 
 } // namespace editor
@@ -36,5 +36,5 @@ void main()
     gl_Position   = clip_from_world * position;
     vs_position   = a_position.xyz;
     vs_color      = a_color;
-    vs_line_width = (1.0 / 1024.0) * viewport_width * distance_scaled_thickness / fov_width; //primitive.primitives[gl_DrawID].size;
+    vs_line_width = (1.0 / 1024.0) * viewport_width * distance_scaled_thickness / fov_width; //primitive.primitives[gl_BaseInstance + gl_InstanceID].size;
 }
@@ -8,7 +8,7 @@ out gl_PerVertex {
 
 void main()
 {
-    mat4 world_from_node = primitive.primitives[gl_DrawID].world_from_node;
+    mat4 world_from_node = primitive.primitives[gl_BaseInstance + gl_InstanceID].world_from_node;
     mat4 clip_from_world = camera.cameras[0].clip_from_world;
     vec4 position        = world_from_node * vec4(a_position, 1.0);
     vec3 normal          = normalize(vec3(world_from_node * vec4(a_normal, 0.0)));
@@ -22,11 +22,11 @@ void main()
     vec3  v        = normalize(view_position_in_world - position.xyz);
     float NdotV    = dot(normal, v);
     float d        = distance(view_position_in_world, position.xyz);
-    //float max_size = (NdotV > 0.0) ? primitive.primitives[gl_DrawID].size : 0.0; // cull back facing points
-    float max_size = primitive.primitives[gl_DrawID].size;
+    //float max_size = (NdotV > 0.0) ? primitive.primitives[gl_BaseInstance + gl_InstanceID].size : 0.0; // cull back facing points
+    float max_size = primitive.primitives[gl_BaseInstance + gl_InstanceID].size;
     float bias     = camera.cameras[0].clip_depth_direction * 0.0005 * abs(NdotV);
     v_normal       = normal;
-    v_color        = primitive.primitives[gl_DrawID].color;
+    v_color        = primitive.primitives[gl_BaseInstance + gl_InstanceID].color;
     gl_Position    = clip_from_world * position;
     gl_Position.z -= bias;
     gl_PointSize   = max(max_size / d, 2.0);
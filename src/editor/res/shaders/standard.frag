@@ -216,6 +216,22 @@ float get_spot_attenuation(vec3 point_to_light, vec3 spot_direction, float outer
     return 0.0;
 }
 
+#if defined(ERHE_LIGHT_CLUSTERS)
+uint get_light_cluster_index(vec3 position_in_world, vec3 view_position_in_world)
+{
+    vec4  viewport   = camera.cameras[0].viewport;
+    uvec3 grid_size  = light_cluster_block.grid_size.xyz;
+    vec2  tile       = (gl_FragCoord.xy - viewport.xy) / viewport.zw;
+    vec3  view_axis  = -normalize(vec3(camera.cameras[0].world_from_node[2]));
+    float view_depth = max(dot(position_in_world - view_position_in_world, view_axis), 0.000001);
+    float slice      = floor(log(view_depth) * light_cluster_block.depth_params.x + light_cluster_block.depth_params.y);
+    uint  x          = uint(clamp(tile.x * float(grid_size.x), 0.0, float(grid_size.x - 1u)));
+    uint  y          = uint(clamp(tile.y * float(grid_size.y), 0.0, float(grid_size.y - 1u)));
+    uint  z          = uint(clamp(slice,                       0.0, float(grid_size.z - 1u)));
+    return x + grid_size.x * (y + grid_size.y * z);
+}
+#endif
+
 void main()
 {
     vec3 view_position_in_world = vec3(
@@ -322,9 +338,16 @@ void main()
         }
     }
 
+#if defined(ERHE_LIGHT_CLUSTERS)
+    uvec2 cluster = light_cluster_block.clusters[get_light_cluster_index(v_position.xyz, view_position_in_world)];
+    for (uint i = 0; i < cluster.y; ++i)
+    {
+        uint  light_index    = light_cluster_block.light_indices[cluster.x + i];
+#else
     for (uint i = 0; i < spot_light_count; ++i)
     {
         uint  light_index    = spot_light_offset + i;
+#endif
         Light light          = light_block.lights[light_index];
         vec3  point_to_light = light.position_and_inner_spot_cos.xyz - v_position.xyz;
         vec3  L              = normalize(point_to_light);
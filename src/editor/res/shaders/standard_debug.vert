@@ -8,7 +8,7 @@ out float     v_line_width;
 
 void main()
 {
-    mat4 world_from_node = primitive.primitives[gl_DrawID].world_from_node;
+    mat4 world_from_node = primitive.primitives[gl_BaseInstance + gl_InstanceID].world_from_node;
     mat4 clip_from_world = camera.cameras[0].clip_from_world;
 
     //vec3 normal          = a_normal;
@@ -23,8 +23,8 @@ void main()
     v_position       = position;
     v_TBN            = mat3(tangent, bitangent, normal);
     gl_Position      = clip_from_world * position;
-    v_material_index = primitive.primitives[gl_DrawID].material_index;
+    v_material_index = primitive.primitives[gl_BaseInstance + gl_InstanceID].material_index;
     v_texcoord       = a_texcoord;
     v_color          = a_color;
-    v_line_width     = primitive.primitives[gl_DrawID].size;
+    v_line_width     = primitive.primitives[gl_BaseInstance + gl_InstanceID].size;
 }
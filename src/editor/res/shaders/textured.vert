@@ -3,9 +3,9 @@ out flat uvec2 v_texture;
 
 void main()
 {
-    mat4 world_from_node = primitive.primitives[gl_DrawID].world_from_node;
+    mat4 world_from_node = primitive.primitives[gl_BaseInstance + gl_InstanceID].world_from_node;
     mat4 clip_from_world = camera.cameras[0].clip_from_world;
-    uint material_index  = primitive.primitives[gl_DrawID].material_index;
+    uint material_index  = primitive.primitives[gl_BaseInstance + gl_InstanceID].material_index;
 
     vec4 position = world_from_node * vec4(a_position, 1.0);
     gl_Position   = clip_from_world * position;
@@ -3,7 +3,7 @@
 #include "scene/node_raytrace.hpp"
 #include "editor_log.hpp"
 
-#include "erhe/geometry/operation/clone.hpp"
+#include "erhe/concurrency/concurrent_queue.hpp"
 #include "erhe/physics/icollision_shape.hpp"
 #include "erhe/physics/irigid_body.hpp"
 #include "erhe/physics/iworld.hpp"
@@ -14,9 +14,10 @@
 #include "erhe/raytrace/iscene.hpp"
 #include "erhe/scene/mesh.hpp"
 #include "erhe/scene/scene.hpp"
-#include "erhe/toolkit/math_util.hpp"
 #include "erhe/toolkit/profile.hpp"
 
+#include <cmath>
+
 namespace editor
 {
 
@@ -31,6 +32,28 @@ using glm::mat4;
 using glm::vec3;
 using glm::vec4;
 
+namespace
+{
+
+auto make_brush_primitive(
+    erhe::geometry::Geometry&           geometry,
+    erhe::primitive::Build_info&        build_info,
+    const erhe::primitive::Normal_style normal_style,
+    erhe::concurrency::Thread_pool*     thread_pool
+) -> erhe::primitive::Primitive_geometry
+{
+    erhe::primitive::prepare_geometry(geometry, build_info.format);
+    if (thread_pool == nullptr)
+    {
+        return make_primitive(geometry, build_info, normal_style);
+    }
+
+    erhe::concurrency::Concurrent_queue queue{*thread_pool, "brush primitive"};
+    return make_primitive(geometry, build_info, normal_style, &queue);
+}
+
+} // anonymous namespace
+
 Reference_frame::Reference_frame() = default;
 
 Reference_frame::Reference_frame(
@@ -118,10 +141,11 @@ void Brush::initialize(const Create_info& create_info)
     {
         ERHE_PROFILE_SCOPE("gl primitive");
 
-        gl_primitive_geometry = make_primitive(
+        gl_primitive_geometry = make_brush_primitive(
             *create_info.geometry.get(),
             build_info,
-            normal_style
+            normal_style,
+            create_info.thread_pool
         );
     }
 
@@ -171,10 +195,11 @@ Brush::Brush(const Create_info& create_info)
     {
         ERHE_PROFILE_SCOPE("make brush primitive");
 
-        gl_primitive_geometry = make_primitive(
+        gl_primitive_geometry = make_brush_primitive(
             *create_info.geometry.get(),
             build_info,
-            normal_style
+            normal_style,
+            create_info.thread_pool
         );
     }
 
@@ -268,121 +293,49 @@ auto Brush::create_scaled(const int scale_key) -> Scaled
 
     const float scale = static_cast<float>(scale_key) / c_scale_factor;
 
-    if (scale == 1.0f)
-    {
-        glm::mat4 local_inertia{0.0f};
-        if (collision_shape)
-        {
-            ERHE_VERIFY(collision_shape->is_convex());
-            const auto mass = density * volume;
-            collision_shape->calculate_local_inertia(mass, local_inertia);
-            return Scaled{
-                .scale_key             = scale_key,
-                .geometry              = geometry,
-                .gl_primitive_geometry = gl_primitive_geometry,
-                .rt_primitive          = rt_primitive,
-                .collision_shape       = collision_shape,
-                .volume                = volume,
-                .local_inertia         = local_inertia
-            };
-        }
-        else if (collision_shape_generator)
-        {
-            const auto generated_collision_shape = collision_shape_generator(scale);
-            const auto mass = density * volume;
-            generated_collision_shape->calculate_local_inertia(mass, local_inertia);
-            return Scaled{
-                .scale_key             = scale_key,
-                .geometry              = geometry,
-                .gl_primitive_geometry = gl_primitive_geometry,
-                .rt_primitive          = rt_primitive,
-                .collision_shape       = generated_collision_shape,
-                .volume                = volume,
-                .local_inertia         = local_inertia
-            };
-        }
-        else
-        {
-            return Scaled{
-                .scale_key             = scale_key,
-                .geometry              = geometry,
-                .gl_primitive_geometry = gl_primitive_geometry,
-                .rt_primitive          = rt_primitive,
-                .collision_shape       = {},
-                .volume                = volume,
-                .local_inertia         = local_inertia
-            };
-        }
-    }
-
     log_brush->trace("create_scaled() scale = {}", scale);
 
-    auto scaled_geometry = std::make_shared<erhe::geometry::Geometry>(
-        erhe::geometry::operation::clone(
-            *geometry.get(),
-            erhe::toolkit::create_scale(scale)
-        )
-    );
-    scaled_geometry->name = fmt::format(
-        "{} scaled by {}",
-        geometry->name,
-        scale
-    );
-
-    auto scaled_gl_primitive_geometry = make_primitive(
-        *scaled_geometry.get(),
-        build_info,
-        normal_style
-    );
-
-    auto scaled_rt_primitive = std::make_shared<Raytrace_primitive>(scaled_geometry);
-
     glm::mat4 local_inertia{0.0f};
     if (collision_shape)
     {
         ERHE_VERIFY(collision_shape->is_convex());
         const auto scaled_volume          = volume * scale * scale * scale;
         const auto mass                   = density * scaled_volume;
-        auto       scaled_collision_shape = erhe::physics::ICollision_shape::create_uniform_scaling_shape_shared(collision_shape.get(), scale);
+        auto       scaled_collision_shape = (scale == 1.0f)
+            ? collision_shape
+            : erhe::physics::ICollision_shape::create_uniform_scaling_shape_shared(collision_shape.get(), scale);
         scaled_collision_shape->calculate_local_inertia(mass, local_inertia);
         return Scaled{
-            .scale_key             = scale_key,
-            .geometry              = scaled_geometry,
-            .gl_primitive_geometry = scaled_gl_primitive_geometry,
-            .rt_primitive          = scaled_rt_primitive,
-            .collision_shape       = scaled_collision_shape,
-            .volume                = scaled_volume,
-            .local_inertia         = local_inertia
+            .scale_key       = scale_key,
+            .collision_shape = scaled_collision_shape,
+            .volume          = scaled_volume,
+            .local_inertia   = local_inertia
         };
     }
     else if (collision_shape_generator)
     {
         auto       scaled_collision_shape = collision_shape_generator(scale);
-        const auto scaled_volume          = collision_volume_calculator
-            ? collision_volume_calculator(scale)
-            : volume * scale * scale * scale;
+        const auto scaled_volume          = (scale == 1.0f)
+            ? volume
+            : collision_volume_calculator
+                ? collision_volume_calculator(scale)
+                : volume * scale * scale * scale;
         const auto mass                   = density * scaled_volume;
         scaled_collision_shape->calculate_local_inertia(mass, local_inertia);
         return Scaled{
-            .scale_key             = scale_key,
-            .geometry              = scaled_geometry,
-            .gl_primitive_geometry = scaled_gl_primitive_geometry,
-            .rt_primitive          = scaled_rt_primitive,
-            .collision_shape       = scaled_collision_shape,
-            .volume                = scaled_volume,
-            .local_inertia         = local_inertia
+            .scale_key       = scale_key,
+            .collision_shape = scaled_collision_shape,
+            .volume          = scaled_volume,
+            .local_inertia   = local_inertia
         };
     }
     else
     {
         return Scaled{
-            .scale_key             = scale_key,
-            .geometry              = scaled_geometry,
-            .gl_primitive_geometry = scaled_gl_primitive_geometry,
-            .rt_primitive          = scaled_rt_primitive,
-            .collision_shape       = {},
-            .volume                = volume * scale * scale * scale,
-            .local_inertia         = local_inertia
+            .scale_key       = scale_key,
+            .collision_shape = {},
+            .volume          = volume * scale * scale * scale,
+            .local_inertia   = local_inertia
         };
     }
 }
@@ -400,13 +353,30 @@ auto Brush::make_instance(
 {
     ERHE_PROFILE_FUNCTION
 
-    const auto& scaled = get_scaled(instance_create_info.scale);
+    // Scale is taken from the basis of world_from_node. Physics
+    // requires uniform scale: basis must be rotation times scale.
+    const glm::mat4 world_from_node = instance_create_info.world_from_node;
+    const glm::mat3 basis           {world_from_node};
+    const float     scale           = glm::length(basis[0]);
+    const glm::mat3 rotation_error  = glm::transpose(basis) * basis / (scale * scale) - glm::mat3{1.0f};
+    bool            uniform_scale   = true;
+    for (glm::mat3::length_type i = 0; i < 3; ++i)
+    {
+        for (glm::mat3::length_type j = 0; j < 3; ++j)
+        {
+            if (std::abs(rotation_error[i][j]) > 0.001f)
+            {
+                uniform_scale = false;
+            }
+        }
+    }
+    const auto& scaled = get_scaled(scale);
 
-    const auto& name = scaled.geometry
-        ? scaled.geometry->name
+    const auto& name = geometry
+        ? geometry->name
         : empty_string;
 
-    ERHE_VERIFY(scaled.rt_primitive);
+    ERHE_VERIFY(rt_primitive);
 
     log_scene->trace(
         "creating {} with material index {} : {}",
@@ -419,20 +389,30 @@ auto Brush::make_instance(
     mesh->mesh_data.primitives.push_back(
         erhe::primitive::Primitive{
             .material              = instance_create_info.material,
-            .gl_primitive_geometry = scaled.gl_primitive_geometry,
-            .rt_primitive_geometry = scaled.rt_primitive->primitive_geometry,
-            .rt_vertex_buffer      = scaled.rt_primitive->vertex_buffer,
-            .rt_index_buffer       = scaled.rt_primitive->index_buffer,
-            .source_geometry       = scaled.geometry,
+            .gl_primitive_geometry = gl_primitive_geometry,
+            .rt_primitive_geometry = rt_primitive->primitive_geometry,
+            .rt_vertex_buffer      = rt_primitive->vertex_buffer,
+            .rt_index_buffer       = rt_primitive->index_buffer,
+            .source_geometry       = geometry,
             .normal_style          = normal_style
         }
     );
     mesh->set_visibility_mask(instance_create_info.node_visibility_flags);
-    mesh->set_world_from_node(instance_create_info.world_from_node);
+    mesh->set_world_from_node(world_from_node);
 
     std::shared_ptr<Node_physics>  node_physics;
     std::shared_ptr<Node_raytrace> node_raytrace;
-    if (collision_shape || collision_shape_generator)
+    if (
+        (collision_shape || collision_shape_generator) &&
+        !uniform_scale
+    )
+    {
+        log_brush->warn(
+            "{} has non-uniform scale, which is not supported by physics - instance created without physics",
+            name
+        );
+    }
+    else if (collision_shape || collision_shape_generator)
     {
         ERHE_PROFILE_SCOPE("make brush node physics");
 
@@ -444,14 +424,19 @@ auto Brush::make_instance(
             .debug_label     = name.c_str()
         };
         node_physics = std::make_shared<Node_physics>(rigid_body_create_info);
+
+        // Rigid body transform must not contain scale; collision shape is scaled instead
+        node_physics->set_rigidbody_from_node(
+            erhe::physics::Transform{glm::mat3{scale}}
+        );
         mesh->attach(node_physics);
     }
 
-    if (scaled.rt_primitive)
+    if (rt_primitive)
     {
         node_raytrace = std::make_shared<Node_raytrace>(
-            scaled.geometry,
-            scaled.rt_primitive
+            geometry,
+            rt_primitive
         );
         mesh->attach(node_raytrace);
     }
@@ -8,6 +8,11 @@
 #include "erhe/primitive/primitive_builder.hpp"
 #include "erhe/primitive/build_info.hpp"
 
+namespace erhe::concurrency
+{
+    class Thread_pool;
+}
+
 namespace erhe::geometry
 {
     class Geometry;
@@ -75,6 +80,7 @@ public:
     std::shared_ptr<erhe::physics::ICollision_shape> collision_shape;
     Collision_volume_calculator                      collision_volume_calculator{};
     Collision_shape_generator                        collision_shape_generator  {};
+    erhe::concurrency::Thread_pool*                  thread_pool{nullptr}; // Used to build large primitives in parallel
 };
 
 class Instance_create_info final
@@ -84,7 +90,6 @@ public:
     erhe::physics::IWorld&                     physics_world;
     glm::mat4                                  world_from_node;
     std::shared_ptr<erhe::primitive::Material> material;
-    float                                      scale;
 };
 
 class Brush final
@@ -94,13 +99,13 @@ public:
 
     static constexpr float c_scale_factor = 65536.0f;
 
+    // Instances share geometry, gl primitive and raytrace primitive of
+    // the brush, scale is applied through node transform. Only physics
+    // data is kept per scale.
     class Scaled
     {
     public:
         int                                              scale_key;
-        std::shared_ptr<erhe::geometry::Geometry>        geometry;
-        erhe::primitive::Primitive_geometry              gl_primitive_geometry;
-        std::shared_ptr<Raytrace_primitive>              rt_primitive;
         std::shared_ptr<erhe::physics::ICollision_shape> collision_shape;
         float                                            volume;
         glm::mat4                                        local_inertia;
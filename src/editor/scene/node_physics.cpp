@@ -59,7 +59,17 @@ void Node_physics::on_node_transform_changed()
 {
     if (m_transform_change_from_physics)
     {
-        return;
+        // Notification can be deferred until transform hierarchy is
+        // updated. Skip write-back only if node transform is still the
+        // one set from physics.
+        m_transform_change_from_physics = false;
+        if (
+            (get_node() != nullptr) &&
+            (get_node()->world_from_node() == m_world_from_node_from_physics)
+        )
+        {
+            return;
+        }
     }
 
     const erhe::physics::Transform world_from_node = get_world_from_node();
@@ -78,6 +88,11 @@ void Node_physics::set_rigidbody_from_node(const erhe::physics::Transform rigidb
     m_node_from_rigidbody = inverse(rigidbody_from_node);
 }
 
+auto Node_physics::get_rigidbody_from_node() const -> erhe::physics::Transform
+{
+    return m_rigidbody_from_node;
+}
+
 auto Node_physics::get_world_from_rigidbody() const -> erhe::physics::Transform
 {
     return get_world_from_node() * m_node_from_rigidbody;
@@ -131,13 +146,13 @@ void Node_physics::set_world_from_node(
     if (world_from_node.origin.y < -100.0f)
     {
         const glm::vec3 respawn_location{0.0f, 8.0f, 0.0f};
-        m_rigid_body->set_world_transform(erhe::physics::Transform{world_from_node.basis, respawn_location});
+        m_rigid_body->set_world_transform(
+            erhe::physics::Transform{world_from_node.basis, respawn_location} * m_node_from_rigidbody
+        );
         m_rigid_body->set_linear_velocity (glm::vec3{0.0f, 0.0f, 0.0f});
         m_rigid_body->set_angular_velocity(glm::vec3{0.0f, 0.0f, 0.0f});
     }
 
-    m_transform_change_from_physics = true;
-
     const auto& m = world_from_node.basis;
     glm::mat4 matrix{m};
     matrix[3] = glm::vec4{
@@ -146,11 +161,15 @@ void Node_physics::set_world_from_node(
         world_from_node.origin.z,
         1.0f
     };
+
+    // Stays set until on_node_transform_changed() is called, which
+    // may happen later when transform hierarchy is updated
+    m_transform_change_from_physics = true;
+    m_world_from_node_from_physics  = matrix;
+
     // TODO don't unparent, call set_world_from_node() instead
     get_node()->unparent();
     get_node()->set_parent_from_node(matrix);
-
-    m_transform_change_from_physics = false;
 }
 
 auto Node_physics::rigid_body() -> IRigid_body*
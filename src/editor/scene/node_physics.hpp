@@ -48,6 +48,7 @@ public:
 
     void set_world_from_node     (const erhe::physics::Transform world_from_node);
     void set_rigidbody_from_node (const erhe::physics::Transform rigidbody_from_node);
+    [[nodiscard]] auto get_rigidbody_from_node() const -> erhe::physics::Transform;
 
 private:
     erhe::physics::IWorld*                           m_physics_world      {nullptr};
@@ -57,6 +58,7 @@ private:
     std::shared_ptr<erhe::physics::IRigid_body>      m_rigid_body;
     std::shared_ptr<erhe::physics::ICollision_shape> m_collision_shape;
     bool                                             m_transform_change_from_physics{false};
+    glm::mat4                                        m_world_from_node_from_physics {1.0f};
 };
 
 auto is_physics(const erhe::scene::INode_attachment* const attachment) -> bool;
@@ -7,6 +7,7 @@
 #include "erhe/primitive/buffer_sink.hpp"
 #include "erhe/primitive/primitive_builder.hpp"
 #include "erhe/primitive/build_info.hpp"
+#include "erhe/primitive/triangle_soup.hpp"
 #include "erhe/raytrace/ibuffer.hpp"
 #include "erhe/raytrace/igeometry.hpp"
 #include "erhe/raytrace/iinstance.hpp"
@@ -33,11 +34,36 @@ auto raytrace_node_mask(erhe::scene::Node& node) -> uint32_t
     return result;
 }
 
-Raytrace_primitive::Raytrace_primitive(
-    const std::shared_ptr<erhe::geometry::Geometry>& geometry
+namespace
+{
+
+// Just float vec3 position and triangle indices
+void set_raytrace_build_info(
+    erhe::primitive::Build_info&                           build_info,
+    const std::shared_ptr<erhe::graphics::Vertex_format>& vertex_format
 )
 {
-    // Just float vec3 position
+    build_info.buffer.index_type = gl::Draw_elements_type::unsigned_int;
+    build_info.format.features = {
+        .fill_triangles  = true,
+        .edge_lines      = false,
+        .corner_points   = false,
+        .centroid_points = false,
+        .position        = true,
+        .normal          = false,
+        .normal_flat     = false,
+        .normal_smooth   = false,
+        .tangent         = false,
+        .bitangent       = false,
+        .color           = false,
+        .texcoord        = false,
+        .id              = false
+    };
+    build_info.buffer.vertex_format = vertex_format;
+}
+
+[[nodiscard]] auto make_raytrace_vertex_format() -> std::shared_ptr<erhe::graphics::Vertex_format>
+{
     auto vertex_format = std::make_shared<erhe::graphics::Vertex_format>();
     vertex_format->add(
         {
@@ -53,9 +79,18 @@ Raytrace_primitive::Raytrace_primitive(
             }
         }
     );
+    return vertex_format;
+}
 
-    //const auto   index_type   = gl::Draw_elements_type::unsigned_int;
-    const std::size_t index_stride = 4;
+constexpr std::size_t c_raytrace_index_stride = 4;
+
+} // anonymous namespace
+
+Raytrace_primitive::Raytrace_primitive(
+    const std::shared_ptr<erhe::geometry::Geometry>& geometry
+)
+{
+    const auto vertex_format = make_raytrace_vertex_format();
 
     const erhe::geometry::Mesh_info mesh_info = geometry->get_mesh_info();
 
@@ -65,7 +100,7 @@ Raytrace_primitive::Raytrace_primitive(
     );
     index_buffer = erhe::raytrace::IBuffer::create_shared(
         geometry->name + "_index",
-        mesh_info.index_count_fill_triangles * index_stride
+        mesh_info.index_count_fill_triangles * c_raytrace_index_stride
     );
 
     erhe::primitive::Raytrace_buffer_sink buffer_sink{
@@ -74,28 +109,43 @@ Raytrace_primitive::Raytrace_primitive(
     };
 
     erhe::primitive::Build_info build_info{&buffer_sink};
-    build_info.buffer.index_type = gl::Draw_elements_type::unsigned_int;
+    set_raytrace_build_info(build_info, vertex_format);
 
-    // Just triangle indices and position
-    build_info.format.features = {
-        .fill_triangles  = true,
-        .edge_lines      = false,
-        .corner_points   = false,
-        .centroid_points = false,
-        .position        = true,
-        .normal          = false,
-        .normal_flat     = false,
-        .normal_smooth   = false,
-        .tangent         = false,
-        .bitangent       = false,
-        .color           = false,
-        .texcoord        = false,
-        .id              = false
+    primitive_geometry = make_primitive(
+        *geometry.get(),
+        build_info,
+        erhe::primitive::Normal_style::none
+    );
+}
+
+Raytrace_primitive::Raytrace_primitive(
+    const std::shared_ptr<erhe::primitive::Triangle_soup>& triangle_soup
+)
+{
+    const auto vertex_format = make_raytrace_vertex_format();
+
+    // One vertex per corner, same as with geometry
+    const std::size_t corner_count = 3 * triangle_soup->triangle_count();
+
+    vertex_buffer = erhe::raytrace::IBuffer::create_shared(
+        triangle_soup->name + "_vertex",
+        corner_count * vertex_format->stride()
+    );
+    index_buffer = erhe::raytrace::IBuffer::create_shared(
+        triangle_soup->name + "_index",
+        corner_count * c_raytrace_index_stride
+    );
+
+    erhe::primitive::Raytrace_buffer_sink buffer_sink{
+        *vertex_buffer.get(),
+        *index_buffer.get()
     };
-    build_info.buffer.vertex_format = vertex_format;
+
+    erhe::primitive::Build_info build_info{&buffer_sink};
+    set_raytrace_build_info(build_info, vertex_format);
 
     primitive_geometry = make_primitive(
-        *geometry.get(),
+        *triangle_soup.get(),
         build_info,
         erhe::primitive::Normal_style::none
     );
@@ -104,7 +154,8 @@ Raytrace_primitive::Raytrace_primitive(
 Node_raytrace::Node_raytrace(
     const std::shared_ptr<erhe::geometry::Geometry>& source_geometry
 )
-    : m_primitive      {std::make_shared<Raytrace_primitive>(source_geometry)}
+    : m_name           {source_geometry->name}
+    , m_primitive      {std::make_shared<Raytrace_primitive>(source_geometry)}
     , m_source_geometry{source_geometry}
 {
     initialize();
@@ -117,7 +168,7 @@ void Node_raytrace::initialize()
     m_flag_bits |= INode_attachment::c_flag_bit_is_raytrace;
 
     m_geometry = erhe::raytrace::IGeometry::create_unique(
-        m_source_geometry->name + "_triangle_geometry",
+        m_name + "_triangle_geometry",
         erhe::raytrace::Geometry_type::GEOMETRY_TYPE_TRIANGLE
     );
 
@@ -149,7 +200,7 @@ void Node_raytrace::initialize()
         triangle_size,
         triangle_count
     );
-    SPDLOG_LOGGER_INFO(log_raytrace, "{}:", m_source_geometry->name);
+    SPDLOG_LOGGER_INFO(log_raytrace, "{}:", m_name);
 
     {
         ERHE_PROFILE_SCOPE("geometry commit");
@@ -159,14 +210,14 @@ void Node_raytrace::initialize()
     {
         ERHE_PROFILE_SCOPE("create scene");
         m_scene = erhe::raytrace::IScene::create_unique(
-            m_source_geometry->name + "_scene"
+            m_name + "_scene"
         );
     }
 
     m_scene->attach(m_geometry.get());
 
     m_instance = erhe::raytrace::IInstance::create_unique(
-        m_source_geometry->name + "_instance_geometry"
+        m_name + "_instance_geometry"
     );
 
     m_instance->set_scene(m_scene.get());
@@ -181,12 +232,24 @@ Node_raytrace::Node_raytrace(
     const std::shared_ptr<erhe::geometry::Geometry>& source_geometry,
     const std::shared_ptr<Raytrace_primitive>&       primitive
 )
-    : m_primitive      {primitive}
+    : m_name           {source_geometry->name}
+    , m_primitive      {primitive}
     , m_source_geometry{source_geometry}
 {
     initialize();
 }
 
+Node_raytrace::Node_raytrace(
+    const std::shared_ptr<erhe::primitive::Triangle_soup>& source_triangle_soup,
+    const std::shared_ptr<Raytrace_primitive>&             primitive
+)
+    : m_name                {source_triangle_soup->name}
+    , m_primitive           {primitive}
+    , m_source_triangle_soup{source_triangle_soup}
+{
+    initialize();
+}
+
 Node_raytrace::~Node_raytrace() noexcept
 {
     // TODO
@@ -242,6 +305,10 @@ void Node_raytrace::on_node_visibility_mask_changed(const uint64_t mask)
 
 auto Node_raytrace::source_geometry() -> std::shared_ptr<erhe::geometry::Geometry>
 {
+    if (!m_source_geometry && m_source_triangle_soup)
+    {
+        return m_source_triangle_soup->get_geometry();
+    }
     return m_source_geometry;
 }
 
@@ -5,12 +5,19 @@
 #include "scene/node_raytrace_mask.hpp"
 
 #include <functional>
+#include <memory>
+#include <string>
 
 namespace erhe::geometry
 {
     class Geometry;
 }
 
+namespace erhe::primitive
+{
+    class Triangle_soup;
+}
+
 namespace erhe::raytrace
 {
     class IBuffer;
@@ -30,6 +37,9 @@ public:
     explicit Raytrace_primitive(
         const std::shared_ptr<erhe::geometry::Geometry>& geometry
     );
+    explicit Raytrace_primitive(
+        const std::shared_ptr<erhe::primitive::Triangle_soup>& triangle_soup
+    );
 
     std::shared_ptr<erhe::raytrace::IBuffer>  vertex_buffer;
     std::shared_ptr<erhe::raytrace::IBuffer>  index_buffer;
@@ -47,6 +57,10 @@ public:
         const std::shared_ptr<erhe::geometry::Geometry>& source_geometry,
         const std::shared_ptr<Raytrace_primitive>&       primitive
     );
+    Node_raytrace(
+        const std::shared_ptr<erhe::primitive::Triangle_soup>& source_triangle_soup,
+        const std::shared_ptr<Raytrace_primitive>&             primitive
+    );
 
     ~Node_raytrace() noexcept override;
 
@@ -57,6 +71,7 @@ public:
     void on_node_visibility_mask_changed(const uint64_t mask) override;
 
     // Public API
+    // Geometry is made on first call if node was created from triangle soup
     [[nodiscard]] auto source_geometry() -> std::shared_ptr<erhe::geometry::Geometry>;
     [[nodiscard]] auto raytrace_primitive() -> Raytrace_primitive*;
     [[nodiscard]] auto raytrace_geometry()       ->       erhe::raytrace::IGeometry*;
@@ -67,11 +82,13 @@ public:
 private:
     void initialize();
 
-    std::shared_ptr<Raytrace_primitive>        m_primitive;
-    std::shared_ptr<erhe::geometry::Geometry>  m_source_geometry;
-    std::unique_ptr<erhe::raytrace::IGeometry> m_geometry;
-    std::unique_ptr<erhe::raytrace::IScene>    m_scene;
-    std::unique_ptr<erhe::raytrace::IInstance> m_instance;
+    std::string                                     m_name;
+    std::shared_ptr<Raytrace_primitive>             m_primitive;
+    std::shared_ptr<erhe::geometry::Geometry>       m_source_geometry;
+    std::shared_ptr<erhe::primitive::Triangle_soup> m_source_triangle_soup;
+    std::unique_ptr<erhe::raytrace::IGeometry>      m_geometry;
+    std::unique_ptr<erhe::raytrace::IScene>         m_scene;
+    std::unique_ptr<erhe::raytrace::IInstance>      m_instance;
 };
 
 auto is_raytrace(const erhe::scene::INode_attachment* const attachment) -> bool;
@@ -5,6 +5,7 @@
 
 #include "parsers/gltf.hpp"
 #include "parsers/json_polyhedron.hpp"
+#include "parsers/mesh_cache.hpp"
 #include "parsers/wavefront_obj.hpp"
 #include "renderers/mesh_memory.hpp"
 #include "renderers/programs.hpp"
@@ -30,6 +31,7 @@
 #include "erhe/geometry/shapes/regular_polyhedron.hpp"
 #include "erhe/graphics/buffer.hpp"
 #include "erhe/graphics/buffer_transfer_queue.hpp"
+#include "erhe/graphics/texture_transfer_queue.hpp"
 #include "erhe/primitive/primitive.hpp"
 #include "erhe/primitive/primitive_builder.hpp"
 #include "erhe/primitive/material.hpp"
@@ -89,6 +91,7 @@ void Scene_builder::declare_required_components()
 {
     require<erhe::application::Configuration      >();
     require<erhe::application::Gl_context_provider>();
+    require<Worker_thread_pool>();
     require<Editor_rendering>();
     require<Fly_camera_tool >();
     require<Materials       >();
@@ -107,6 +110,7 @@ void Scene_builder::initialize_component()
     };
 
     m_scene_root = Component::get<Scene_root>();
+    m_texture_transfer_queue = std::make_unique<erhe::graphics::Texture_transfer_queue>();
 
     setup_scene();
 
@@ -169,20 +173,12 @@ void Scene_builder::make_brushes()
 {
     ERHE_PROFILE_FUNCTION
 
-    std::unique_ptr<ITask_queue> execution_queue;
+    const bool parallel = get<erhe::application::Configuration>()->threading.parallel_initialization;
+    erhe::concurrency::Thread_pool* const thread_pool = parallel
+        ? &get<Worker_thread_pool>()->thread_pool()
+        : nullptr;
 
-    if (get<erhe::application::Configuration>()->threading.parallel_initialization)
-    {
-        const std::size_t thread_count = std::min(
-            8U,
-            std::max(std::thread::hardware_concurrency() - 0, 1U)
-        );
-        execution_queue = std::make_unique<Parallel_task_queue>("scene builder", thread_count);
-    }
-    else
-    {
-        execution_queue = std::make_unique<Serial_task_queue>();
-    }
+    auto execution_queue = get<Worker_thread_pool>()->make_task_queue("scene builder", parallel);
 
     const auto& config = get<erhe::application::Configuration>()->scene;
 
@@ -200,13 +196,14 @@ void Scene_builder::make_brushes()
     if (config.floor)
     {
         execution_queue->enqueue(
-            [this, /*floor_size,*/ &floor_box_shape/*, &table_box_shape*/, &config]()
+            [this, /*floor_size,*/ &floor_box_shape/*, &table_box_shape*/, &config, thread_pool]()
             {
                 ERHE_PROFILE_SCOPE("Floor brush");
 
                 Brush_create_context context{
                     .build_info   = build_info(),
-                    .normal_style = Normal_style::corner_normals
+                    .normal_style = Normal_style::corner_normals,
+                    .thread_pool  = thread_pool
                 };
                 context.normal_style = Normal_style::polygon_normals;
 
@@ -218,7 +215,6 @@ void Scene_builder::make_brushes()
                     )
                 );
                 floor_geometry->name = "floor";
-                floor_geometry->build_edges();
 
                 m_floor_brush = std::make_unique<Brush>(
                     Brush::Create_info{
@@ -275,7 +271,16 @@ void Scene_builder::make_brushes()
                 };
                 for (auto* path : files_names)
                 {
-                    parse_gltf(m_scene_root, build_info(), path);
+                    parse_gltf(
+                        m_scene_root,
+                        build_info(),
+                        path,
+                        thread_pool,
+                        config.gltf_direct
+                            ? Gltf_import_mode::direct
+                            : Gltf_import_mode::geometry,
+                        m_texture_transfer_queue.get()
+                    );
 
                     //for (auto& geometry : geometries)
                     //{
@@ -291,13 +296,14 @@ void Scene_builder::make_brushes()
     if (config.obj_files)
     {
         execution_queue->enqueue(
-            [this]()
+            [this, &config, thread_pool]()
             {
                 ERHE_PROFILE_SCOPE("parse .obj files");
 
                 const Brush_create_context context{
                     .build_info   = build_info(),
-                    .normal_style = Normal_style::polygon_normals
+                    .normal_style = Normal_style::polygon_normals,
+                    .thread_pool  = thread_pool
                 };
                 constexpr bool instantiate = true;
 
@@ -309,18 +315,36 @@ void Scene_builder::make_brushes()
                 };
                 for (auto* path : obj_files_names)
                 {
-                    auto geometries = parse_obj_geometry(path);
+                    const auto make_geometries = [path, thread_pool]()
+                    {
+                        auto geometries = parse_obj_geometry(path, thread_pool);
+
+                        for (auto& geometry : geometries)
+                        {
+                            geometry->compute_polygon_normals();
+                            // The real teapot is ~33% taller (ratio 4:3)
+                            //const mat4 scale_t = erhe::toolkit::create_scale(0.5f, 0.5f * 4.0f / 3.0f, 0.5f);
+                            //geometry->transform(scale_t);
+
+                            const mat4 scale_t = erhe::toolkit::create_scale(0.01f);
+                            geometry->transform(scale_t);
+                            geometry->flip_reversed_polygons();
+                        }
+                        return geometries;
+                    };
+
+                    // Settings must change when processing above changes
+                    auto geometries = config.mesh_cache
+                        ? load_geometries_cached(
+                            config.mesh_cache_directory,
+                            fs::path{path}.stem().string(),
+                            make_mesh_cache_key(path, "obj scale 0.01 flip"),
+                            make_geometries
+                        )
+                        : make_geometries();
 
                     for (auto& geometry : geometries)
                     {
-                        geometry->compute_polygon_normals();
-                        // The real teapot is ~33% taller (ratio 4:3)
-                        //const mat4 scale_t = erhe::toolkit::create_scale(0.5f, 0.5f * 4.0f / 3.0f, 0.5f);
-                        //geometry->transform(scale_t);
-
-                        const mat4 scale_t = erhe::toolkit::create_scale(0.01f);
-                        geometry->transform(scale_t);
-                        geometry->flip_reversed_polygons();
                         make_brush(instantiate, move(geometry), context);
                     }
                 }
@@ -558,6 +582,7 @@ void Scene_builder::make_brushes()
              8 * std::max(1, config.detail)
         );
         ring_geometry.transform(erhe::toolkit::mat4_swap_xy);
+        erhe::primitive::prepare_geometry(ring_geometry, build_info().format);
         auto rotate_ring_pg = make_primitive(ring_geometry, build_info());
         const auto shared_geometry = std::make_shared<erhe::geometry::Geometry>(
             std::move(ring_geometry)
@@ -619,20 +644,42 @@ void Scene_builder::make_brushes()
             {
                 ERHE_PROFILE_SCOPE("make brushes");
 
+                const uint64_t source_key = config.mesh_cache
+                    ? make_mesh_cache_key("res/polyhedra/johnson.json", "")
+                    : 0;
                 for (const auto& key_name : library.names)
                 {
                     execution_queue->enqueue(
-                        [this, &library, &key_name, &context]()
+                        [this, &library, &key_name, &context, &config, source_key]()
                         {
                             constexpr bool instantiate = true;
-                            auto geometry = library.make_geometry(key_name);
-                            if (geometry.get_polygon_count() == 0)
+                            const auto make_geometries = [&library, &key_name]()
                             {
-                                return;
+                                std::vector<std::shared_ptr<erhe::geometry::Geometry>> geometries;
+                                auto geometry = library.make_geometry(key_name);
+                                if (geometry.get_polygon_count() > 0)
+                                {
+                                    geometry.compute_polygon_normals();
+                                    geometries.push_back(
+                                        std::make_shared<erhe::geometry::Geometry>(std::move(geometry))
+                                    );
+                                }
+                                return geometries;
+                            };
+
+                            const auto geometries = (source_key != 0)
+                                ? load_geometries_cached(
+                                    fs::path{config.mesh_cache_directory} / "johnson",
+                                    key_name,
+                                    make_mesh_cache_key(source_key, key_name),
+                                    make_geometries
+                                )
+                                : make_geometries();
+
+                            for (const auto& geometry : geometries)
+                            {
+                                make_brush(instantiate, geometry, context);
                             }
-                            geometry.compute_polygon_normals();
-
-                            make_brush(instantiate, std::move(geometry), context);
                         }
                     );
                 }
@@ -681,8 +728,7 @@ void Scene_builder::add_room()
         .node_visibility_flags = Node_visibility::visible | Node_visibility::content | Node_visibility::id,
         .physics_world         = m_scene_root->physics_world(),
         .world_from_node       = erhe::toolkit::create_translation<float>(0.0f, -0.5001f, 0.0f),
-        .material              = floor_material,
-        .scale                 = 1.0f
+        .material              = floor_material
     };
 
     auto floor_instance = m_floor_brush->make_instance(
@@ -868,8 +914,7 @@ void Scene_builder::make_mesh_nodes()
                 ),
                 .physics_world         = m_scene_root->physics_world(),
                 .world_from_node       = erhe::toolkit::create_translation(x, y, z),
-                .material              = m_scene_root->materials().at(material_index),
-                .scale                 = 1.0f
+                .material              = m_scene_root->materials().at(material_index)
             };
             auto instance = brush->make_instance(brush_instance_create_info);
             m_scene_root->add_instance(instance);
@@ -887,6 +932,7 @@ void Scene_builder::make_cube_benchmark()
 
     auto material = m_scene_root->make_material("cube", vec3{1.0, 1.0f, 1.0f}, glm::vec2{0.3f, 0.4f}, 0.0f);
     auto cube     = make_cube(0.1f);
+    erhe::primitive::prepare_geometry(cube, build_info().format);
     auto cube_pg  = make_primitive(cube, build_info(), Normal_style::polygon_normals);
 
     constexpr float scale   = 0.5f;
@@ -1077,9 +1123,15 @@ void Scene_builder::update_once_per_frame(
 {
     ERHE_PROFILE_FUNCTION
 
+    // Skinned vertices are written to buffer transfer queue
+    m_scene_root->update_animations(static_cast<float>(time_context.dt), build_info());
+
     buffer_transfer_queue().flush();
 
-    static_cast<void>(time_context);
+    // Texture levels are streamed over several frames
+    constexpr std::size_t texture_upload_byte_budget = 4 * 1024 * 1024;
+    m_texture_transfer_queue->flush(texture_upload_byte_budget);
+
     animate_lights(time_context.time);
 }
 
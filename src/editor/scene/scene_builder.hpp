@@ -22,6 +22,7 @@ namespace erhe::graphics
 {
     class Buffer;
     class Buffer_transfer_queue;
+    class Texture_transfer_queue;
     class Vertex_format;
 }
 
@@ -141,6 +142,8 @@ private:
     std::vector<std::shared_ptr<Brush>>    m_scene_brushes;
     std::shared_ptr<Rendertarget_viewport> m_rendertarget_viewport;
 
+    std::unique_ptr<erhe::graphics::Texture_transfer_queue> m_texture_transfer_queue;
+
     std::vector<std::shared_ptr<erhe::physics::ICollision_shape>> m_collision_shapes;
 };
 
@@ -1,6 +1,7 @@
 #include "scene/scene_root.hpp"
 
 #include "editor_log.hpp"
+#include "task_queue.hpp"
 
 #include "scene/helpers.hpp"
 #include "scene/node_physics.hpp"
@@ -9,17 +10,23 @@
 
 #include "erhe/application/configuration.hpp"
 #include "erhe/application/view.hpp"
+#include "erhe/concurrency/concurrent_queue.hpp"
 #include "erhe/graphics/buffer.hpp"
 #include "erhe/primitive/material.hpp"
+#include "erhe/primitive/triangle_soup.hpp"
 #include "erhe/physics/iworld.hpp"
 #include "erhe/raytrace/iscene.hpp"
+#include "erhe/scene/animation.hpp"
 #include "erhe/scene/camera.hpp"
 #include "erhe/scene/light.hpp"
 #include "erhe/scene/mesh.hpp"
 #include "erhe/scene/node.hpp"
 #include "erhe/scene/scene.hpp"
+#include "erhe/scene/skin.hpp"
+#include "erhe/scene/spatial_index.hpp"
 #include "erhe/toolkit/math_util.hpp"
 #include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
 
 #include <glm/gtx/color_space.hpp>
 
@@ -99,6 +106,7 @@ void Scene_root::declare_required_components()
 {
     require<erhe::application::Configuration>();
     require<erhe::application::View>();
+    require<Worker_thread_pool>();
 }
 
 void Scene_root::initialize_component()
@@ -116,6 +124,9 @@ void Scene_root::initialize_component()
     m_brush_layer      = make_shared<Mesh_layer>("brush",      Node_visibility::brush);
     m_light_layer      = make_shared<Light_layer>("lights");
 
+    // Content layer is the only one large enough to benefit from spatial index
+    m_content_layer->spatial_index = make_unique<erhe::scene::Mesh_spatial_index>();
+
     m_scene            = std::make_unique<Scene>();
 
     m_scene->mesh_layers .push_back(m_content_layer);
@@ -127,7 +138,16 @@ void Scene_root::initialize_component()
     m_physics_world  = erhe::physics::IWorld::create_unique();
     m_raytrace_scene = erhe::raytrace::IScene::create_unique("root");
 
-    if (get<erhe::application::Configuration>()->physics.enabled)
+    const auto& configuration = *get<erhe::application::Configuration>().get();
+    if (configuration.threading.parallel_transform_update)
+    {
+        m_concurrent_queue = std::make_unique<erhe::concurrency::Concurrent_queue>(
+            get<Worker_thread_pool>()->thread_pool(),
+            "scene root"
+        );
+    }
+
+    if (configuration.physics.enabled)
     {
         m_physics_world->enable_physics_updates();
     }
@@ -235,6 +255,158 @@ auto Scene_root::scene() const -> const erhe::scene::Scene&
     return *m_scene.get();
 }
 
+auto Scene_root::concurrent_queue() -> erhe::concurrency::Concurrent_queue*
+{
+    return m_concurrent_queue.get();
+}
+
+void Scene_root::update_node_transforms()
+{
+    ERHE_PROFILE_FUNCTION
+
+    ERHE_VERIFY(m_scene);
+    m_scene->update_node_transforms(m_concurrent_queue.get());
+}
+
+void Scene_root::add_animation_player(
+    const std::shared_ptr<erhe::scene::Animation_player>& animation_player
+)
+{
+    Expects(animation_player);
+
+    const std::lock_guard<std::mutex> lock{m_scene_mutex};
+    m_animation_players.push_back(animation_player);
+}
+
+void Scene_root::add_skinned_mesh(const std::shared_ptr<erhe::scene::Mesh>& mesh)
+{
+    Expects(mesh);
+    Expects(mesh->mesh_data.skin);
+
+    const std::lock_guard<std::mutex> lock{m_scene_mutex};
+    m_skinned_meshes.push_back(Skinned_mesh{.mesh = mesh});
+}
+
+void Scene_root::update_animations(
+    const float                        delta_time,
+    const erhe::primitive::Build_info& build_info
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    if (m_animation_players.empty())
+    {
+        return;
+    }
+
+    auto* const queue = m_concurrent_queue.get();
+
+    // Sampling and local transforms do not touch nodes
+    for (const auto& animation_player : m_animation_players)
+    {
+        if (queue != nullptr)
+        {
+            queue->enqueue(
+                [&animation_player, delta_time]()
+                {
+                    animation_player->update(delta_time);
+                }
+            );
+        }
+        else
+        {
+            animation_player->update(delta_time);
+        }
+    }
+    if (queue != nullptr)
+    {
+        queue->wait();
+    }
+
+    for (const auto& animation_player : m_animation_players)
+    {
+        animation_player->apply();
+    }
+
+    // Joint matrices need up to date world transforms
+    update_node_transforms();
+
+    // Meshes which are no longer alive are dropped
+    m_skinned_meshes.erase(
+        std::remove_if(
+            m_skinned_meshes.begin(),
+            m_skinned_meshes.end(),
+            [](const Skinned_mesh& skinned_mesh)
+            {
+                return skinned_mesh.mesh.expired();
+            }
+        ),
+        m_skinned_meshes.end()
+    );
+
+    for (auto& skinned_mesh : m_skinned_meshes)
+    {
+        if (queue != nullptr)
+        {
+            queue->enqueue(
+                [this, &skinned_mesh, &build_info]()
+                {
+                    skin_mesh(skinned_mesh, build_info);
+                }
+            );
+        }
+        else
+        {
+            skin_mesh(skinned_mesh, build_info);
+        }
+    }
+    if (queue != nullptr)
+    {
+        queue->wait();
+    }
+}
+
+void Scene_root::skin_mesh(
+    Skinned_mesh&                      skinned_mesh,
+    const erhe::primitive::Build_info& build_info
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto mesh = skinned_mesh.mesh.lock();
+    if (!mesh || !mesh->mesh_data.skin)
+    {
+        return;
+    }
+
+    mesh->mesh_data.skin->update_joint_matrices(*mesh.get(), skinned_mesh.joint_matrices);
+    for (auto& primitive : mesh->mesh_data.primitives)
+    {
+        const auto& triangle_soup = primitive.source_triangle_soup;
+        if (!triangle_soup || triangle_soup->joints.empty())
+        {
+            continue;
+        }
+        erhe::primitive::skin_vertices(
+            *triangle_soup.get(),
+            skinned_mesh.joint_matrices,
+            skinned_mesh.positions,
+            skinned_mesh.normals
+        );
+
+        // Buffer sink enqueues vertex data to transfer queue, which is
+        // flushed by the thread which owns the graphics context.
+        erhe::primitive::update_vertices(
+            *triangle_soup.get(),
+            skinned_mesh.positions,
+            skinned_mesh.normals,
+            primitive.gl_primitive_geometry,
+            build_info,
+            primitive.normal_style
+        );
+    }
+}
+
 void Scene_root::add_instance(const Instance& instance)
 {
     ERHE_PROFILE_FUNCTION
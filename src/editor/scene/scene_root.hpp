@@ -22,6 +22,11 @@
 
 class btCollisionShape;
 
+namespace erhe::concurrency
+{
+    class Concurrent_queue;
+}
+
 namespace erhe::geometry
 {
     class Geometry;
@@ -48,6 +53,7 @@ namespace erhe::primitive
 
 namespace erhe::scene
 {
+    class Animation_player;
     class Camera;
     class Light;
     class Light_layer;
@@ -209,6 +215,26 @@ public:
 
     void sort_lights();
 
+    // Updates scene node transforms, using worker threads for large scenes
+    void update_node_transforms();
+
+    // Queue for parallel per-frame scene work, nullptr if disabled
+    [[nodiscard]] auto concurrent_queue() -> erhe::concurrency::Concurrent_queue*;
+
+    void add_animation_player(const std::shared_ptr<erhe::scene::Animation_player>& animation_player);
+
+    // Mesh must have skin, and triangle soup for each primitive
+    void add_skinned_mesh(const std::shared_ptr<erhe::scene::Mesh>& mesh);
+
+    // Advances animation players, updates node transforms, and skins
+    // skinned meshes on CPU, writing vertices through build info buffer
+    // sink. Players and meshes are processed in parallel when concurrent
+    // queue is available.
+    void update_animations(
+        const float                        delta_time,
+        const erhe::primitive::Build_info& build_info
+    );
+
 private:
     // Commands
     Create_new_camera_command     m_create_new_camera_command;
@@ -230,6 +256,25 @@ private:
     std::shared_ptr<erhe::scene::Light_layer> m_light_layer;
     std::shared_ptr<erhe::scene::Camera>      m_camera;
     std::shared_ptr<Frame_controller>         m_camera_controls;
+
+    std::unique_ptr<erhe::concurrency::Concurrent_queue> m_concurrent_queue;
+
+    class Skinned_mesh
+    {
+    public:
+        std::weak_ptr<erhe::scene::Mesh> mesh;
+        std::vector<glm::mat4>           joint_matrices;
+        std::vector<glm::vec3>           positions;
+        std::vector<glm::vec3>           normals;
+    };
+
+    void skin_mesh(
+        Skinned_mesh&                      skinned_mesh,
+        const erhe::primitive::Build_info& build_info
+    );
+
+    std::vector<std::shared_ptr<erhe::scene::Animation_player>> m_animation_players;
+    std::vector<Skinned_mesh>                                   m_skinned_meshes;
 };
 
 } // namespace editor
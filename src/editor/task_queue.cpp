@@ -1,14 +1,21 @@
 #include "task_queue.hpp"
 
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
+#include <thread>
+
 namespace editor {
 
 ITask_queue::~ITask_queue()
 {
 }
 
-Parallel_task_queue::Parallel_task_queue(const std::string_view name, std::size_t thread_count)
-    : m_thread_pool{thread_count}
-    , m_queue      {m_thread_pool, name}
+Parallel_task_queue::Parallel_task_queue(
+    erhe::concurrency::Thread_pool& thread_pool,
+    const std::string_view          name
+)
+    : m_queue{thread_pool, name}
 {
 }
 
@@ -21,6 +28,11 @@ void Serial_task_queue::wait()
 {
 }
 
+auto Serial_task_queue::concurrent_queue() -> erhe::concurrency::Concurrent_queue*
+{
+    return nullptr;
+}
+
 void Parallel_task_queue::enqueue(std::function<void()>&& func)
 {
     m_queue.enqueue(func);
@@ -31,4 +43,42 @@ void Parallel_task_queue::wait()
     m_queue.wait();
 }
 
+auto Parallel_task_queue::concurrent_queue() -> erhe::concurrency::Concurrent_queue*
+{
+    return &m_queue;
+}
+
+Worker_thread_pool::Worker_thread_pool()
+    : Component{c_label}
+{
+}
+
+Worker_thread_pool::~Worker_thread_pool() noexcept
+{
+}
+
+void Worker_thread_pool::initialize_component()
+{
+    const std::size_t thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+    m_thread_pool = std::make_unique<erhe::concurrency::Thread_pool>(thread_count);
 }
+
+auto Worker_thread_pool::thread_pool() -> erhe::concurrency::Thread_pool&
+{
+    ERHE_VERIFY(m_thread_pool);
+    return *m_thread_pool.get();
+}
+
+auto Worker_thread_pool::make_task_queue(
+    const std::string_view name,
+    const bool             parallel
+) -> std::unique_ptr<ITask_queue>
+{
+    if (parallel)
+    {
+        return std::make_unique<Parallel_task_queue>(thread_pool(), name);
+    }
+    return std::make_unique<Serial_task_queue>();
+}
+
+} // namespace editor
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "erhe/components/components.hpp"
+
 #include <erhe/concurrency/concurrent_queue.hpp>
 
+#include <memory>
+
 namespace editor {
 
 class ITask_queue
@@ -10,6 +14,9 @@ public:
     virtual ~ITask_queue();
     virtual void enqueue(std::function<void()>&& func) = 0;
     virtual void wait   () = 0;
+
+    // Returns nullptr if tasks are not run concurrently
+    [[nodiscard]] virtual auto concurrent_queue() -> erhe::concurrency::Concurrent_queue* = 0;
 };
 
 class Serial_task_queue
@@ -18,20 +25,53 @@ class Serial_task_queue
 public:
     void enqueue(std::function<void()>&& func) override;
     void wait   () override;
+
+    [[nodiscard]] auto concurrent_queue() -> erhe::concurrency::Concurrent_queue* override;
 };
 
 class Parallel_task_queue
     : public ITask_queue
 {
 public:
-    explicit Parallel_task_queue(const std::string_view name, std::size_t thread_count);
+    Parallel_task_queue(erhe::concurrency::Thread_pool& thread_pool, const std::string_view name);
 
     void enqueue(std::function<void()>&& func) override;
     void wait   () override;
 
+    [[nodiscard]] auto concurrent_queue() -> erhe::concurrency::Concurrent_queue* override;
+
 private:
-    erhe::concurrency::Thread_pool      m_thread_pool;
     erhe::concurrency::Concurrent_queue m_queue;
 };
 
+// Owns the thread pool shared by all task queues and concurrent queues
+// of the editor. Queues waiting for their tasks help the pool, so tasks
+// may create and wait for nested queues.
+class Worker_thread_pool
+    : public erhe::components::Component
+{
+public:
+    static constexpr std::string_view c_label{"Worker_thread_pool"};
+    static constexpr uint32_t hash = compiletime_xxhash::xxh32(c_label.data(), c_label.size(), {});
+
+    Worker_thread_pool ();
+    ~Worker_thread_pool() noexcept override;
+
+    // Implements Component
+    [[nodiscard]] auto get_type_hash() const -> uint32_t override { return hash; }
+    void initialize_component() override;
+
+    // Public API
+    [[nodiscard]] auto thread_pool() -> erhe::concurrency::Thread_pool&;
+
+    // Returns serial queue if parallel is not set
+    [[nodiscard]] auto make_task_queue(
+        const std::string_view name,
+        const bool             parallel
+    ) -> std::unique_ptr<ITask_queue>;
+
+private:
+    std::unique_ptr<erhe::concurrency::Thread_pool> m_thread_pool;
+};
+
 } // namespace editor
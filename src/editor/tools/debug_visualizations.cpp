@@ -101,7 +101,7 @@ void Debug_visualizations::mesh_selection_visualization(
     //const auto& mesh = as_mesh(node);
     for (const auto& primitive : mesh->mesh_data.primitives)
     {
-        if (!primitive.source_geometry)
+        if (!primitive.get_geometry())
         {
             continue;
         }
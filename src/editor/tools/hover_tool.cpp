@@ -1,6 +1,7 @@
 #include "hover_tool.hpp"
 #include "editor_log.hpp"
 #include "editor_rendering.hpp"
+#include "renderers/id_renderer.hpp"
 #include "renderers/render_context.hpp"
 #include "scene/scene_root.hpp"
 #include "tools/hover_tool.hpp"
@@ -88,6 +89,7 @@ void Hover_tool::initialize_component()
 
 void Hover_tool::post_initialize()
 {
+    m_id_renderer       = get<Id_renderer                         >();
     m_line_renderer_set = get<erhe::application::Line_renderer_set>();
     m_pointer_context   = get<Pointer_context                     >();
     m_text_renderer     = get<erhe::application::Text_renderer    >();
@@ -110,18 +112,73 @@ auto Hover_tool::try_call() -> bool
     m_hover_tool           = tool   .valid && tool   .mesh;
     m_hover_position_world = content.valid ? content.position : nonstd::optional<vec3>{};
     m_hover_normal         = content.valid ? content.normal   : nonstd::optional<vec3>{};
+
+    std::shared_ptr<erhe::scene::Mesh> mesh            = content.mesh;
+    std::size_t                        primitive_index = content.primitive;
+    if (!m_hover_content && !m_hover_tool)
+    {
+        mesh            = hover_near_pointer();
+        primitive_index = 0;
+    }
+
     if (
-        (content.mesh      != m_hover_mesh           ) ||
-        (content.primitive != m_hover_primitive_index)
+        (mesh            != m_hover_mesh           ) ||
+        (primitive_index != m_hover_primitive_index)
     )
     {
         deselect();
-        select();
+        select(mesh, primitive_index);
     }
 
     return false;
 }
 
+auto Hover_tool::hover_near_pointer() -> std::shared_ptr<erhe::scene::Mesh>
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Pointer is not directly over a mesh. Accept content mesh within
+    // pick radius, using latest id buffer readback, so that hover never
+    // waits for the GPU.
+    auto*      window   = m_pointer_context->window();
+    const auto position = m_pointer_context->position_in_viewport_window();
+    if (!m_id_renderer || (window == nullptr) || !position.has_value())
+    {
+        return {};
+    }
+
+    const int x  = static_cast<int>(position.value().x);
+    const int y  = static_cast<int>(position.value().y);
+    const int x0 = x - m_pick_radius;
+    const int y0 = y - m_pick_radius;
+    const int x1 = x + m_pick_radius;
+    const int y1 = y + m_pick_radius;
+    for (const auto& mesh : m_id_renderer->get_meshes_in_rectangle(x0, y0, x1, y1))
+    {
+        if ((mesh->get_visibility_mask() & erhe::scene::Node_visibility::content) != erhe::scene::Node_visibility::content)
+        {
+            continue;
+        }
+
+        // Hover position is placed at nearest depth in pick region
+        const auto depth_range = m_id_renderer->get_depth_range(x0, y0, x1, y1);
+        if (depth_range.valid)
+        {
+            const float depth             = window->viewport().reverse_depth ? depth_range.max_depth : depth_range.min_depth;
+            const auto  position_in_world = window->unproject_to_world(
+                glm::dvec3{position.value().x, position.value().y, depth}
+            );
+            if (position_in_world.has_value())
+            {
+                m_hover_position_world = vec3{position_in_world.value()};
+            }
+        }
+        m_hover_content = true;
+        return mesh;
+    }
+    return {};
+}
+
 void Hover_tool::tool_render(
     const Render_context& context
 )
@@ -254,19 +311,21 @@ void Hover_tool::deselect()
     }
 }
 
-void Hover_tool::select()
+void Hover_tool::select(
+    const std::shared_ptr<erhe::scene::Mesh>& mesh,
+    const std::size_t                         primitive_index
+)
 {
     ERHE_PROFILE_FUNCTION
 
-    const auto& hover = m_pointer_context->get_hover(Pointer_context::content_slot);
-    if (!hover.valid || !hover.mesh)
+    if (!mesh)
     {
         return;
     }
 
     // Update hover information
-    m_hover_mesh            = hover.mesh;
-    m_hover_primitive_index = hover.primitive;
+    m_hover_mesh            = mesh;
+    m_hover_primitive_index = primitive_index;
 
     if (m_enable_color_highlight)
     {
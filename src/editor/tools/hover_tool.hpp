@@ -31,6 +31,7 @@ namespace editor
 {
 
 class Hover_tool;
+class Id_renderer;
 class Pointer_context;
 class Scene_root;
 
@@ -87,9 +88,11 @@ public:
 
 private:
     void deselect();
-    void select  ();
+    void select  (const std::shared_ptr<erhe::scene::Mesh>& mesh, const std::size_t primitive_index);
+    [[nodiscard]] auto hover_near_pointer() -> std::shared_ptr<erhe::scene::Mesh>;
 
     // Component dependencies
+    std::shared_ptr<Id_renderer>                          m_id_renderer;
     std::shared_ptr<erhe::application::Line_renderer_set> m_line_renderer_set;
     std::shared_ptr<Pointer_context>                      m_pointer_context;
     std::shared_ptr<Scene_root>                           m_scene_root;
@@ -111,6 +114,7 @@ private:
     std::size_t                                m_hover_material_index{0};
 
     bool m_enable_color_highlight{false};
+    int  m_pick_radius           {4}; // pixels, used when pointer is not directly over a mesh
 };
 
 } // namespace editor
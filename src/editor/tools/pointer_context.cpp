@@ -354,7 +354,7 @@ void Pointer_context::update_viewport(Viewport_window* viewport_window)
             if (entry.mesh)
             {
                 const auto& primitive = entry.mesh->mesh_data.primitives[entry.primitive];
-                entry.geometry = primitive.source_geometry.get();
+                entry.geometry = primitive.get_geometry().get(); // kept alive by primitive
                 entry.normal   = {};
                 if (entry.geometry != nullptr)
                 {
@@ -5,6 +5,7 @@
 #include "operations/compound_operation.hpp"
 #include "operations/insert_operation.hpp"
 #include "operations/operation_stack.hpp"
+#include "renderers/id_renderer.hpp"
 #include "renderers/render_context.hpp"
 #include "scene/node_physics.hpp"
 #include "scene/node_raytrace.hpp"
@@ -13,6 +14,7 @@
 #include "tools/tools.hpp"
 #include "tools/trs_tool.hpp"
 #include "windows/viewport_config.hpp"
+#include "windows/viewport_window.hpp"
 
 #include "erhe/application/time.hpp"
 #include "erhe/application/view.hpp"
@@ -23,6 +25,7 @@
 #include "erhe/scene/light.hpp"
 #include "erhe/scene/scene.hpp"
 #include "erhe/toolkit/math_util.hpp"
+#include "erhe/toolkit/profile.hpp"
 
 namespace editor
 {
@@ -147,6 +150,39 @@ auto Selection_tool_select_command::try_call(
     return consumed;
 }
 
+void Selection_tool_box_select_command::try_ready(
+    erhe::application::Command_context& context
+)
+{
+    if (m_selection_tool.box_select_try_ready())
+    {
+        set_ready(context);
+    }
+}
+
+auto Selection_tool_box_select_command::try_call(
+    erhe::application::Command_context& context
+) -> bool
+{
+    static_cast<void>(context);
+
+    if (state() != erhe::application::State::Active)
+    {
+        return false;
+    }
+
+    return m_selection_tool.on_box_select();
+}
+
+void Selection_tool_box_select_command::on_inactive(
+    erhe::application::Command_context& context
+)
+{
+    static_cast<void>(context);
+
+    m_selection_tool.end_box_select();
+}
+
 auto Selection_tool_delete_command::try_call(
     erhe::application::Command_context& context
 ) -> bool
@@ -236,6 +272,7 @@ Selection_tool::Selection_tool()
     : erhe::components::Component{c_label}
     , m_select_command           {*this}
     , m_delete_command           {*this}
+    , m_box_select_command       {*this}
     , m_range_selection          {*this}
 {
 }
@@ -258,12 +295,15 @@ void Selection_tool::initialize_component()
 
     view->register_command           (&m_select_command);
     view->register_command           (&m_delete_command);
+    view->register_command           (&m_box_select_command);
     view->bind_command_to_mouse_click(&m_select_command, erhe::toolkit::Mouse_button_left);
+    view->bind_command_to_mouse_drag (&m_box_select_command, erhe::toolkit::Mouse_button_middle);
     view->bind_command_to_key        (&m_delete_command, erhe::toolkit::Key_delete, true);
 }
 
 void Selection_tool::post_initialize()
 {
+    m_id_renderer       = get<Id_renderer      >();
     m_line_renderer_set = get<erhe::application::Line_renderer_set>();
     m_pointer_context   = get<Pointer_context  >();
     m_scene_root        = get<Scene_root       >();
@@ -379,6 +419,174 @@ auto Selection_tool::on_mouse_select() -> bool
     return true;
 }
 
+auto Selection_tool::box_select_try_ready() -> bool
+{
+    if (
+        (m_pointer_context->window() == nullptr) ||
+        !m_pointer_context->position_in_viewport_window().has_value()
+    )
+    {
+        return false;
+    }
+
+    m_box_select_points.clear();
+    m_box_select_points.push_back(m_pointer_context->position_in_viewport_window().value());
+    m_box_select_nodes.clear();
+    m_box_select_active = false;
+    m_box_select_lasso  = m_pointer_context->shift_key_down();
+    return true;
+}
+
+auto Selection_tool::on_box_select() -> bool
+{
+    const auto position = m_pointer_context->position_in_viewport_window();
+    if (!position.has_value() || m_box_select_points.empty())
+    {
+        return false;
+    }
+
+    m_box_select_active = true;
+    if (m_box_select_lasso)
+    {
+        constexpr float min_distance = 2.0f;
+        if (glm::distance(m_box_select_points.back(), position.value()) >= min_distance)
+        {
+            m_box_select_points.push_back(position.value());
+        }
+    }
+    else
+    {
+        m_box_select_points.resize(2);
+        m_box_select_points[1] = position.value();
+    }
+    update_box_select();
+    return true;
+}
+
+void Selection_tool::update_box_select()
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Id buffer is read back only around the pointer, so meshes are
+    // collected from each readback while dragging. Queries use the
+    // latest completed readback and never wait for the GPU.
+    if (!m_id_renderer)
+    {
+        return;
+    }
+
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> meshes;
+    if (m_box_select_lasso)
+    {
+        meshes = m_id_renderer->get_meshes_in_lasso(m_box_select_points);
+    }
+    else if (m_box_select_points.size() == 2)
+    {
+        meshes = m_id_renderer->get_meshes_in_rectangle(
+            static_cast<int>(m_box_select_points[0].x),
+            static_cast<int>(m_box_select_points[0].y),
+            static_cast<int>(m_box_select_points[1].x),
+            static_cast<int>(m_box_select_points[1].y)
+        );
+    }
+
+    for (const auto& mesh : meshes)
+    {
+        if (
+            ((mesh->get_visibility_mask() & erhe::scene::Node_visibility::content) == erhe::scene::Node_visibility::content) &&
+            !is_in<std::shared_ptr<erhe::scene::Node>>(mesh, m_box_select_nodes)
+        )
+        {
+            m_box_select_nodes.push_back(mesh);
+        }
+    }
+}
+
+void Selection_tool::end_box_select()
+{
+    if (!m_box_select_active)
+    {
+        m_box_select_points.clear();
+        return;
+    }
+
+    update_box_select();
+    m_box_select_active = false;
+
+    if (m_pointer_context->control_key_down())
+    {
+        for (const auto& node : m_box_select_nodes)
+        {
+            if (!is_in_selection(node))
+            {
+                add_to_selection(node);
+            }
+        }
+    }
+    else
+    {
+        m_range_selection.reset();
+        set_selection(m_box_select_nodes);
+    }
+
+    log_selection->trace("Box select found {} meshes", m_box_select_nodes.size());
+    m_box_select_points.clear();
+    m_box_select_nodes.clear();
+}
+
+void Selection_tool::tool_render(
+    const Render_context& context
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    if (
+        !m_box_select_active ||
+        (context.window == nullptr) ||
+        (context.window != m_pointer_context->window()) ||
+        (m_box_select_points.size() < 2)
+    )
+    {
+        return;
+    }
+
+    std::vector<glm::vec2> outline;
+    if (m_box_select_lasso)
+    {
+        outline = m_box_select_points;
+    }
+    else
+    {
+        const glm::vec2 a = m_box_select_points[0];
+        const glm::vec2 b = m_box_select_points[1];
+        outline = { a, glm::vec2{b.x, a.y}, b, glm::vec2{a.x, b.y} };
+    }
+
+    // Outline is placed just beyond near plane
+    const double depth = context.window->viewport().reverse_depth ? 0.999 : 0.001;
+    auto& line_renderer = m_line_renderer_set->hidden;
+    line_renderer.set_line_color(0xffffffffu);
+    line_renderer.set_thickness(1.0f);
+    for (std::size_t i = 0, end = outline.size(); i < end; ++i)
+    {
+        const glm::vec2 p0 = outline[i];
+        const glm::vec2 p1 = outline[(i + 1) % end];
+        const auto      w0 = context.window->unproject_to_world(glm::dvec3{p0.x, p0.y, depth});
+        const auto      w1 = context.window->unproject_to_world(glm::dvec3{p1.x, p1.y, depth});
+        if (w0.has_value() && w1.has_value())
+        {
+            line_renderer.add_lines(
+                {
+                    {
+                        vec3{w0.value()},
+                        vec3{w1.value()}
+                    }
+                }
+            );
+        }
+    }
+}
+
 auto Selection_tool::clear_selection() -> bool
 {
     if (m_selection.empty())
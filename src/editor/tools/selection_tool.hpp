@@ -7,6 +7,8 @@
 #include "erhe/components/components.hpp"
 #include "erhe/scene/node.hpp"
 
+#include <glm/glm.hpp>
+
 #include <functional>
 #include <memory>
 #include <vector>
@@ -25,6 +27,7 @@ namespace erhe::application
 namespace editor
 {
 
+class Id_renderer;
 class Pointer_context;
 class Scene_root;
 class Selection_tool;
@@ -63,6 +66,26 @@ private:
     Selection_tool& m_selection_tool;
 };
 
+// Middle mouse button drag selects meshes inside rectangle, or inside
+// lasso when shift is held. With control, meshes are added to selection.
+class Selection_tool_box_select_command
+    : public erhe::application::Command
+{
+public:
+    explicit Selection_tool_box_select_command(Selection_tool& selection_tool)
+        : Command         {"Selection_tool.box_select"}
+        , m_selection_tool{selection_tool}
+    {
+    }
+
+    void try_ready  (erhe::application::Command_context& context) override;
+    auto try_call   (erhe::application::Command_context& context) -> bool override;
+    void on_inactive(erhe::application::Command_context& context) override;
+
+private:
+    Selection_tool& m_selection_tool;
+};
+
 class Range_selection
 {
 public:
@@ -152,6 +175,7 @@ public:
     // Implements Tool
     [[nodiscard]] auto tool_priority() const -> int   override { return c_priority; }
     [[nodiscard]] auto description  () -> const char* override;
+    void tool_render(const Render_context& context) override;
 
     // Public API
     [[nodiscard]] auto subscribe_selection_change_notification(On_selection_changed callback) -> Subcription;
@@ -169,6 +193,9 @@ public:
     // Commands
     auto mouse_select_try_ready() -> bool;
     auto on_mouse_select       () -> bool;
+    auto box_select_try_ready  () -> bool;
+    auto on_box_select         () -> bool;
+    void end_box_select        ();
 
     auto delete_selection() -> bool;
 
@@ -178,6 +205,7 @@ private:
         const std::shared_ptr<erhe::scene::Node>& item,
         const bool clear_others
     );
+    void update_box_select();
 
     class Subscription_entry
     {
@@ -186,12 +214,14 @@ private:
         int                  handle;
     };
 
-    Selection_tool_select_command m_select_command;
-    Selection_tool_delete_command m_delete_command;
+    Selection_tool_select_command     m_select_command;
+    Selection_tool_delete_command     m_delete_command;
+    Selection_tool_box_select_command m_box_select_command;
 
     Range_selection m_range_selection;
 
     // Component dependencies
+    std::shared_ptr<Id_renderer>       m_id_renderer;
     std::shared_ptr<erhe::application::Line_renderer_set> m_line_renderer_set;
     std::shared_ptr<Pointer_context>   m_pointer_context;
     std::shared_ptr<Viewport_config>   m_viewport_config;
@@ -204,6 +234,12 @@ private:
     std::shared_ptr<erhe::scene::Mesh> m_hover_mesh;
     bool                               m_hover_content{false};
     bool                               m_hover_tool   {false};
+
+    // Rectangle corners, or lasso polygon, in viewport window coordinates
+    std::vector<glm::vec2>             m_box_select_points;
+    Selection                          m_box_select_nodes;
+    bool                               m_box_select_active{false};
+    bool                               m_box_select_lasso {false};
 };
 
 } // namespace editor
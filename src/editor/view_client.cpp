@@ -60,7 +60,7 @@ void View_client::update()
     m_viewport_windows->update_viewport_windows();
     if (m_scene_root)
     {
-        m_scene_root->scene().update_node_transforms();
+        m_scene_root->update_node_transforms();
     }
 }
 
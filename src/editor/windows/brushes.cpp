@@ -166,12 +166,6 @@ auto Brushes::make_brush(
 {
     ERHE_PROFILE_FUNCTION
 
-    geometry->build_edges();
-    geometry->compute_polygon_normals();
-    geometry->compute_tangents();
-    geometry->compute_polygon_centroids();
-    geometry->compute_point_normals(erhe::geometry::c_point_normals_smooth);
-
     const auto brush = allocate_brush(context.build_info);
     brush->initialize(
         Brush::Create_info{
@@ -180,7 +174,8 @@ auto Brushes::make_brush(
             .normal_style    = context.normal_style,
             .density         = 1.0f,
             .volume          = geometry->get_mass_properties().volume,
-            .collision_shape = collision_shape
+            .collision_shape = collision_shape,
+            .thread_pool     = context.thread_pool
         }
     );
     return brush;
@@ -195,11 +190,6 @@ auto Brushes::make_brush(
 {
     ERHE_PROFILE_FUNCTION
 
-    geometry->build_edges();
-    geometry->compute_polygon_normals();
-    geometry->compute_tangents();
-    geometry->compute_polygon_centroids();
-    geometry->compute_point_normals(erhe::geometry::c_point_normals_smooth);
     const Brush::Create_info create_info{
         .geometry                    = geometry,
         .build_info                  = context.build_info,
@@ -208,7 +198,8 @@ auto Brushes::make_brush(
         .volume                      = 1.0f,
         .collision_shape             = {},
         .collision_volume_calculator = collision_volume_calculator,
-        .collision_shape_generator   = collision_shape_generator
+        .collision_shape_generator   = collision_shape_generator,
+        .thread_pool                 = context.thread_pool
     };
 
     const auto brush = allocate_brush(context.build_info);
@@ -349,7 +340,10 @@ auto Brushes::get_brush_transform() -> mat4
     const mat4 inverse_brush   = inverse(brush_transform);
     const mat4 align           = hover_transform * inverse_brush;
 
-    return align;
+    // Brush geometry is shared by all scales, scale is part of the transform
+    return (scale != 1.0f)
+        ? align * erhe::toolkit::create_scale(scale)
+        : align;
 }
 
 void Brushes::update_mesh_node_transform()
@@ -363,7 +357,6 @@ void Brushes::update_mesh_node_transform()
     ERHE_VERIFY(m_hover_mesh);
 
     const auto  transform    = get_brush_transform();
-    const auto& brush_scaled = m_brush->get_scaled(m_transform_scale);
     const auto& brush_parent = m_brush_mesh->parent().lock();
     if (brush_parent != m_hover_mesh)
     {
@@ -399,12 +392,6 @@ void Brushes::update_mesh_node_transform()
         }
     }
     m_brush_mesh->set_parent_from_node(transform);
-
-    auto& primitive = m_brush_mesh->mesh_data.primitives.front();
-    primitive.gl_primitive_geometry = brush_scaled.gl_primitive_geometry;
-    primitive.rt_primitive_geometry = brush_scaled.rt_primitive->primitive_geometry;
-    primitive.rt_vertex_buffer      = brush_scaled.rt_primitive->vertex_buffer;
-    primitive.rt_index_buffer       = brush_scaled.rt_primitive->index_buffer;
 }
 
 void Brushes::do_insert_operation()
@@ -437,8 +424,7 @@ void Brushes::do_insert_operation()
         .node_visibility_flags = visibility_flags,
         .physics_world         = m_scene_root->physics_world(),
         .world_from_node       = m_hover_mesh->world_from_node() * hover_from_brush,
-        .material              = m_materials->selected_material(),
-        .scale                 = m_transform_scale
+        .material              = m_materials->selected_material()
     };
     const auto instance = m_brush->make_instance(brush_instance_create_info);
 
@@ -474,16 +460,15 @@ void Brushes::add_brush_mesh()
         return;
     }
 
-    const auto& brush_scaled = m_brush->get_scaled(m_transform_scale);
     m_brush_mesh = std::make_shared<erhe::scene::Mesh>(
         m_brush->name(),
         erhe::primitive::Primitive{
             .material              = material,
-            .gl_primitive_geometry = brush_scaled.gl_primitive_geometry,
-            .rt_primitive_geometry = brush_scaled.rt_primitive->primitive_geometry,
-            .rt_vertex_buffer      = brush_scaled.rt_primitive->vertex_buffer,
-            .rt_index_buffer       = brush_scaled.rt_primitive->index_buffer,
-            .source_geometry       = brush_scaled.geometry,
+            .gl_primitive_geometry = m_brush->gl_primitive_geometry,
+            .rt_primitive_geometry = m_brush->rt_primitive->primitive_geometry,
+            .rt_vertex_buffer      = m_brush->rt_primitive->vertex_buffer,
+            .rt_index_buffer       = m_brush->rt_primitive->index_buffer,
+            .source_geometry       = m_brush->geometry,
             .normal_style          = m_brush->normal_style
         }
     );
@@ -15,6 +15,11 @@
 #include <mutex>
 #include <vector>
 
+namespace erhe::concurrency
+{
+    class Thread_pool;
+}
+
 namespace erhe::geometry
 {
     class Geometry;
@@ -87,8 +92,9 @@ private:
 class Brush_create_context
 {
 public:
-    erhe::primitive::Build_info&  build_info;
-    erhe::primitive::Normal_style normal_style{erhe::primitive::Normal_style::corner_normals};
+    erhe::primitive::Build_info&    build_info;
+    erhe::primitive::Normal_style   normal_style{erhe::primitive::Normal_style::corner_normals};
+    erhe::concurrency::Thread_pool* thread_pool {nullptr};
 };
 
 class Brushes
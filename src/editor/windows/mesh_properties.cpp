@@ -93,7 +93,7 @@ void Mesh_properties::tool_render(
         const glm::mat4 world_from_node = mesh->world_from_node();
         for (auto& primitive : mesh->mesh_data.primitives)
         {
-            const auto& geometry = primitive.source_geometry;
+            const auto geometry = primitive.get_geometry();
             if (!geometry)
             {
                 continue;
@@ -138,6 +138,7 @@ void Mesh_properties::tool_render(
 
             if ((point_locations != nullptr) && m_show_edges)
             {
+                geometry->ensure(erhe::geometry::Derived::edges);
                 const uint32_t end = (std::min)(
                     static_cast<uint32_t>(m_max_labels),
                     geometry->get_edge_count()
@@ -272,7 +272,7 @@ void Node_properties::mesh_properties(erhe::scene::Mesh& mesh) const
     {
         for (auto& primitive : mesh_data.primitives)
         {
-            const auto& geometry = primitive.source_geometry;
+            const auto geometry = primitive.get_geometry();
             if (geometry)
             {
                 if (
@@ -118,7 +118,9 @@ Configuration::Configuration(int argc, char** argv)
         if (ini.has("threading"))
         {
             const auto& section = ini["threading"];
-            ini_get(section, "parallel_init", threading.parallel_initialization);
+            ini_get(section, "parallel_init",             threading.parallel_initialization);
+            ini_get(section, "parallel_transform_update", threading.parallel_transform_update);
+            ini_get(section, "parallel_draw_lists",       threading.parallel_draw_lists);
         }
         if (ini.has("graphics"))
         {
@@ -167,11 +169,15 @@ Configuration::Configuration(int argc, char** argv)
         if (ini.has("renderer"))
         {
             const auto& section = ini["renderer"];
-            ini_get(section, "max_material_count",  renderer.max_material_count );
-            ini_get(section, "max_light_count",     renderer.max_light_count    );
-            ini_get(section, "max_camera_count",    renderer.max_camera_count   );
-            ini_get(section, "max_primitive_count", renderer.max_primitive_count);
-            ini_get(section, "max_draw_count",      renderer.max_draw_count     );
+            ini_get(section, "max_material_count",          renderer.max_material_count         );
+            ini_get(section, "max_light_count",             renderer.max_light_count            );
+            ini_get(section, "max_camera_count",            renderer.max_camera_count           );
+            ini_get(section, "max_primitive_count",         renderer.max_primitive_count        );
+            ini_get(section, "max_draw_count",              renderer.max_draw_count             );
+            ini_get(section, "cpu_frustum_culling",         renderer.cpu_frustum_culling        );
+            ini_get(section, "cpu_occlusion_culling",       renderer.cpu_occlusion_culling      );
+            ini_get(section, "light_clusters",              renderer.light_clusters             );
+            ini_get(section, "persistent_primitive_buffer", renderer.persistent_primitive_buffer);
         }
 
         if (ini.has("physics"))
@@ -226,6 +232,7 @@ Configuration::Configuration(int argc, char** argv)
             ini_get(section, "instance_gap",                scene.instance_gap);
             ini_get(section, "detail",                      scene.detail);
             ini_get(section, "gltf_files",                  scene.gltf_files);
+            ini_get(section, "gltf_direct",                 scene.gltf_direct);
             ini_get(section, "obj_files",                   scene.obj_files);
             ini_get(section, "floor",                       scene.floor);
             ini_get(section, "sphere",                      scene.sphere);
@@ -234,6 +241,8 @@ Configuration::Configuration(int argc, char** argv)
             ini_get(section, "cone",                        scene.cone);
             ini_get(section, "platonic_solids",             scene.platonic_solids);
             ini_get(section, "johnson_solids",              scene.johnson_solids);
+            ini_get(section, "mesh_cache",                  scene.mesh_cache);
+            ini_get(section, "mesh_cache_directory",        scene.mesh_cache_directory);
         }
 
         if (ini.has("viewport"))
@@ -50,7 +50,9 @@ public:
     class Threading
     {
     public:
-        bool parallel_initialization{true};
+        bool parallel_initialization  {true};
+        bool parallel_transform_update{true};
+        bool parallel_draw_lists      {true};
     };
     Threading threading;
 
@@ -109,11 +111,15 @@ public:
     class Renderer
     {
     public:
-        int max_material_count  {256};
-        int max_light_count     {256};
-        int max_camera_count    {256};
-        int max_primitive_count {8000}; // GLTF primitives
-        int max_draw_count      {8000};
+        int  max_material_count         {256};
+        int  max_light_count            {256};
+        int  max_camera_count           {256};
+        int  max_primitive_count        {8000}; // GLTF primitives
+        int  max_draw_count             {8000};
+        bool cpu_frustum_culling        {true};
+        bool cpu_occlusion_culling      {true}; // requires cpu_frustum_culling
+        bool light_clusters             {true};
+        bool persistent_primitive_buffer{true};
     };
     Renderer renderer;
 
@@ -142,6 +148,7 @@ public:
         int   detail                     {2};
         bool  floor                      {true};
         bool  gltf_files                 {false};
+        bool  gltf_direct                {false};
         bool  obj_files                  {false};
         bool  sphere                     {false};
         bool  torus                      {false};
@@ -149,6 +156,8 @@ public:
         bool  cone                       {false};
         bool  platonic_solids            {true};
         bool  johnson_solids             {false};
+        bool  mesh_cache                 {false};
+        std::string mesh_cache_directory {"cache"};
     };
     Scene scene;
 
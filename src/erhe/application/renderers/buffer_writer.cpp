@@ -53,6 +53,7 @@ void Buffer_writer::reset()
 {
     range.first_byte_offset = 0;
     range.byte_count        = 0;
+    range.buffer            = nullptr;
     write_offset            = 0;
 }
 
@@ -4,14 +4,20 @@
 
 #include <cstddef>
 
+namespace erhe::graphics
+{
+    class Buffer;
+}
+
 namespace erhe::application
 {
 
 class Buffer_range
 {
 public:
-    std::size_t first_byte_offset{0};
-    std::size_t byte_count       {0};
+    std::size_t             first_byte_offset{0};
+    std::size_t             byte_count       {0};
+    erhe::graphics::Buffer* buffer           {nullptr}; // set when owner may replace its buffer
 };
 
 class Buffer_writer
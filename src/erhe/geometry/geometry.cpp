@@ -11,6 +11,7 @@
 #   include <Mathematics/PolyhedralMassProperties.h>
 #endif
 
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 #include <sstream>
@@ -24,6 +25,27 @@ using glm::vec4;
 using glm::mat3;
 using glm::mat4;
 
+namespace
+{
+
+// True if m is rotation and uniform scale, possibly with reflection
+auto is_similarity(const mat3& m) -> bool
+{
+    const float epsilon = 1e-5f;
+    const float xx      = glm::dot(m[0], m[0]);
+    const float yy      = glm::dot(m[1], m[1]);
+    const float zz      = glm::dot(m[2], m[2]);
+    const float scale   = std::max(xx, std::max(yy, zz)) * epsilon;
+    return
+        (std::abs(xx - yy) <= scale) &&
+        (std::abs(xx - zz) <= scale) &&
+        (std::abs(glm::dot(m[0], m[1])) <= scale) &&
+        (std::abs(glm::dot(m[0], m[2])) <= scale) &&
+        (std::abs(glm::dot(m[1], m[2])) <= scale);
+}
+
+} // anonymous namespace
+
 Geometry::Geometry() = default;
 
 Geometry::Geometry(
@@ -553,6 +575,13 @@ auto Geometry::transform(const mat4& m) -> Geometry&
         reverse_polygons();
     }
 
+    // Normals and centroids follow any affine transform, but tangents
+    // and averaged normals are only preserved by similarity transforms
+    if (!is_similarity(mat3{m}))
+    {
+        invalidate_point_locations();
+    }
+
     return *this;
 }
 
@@ -570,14 +599,13 @@ void Geometry::flip_reversed_polygons()
 {
     ERHE_PROFILE_FUNCTION
 
-    ++m_serial;
-
     compute_polygon_normals();
     compute_polygon_centroids();
 
     const auto* const polygon_normals   = polygon_attributes().find_or_create<vec3>(c_polygon_normals);
     const auto* const polygon_centroids = polygon_attributes().find_or_create<vec3>(c_polygon_centroids);
 
+    bool flipped{false};
     for (Polygon_id polygon_id = 0; polygon_id < m_next_polygon_id; ++polygon_id)
     {
         const auto normal   = polygon_normals->get(polygon_id);
@@ -585,8 +613,15 @@ void Geometry::flip_reversed_polygons()
         if (glm::dot(normal, centroid) < 0.0f)
         {
             polygons[polygon_id].reverse(*this);
+            flipped = true;
         }
     }
+
+    // Derived data, such as tangents, is kept if nothing was flipped
+    if (flipped)
+    {
+        ++m_serial;
+    }
 }
 
 void Mesh_info::trace(const std::shared_ptr<spdlog::logger>& log) const
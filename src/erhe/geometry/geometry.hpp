@@ -7,7 +7,9 @@
 
 #include <glm/glm.hpp>
 #include <gsl/assert>
+#include <gsl/span>
 
+#include <cstddef>
 #include <functional>
 #include <set>
 #include <string_view>
@@ -17,6 +19,10 @@ namespace spdlog {
     class logger;
 }
 
+namespace erhe::concurrency {
+    class Concurrent_queue;
+}
+
 namespace erhe::geometry
 {
 
@@ -41,6 +47,22 @@ inline constexpr Property_map_descriptor c_polygon_colors      { "polygon_colors
 inline constexpr Property_map_descriptor c_polygon_ids_vec3    { "polygon_ids_vec"     , Transform_mode::none                                         , Interpolation_mode::none };
 inline constexpr Property_map_descriptor c_polygon_ids_uint    { "polygon_ids_uint"    , Transform_mode::none                                         , Interpolation_mode::none };
 
+// Data which Geometry computes from points, polygons and point
+// locations. Each kind has inputs, which may be other derived data;
+// see Geometry::ensure().
+enum class Derived : unsigned int
+{
+    edges                       = 0, // inputs: polygons
+    polygon_normals             = 1, // inputs: polygons, point locations
+    polygon_centroids           = 2, // inputs: polygons, point locations
+    point_normals_smooth        = 3, // inputs: polygon normals
+    polygon_texture_coordinates = 4, // inputs: polygon normals, polygon centroids
+    tangents                    = 5, // inputs: all of above except edges
+    count                       = 6
+};
+
+[[nodiscard]] auto c_str(const Derived derived) -> const char*;
+
 class Point;
 class Polygon;
 class Geometry;
@@ -615,6 +637,19 @@ public:
 
     auto make_polygon_reverse(const std::initializer_list<Point_id> point_list) -> Polygon_id;
 
+    // Derived data is computed on first use: consumers call ensure()
+    // instead of calling compute functions below in the right order.
+    // ensure() computes inputs first, and does nothing if derived data
+    // is already up to date. Any change to polygons invalidates all
+    // derived data; invalidate() invalidates derived data and all
+    // derived data which uses it as input.
+    [[nodiscard]] auto has       (const Derived derived) const -> bool;
+    auto               ensure    (const Derived derived) -> bool;
+    void               invalidate(const Derived derived);
+
+    // Call after point locations have been modified in place
+    void invalidate_point_locations();
+
     // Requires point locations.
     // Returns false if point locations are not available.
     // Returns true on success.
@@ -647,13 +682,16 @@ public:
     [[nodiscard]] auto has_corner_tangents   () const -> bool;
     [[nodiscard]] auto has_corner_bitangents () const -> bool;
 
+    // Uses MikkTSpace. Connected components are processed in batches,
+    // concurrently if queue is given.
     auto compute_tangents(
-        const bool corner_tangents    = true,
-        const bool corner_bitangents  = true,
-        const bool polygon_tangents   = false,
-        const bool polygon_bitangents = false,
-        const bool make_polygons_flat = true,
-        const bool override_existing  = false
+        const bool                           corner_tangents    = true,
+        const bool                           corner_bitangents  = true,
+        const bool                           polygon_tangents   = false,
+        const bool                           polygon_bitangents = false,
+        const bool                           make_polygons_flat = true,
+        const bool                           override_existing  = false,
+        erhe::concurrency::Concurrent_queue* queue              = nullptr
     ) -> bool;
 
     auto generate_polygon_texture_coordinates(const bool overwrite_existing_texture_coordinates = false) -> bool;
@@ -698,6 +736,18 @@ public:
 
     void merge(Geometry& other, const glm::mat4 transform);
 
+    // Binary snapshot of geometry, including edges, and property maps
+    // with float, vec2, vec3 or vec4 values. Snapshot is meant to be
+    // read back by same build of erhe on same platform, like a cache.
+    [[nodiscard]] auto serialize() const -> std::vector<std::byte>;
+
+    // Changes when serialize() output format changes; include in cache keys
+    [[nodiscard]] static auto serialize_format() -> uint64_t;
+
+    // Restores serialize() output to empty geometry. Returns false if
+    // data is not valid; geometry is left in unspecified state.
+    auto deserialize(const gsl::span<const std::byte> data) -> bool;
+
     class Weld_settings
     {
     public:
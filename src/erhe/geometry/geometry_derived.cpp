@@ -0,0 +1,221 @@
+#include "erhe/geometry/geometry.hpp"
+#include "erhe/toolkit/profile.hpp"
+
+#include <array>
+
+namespace erhe::geometry
+{
+
+namespace
+{
+
+constexpr auto index(const Derived derived) -> std::size_t
+{
+    return static_cast<std::size_t>(derived);
+}
+
+constexpr auto bit(const Derived derived) -> uint32_t
+{
+    return 1u << static_cast<unsigned int>(derived);
+}
+
+constexpr std::size_t c_derived_count = index(Derived::count);
+
+template <typename Key_type>
+void clear_map(Property_map<Key_type, glm::vec4>* map)
+{
+    if (map != nullptr)
+    {
+        map->clear();
+    }
+}
+
+// compute_tangents() keeps values which are already present,
+// so stale tangents must be removed before they are recomputed.
+void clear_tangents(Geometry& geometry)
+{
+    clear_map(geometry.polygon_attributes().find<glm::vec4>(c_polygon_tangents  ));
+    clear_map(geometry.polygon_attributes().find<glm::vec4>(c_polygon_bitangents));
+    clear_map(geometry.corner_attributes ().find<glm::vec4>(c_corner_tangents   ));
+    clear_map(geometry.corner_attributes ().find<glm::vec4>(c_corner_bitangents ));
+}
+
+// Derived data used as input by each kind of derived data
+constexpr std::array<uint32_t, c_derived_count> c_derived_inputs{
+    0, // edges
+    0, // polygon_normals
+    0, // polygon_centroids
+    bit(Derived::polygon_normals), // point_normals_smooth
+    bit(Derived::polygon_normals) | bit(Derived::polygon_centroids), // polygon_texture_coordinates
+    bit(Derived::polygon_normals) | bit(Derived::polygon_centroids) | bit(Derived::point_normals_smooth) | bit(Derived::polygon_texture_coordinates) // tangents
+};
+
+// Derived data which uses derived as input, directly or indirectly;
+// this is what invalidate(derived) invalidates in addition to derived
+constexpr auto get_dependents(const Derived derived) -> uint32_t
+{
+    uint32_t result{0};
+    uint32_t inputs{bit(derived)};
+    for (std::size_t pass = 0; pass < c_derived_count; ++pass)
+    {
+        for (std::size_t i = 0; i < c_derived_count; ++i)
+        {
+            if ((c_derived_inputs[i] & inputs) != 0)
+            {
+                result |= 1u << static_cast<unsigned int>(i);
+            }
+        }
+        inputs = bit(derived) | result;
+    }
+    return result;
+}
+
+constexpr auto is_acyclic() -> bool
+{
+    for (std::size_t i = 0; i < c_derived_count; ++i)
+    {
+        const auto derived = static_cast<Derived>(i);
+        if ((get_dependents(derived) & bit(derived)) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks for dependency table; ensure() and invalidate() recurse over it
+static_assert(is_acyclic());
+static_assert(get_dependents(Derived::edges) == 0);
+static_assert(get_dependents(Derived::tangents) == 0);
+static_assert((get_dependents(Derived::polygon_normals  ) & bit(Derived::tangents)) != 0);
+static_assert((get_dependents(Derived::polygon_normals  ) & bit(Derived::point_normals_smooth)) != 0);
+static_assert((get_dependents(Derived::polygon_centroids) & bit(Derived::polygon_texture_coordinates)) != 0);
+static_assert((get_dependents(Derived::polygon_centroids) & bit(Derived::tangents)) != 0);
+
+} // anonymous namespace
+
+auto c_str(const Derived derived) -> const char*
+{
+    switch (derived)
+    {
+        case Derived::edges:                       return "edges";
+        case Derived::polygon_normals:             return "polygon_normals";
+        case Derived::polygon_centroids:           return "polygon_centroids";
+        case Derived::point_normals_smooth:        return "point_normals_smooth";
+        case Derived::polygon_texture_coordinates: return "polygon_texture_coordinates";
+        case Derived::tangents:                    return "tangents";
+        default: return "?";
+    }
+}
+
+auto Geometry::has(const Derived derived) const -> bool
+{
+    switch (derived)
+    {
+        case Derived::edges:                       return has_edges();
+        case Derived::polygon_normals:             return has_polygon_normals();
+        case Derived::polygon_centroids:           return has_polygon_centroids();
+        case Derived::point_normals_smooth:        return has_point_normals();
+        case Derived::polygon_texture_coordinates: return has_polygon_texture_coordinates();
+        case Derived::tangents:                    return has_corner_tangents() && has_corner_bitangents();
+        default: return false;
+    }
+}
+
+auto Geometry::ensure(const Derived derived) -> bool
+{
+    ERHE_PROFILE_FUNCTION
+
+    if (has(derived))
+    {
+        return true;
+    }
+
+    const uint32_t inputs = c_derived_inputs[index(derived)];
+    for (std::size_t i = 0; i < c_derived_count; ++i)
+    {
+        const auto input = static_cast<Derived>(i);
+        if (((inputs & bit(input)) != 0) && !ensure(input))
+        {
+            return false;
+        }
+    }
+
+    switch (derived)
+    {
+        case Derived::edges:                       build_edges(); return true;
+        case Derived::polygon_normals:             return compute_polygon_normals();
+        case Derived::polygon_centroids:           return compute_polygon_centroids();
+        case Derived::point_normals_smooth:        return compute_point_normals(c_point_normals_smooth);
+        case Derived::polygon_texture_coordinates: return generate_polygon_texture_coordinates();
+        case Derived::tangents:
+        {
+            clear_tangents(*this);
+            return compute_tangents();
+        }
+        default: return false;
+    }
+}
+
+void Geometry::invalidate(const Derived derived)
+{
+    // Serial 0 never matches m_serial
+    switch (derived)
+    {
+        case Derived::edges:
+        {
+            m_serial_edges = 0;
+            break;
+        }
+        case Derived::polygon_normals:
+        {
+            m_serial_polygon_normals = 0;
+            break;
+        }
+        case Derived::polygon_centroids:
+        {
+            m_serial_polygon_centroids = 0;
+            break;
+        }
+        case Derived::point_normals_smooth:
+        {
+            m_serial_point_normals        = 0;
+            m_serial_smooth_point_normals = 0;
+            break;
+        }
+        case Derived::polygon_texture_coordinates:
+        {
+            m_serial_polygon_texture_coordinates = 0;
+            break;
+        }
+        case Derived::tangents:
+        {
+            m_serial_polygon_tangents   = 0;
+            m_serial_polygon_bitangents = 0;
+            m_serial_corner_tangents    = 0;
+            m_serial_corner_bitangents  = 0;
+            clear_tangents(*this);
+            break;
+        }
+        default:
+        {
+            return;
+        }
+    }
+
+    for (std::size_t i = 0; i < c_derived_count; ++i)
+    {
+        if ((c_derived_inputs[i] & bit(derived)) != 0)
+        {
+            invalidate(static_cast<Derived>(i));
+        }
+    }
+}
+
+void Geometry::invalidate_point_locations()
+{
+    invalidate(Derived::polygon_normals);
+    invalidate(Derived::polygon_centroids);
+}
+
+} // namespace erhe::geometry
@@ -0,0 +1,629 @@
+#include "erhe/geometry/geometry.hpp"
+#include "erhe/geometry/geometry_log.hpp"
+#include "erhe/toolkit/profile.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace erhe::geometry
+{
+
+// Snapshot layout; all values are in native byte order, and every
+// array starts at multiple of 8 bytes:
+//
+//   uint32 magic, uint32 version, uint32 layout
+//   string name
+//   uint32 id counters (see c_counter_count)
+//   uint32 valid bits (see Valid_bit)
+//   array  corners, points, polygons, edges,
+//          point_corners, polygon_corners, edge_polygons
+//   4 x property map collection (point, corner, polygon, edge):
+//       uint32 map count
+//       per map: string name, uint32 value type, uint64 value count,
+//                values, present flags as one byte per key
+//
+// string is uint32 length and characters, array is uint64 element
+// count and elements.
+
+namespace
+{
+
+constexpr uint32_t c_magic  {0x4f454745u}; // "EGEO"
+constexpr uint32_t c_version{2};              // Bump when layout or member order of stored classes changes
+
+// Corner, Point, Polygon and Edge are stored as raw bytes; their sizes
+// catch most layout changes even if c_version was not bumped
+constexpr uint32_t c_layout{
+    static_cast<uint32_t>(sizeof(Corner )      ) |
+    static_cast<uint32_t>(sizeof(Point  ) <<  8) |
+    static_cast<uint32_t>(sizeof(Polygon) << 16) |
+    static_cast<uint32_t>(sizeof(Edge   ) << 24)
+};
+static_assert(sizeof(Corner) < 256 && sizeof(Point) < 256 && sizeof(Polygon) < 256 && sizeof(Edge) < 256);
+
+enum class Stored_type : uint32_t
+{
+    float_ = 1,
+    vec2   = 2,
+    vec3   = 3,
+    vec4   = 4
+};
+
+// Derived data which is marked valid in loaded geometry
+enum class Valid_bit : uint32_t
+{
+    edges                      = 1u << 0,
+    polygon_normals            = 1u << 1,
+    polygon_centroids          = 1u << 2,
+    polygon_tangents           = 1u << 3,
+    polygon_bitangents         = 1u << 4,
+    polygon_texture_coordinates = 1u << 5,
+    point_normals              = 1u << 6,
+    smooth_point_normals       = 1u << 7,
+    corner_normals             = 1u << 8,
+    corner_tangents            = 1u << 9,
+    corner_bitangents          = 1u << 10,
+    corner_texture_coordinates = 1u << 11
+};
+
+static_assert(std::is_trivially_copyable_v<Corner>);
+static_assert(std::is_trivially_copyable_v<Point>);
+static_assert(std::is_trivially_copyable_v<Polygon>);
+static_assert(std::is_trivially_copyable_v<Edge>);
+
+// Property maps are restored with these descriptors, matched by name
+constexpr std::array<const Property_map_descriptor*, 20> c_known_descriptors{
+    &c_point_locations,
+    &c_point_normals,
+    &c_point_normals_smooth,
+    &c_point_texcoords,
+    &c_point_tangents,
+    &c_point_bitangents,
+    &c_point_colors,
+    &c_corner_normals,
+    &c_corner_texcoords,
+    &c_corner_tangents,
+    &c_corner_bitangents,
+    &c_corner_colors,
+    &c_corner_indices,
+    &c_polygon_centroids,
+    &c_polygon_normals,
+    &c_polygon_tangents,
+    &c_polygon_bitangents,
+    &c_polygon_colors,
+    &c_polygon_ids_vec3,
+    &c_polygon_ids_uint
+};
+
+auto find_descriptor(const std::string_view name) -> const Property_map_descriptor*
+{
+    for (const auto* descriptor : c_known_descriptors)
+    {
+        if (name == descriptor->name)
+        {
+            return descriptor;
+        }
+    }
+    return nullptr;
+}
+
+class Writer
+{
+public:
+    explicit Writer(std::vector<std::byte>& out)
+        : m_out{out}
+    {
+    }
+
+    template <typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write_bytes(&value, sizeof(T));
+    }
+
+    void write_string(const std::string_view text)
+    {
+        write(static_cast<uint32_t>(text.size()));
+        write_bytes(text.data(), text.size());
+    }
+
+    template <typename T>
+    void write_array(const T* data, const std::size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(static_cast<uint64_t>(count));
+        align();
+        write_bytes(data, count * sizeof(T));
+    }
+
+    void align()
+    {
+        m_out.resize((m_out.size() + 7) & ~std::size_t{7}, std::byte{0});
+    }
+
+private:
+    void write_bytes(const void* data, const std::size_t byte_count)
+    {
+        const std::size_t offset = m_out.size();
+        m_out.resize(offset + byte_count);
+        if (byte_count > 0)
+        {
+            std::memcpy(m_out.data() + offset, data, byte_count);
+        }
+    }
+
+    std::vector<std::byte>& m_out;
+};
+
+// All reads are bounds checked; after a failed read, ok() stays false
+class Reader
+{
+public:
+    explicit Reader(const gsl::span<const std::byte> data)
+        : m_data{data}
+    {
+    }
+
+    [[nodiscard]] auto ok() const -> bool
+    {
+        return m_ok;
+    }
+
+    template <typename T>
+    auto read(T& value) -> bool
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return read_bytes(&value, sizeof(T));
+    }
+
+    auto read_string(std::string& text) -> bool
+    {
+        uint32_t length{0};
+        if (!read(length) || !check(length))
+        {
+            return false;
+        }
+        text.assign(reinterpret_cast<const char*>(m_data.data() + m_offset), length);
+        m_offset += length;
+        return true;
+    }
+
+    template <typename T>
+    auto read_array(std::vector<T>& values) -> bool
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        uint64_t count{0};
+        if (!read(count))
+        {
+            return false;
+        }
+        align();
+        if ((count > (m_data.size() / sizeof(T))) || !check(static_cast<std::size_t>(count) * sizeof(T)))
+        {
+            return fail();
+        }
+        values.resize(static_cast<std::size_t>(count));
+        return read_bytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void align()
+    {
+        m_offset = (m_offset + 7) & ~std::size_t{7};
+    }
+
+private:
+    auto fail() -> bool
+    {
+        m_ok = false;
+        return false;
+    }
+
+    auto check(const std::size_t byte_count) -> bool
+    {
+        if (!m_ok || (m_offset > m_data.size()) || (byte_count > m_data.size() - m_offset))
+        {
+            return fail();
+        }
+        return true;
+    }
+
+    auto read_bytes(void* out, const std::size_t byte_count) -> bool
+    {
+        if (!check(byte_count))
+        {
+            return false;
+        }
+        if (byte_count > 0)
+        {
+            std::memcpy(out, m_data.data() + m_offset, byte_count);
+        }
+        m_offset += byte_count;
+        return true;
+    }
+
+    gsl::span<const std::byte> m_data;
+    std::size_t                m_offset{0};
+    bool                       m_ok    {true};
+};
+
+template <typename Key_type, typename Value_type>
+void write_map(
+    Writer&                                   writer,
+    const Property_map<Key_type, Value_type>& map,
+    const Stored_type                         stored_type
+)
+{
+    std::vector<uint8_t> present(map.present.size());
+    for (std::size_t i = 0, end = present.size(); i < end; ++i)
+    {
+        present[i] = map.present[i] ? 1 : 0;
+    }
+    writer.write_string(map.descriptor().name);
+    writer.write(static_cast<uint32_t>(stored_type));
+    writer.write_array(map.values.data(), map.values.size());
+    writer.write_array(present.data(), present.size());
+}
+
+template <typename Key_type>
+void write_collection(
+    Writer&                                  writer,
+    const Property_map_collection<Key_type>& collection
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    using Float_map = Property_map<Key_type, float>;
+    using Vec2_map  = Property_map<Key_type, glm::vec2>;
+    using Vec3_map  = Property_map<Key_type, glm::vec3>;
+    using Vec4_map  = Property_map<Key_type, glm::vec4>;
+
+    // Maps of other value types and unknown names are left out
+    std::vector<const Property_map_base<Key_type>*> maps;
+    for (std::size_t i = 0, end = collection.size(); i < end; ++i)
+    {
+        const auto* map = collection.get(i);
+        if (find_descriptor(map->descriptor().name) == nullptr)
+        {
+            log_geometry->warn("Property map {} is not serialized", map->descriptor().name);
+            continue;
+        }
+        if (
+            (dynamic_cast<const Float_map*>(map) != nullptr) ||
+            (dynamic_cast<const Vec2_map* >(map) != nullptr) ||
+            (dynamic_cast<const Vec3_map* >(map) != nullptr) ||
+            (dynamic_cast<const Vec4_map* >(map) != nullptr)
+        )
+        {
+            maps.push_back(map);
+        }
+        else
+        {
+            log_geometry->warn("Property map {} value type is not serialized", map->descriptor().name);
+        }
+    }
+
+    writer.write(static_cast<uint32_t>(maps.size()));
+    for (const auto* map : maps)
+    {
+        if (const auto* float_map = dynamic_cast<const Float_map*>(map))
+        {
+            write_map(writer, *float_map, Stored_type::float_);
+        }
+        else if (const auto* vec2_map = dynamic_cast<const Vec2_map*>(map))
+        {
+            write_map(writer, *vec2_map, Stored_type::vec2);
+        }
+        else if (const auto* vec3_map = dynamic_cast<const Vec3_map*>(map))
+        {
+            write_map(writer, *vec3_map, Stored_type::vec3);
+        }
+        else if (const auto* vec4_map = dynamic_cast<const Vec4_map*>(map))
+        {
+            write_map(writer, *vec4_map, Stored_type::vec4);
+        }
+    }
+}
+
+template <typename Key_type, typename Value_type>
+auto read_map(
+    Reader&                            reader,
+    Property_map_collection<Key_type>& collection,
+    const Property_map_descriptor&     descriptor
+) -> bool
+{
+    std::vector<Value_type> values;
+    std::vector<uint8_t>    present;
+    if (
+        !reader.read_array(values) ||
+        !reader.read_array(present) ||
+        (present.size() != values.size())
+    )
+    {
+        return false;
+    }
+
+    auto* map = collection.template create<Value_type>(descriptor);
+    map->values = std::move(values);
+    map->present.resize(present.size());
+    for (std::size_t i = 0, end = present.size(); i < end; ++i)
+    {
+        map->present[i] = (present[i] != 0);
+    }
+    return true;
+}
+
+template <typename Key_type>
+auto read_collection(
+    Reader&                            reader,
+    Property_map_collection<Key_type>& collection
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION
+
+    uint32_t map_count{0};
+    if (!reader.read(map_count))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < map_count; ++i)
+    {
+        std::string name;
+        uint32_t    stored_type{0};
+        if (!reader.read_string(name) || !reader.read(stored_type))
+        {
+            return false;
+        }
+        const Property_map_descriptor* descriptor = find_descriptor(name);
+        if ((descriptor == nullptr) || collection.contains(name))
+        {
+            log_geometry->warn("Unexpected property map {}", name);
+            return false;
+        }
+        bool ok{false};
+        switch (static_cast<Stored_type>(stored_type))
+        {
+            case Stored_type::float_: ok = read_map<Key_type, float    >(reader, collection, *descriptor); break;
+            case Stored_type::vec2:   ok = read_map<Key_type, glm::vec2>(reader, collection, *descriptor); break;
+            case Stored_type::vec3:   ok = read_map<Key_type, glm::vec3>(reader, collection, *descriptor); break;
+            case Stored_type::vec4:   ok = read_map<Key_type, glm::vec4>(reader, collection, *descriptor); break;
+            default: break;
+        }
+        if (!ok)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Id ranges are checked in 64 bits, so that they can not wrap around
+auto is_range_valid(const uint32_t first, const uint32_t count, const uint32_t end) -> bool
+{
+    return static_cast<uint64_t>(first) + static_cast<uint64_t>(count) <= static_cast<uint64_t>(end);
+}
+
+} // anonymous namespace
+
+auto Geometry::serialize_format() -> uint64_t
+{
+    return (static_cast<uint64_t>(c_version) << 32u) | static_cast<uint64_t>(c_layout);
+}
+
+auto Geometry::serialize() const -> std::vector<std::byte>
+{
+    ERHE_PROFILE_FUNCTION
+
+    std::vector<std::byte> result;
+    Writer writer{result};
+
+    writer.write(c_magic);
+    writer.write(c_version);
+    writer.write(c_layout);
+    writer.write_string(name);
+
+    writer.write(m_next_corner_id);
+    writer.write(m_next_point_id);
+    writer.write(m_next_polygon_id);
+    writer.write(m_next_edge_id);
+    writer.write(m_next_point_corner_reserve);
+    writer.write(m_next_polygon_corner_id);
+    writer.write(m_next_edge_polygon_id);
+    writer.write(m_polygon_corner_polygon);
+    writer.write(m_edge_polygon_edge);
+
+    const auto valid_bit = [this](const uint64_t serial, const Valid_bit bit) -> uint32_t
+    {
+        return (serial == m_serial) ? static_cast<uint32_t>(bit) : 0u;
+    };
+    const uint32_t valid_bits =
+        valid_bit(m_serial_edges,                       Valid_bit::edges                      ) |
+        valid_bit(m_serial_polygon_normals,             Valid_bit::polygon_normals            ) |
+        valid_bit(m_serial_polygon_centroids,           Valid_bit::polygon_centroids          ) |
+        valid_bit(m_serial_polygon_tangents,            Valid_bit::polygon_tangents           ) |
+        valid_bit(m_serial_polygon_bitangents,          Valid_bit::polygon_bitangents         ) |
+        valid_bit(m_serial_polygon_texture_coordinates, Valid_bit::polygon_texture_coordinates) |
+        valid_bit(m_serial_point_normals,               Valid_bit::point_normals              ) |
+        valid_bit(m_serial_smooth_point_normals,        Valid_bit::smooth_point_normals       ) |
+        valid_bit(m_serial_corner_normals,              Valid_bit::corner_normals             ) |
+        valid_bit(m_serial_corner_tangents,             Valid_bit::corner_tangents            ) |
+        valid_bit(m_serial_corner_bitangents,           Valid_bit::corner_bitangents          ) |
+        valid_bit(m_serial_corner_texture_coordinates,  Valid_bit::corner_texture_coordinates );
+    writer.write(valid_bits);
+
+    writer.write_array(corners        .data(), corners        .size());
+    writer.write_array(points         .data(), points         .size());
+    writer.write_array(polygons       .data(), polygons       .size());
+    writer.write_array(edges          .data(), edges          .size());
+    writer.write_array(point_corners  .data(), point_corners  .size());
+    writer.write_array(polygon_corners.data(), polygon_corners.size());
+    writer.write_array(edge_polygons  .data(), edge_polygons  .size());
+
+    write_collection(writer, m_point_property_map_collection);
+    write_collection(writer, m_corner_property_map_collection);
+    write_collection(writer, m_polygon_property_map_collection);
+    write_collection(writer, m_edge_property_map_collection);
+    writer.align();
+    return result;
+}
+
+auto Geometry::deserialize(const gsl::span<const std::byte> data) -> bool
+{
+    ERHE_PROFILE_FUNCTION
+
+    Expects(get_corner_count() == 0);
+    Expects(get_polygon_count() == 0);
+
+    Reader   reader{data};
+    uint32_t magic  {0};
+    uint32_t version{0};
+    uint32_t layout {0};
+    if (
+        !reader.read(magic) ||
+        !reader.read(version) ||
+        !reader.read(layout) ||
+        (magic   != c_magic) ||
+        (version != c_version) ||
+        (layout  != c_layout)
+    )
+    {
+        return false;
+    }
+
+    uint32_t valid_bits{0};
+    const bool header_ok =
+        reader.read_string(name) &&
+        reader.read(m_next_corner_id) &&
+        reader.read(m_next_point_id) &&
+        reader.read(m_next_polygon_id) &&
+        reader.read(m_next_edge_id) &&
+        reader.read(m_next_point_corner_reserve) &&
+        reader.read(m_next_polygon_corner_id) &&
+        reader.read(m_next_edge_polygon_id) &&
+        reader.read(m_polygon_corner_polygon) &&
+        reader.read(m_edge_polygon_edge) &&
+        reader.read(valid_bits);
+    const bool arrays_ok = header_ok &&
+        reader.read_array(corners) &&
+        reader.read_array(points) &&
+        reader.read_array(polygons) &&
+        reader.read_array(edges) &&
+        reader.read_array(point_corners) &&
+        reader.read_array(polygon_corners) &&
+        reader.read_array(edge_polygons);
+    const bool maps_ok = arrays_ok &&
+        read_collection(reader, m_point_property_map_collection) &&
+        read_collection(reader, m_corner_property_map_collection) &&
+        read_collection(reader, m_polygon_property_map_collection) &&
+        read_collection(reader, m_edge_property_map_collection);
+    if (!maps_ok)
+    {
+        return false;
+    }
+
+    // Ids must refer to stored elements
+    if (
+        (corners        .size() < m_next_corner_id           ) ||
+        (points         .size() < m_next_point_id            ) ||
+        (polygons       .size() < m_next_polygon_id          ) ||
+        (edges          .size() < m_next_edge_id             ) ||
+        (point_corners  .size() < m_next_point_corner_reserve) ||
+        (polygon_corners.size() < m_next_polygon_corner_id   ) ||
+        (edge_polygons  .size() < m_next_edge_polygon_id     )
+    )
+    {
+        return false;
+    }
+
+    // Every stored id must refer to an existing element, so that later
+    // iteration over loaded geometry never reads out of bounds
+    for (Corner_id corner_id = 0; corner_id < m_next_corner_id; ++corner_id)
+    {
+        const Corner& corner = corners[corner_id];
+        if ((corner.point_id >= m_next_point_id) || (corner.polygon_id >= m_next_polygon_id))
+        {
+            log_geometry->warn("Corner {} has invalid point or polygon", corner_id);
+            return false;
+        }
+    }
+    for (Point_id point_id = 0; point_id < m_next_point_id; ++point_id)
+    {
+        const Point& point = points[point_id];
+        if (!is_range_valid(point.first_point_corner_id, point.corner_count, m_next_point_corner_reserve))
+        {
+            log_geometry->warn("Point {} has invalid corner range", point_id);
+            return false;
+        }
+        for (uint32_t i = 0; i < point.corner_count; ++i)
+        {
+            if (point_corners[point.first_point_corner_id + i] >= m_next_corner_id)
+            {
+                log_geometry->warn("Point {} has invalid corner", point_id);
+                return false;
+            }
+        }
+    }
+    for (Polygon_id polygon_id = 0; polygon_id < m_next_polygon_id; ++polygon_id)
+    {
+        const Polygon& polygon = polygons[polygon_id];
+        if (!is_range_valid(polygon.first_polygon_corner_id, polygon.corner_count, m_next_polygon_corner_id))
+        {
+            log_geometry->warn("Polygon {} has invalid corner range", polygon_id);
+            return false;
+        }
+        for (uint32_t i = 0; i < polygon.corner_count; ++i)
+        {
+            if (polygon_corners[polygon.first_polygon_corner_id + i] >= m_next_corner_id)
+            {
+                log_geometry->warn("Polygon {} has invalid corner", polygon_id);
+                return false;
+            }
+        }
+    }
+    for (Edge_id edge_id = 0; edge_id < m_next_edge_id; ++edge_id)
+    {
+        const Edge& edge = edges[edge_id];
+        if (
+            (edge.a >= m_next_point_id) ||
+            (edge.b >= m_next_point_id) ||
+            !is_range_valid(edge.first_edge_polygon_id, edge.polygon_count, m_next_edge_polygon_id)
+        )
+        {
+            log_geometry->warn("Edge {} has invalid point or polygon range", edge_id);
+            return false;
+        }
+        for (uint32_t i = 0; i < edge.polygon_count; ++i)
+        {
+            if (edge_polygons[edge.first_edge_polygon_id + i] >= m_next_polygon_id)
+            {
+                log_geometry->warn("Edge {} has invalid polygon", edge_id);
+                return false;
+            }
+        }
+    }
+
+    ++m_serial;
+    const auto restore = [this, valid_bits](uint64_t& serial, const Valid_bit bit)
+    {
+        serial = ((valid_bits & static_cast<uint32_t>(bit)) != 0) ? m_serial : 0;
+    };
+    restore(m_serial_edges,                       Valid_bit::edges                      );
+    restore(m_serial_polygon_normals,             Valid_bit::polygon_normals            );
+    restore(m_serial_polygon_centroids,           Valid_bit::polygon_centroids          );
+    restore(m_serial_polygon_tangents,            Valid_bit::polygon_tangents           );
+    restore(m_serial_polygon_bitangents,          Valid_bit::polygon_bitangents         );
+    restore(m_serial_polygon_texture_coordinates, Valid_bit::polygon_texture_coordinates);
+    restore(m_serial_point_normals,               Valid_bit::point_normals              );
+    restore(m_serial_smooth_point_normals,        Valid_bit::smooth_point_normals       );
+    restore(m_serial_corner_normals,              Valid_bit::corner_normals             );
+    restore(m_serial_corner_tangents,             Valid_bit::corner_tangents            );
+    restore(m_serial_corner_bitangents,           Valid_bit::corner_bitangents          );
+    restore(m_serial_corner_texture_coordinates,  Valid_bit::corner_texture_coordinates );
+    return true;
+}
+
+} // namespace erhe::geometry
@@ -5,12 +5,25 @@
 #include "erhe/toolkit/verify.hpp"
 #include "erhe/toolkit/profile.hpp"
 
+#include "erhe/concurrency/concurrent_queue.hpp"
+
 #include <glm/glm.hpp>
 #include <mikktspace.h>
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
 namespace erhe::geometry
 {
 
+namespace {
+
+constexpr std::size_t c_tangent_batch_min_triangle_count{4096};
+constexpr std::size_t c_tangent_batch_max_count         {64};
+
+}
+
 using glm::mat4;
 using glm::vec2;
 using glm::vec3;
@@ -37,12 +50,13 @@ auto Geometry::has_corner_bitangents() const -> bool
 }
 
 auto Geometry::compute_tangents(
-    const bool corner_tangents,
-    const bool corner_bitangents,
-    const bool polygon_tangents,
-    const bool polygon_bitangents,
-    const bool make_polygons_flat,
-    const bool override_existing
+    const bool                           corner_tangents,
+    const bool                           corner_bitangents,
+    const bool                           polygon_tangents,
+    const bool                           polygon_bitangents,
+    const bool                           make_polygons_flat,
+    const bool                           override_existing,
+    erhe::concurrency::Concurrent_queue* queue
 ) -> bool
 {
     ERHE_PROFILE_FUNCTION
@@ -76,6 +90,33 @@ auto Geometry::compute_tangents(
         return false;
     }
 
+    // Tangents are collected here by MikkTSpace callbacks and are copied
+    // to property maps after all batches are done. Batches never share
+    // polygons or corners, so each element is written by one thread only.
+    class Tangent_output
+    {
+    public:
+        void resize(const std::size_t size)
+        {
+            values .resize(size);
+            written.resize(size, 0);
+        }
+
+        void store(Property_map<uint32_t, vec4>* map) const
+        {
+            for (uint32_t key = 0, end = static_cast<uint32_t>(values.size()); key < end; ++key)
+            {
+                if (written[key] != 0)
+                {
+                    map->put(key, values[key]);
+                }
+            }
+        }
+
+        std::vector<vec4>    values;
+        std::vector<uint8_t> written; // not vector<bool>, elements are set from different threads
+    };
+
     class Geometry_context
     {
     public:
@@ -96,6 +137,11 @@ auto Geometry::compute_tangents(
         Property_map<Point_id, vec3>*   point_normals_smooth{nullptr};
         Property_map<Point_id, vec2>*   point_texcoords     {nullptr};
 
+        Tangent_output* polygon_tangent_output  {nullptr};
+        Tangent_output* polygon_bitangent_output{nullptr};
+        Tangent_output* corner_tangent_output   {nullptr};
+        Tangent_output* corner_bitangent_output {nullptr};
+
         // Polygons are triangulated.
         class Triangle
         {
@@ -104,11 +150,6 @@ auto Geometry::compute_tangents(
             uint32_t   triangle_index;
         };
 
-        [[nodiscard]] auto get_triangle(const int iFace) -> Triangle&
-        {
-            return triangles[iFace];
-        }
-
         [[nodiscard]] auto get_triangle(const int iFace) const -> const Triangle&
         {
             return triangles[iFace];
@@ -280,6 +321,26 @@ auto Geometry::compute_tangents(
             // unreachable return vec2{0.0f, 0.0f};
         }
 
+        // Polygon_id and Corner_id are both uint32_t
+        void put(
+            Tangent_output*                     output,
+            const Property_map<uint32_t, vec4>* map,
+            const uint32_t                      key,
+            const vec4                          value
+        ) const
+        {
+            if (output == nullptr)
+            {
+                return;
+            }
+            if (!override_existing && ((output->written[key] != 0) || map->has(key)))
+            {
+                return;
+            }
+            output->values [key] = value;
+            output->written[key] = 1;
+        }
+
         void set_tangent(
             const int   iFace,
             const int   iVert,
@@ -295,16 +356,9 @@ auto Geometry::compute_tangents(
             const Polygon_id polygon_id = get_polygon_id(iFace);
             const Corner_id  corner_id  = get_corner_id(iFace, iVert);
 
-            if (polygon_tangents && (override_existing || !polygon_tangents->has(polygon_id)))
-            {
-                SPDLOG_LOGGER_TRACE(log_tangent_gen, "put polygon_id {}, tangent = {}, sign = {}", polygon_id, tangent, sign);
-                polygon_tangents->put(polygon_id, vec4{tangent, sign});
-            }
-            if (corner_tangents && (override_existing || !corner_tangents->has(corner_id)))
-            {
-                SPDLOG_LOGGER_TRACE(log_tangent_gen, "put polygon_id {}, corner_id = {} tangent = {}, sign = {}", polygon_id, corner_id, tangent, sign);
-                corner_tangents->put(corner_id, vec4{tangent, sign});
-            }
+            SPDLOG_LOGGER_TRACE(log_tangent_gen, "polygon_id {}, corner_id = {} tangent = {}, sign = {}", polygon_id, corner_id, tangent, sign);
+            put(polygon_tangent_output, polygon_tangents, polygon_id, vec4{tangent, sign});
+            put(corner_tangent_output,  corner_tangents,  corner_id,  vec4{tangent, sign});
         }
 
         void set_bitangent(
@@ -322,21 +376,16 @@ auto Geometry::compute_tangents(
             const Polygon_id polygon_id = get_polygon_id(iFace);
             const Corner_id  corner_id  = get_corner_id(iFace, iVert);
 
-            if (polygon_bitangents && (override_existing || !polygon_bitangents->has(polygon_id)))
-            {
-                SPDLOG_LOGGER_TRACE(log_tangent_gen, "put polygon_id {}, bitangent = {}, sign = {}", polygon_id, bitangent, sign);
-                polygon_bitangents->put(polygon_id, vec4{bitangent, sign});
-            }
-            if (corner_bitangents && (override_existing || !corner_bitangents->has(corner_id)))
-            {
-                SPDLOG_LOGGER_TRACE(log_tangent_gen, "put polygon_id {}, corner_id = {} bitangent = {}, sign = {}", polygon_id, corner_id, bitangent, sign);
-                corner_bitangents->put(corner_id, vec4{bitangent, sign});
-            }
+            SPDLOG_LOGGER_TRACE(log_tangent_gen, "polygon_id {}, corner_id = {} bitangent = {}, sign = {}", polygon_id, corner_id, bitangent, sign);
+            put(polygon_bitangent_output, polygon_bitangents, polygon_id, vec4{bitangent, sign});
+            put(corner_bitangent_output,  corner_bitangents,  corner_id,  vec4{bitangent, sign});
         }
 
-        std::vector<Triangle> triangles;
+        const Triangle* triangles{nullptr}; // triangles of one batch
     };
 
+    using Batch_triangle = Geometry_context::Triangle;
+
     Geometry_context g;
     g.geometry             = this;
     g.override_existing    = override_existing;
@@ -359,23 +408,128 @@ auto Geometry::compute_tangents(
         return false;
     }
 
-    // MikkTSpace can only handle triangles or quads.
-    // We triangulate all non-triangles by adding a virtual polygon centroid
-    // and presenting N virtual triangles to MikkTSpace.
-    int               face_index     = 0;
-    const std::size_t triangle_count = count_polygon_triangles();
-    g.triangle_count = static_cast<int>(triangle_count);
-    g.triangles.resize(triangle_count);
-    for (Polygon_id polygon_id = 0; polygon_id < m_next_polygon_id; ++polygon_id)
+    Tangent_output polygon_tangent_output;
+    Tangent_output polygon_bitangent_output;
+    Tangent_output corner_tangent_output;
+    Tangent_output corner_bitangent_output;
+    if (polygon_tangents)
+    {
+        polygon_tangent_output.resize(m_next_polygon_id);
+        g.polygon_tangent_output = &polygon_tangent_output;
+    }
+    if (polygon_bitangents)
+    {
+        polygon_bitangent_output.resize(m_next_polygon_id);
+        g.polygon_bitangent_output = &polygon_bitangent_output;
+    }
+    if (corner_tangents)
+    {
+        corner_tangent_output.resize(m_next_corner_id);
+        g.corner_tangent_output = &corner_tangent_output;
+    }
+    if (corner_bitangents)
+    {
+        corner_bitangent_output.resize(m_next_corner_id);
+        g.corner_bitangent_output = &corner_bitangent_output;
+    }
+
+    // Polygons which share points form connected components, which are
+    // given to MikkTSpace separately. MikkTSpace merges identical
+    // vertices; only merges between separate components which happen
+    // to have coincident vertices are lost. Components are grouped into
+    // batches of roughly equal size, and batches are processed
+    // concurrently if queue is given. Batches do not depend on queue,
+    // so neither do results.
+    std::vector<Batch_triangle> triangles;
+    std::vector<std::size_t>    batch_offsets;
     {
-        const Polygon& polygon = polygons[polygon_id];
-        if (polygon.corner_count < 3)
+        ERHE_PROFILE_SCOPE("make batches");
+
+        // Union-find of points, points of same polygon are joined
+        std::vector<Point_id> point_parent(m_next_point_id);
+        std::iota(point_parent.begin(), point_parent.end(), Point_id{0});
+        const auto find_root = [&point_parent](Point_id point_id) -> Point_id
+        {
+            while (point_parent[point_id] != point_id)
+            {
+                point_parent[point_id] = point_parent[point_parent[point_id]];
+                point_id = point_parent[point_id];
+            }
+            return point_id;
+        };
+        const auto get_polygon_point = [this](const Polygon& polygon, const uint32_t i) -> Point_id
+        {
+            return corners[polygon_corners[polygon.first_polygon_corner_id + i]].point_id;
+        };
+        for (Polygon_id polygon_id = 0; polygon_id < m_next_polygon_id; ++polygon_id)
+        {
+            const Polygon& polygon = polygons[polygon_id];
+            if (polygon.corner_count < 3)
+            {
+                continue;
+            }
+            const Point_id root = find_root(get_polygon_point(polygon, 0));
+            for (uint32_t i = 1; i < polygon.corner_count; ++i)
+            {
+                const Point_id other_root = find_root(get_polygon_point(polygon, i));
+                if (other_root != root)
+                {
+                    point_parent[other_root] = root;
+                }
+            }
+        }
+
+        // Assign components to batches in polygon order
+        constexpr uint32_t no_batch = std::numeric_limits<uint32_t>::max();
+        const std::size_t  triangle_count     = count_polygon_triangles();
+        const std::size_t  batch_target_count = std::max(
+            c_tangent_batch_min_triangle_count,
+            triangle_count / c_tangent_batch_max_count
+        );
+        std::vector<uint32_t>    root_batch   (m_next_point_id, no_batch);
+        std::vector<uint32_t>    polygon_batch(m_next_polygon_id, no_batch);
+        std::vector<std::size_t> batch_triangle_counts;
+        for (Polygon_id polygon_id = 0; polygon_id < m_next_polygon_id; ++polygon_id)
         {
-            continue;
+            const Polygon& polygon = polygons[polygon_id];
+            if (polygon.corner_count < 3)
+            {
+                continue;
+            }
+            const Point_id root = find_root(get_polygon_point(polygon, 0));
+            if (root_batch[root] == no_batch)
+            {
+                if (batch_triangle_counts.empty() || (batch_triangle_counts.back() >= batch_target_count))
+                {
+                    batch_triangle_counts.push_back(0);
+                }
+                root_batch[root] = static_cast<uint32_t>(batch_triangle_counts.size() - 1);
+            }
+            const uint32_t batch = root_batch[root];
+            polygon_batch[polygon_id] = batch;
+            batch_triangle_counts[batch] += polygon.corner_count - 2;
         }
-        for (uint32_t i = 0; i < polygon.corner_count - 2; ++i)
+
+        batch_offsets.resize(batch_triangle_counts.size() + 1, 0);
+        std::partial_sum(batch_triangle_counts.begin(), batch_triangle_counts.end(), batch_offsets.begin() + 1);
+
+        // MikkTSpace can only handle triangles or quads.
+        // We triangulate all non-triangles by adding a virtual polygon centroid
+        // and presenting N virtual triangles to MikkTSpace.
+        std::vector<std::size_t> batch_fill(batch_offsets.begin(), batch_offsets.end() - 1);
+        triangles.resize(triangle_count);
+        for (Polygon_id polygon_id = 0; polygon_id < m_next_polygon_id; ++polygon_id)
         {
-            g.triangles[face_index++] = {polygon_id, i};
+            const Polygon& polygon = polygons[polygon_id];
+            if (polygon.corner_count < 3)
+            {
+                continue;
+            }
+            std::size_t& fill = batch_fill[polygon_batch[polygon_id]];
+            for (uint32_t i = 0; i < polygon.corner_count - 2; ++i)
+            {
+                triangles[fill++] = {polygon_id, i};
+            }
         }
     }
 
@@ -463,20 +617,69 @@ auto Geometry::compute_tangents(
         }
     };
 
-    SMikkTSpaceContext context
+    const std::size_t    batch_count = batch_offsets.size() - 1;
+    std::vector<uint8_t> batch_ok(batch_count, 0);
+    const auto process_batch = [&g, &mikktspace, &triangles, &batch_offsets, &batch_ok](const std::size_t batch)
     {
-        .m_pInterface = &mikktspace,
-        .m_pUserData  = &g
+        ERHE_PROFILE_SCOPE("genTangSpaceDefault");
+
+        Geometry_context batch_context = g;
+        batch_context.triangles      = triangles.data() + batch_offsets[batch];
+        batch_context.triangle_count = static_cast<int>(batch_offsets[batch + 1] - batch_offsets[batch]);
+
+        SMikkTSpaceContext context
+        {
+            .m_pInterface = &mikktspace,
+            .m_pUserData  = &batch_context
+        };
+        batch_ok[batch] = (genTangSpaceDefault(&context) != 0) ? 1 : 0;
     };
 
+    if ((queue != nullptr) && (batch_count > 1))
     {
-        ERHE_PROFILE_SCOPE("genTangSpaceDefault");
+        for (std::size_t batch = 0; batch < batch_count; ++batch)
+        {
+            queue->enqueue(
+                [&process_batch, batch]()
+                {
+                    process_batch(batch);
+                }
+            );
+        }
+        queue->wait();
+    }
+    else
+    {
+        for (std::size_t batch = 0; batch < batch_count; ++batch)
+        {
+            process_batch(batch);
+        }
+    }
+
+    if (std::find(batch_ok.begin(), batch_ok.end(), 0) != batch_ok.end())
+    {
+        log_tangent_gen->trace("genTangSpaceDefault() returned 0");
+        return false;
+    }
 
-        const auto res = genTangSpaceDefault(&context);
-        if (res == 0)
+    {
+        ERHE_PROFILE_SCOPE("store tangents");
+
+        if (polygon_tangents)
+        {
+            polygon_tangent_output.store(g.polygon_tangents);
+        }
+        if (polygon_bitangents)
+        {
+            polygon_bitangent_output.store(g.polygon_bitangents);
+        }
+        if (corner_tangents)
+        {
+            corner_tangent_output.store(g.corner_tangents);
+        }
+        if (corner_bitangents)
         {
-            log_tangent_gen->trace("genTangSpaceDefault() returned 0");
-            return false;
+            corner_bitangent_output.store(g.corner_bitangents);
         }
     }
 
@@ -614,7 +817,7 @@ auto Geometry::compute_tangents(
             }
             if (polygon_bitangents)
             {
-                g.polygon_tangents->put(polygon_id, B);
+                g.polygon_bitangents->put(polygon_id, B);
             }
             if (corner_tangents)
             {
@@ -15,6 +15,7 @@ Clone::Clone(Geometry& source, Geometry& destination, glm::mat4 transform)
     destination.corners                              = source.corners;
     destination.point_corners                        = source.point_corners;
     destination.polygon_corners                      = source.polygon_corners;
+    destination.edge_polygons                        = source.edge_polygons;
     destination.m_next_corner_id                     = source.m_next_corner_id;
     destination.m_next_point_id                      = source.m_next_point_id;
     destination.m_next_polygon_id                    = source.m_next_polygon_id;
@@ -39,6 +40,8 @@ Clone::Clone(Geometry& source, Geometry& destination, glm::mat4 transform)
     destination.m_serial_corner_texture_coordinates  = source.m_serial_corner_texture_coordinates ;
 
     destination.m_next_edge_polygon_id            = source.m_next_edge_polygon_id;
+    destination.m_polygon_corner_polygon          = source.m_polygon_corner_polygon;
+    destination.m_edge_polygon_edge               = source.m_edge_polygon_edge;
     destination.m_point_property_map_collection   = source.m_point_property_map_collection  .clone_with_transform(transform);
     destination.m_corner_property_map_collection  = source.m_corner_property_map_collection .clone_with_transform(transform);
     destination.m_polygon_property_map_collection = source.m_polygon_property_map_collection.clone_with_transform(transform);
@@ -53,6 +53,9 @@ public:
 
     auto size() const -> size_t;
 
+    // For visiting all maps, index < size()
+    auto get(std::size_t index) const -> Property_map_base<Key_type>*;
+
     template <typename Value_type>
     auto create(
         const Property_map_descriptor& descriptor
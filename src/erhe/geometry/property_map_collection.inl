@@ -38,6 +38,13 @@ Property_map_collection<Key_type>::size() const -> size_t
     return m_entries.size();
 }
 
+template <typename Key_type>
+inline auto
+Property_map_collection<Key_type>::get(const std::size_t index) const -> Property_map_base<Key_type>*
+{
+    return m_entries.at(index).value.get();
+}
+
 template <typename Key_type>
 inline void
 Property_map_collection<Key_type>::insert(Property_map_base<Key_type>* map)
@@ -0,0 +1,186 @@
+#include "erhe/graphics/mipmapped_image.hpp"
+#include "erhe/graphics/texture.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace erhe::graphics
+{
+
+namespace
+{
+
+// sRGB to linear for every byte value, and linear to sRGB for
+// c_linear_step_count evenly spaced linear values
+class Srgb_tables
+{
+public:
+    static constexpr int c_linear_step_count{4096};
+
+    Srgb_tables()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            const float c = static_cast<float>(i) / 255.0f;
+            to_linear[i] = (c <= 0.04045f)
+                ? c / 12.92f
+                : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < c_linear_step_count; ++i)
+        {
+            const float l = static_cast<float>(i) / static_cast<float>(c_linear_step_count - 1);
+            const float c = (l <= 0.0031308f)
+                ? l * 12.92f
+                : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            to_srgb[i] = static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+    }
+
+    std::array<float,   256                > to_linear;
+    std::array<uint8_t, c_linear_step_count> to_srgb;
+};
+
+auto get_srgb_tables() -> const Srgb_tables&
+{
+    static const Srgb_tables tables;
+    return tables;
+}
+
+// Box filters 2 x 2 source texels to each destination texel. With odd
+// source width or height, the last source column or row is folded into
+// the last destination texel, which then covers 3 source texels.
+void downsample(
+    const uint8_t* const src,
+    const int            src_width,
+    const int            src_height,
+    uint8_t* const       dst,
+    const int            dst_width,
+    const int            dst_height
+)
+{
+    const auto&       tables      = get_srgb_tables();
+    const float       max_linear  = static_cast<float>(Srgb_tables::c_linear_step_count - 1);
+    const std::size_t src_stride  = static_cast<std::size_t>(src_width) * Mipmapped_image::c_pixel_byte_count;
+    const std::size_t dst_stride  = static_cast<std::size_t>(dst_width) * Mipmapped_image::c_pixel_byte_count;
+
+    for (int y = 0; y < dst_height; ++y)
+    {
+        const int src_y0  = std::min(2 * y, src_height - 1);
+        const int src_y1  = (y == dst_height - 1) ? src_height : std::min(2 * y + 2, src_height);
+        uint8_t*  dst_row = dst + static_cast<std::size_t>(y) * dst_stride;
+        for (int x = 0; x < dst_width; ++x)
+        {
+            const int src_x0 = std::min(2 * x, src_width - 1);
+            const int src_x1 = (x == dst_width - 1) ? src_width : std::min(2 * x + 2, src_width);
+
+            float        sum[3]   {0.0f, 0.0f, 0.0f};
+            unsigned int alpha_sum{0u};
+            for (int sy = src_y0; sy < src_y1; ++sy)
+            {
+                const uint8_t* row = src + static_cast<std::size_t>(sy) * src_stride;
+                for (int sx = src_x0; sx < src_x1; ++sx)
+                {
+                    const uint8_t* texel = row + static_cast<std::size_t>(sx) * 4;
+                    sum[0]    += tables.to_linear[texel[0]];
+                    sum[1]    += tables.to_linear[texel[1]];
+                    sum[2]    += tables.to_linear[texel[2]];
+                    alpha_sum += texel[3];
+                }
+            }
+
+            const unsigned int count = static_cast<unsigned int>((src_x1 - src_x0) * (src_y1 - src_y0));
+            const float        scale = max_linear / static_cast<float>(count);
+            uint8_t*           out   = dst_row + static_cast<std::size_t>(x) * 4;
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                out[c] = tables.to_srgb[static_cast<std::size_t>(sum[c] * scale + 0.5f)];
+            }
+            out[3] = static_cast<uint8_t>((alpha_sum + count / 2u) / count);
+        }
+    }
+}
+
+} // anonymous namespace
+
+void Mipmapped_image::allocate(const int width, const int height)
+{
+    Expects(width  >= 1);
+    Expects(height >= 1);
+
+    const int level_count = std::max(
+        Texture::size_level_count(width),
+        Texture::size_level_count(height)
+    );
+
+    levels.clear();
+    levels.reserve(level_count);
+    std::size_t byte_offset{0};
+    int level_width  = width;
+    int level_height = height;
+    for (int level = 0; level < level_count; ++level)
+    {
+        const std::size_t level_byte_count =
+            static_cast<std::size_t>(level_width) *
+            static_cast<std::size_t>(level_height) *
+            c_pixel_byte_count;
+        levels.push_back(
+            Mipmap_level{
+                .width       = level_width,
+                .height      = level_height,
+                .byte_offset = byte_offset,
+                .byte_count  = level_byte_count
+            }
+        );
+        byte_offset += level_byte_count;
+        level_width  = std::max(1, level_width  / 2);
+        level_height = std::max(1, level_height / 2);
+    }
+    data.resize(byte_offset);
+}
+
+void Mipmapped_image::generate_mipmaps()
+{
+    ERHE_PROFILE_FUNCTION
+
+    for (std::size_t level = 1; level < levels.size(); ++level)
+    {
+        const Mipmap_level& src = levels[level - 1];
+        const Mipmap_level& dst = levels[level];
+        downsample(
+            reinterpret_cast<const uint8_t*>(data.data() + src.byte_offset),
+            src.width,
+            src.height,
+            reinterpret_cast<uint8_t*>(data.data() + dst.byte_offset),
+            dst.width,
+            dst.height
+        );
+    }
+}
+
+auto Mipmapped_image::level_count() const -> int
+{
+    return static_cast<int>(levels.size());
+}
+
+auto Mipmapped_image::byte_count() const -> std::size_t
+{
+    return data.size();
+}
+
+auto Mipmapped_image::level_span(const int level) -> gsl::span<std::byte>
+{
+    const Mipmap_level& mipmap_level = levels.at(level);
+    return gsl::span<std::byte>{data}.subspan(mipmap_level.byte_offset, mipmap_level.byte_count);
+}
+
+auto Mipmapped_image::level_span(const int level) const -> gsl::span<const std::byte>
+{
+    const Mipmap_level& mipmap_level = levels.at(level);
+    return gsl::span<const std::byte>{data}.subspan(mipmap_level.byte_offset, mipmap_level.byte_count);
+}
+
+} // namespace erhe::graphics
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <gsl/span>
+
+#include <cstddef>
+#include <vector>
+
+namespace erhe::graphics
+{
+
+class Mipmap_level
+{
+public:
+    int         width      {0};
+    int         height     {0};
+    std::size_t byte_offset{0};
+    std::size_t byte_count {0};
+};
+
+// RGBA8 sRGB image with complete mipmap chain in one allocation.
+//
+// Levels are made with 2x2 box filter. Color is averaged in linear
+// space using lookup tables, alpha is averaged as is. When level size
+// is odd, last row or column is used twice.
+class Mipmapped_image
+{
+public:
+    static constexpr std::size_t c_pixel_byte_count{4};
+
+    // Allocates all levels. Base level is filled by caller.
+    void allocate(const int width, const int height);
+
+    // Computes levels 1 .. level_count() - 1 from base level
+    void generate_mipmaps();
+
+    [[nodiscard]] auto level_count() const -> int;
+    [[nodiscard]] auto byte_count () const -> std::size_t;
+    [[nodiscard]] auto level_span (const int level)       -> gsl::span<std::byte>;
+    [[nodiscard]] auto level_span (const int level) const -> gsl::span<const std::byte>;
+
+    std::vector<Mipmap_level> levels; // level 0 is base level
+    std::vector<std::byte>    data;
+};
+
+} // namespace erhe::graphics
@@ -97,6 +97,40 @@ auto PNG_loader::open(
     return true;
 }
 
+auto PNG_loader::open(
+    const gsl::span<const std::byte>& data,
+    Image_info&                       info
+) -> bool
+{
+    close();
+
+    const bool is_jpeg =
+        (data.size_bytes() >= 2) &&
+        (data[0] == std::byte{0xff}) &&
+        (data[1] == std::byte{0xd8});
+    m_image_decoder = std::make_unique<mango::image::ImageDecoder>(
+        mango::ConstMemory{
+            reinterpret_cast<const mango::u8*>(data.data()),
+            data.size_bytes()
+        },
+        is_jpeg ? ".jpg" : ".png"
+    );
+    if (!m_image_decoder->isDecoder())
+    {
+        m_image_decoder.reset();
+        return false;
+    }
+
+    mango::image::ImageHeader header = m_image_decoder->header();
+    info.width       = header.width;
+    info.height      = header.height;
+    info.depth       = header.depth;
+    info.level_count = (header.levels > 0) ? header.levels : 1;
+    info.row_stride  = header.width * header.format.bytes();
+    info.format      = from_mango(header.format);
+    return true;
+}
+
 auto PNG_loader::load(gsl::span<std::byte> transfer_buffer) -> bool
 {
     const mango::image::ImageHeader header{m_image_decoder->header()};
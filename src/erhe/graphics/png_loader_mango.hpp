@@ -53,6 +53,12 @@ public:
         Image_info&     image_info
     ) -> bool;
 
+    // Opens PNG or JPEG image in memory; data must remain valid until close()
+    [[nodiscard]] auto open(
+        const gsl::span<const std::byte>& data,
+        Image_info&                       image_info
+    ) -> bool;
+
     [[nodiscard]] auto load(
         gsl::span<std::byte> transfer_buffer
     ) -> bool;
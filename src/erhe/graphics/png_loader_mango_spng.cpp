@@ -8,6 +8,8 @@
 
 #include <mango/mango.hpp>
 
+#include <array>
+#include <cstring>
 #include <fstream>
 
 namespace erhe::graphics
@@ -69,6 +71,7 @@ void PNG_loader::close()
 {
     ::spng_ctx_free(m_image_decoder);
     m_image_decoder = nullptr;
+    m_mango_decoder.reset();
     m_file.reset();
 }
 
@@ -81,6 +84,75 @@ auto PNG_loader::open(
 
     m_file = std::make_unique<mango::filesystem::File>(path.string());
     mango::filesystem::File& file = *m_file;
+    return open_png(
+        gsl::span<const std::byte>{
+            reinterpret_cast<const std::byte*>(file.data()),
+            file.size()
+        },
+        info
+    );
+}
+
+auto PNG_loader::open(
+    const gsl::span<const std::byte>& data,
+    Image_info&                       info
+) -> bool
+{
+    close();
+
+    static constexpr std::array<uint8_t, 8> png_signature{ 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+    const bool is_png =
+        (data.size_bytes() >= png_signature.size()) &&
+        (std::memcmp(data.data(), png_signature.data(), png_signature.size()) == 0);
+
+    return is_png
+        ? open_png  (data, info)
+        : open_mango(data, info);
+}
+
+auto PNG_loader::open_mango(
+    const gsl::span<const std::byte>& data,
+    Image_info&                       info
+) -> bool
+{
+    static constexpr std::array<uint8_t, 3> jpeg_signature{ 0xff, 0xd8, 0xff };
+    const bool is_jpeg =
+        (data.size_bytes() >= jpeg_signature.size()) &&
+        (std::memcmp(data.data(), jpeg_signature.data(), jpeg_signature.size()) == 0);
+    if (!is_jpeg)
+    {
+        log_load_png->warn("unsupported image format");
+        return false;
+    }
+
+    m_mango_decoder = std::make_unique<mango::image::ImageDecoder>(
+        mango::ConstMemory{
+            reinterpret_cast<const mango::u8*>(data.data()),
+            data.size_bytes()
+        },
+        ".jpg"
+    );
+    if (!m_mango_decoder->isDecoder())
+    {
+        m_mango_decoder.reset();
+        return false;
+    }
+
+    const mango::image::ImageHeader header = m_mango_decoder->header();
+    info.width       = header.width;
+    info.height      = header.height;
+    info.depth       = 1;
+    info.level_count = 1;
+    info.row_stride  = header.width * 4;
+    info.format      = Image_format::srgb8_alpha8;
+    return true;
+}
+
+auto PNG_loader::open_png(
+    const gsl::span<const std::byte>& data,
+    Image_info&                       info
+) -> bool
+{
     m_image_decoder = ::spng_ctx_new(0);
     if (m_image_decoder == nullptr)
     {
@@ -89,7 +161,7 @@ auto PNG_loader::open(
     }
 
     int result{};
-    result = ::spng_set_png_buffer(m_image_decoder, file.data(), file.size());
+    result = ::spng_set_png_buffer(m_image_decoder, data.data(), data.size_bytes());
     if (result != 0)
     {
         return false;
@@ -129,6 +201,23 @@ auto PNG_loader::open(
 
 auto PNG_loader::load(gsl::span<std::byte> transfer_buffer) -> bool
 {
+    if (m_mango_decoder)
+    {
+        using Format = mango::image::Format;
+        const mango::image::ImageHeader header{m_mango_decoder->header()};
+        const std::size_t stride = static_cast<std::size_t>(header.width) * 4;
+        Expects(transfer_buffer.size_bytes() >= stride * static_cast<std::size_t>(header.height));
+        mango::image::Surface surface{
+            header.width,
+            header.height,
+            Format{32, Format::UNORM, Format::RGBA, 8, 8, 8, 8},
+            stride,
+            reinterpret_cast<mango::u8*>(transfer_buffer.data())
+        };
+        const auto status = m_mango_decoder->decode(surface);
+        return status.success;
+    }
+
     int result = ::spng_decode_image(m_image_decoder, transfer_buffer.data(), transfer_buffer.size(), SPNG_FMT_RGBA8, 0);
     return (result == 0);
 }
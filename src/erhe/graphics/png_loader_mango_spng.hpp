@@ -16,6 +16,10 @@ namespace mango {
         class File;
         class FileStream;
     }
+    namespace image
+    {
+        class ImageDecoder;
+    }
 }
 
 namespace erhe::graphics
@@ -53,6 +57,14 @@ public:
         Image_info&     image_info
     ) -> bool;
 
+    // Opens image in memory; data must remain valid until close().
+    // PNG is decoded with spng, other formats (JPEG) with mango.
+    // Images are always loaded as RGBA8.
+    [[nodiscard]] auto open(
+        const gsl::span<const std::byte>& data,
+        Image_info&                       image_info
+    ) -> bool;
+
     [[nodiscard]] auto load(
         gsl::span<std::byte> transfer_buffer
     ) -> bool;
@@ -60,9 +72,12 @@ public:
     void close();
 
 private:
-    std::unique_ptr<mango::filesystem::File> m_file;
-    struct ::spng_ctx*                       m_image_decoder{nullptr};
-    //std::unique_ptr<mango::image::ImageDecoder> m_image_decoder;
+    [[nodiscard]] auto open_png  (const gsl::span<const std::byte>& data, Image_info& image_info) -> bool;
+    [[nodiscard]] auto open_mango(const gsl::span<const std::byte>& data, Image_info& image_info) -> bool;
+
+    std::unique_ptr<mango::filesystem::File>    m_file;
+    struct ::spng_ctx*                          m_image_decoder{nullptr};
+    std::unique_ptr<mango::image::ImageDecoder> m_mango_decoder;
 };
 
 class PNG_writer final
@@ -15,6 +15,11 @@ auto PNG_loader::open(const fs::path&, Image_info&) -> bool
     return false;
 }
 
+auto PNG_loader::open(const gsl::span<const std::byte>&, Image_info&) -> bool
+{
+    return false;
+}
+
 auto PNG_loader::load(gsl::span<std::byte>) -> bool
 {
     return false;
@@ -40,6 +40,11 @@ public:
         Image_info&     image_info
     ) -> bool;
 
+    [[nodiscard]] auto open(
+        const gsl::span<const std::byte>& data,
+        Image_info&                       image_info
+    ) -> bool;
+
     [[nodiscard]] auto load(
         gsl::span<std::byte> transfer_buffer
     ) -> bool;
@@ -33,6 +33,21 @@ Sampler::Sampler(
     apply();
 }
 
+Sampler::Sampler(
+    const gl::Texture_min_filter min_filter,
+    const gl::Texture_mag_filter mag_filter,
+    const gl::Texture_wrap_mode  wrap_mode_s,
+    const gl::Texture_wrap_mode  wrap_mode_t
+)
+    : min_filter{min_filter}
+    , mag_filter{mag_filter}
+    , wrap_mode {wrap_mode_s, wrap_mode_t, wrap_mode_s}
+{
+    Expects(m_handle.gl_name() != 0);
+
+    apply();
+}
+
 void Sampler::set_debug_label(const std::string& value)
 {
     m_debug_label = "(S) " + value;
@@ -24,6 +24,14 @@ public:
         const gl::Texture_wrap_mode  wrap_mode
     );
 
+    // Wrap mode r is set to wrap_mode_s
+    Sampler(
+        const gl::Texture_min_filter min_filter,
+        const gl::Texture_mag_filter mag_filter,
+        const gl::Texture_wrap_mode  wrap_mode_s,
+        const gl::Texture_wrap_mode  wrap_mode_t
+    );
+
     ~Sampler() noexcept = default;
 
     [[nodiscard]] auto gl_name() const -> unsigned int
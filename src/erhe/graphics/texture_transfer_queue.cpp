@@ -0,0 +1,118 @@
+#include "erhe/graphics/texture_transfer_queue.hpp"
+#include "erhe/graphics/graphics_log.hpp"
+#include "erhe/graphics/mipmapped_image.hpp"
+#include "erhe/graphics/texture.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace erhe::graphics
+{
+
+Texture_transfer_queue::Texture_transfer_queue()
+{
+}
+
+Texture_transfer_queue::~Texture_transfer_queue() noexcept
+{
+}
+
+void Texture_transfer_queue::enqueue(
+    const std::shared_ptr<Texture>&               texture,
+    const std::shared_ptr<const Mipmapped_image>& image,
+    std::function<void()>                         on_complete
+)
+{
+    Expects(texture);
+    Expects(image);
+    Expects(image->level_count() >= 1);
+
+    const std::lock_guard<std::mutex> lock{m_mutex};
+
+    log_texture->trace(
+        "queued texture {} transfer {}x{} levels = {} size = {}",
+        texture->gl_name(),
+        image->levels.front().width,
+        image->levels.front().height,
+        image->level_count(),
+        image->byte_count()
+    );
+    m_queued.push_back(
+        Transfer_entry{
+            .texture     = texture,
+            .image       = image,
+            .on_complete = std::move(on_complete),
+            .next_level  = image->level_count() - 1
+        }
+    );
+}
+
+auto Texture_transfer_queue::flush(const std::size_t byte_budget) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Budget of at least one byte, so that at least one level is uploaded
+    const std::size_t                  min_budget = std::max(byte_budget, std::size_t{1});
+    std::vector<std::function<void()>> completed;
+    std::size_t                        byte_count{0};
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+
+        while (!m_queued.empty() && (byte_count < min_budget))
+        {
+            Transfer_entry entry = std::move(m_queued.front());
+            m_queued.pop_front();
+
+            const int           level        = entry.next_level;
+            const Mipmap_level& mipmap_level = entry.image->levels.at(level);
+            entry.texture->upload(
+                gl::Internal_format::srgb8_alpha8,
+                entry.image->level_span(level),
+                mipmap_level.width,
+                mipmap_level.height,
+                1,
+                level
+            );
+            byte_count += mipmap_level.byte_count;
+
+            if (level > 0)
+            {
+                --entry.next_level;
+                m_queued.push_back(std::move(entry));
+            }
+            else
+            {
+                log_texture->trace("texture {} transfer complete", entry.texture->gl_name());
+                if (entry.on_complete)
+                {
+                    completed.push_back(std::move(entry.on_complete));
+                }
+            }
+        }
+    }
+
+    // Callbacks are called without holding lock; they may enqueue more
+    for (const auto& on_complete : completed)
+    {
+        on_complete();
+    }
+    return byte_count;
+}
+
+void Texture_transfer_queue::flush_all()
+{
+    while (flush(std::numeric_limits<std::size_t>::max()) > 0)
+    {
+    }
+}
+
+auto Texture_transfer_queue::empty() -> bool
+{
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    return m_queued.empty();
+}
+
+} // namespace erhe::graphics
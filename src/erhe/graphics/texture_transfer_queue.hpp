@@ -0,0 +1,57 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace erhe::graphics
+{
+
+class Mipmapped_image;
+class Texture;
+
+// Uploads mipmapped images to textures over several frames.
+//
+// Each flush uploads levels until its byte budget is used. Levels of
+// a texture are uploaded from smallest to largest, and textures take
+// turns, so small textures and coarse levels become resident first.
+// Completion callback is called once all levels of texture have been
+// uploaded; textures should not be bound before that.
+class Texture_transfer_queue final
+{
+public:
+    Texture_transfer_queue ();
+    ~Texture_transfer_queue() noexcept;
+    Texture_transfer_queue (Texture_transfer_queue&) = delete;
+    auto operator=         (Texture_transfer_queue&) -> Texture_transfer_queue& = delete;
+
+    void enqueue(
+        const std::shared_ptr<Texture>&               texture,
+        const std::shared_ptr<const Mipmapped_image>& image,
+        std::function<void()>                         on_complete
+    );
+
+    // Uploads at least one level if any are queued. Returns number of
+    // bytes uploaded.
+    auto flush(const std::size_t byte_budget) -> std::size_t;
+
+    void flush_all();
+
+    [[nodiscard]] auto empty() -> bool;
+
+private:
+    class Transfer_entry
+    {
+    public:
+        std::shared_ptr<Texture>               texture;
+        std::shared_ptr<const Mipmapped_image> image;
+        std::function<void()>                  on_complete;
+        int                                    next_level{0}; // counts down to 0
+    };
+
+    std::mutex                 m_mutex;
+    std::deque<Transfer_entry> m_queued;
+};
+
+} // namespace erhe::graphics
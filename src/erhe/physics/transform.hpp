@@ -35,9 +35,10 @@ inline auto operator*(const Transform& lhs, const Transform& rhs) -> Transform
     };
 }
 
+// Basis may contain scale, so it is not inverted by transpose
 inline auto inverse(const Transform& transform) -> Transform
 {
-	const auto inverse_basis = glm::transpose(transform.basis);
+    const auto inverse_basis = glm::inverse(transform.basis);
     return Transform{inverse_basis, inverse_basis * -transform.origin};
 }
 
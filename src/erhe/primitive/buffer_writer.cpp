@@ -1,9 +1,7 @@
 #include "erhe/primitive/buffer_writer.hpp"
 #include "erhe/primitive/buffer_sink.hpp"
 #include "erhe/primitive/primitive_log.hpp"
-#include "erhe/primitive/primitive_builder.hpp"
 #include "erhe/primitive/primitive_geometry.hpp"
-#include "erhe/geometry/geometry.hpp"
 #include "erhe/toolkit/verify.hpp"
 
 #include <glm/glm.hpp>
@@ -174,84 +172,102 @@ inline void write_low(
 } // namespace
 
 Vertex_buffer_writer::Vertex_buffer_writer(
-    Build_context&              build_context,
+    const Primitive_geometry&   primitive_geometry,
     gsl::not_null<Buffer_sink*> buffer_sink
 )
-    : build_context{build_context}
-    , buffer_sink  {buffer_sink}
+    : primitive_geometry{primitive_geometry}
+    , buffer_sink       {buffer_sink}
 {
-    Expects(build_context.root.primitive_geometry != nullptr);
-    const auto& vertex_buffer_range = build_context.root.primitive_geometry->vertex_buffer_range;
+    const auto& vertex_buffer_range = primitive_geometry.vertex_buffer_range;
     vertex_data.resize(vertex_buffer_range.count * vertex_buffer_range.element_size);
     vertex_data_span = gsl::make_span(vertex_data);
 }
 
+Vertex_buffer_writer::Vertex_buffer_writer(
+    const Vertex_buffer_writer& parent,
+    const std::size_t           first_vertex,
+    const std::size_t           vertex_stride
+)
+    : primitive_geometry {parent.primitive_geometry}
+    , buffer_sink        {parent.buffer_sink}
+    , vertex_data_span   {parent.vertex_data_span}
+    , vertex_write_offset{first_vertex * vertex_stride}
+    , owns_data          {false}
+{
+}
+
 Vertex_buffer_writer::~Vertex_buffer_writer() noexcept
 {
-    buffer_sink->buffer_ready(*this);
+    if (owns_data)
+    {
+        buffer_sink->buffer_ready(*this);
+    }
 }
 
 auto Vertex_buffer_writer::start_offset() -> std::size_t
 {
-    return build_context.root.primitive_geometry->vertex_buffer_range.byte_offset;
+    return primitive_geometry.vertex_buffer_range.byte_offset;
 }
 
 Index_buffer_writer::Index_buffer_writer(
-    Build_context&              build_context,
-    gsl::not_null<Buffer_sink*> buffer_sink
+    const Primitive_geometry&    primitive_geometry,
+    gsl::not_null<Buffer_sink*>  buffer_sink,
+    const gl::Draw_elements_type index_type
 )
-    : build_context  {build_context}
-    , buffer_sink    {buffer_sink}
-    , index_type     {build_context.root.build_info.buffer.index_type}
-    , index_type_size{build_context.root.primitive_geometry->index_buffer_range.element_size}
+    : primitive_geometry{primitive_geometry}
+    , buffer_sink       {buffer_sink}
+    , index_type        {index_type}
+    , index_type_size   {primitive_geometry.index_buffer_range.element_size}
 {
-    Expects(build_context.root.primitive_geometry != nullptr);
-    const auto& primitive_geometry = *build_context.root.primitive_geometry;
     const auto& index_buffer_range = primitive_geometry.index_buffer_range;
-    const auto& mesh_info          = build_context.root.mesh_info;
     index_data.resize(index_buffer_range.count * index_type_size);
     index_data_span = gsl::make_span(index_data);
 
-    const auto& features = build_context.root.build_info.format.features;
-
-    if (features.corner_points)
-    {
-        corner_point_index_data_span = index_data_span.subspan(
-            primitive_geometry.corner_point_indices.first_index * index_type_size,
-            mesh_info.index_count_corner_points * index_type_size
-        );
-    }
-    if (features.fill_triangles)
-    {
-        triangle_fill_index_data_span = index_data_span.subspan(
-            primitive_geometry.triangle_fill_indices.first_index * index_type_size,
-            mesh_info.index_count_fill_triangles * index_type_size
-        );
-    }
-    if (features.edge_lines)
+    // Index ranges of features which were not requested are empty
+    const auto range_span = [this](const Index_range& range)
     {
-        edge_line_index_data_span = index_data_span.subspan(
-            primitive_geometry.edge_line_indices.first_index * index_type_size,
-            mesh_info.index_count_edge_lines * index_type_size
+        return index_data_span.subspan(
+            range.first_index * index_type_size,
+            range.index_count * index_type_size
         );
-    }
-    if (features.centroid_points)
-    {
-        polygon_centroid_index_data_span = index_data_span.subspan(
-            primitive_geometry.polygon_centroid_indices.first_index * index_type_size,
-            mesh_info.polygon_count * index_type_size
-        );
-    }
+    };
+    corner_point_index_data_span     = range_span(primitive_geometry.corner_point_indices);
+    triangle_fill_index_data_span    = range_span(primitive_geometry.triangle_fill_indices);
+    edge_line_index_data_span        = range_span(primitive_geometry.edge_line_indices);
+    polygon_centroid_index_data_span = range_span(primitive_geometry.polygon_centroid_indices);
+}
+
+Index_buffer_writer::Index_buffer_writer(
+    const Index_buffer_writer& parent,
+    const std::size_t          first_corner,
+    const std::size_t          first_triangle
+)
+    : primitive_geometry              {parent.primitive_geometry}
+    , buffer_sink                     {parent.buffer_sink}
+    , index_type                      {parent.index_type}
+    , index_type_size                 {parent.index_type_size}
+    , index_data_span                 {parent.index_data_span}
+    , corner_point_index_data_span    {parent.corner_point_index_data_span}
+    , triangle_fill_index_data_span   {parent.triangle_fill_index_data_span}
+    , edge_line_index_data_span       {parent.edge_line_index_data_span}
+    , polygon_centroid_index_data_span{parent.polygon_centroid_index_data_span}
+    , corner_point_indices_written    {first_corner}
+    , triangle_indices_written        {3 * first_triangle}
+    , owns_data                       {false}
+{
 }
 
 Index_buffer_writer::~Index_buffer_writer() noexcept
 {
-    buffer_sink->buffer_ready(*this);
+    if (owns_data)
+    {
+        buffer_sink->buffer_ready(*this);
+    }
 }
 
 auto Index_buffer_writer::start_offset() -> std::size_t
 {
-    return build_context.root.primitive_geometry->index_buffer_range.byte_offset;
+    return primitive_geometry.index_buffer_range.byte_offset;
 }
 
 void Vertex_buffer_writer::write(
@@ -18,7 +18,6 @@ namespace erhe::geometry
 namespace erhe::primitive
 {
 
-class Build_context;
 class Buffer_sink;
 class Primitive_geometry;
 
@@ -28,10 +27,19 @@ class Primitive_geometry;
 class Vertex_buffer_writer
 {
 public:
+    // Vertex buffer range of primitive geometry must be allocated
     Vertex_buffer_writer(
-        Build_context&              build_context,
+        const Primitive_geometry&   primitive_geometry,
         gsl::not_null<Buffer_sink*> buffer_sink
     );
+
+    // Creates writer which writes into vertex data owned by parent writer,
+    // starting at the given vertex. Used by parallel polygon range builds.
+    Vertex_buffer_writer(
+        const Vertex_buffer_writer& parent,
+        const std::size_t           first_vertex,
+        const std::size_t           vertex_stride
+    );
     virtual ~Vertex_buffer_writer() noexcept;
 
     void write(const Vertex_attribute_info& attribute, const glm::vec2 value);
@@ -42,12 +50,13 @@ public:
 
     [[nodiscard]] auto start_offset() -> std::size_t;
 
-    Build_context&              build_context;
+    const Primitive_geometry&   primitive_geometry;
     gsl::not_null<Buffer_sink*> buffer_sink;
     Buffer_range                buffer_range;
     std::vector<std::uint8_t>   vertex_data;
     gsl::span<std::uint8_t>     vertex_data_span;
     std::size_t                 vertex_write_offset{0};
+    bool                        owns_data{true};
 };
 
 /// Writes 8/16/32 -bit indices to byte buffer/memory
@@ -56,9 +65,21 @@ public:
 class Index_buffer_writer
 {
 public:
+    // Index buffer range and index ranges of primitive geometry must be
+    // allocated
     Index_buffer_writer(
-        Build_context&              build_context,
-        gsl::not_null<Buffer_sink*> buffer_sink
+        const Primitive_geometry&    primitive_geometry,
+        gsl::not_null<Buffer_sink*>  buffer_sink,
+        const gl::Draw_elements_type index_type
+    );
+
+    // Creates writer which writes into index data owned by parent writer,
+    // starting at the given corner and triangle. Used by parallel polygon
+    // range builds.
+    Index_buffer_writer(
+        const Index_buffer_writer& parent,
+        const std::size_t          first_corner,
+        const std::size_t          first_triangle
     );
     virtual ~Index_buffer_writer() noexcept;
 
@@ -70,7 +91,7 @@ public:
 
     [[nodiscard]] auto start_offset  () -> std::size_t;
 
-    Build_context&               build_context;
+    const Primitive_geometry&    primitive_geometry;
     gsl::not_null<Buffer_sink*>  buffer_sink;
     Buffer_range                 buffer_range;
     const gl::Draw_elements_type index_type;
@@ -86,6 +107,7 @@ public:
     std::size_t triangle_indices_written        {0};
     std::size_t edge_line_indices_written       {0};
     std::size_t polygon_centroid_indices_written{0};
+    bool        owns_data{true};
 };
 
 } // namespace erhe::primitive
@@ -1,6 +1,7 @@
 #include "erhe/primitive/primitive.hpp"
 #include "erhe/primitive/primitive_geometry.hpp"
 #include "erhe/primitive/primitive_log.hpp"
+#include "erhe/primitive/triangle_soup.hpp"
 #include "erhe/graphics/buffer.hpp"
 #include "erhe/raytrace/ibuffer.hpp"
 #include "erhe/toolkit/verify.hpp"
@@ -43,4 +44,17 @@ auto c_str(const Normal_style normal_style) -> const char*
     }
 }
 
+auto Primitive::get_geometry() const -> std::shared_ptr<erhe::geometry::Geometry>
+{
+    if (source_geometry)
+    {
+        return source_geometry;
+    }
+    if (source_triangle_soup)
+    {
+        return source_triangle_soup->get_geometry();
+    }
+    return {};
+}
+
 } // namespace erhe::primitive
@@ -21,17 +21,22 @@ namespace erhe::primitive
 {
 
 class Material;
-
+class Triangle_soup;
 
 class Primitive
 {
 public:
+    // Returns source geometry. For primitives built from triangle soup,
+    // geometry is made on first call.
+    [[nodiscard]] auto get_geometry() const -> std::shared_ptr<erhe::geometry::Geometry>;
+
     std::shared_ptr<Material>                 material             {};
     Primitive_geometry                        gl_primitive_geometry{};
     Primitive_geometry                        rt_primitive_geometry{};
     std::shared_ptr<erhe::raytrace::IBuffer>  rt_vertex_buffer     {};
     std::shared_ptr<erhe::raytrace::IBuffer>  rt_index_buffer      {};
     std::shared_ptr<erhe::geometry::Geometry> source_geometry      {};
+    std::shared_ptr<Triangle_soup>            source_triangle_soup {}; // used if there is no source geometry
     Normal_style                              normal_style         {Normal_style::none};
 };
 
@@ -6,6 +6,7 @@
 #include "erhe/primitive/index_range.hpp"
 #include "erhe/primitive/primitive_log.hpp"
 #include "erhe/primitive/primitive_geometry.hpp"
+#include "erhe/concurrency/concurrent_queue.hpp"
 #include "erhe/geometry/geometry.hpp"
 #include "erhe/geometry/property_map.hpp"
 #include "erhe/gl/enum_string_functions.hpp"
@@ -25,6 +26,7 @@
 #include <glm/gtc/type_precision.hpp>
 #include <gsl/span>
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <stdexcept>
@@ -332,25 +334,30 @@ void Build_context_root::get_mesh_info()
     SPDLOG_LOGGER_INFO(log_primitive_builder, "Total {} vertices", total_vertex_count);
 }
 
-void Build_context_root::get_vertex_attributes()
+Vertex_attributes::Vertex_attributes(const Build_info& build_info)
 {
     ERHE_PROFILE_FUNCTION
 
-    const auto& format_info = build_info.format;
-    attributes.position      = Vertex_attribute_info(vertex_format, format_info.position_type,      3, Vertex_attribute::Usage_type::position,  0);
-    attributes.normal        = Vertex_attribute_info(vertex_format, format_info.normal_type,        3, Vertex_attribute::Usage_type::normal,    0); // content normals
-    attributes.normal_flat   = Vertex_attribute_info(vertex_format, format_info.normal_flat_type,   3, Vertex_attribute::Usage_type::normal,    1); // flat normals
-    attributes.normal_smooth = Vertex_attribute_info(vertex_format, format_info.normal_smooth_type, 3, Vertex_attribute::Usage_type::normal,    2); // smooth normals
-    attributes.tangent       = Vertex_attribute_info(vertex_format, format_info.tangent_type,       4, Vertex_attribute::Usage_type::tangent,   0);
-    attributes.bitangent     = Vertex_attribute_info(vertex_format, format_info.bitangent_type,     4, Vertex_attribute::Usage_type::bitangent, 0);
-    attributes.color         = Vertex_attribute_info(vertex_format, format_info.color_type,         4, Vertex_attribute::Usage_type::color,     0);
-    attributes.texcoord      = Vertex_attribute_info(vertex_format, format_info.texcoord_type,      2, Vertex_attribute::Usage_type::tex_coord, 0);
-    attributes.id_vec3       = Vertex_attribute_info(vertex_format, format_info.id_vec3_type,       3, Vertex_attribute::Usage_type::id,        0);
+    auto* const vertex_format = build_info.buffer.vertex_format.get();
+    const auto& format_info   = build_info.format;
+    position      = Vertex_attribute_info(vertex_format, format_info.position_type,      3, Vertex_attribute::Usage_type::position,  0);
+    normal        = Vertex_attribute_info(vertex_format, format_info.normal_type,        3, Vertex_attribute::Usage_type::normal,    0); // content normals
+    normal_flat   = Vertex_attribute_info(vertex_format, format_info.normal_flat_type,   3, Vertex_attribute::Usage_type::normal,    1); // flat normals
+    normal_smooth = Vertex_attribute_info(vertex_format, format_info.normal_smooth_type, 3, Vertex_attribute::Usage_type::normal,    2); // smooth normals
+    tangent       = Vertex_attribute_info(vertex_format, format_info.tangent_type,       4, Vertex_attribute::Usage_type::tangent,   0);
+    bitangent     = Vertex_attribute_info(vertex_format, format_info.bitangent_type,     4, Vertex_attribute::Usage_type::bitangent, 0);
+    color         = Vertex_attribute_info(vertex_format, format_info.color_type,         4, Vertex_attribute::Usage_type::color,     0);
+    texcoord      = Vertex_attribute_info(vertex_format, format_info.texcoord_type,      2, Vertex_attribute::Usage_type::tex_coord, 0);
+    id_vec3       = Vertex_attribute_info(vertex_format, format_info.id_vec3_type,       3, Vertex_attribute::Usage_type::id,        0);
     if (erhe::graphics::Instance::info.use_integer_polygon_ids)
     {
-        attributes.attribute_id_uint = Vertex_attribute_info(vertex_format, format_info.id_uint_type, 1, Vertex_attribute::Usage_type::id, 0);
+        attribute_id_uint = Vertex_attribute_info(vertex_format, format_info.id_uint_type, 1, Vertex_attribute::Usage_type::id, 0);
     }
+}
 
+void Build_context_root::get_vertex_attributes()
+{
+    attributes = Vertex_attributes{build_info};
 }
 
 void Build_context_root::allocate_vertex_buffer()
@@ -436,14 +443,19 @@ void Build_context_root::calculate_bounding_volume(
     );
 }
 
-auto Primitive_builder::build() -> Primitive_geometry
+auto Primitive_builder::build(
+    erhe::concurrency::Concurrent_queue* queue
+) -> Primitive_geometry
 {
     Primitive_geometry primitive_geometry;
-    build(&primitive_geometry);
+    build(&primitive_geometry, queue);
     return primitive_geometry;
 }
 
-void Primitive_builder::build(Primitive_geometry* primitive_geometry)
+void Primitive_builder::build(
+    Primitive_geometry*                  primitive_geometry,
+    erhe::concurrency::Concurrent_queue* queue
+)
 {
     ERHE_PROFILE_FUNCTION
 
@@ -470,7 +482,17 @@ void Primitive_builder::build(Primitive_geometry* primitive_geometry)
 
     if (features.fill_triangles)
     {
-        build_context.build_polygon_fill();
+        const bool use_parallel_build =
+            (queue != nullptr) &&
+            (m_geometry.get_polygon_count() >= 2 * s_parallel_polygon_range_size);
+        if (use_parallel_build)
+        {
+            build_context.build_polygon_fill_parallel(*queue);
+        }
+        else
+        {
+            build_context.build_polygon_fill();
+        }
     }
 
     if (features.edge_lines)
@@ -492,8 +514,8 @@ Build_context::Build_context(
 )
     : root         {geometry, build_info, primitive_geometry}
     , normal_style {normal_style}
-    , vertex_writer{*this, build_info.buffer.buffer_sink}
-    , index_writer {*this, build_info.buffer.buffer_sink}
+    , vertex_writer{*primitive_geometry, build_info.buffer.buffer_sink}
+    , index_writer {*primitive_geometry, build_info.buffer.buffer_sink, build_info.buffer.index_type}
     , property_maps{geometry, build_info.format}
 {
     Expects(property_maps.point_locations != nullptr);
@@ -501,9 +523,29 @@ Build_context::Build_context(
     root.calculate_bounding_volume(property_maps.point_locations);
 }
 
+Build_context::Build_context(
+    const Build_context& parent,
+    const Polygon_range& polygon_range
+)
+    : root              {parent.root}
+    , vertex_index      {polygon_range.first_vertex}
+    , polygon_index     {static_cast<uint32_t>(polygon_range.first_polygon_id)}
+    , primitive_index   {polygon_range.first_triangle}
+    , normal_style      {parent.normal_style}
+    , vertex_writer     {parent.vertex_writer, polygon_range.first_vertex, parent.root.vertex_stride}
+    , index_writer      {parent.index_writer, polygon_range.first_vertex, polygon_range.first_triangle}
+    , property_maps     {parent.property_maps.borrow()}
+    , any_normal_feature{parent.any_normal_feature}
+    , is_range_context  {true}
+{
+}
+
 Build_context::~Build_context() noexcept
 {
-    ERHE_VERIFY(vertex_index == root.total_vertex_count);
+    if (!is_range_context)
+    {
+        ERHE_VERIFY(vertex_index == root.total_vertex_count);
+    }
 }
 
 void Build_context::build_polygon_id()
@@ -920,36 +962,238 @@ void Build_context::build_triangle_fill_index()
     previous_index = vertex_index;
 }
 
-void Build_context::build_polygon_fill()
+void Build_context::prepare_polygon_fill()
 {
-    ERHE_PROFILE_FUNCTION
-
     // TODO property_maps.corner_indices needs to be setup
     //      also if edge lines are wanted.
 
     property_maps.corner_indices->clear();
 
-    vertex_index  = 0;
-    polygon_index = 0;
+    vertex_index    = 0;
+    polygon_index   = 0;
+    primitive_index = 0;
 
-    const bool any_normal_feature = root.build_info.format.features.normal =
+    any_normal_feature = root.build_info.format.features.normal =
         root.build_info.format.features.normal      ||
         root.build_info.format.features.normal_flat ||
         root.build_info.format.features.normal_smooth;
+}
+
+void Build_context::build_polygon_fill()
+{
+    ERHE_PROFILE_FUNCTION
+
+    prepare_polygon_fill();
+
+    const Polygon_range all_polygons{
+        .first_polygon_id = 0,
+        .end_polygon_id   = root.geometry.get_polygon_count(),
+        .first_vertex     = 0,
+        .first_triangle   = 0
+    };
+    build_polygon_range(all_polygons, true);
+
+    log_fallbacks();
+}
+
+auto Build_context::make_polygon_ranges(
+    const std::size_t polygon_range_size
+) const -> std::vector<Polygon_range>
+{
+    ERHE_PROFILE_FUNCTION
+
+    Expects(polygon_range_size > 0);
+
+    std::vector<Polygon_range> ranges;
 
     const Polygon_id polygon_id_end = root.geometry.get_polygon_count();
-    for (polygon_id = 0; polygon_id < polygon_id_end; ++polygon_id)
+    ranges.reserve((polygon_id_end + polygon_range_size - 1) / polygon_range_size);
+
+    // Prefix sum of corner and triangle counts gives output offsets for each range
+    uint32_t vertex_count  {0};
+    uint32_t triangle_count{0};
+    for (Polygon_id polygon_id = 0; polygon_id < polygon_id_end; ++polygon_id)
+    {
+        if ((polygon_id % polygon_range_size) == 0)
+        {
+            ranges.push_back(
+                Polygon_range{
+                    .first_polygon_id = polygon_id,
+                    .end_polygon_id   = std::min(
+                        static_cast<Polygon_id>(polygon_id + polygon_range_size),
+                        polygon_id_end
+                    ),
+                    .first_vertex     = vertex_count,
+                    .first_triangle   = triangle_count
+                }
+            );
+        }
+        const Polygon& polygon = root.geometry.polygons[polygon_id];
+        vertex_count += polygon.corner_count;
+        if (polygon.corner_count >= 2)
+        {
+            triangle_count += polygon.corner_count - 2;
+        }
+    }
+
+    return ranges;
+}
+
+void Build_context::build_polygon_fill_parallel(erhe::concurrency::Concurrent_queue& queue)
+{
+    ERHE_PROFILE_FUNCTION
+
+    prepare_polygon_fill();
+
+    const std::vector<Polygon_range> ranges = make_polygon_ranges(
+        Primitive_builder::s_parallel_polygon_range_size
+    );
+
+    // Range contexts write vertex and index data directly into spans
+    // owned by this context. Ranges do not overlap, so no synchronization
+    // is needed. Property maps are not thread safe, so those are updated
+    // after range contexts have completed.
+    std::vector<std::unique_ptr<Build_context>> range_contexts;
+    range_contexts.reserve(ranges.size());
+    for (const Polygon_range& range : ranges)
+    {
+        range_contexts.push_back(std::make_unique<Build_context>(*this, range));
+    }
+
+    for (std::size_t i = 0, end = ranges.size(); i < end; ++i)
+    {
+        queue.enqueue(
+            [range_context = range_contexts[i].get(), &range = ranges[i]]()
+            {
+                range_context->build_polygon_range(range, false);
+            }
+        );
+    }
+    queue.wait();
+
+    for (const auto& range_context : range_contexts)
+    {
+        used_fallback_smooth_normal = used_fallback_smooth_normal || range_context->used_fallback_smooth_normal;
+        used_fallback_tangent       = used_fallback_tangent       || range_context->used_fallback_tangent;
+        used_fallback_bitangent     = used_fallback_bitangent     || range_context->used_fallback_bitangent;
+        used_fallback_texcoord      = used_fallback_texcoord      || range_context->used_fallback_texcoord;
+    }
+
+    for (const Polygon_range& range : ranges)
+    {
+        put_polygon_properties(range);
+    }
+
+    // Continue from where last range ended
+    const Build_context& last = *range_contexts.back().get();
+    vertex_index                              = last.vertex_index;
+    polygon_index                             = last.polygon_index;
+    primitive_index                           = last.primitive_index;
+    vertex_writer.vertex_write_offset         = last.vertex_writer.vertex_write_offset;
+    index_writer.corner_point_indices_written = last.index_writer.corner_point_indices_written;
+    index_writer.triangle_indices_written     = last.index_writer.triangle_indices_written;
+
+#if !defined(NDEBUG)
+    verify_polygon_fill();
+#endif
+
+    log_fallbacks();
+}
+
+#if !defined(NDEBUG)
+// Builds all polygons serially over output of parallel build and
+// verifies that output is byte identical.
+void Build_context::verify_polygon_fill()
+{
+    ERHE_PROFILE_FUNCTION
+
+    const std::vector<std::uint8_t> parallel_vertex_data{
+        vertex_writer.vertex_data_span.begin(),
+        vertex_writer.vertex_data_span.end()
+    };
+    const std::vector<std::uint8_t> parallel_corner_point_index_data{
+        index_writer.corner_point_index_data_span.begin(),
+        index_writer.corner_point_index_data_span.end()
+    };
+    const std::vector<std::uint8_t> parallel_triangle_fill_index_data{
+        index_writer.triangle_fill_index_data_span.begin(),
+        index_writer.triangle_fill_index_data_span.end()
+    };
+
+    const Polygon_range all_polygons{
+        .first_polygon_id = 0,
+        .end_polygon_id   = root.geometry.get_polygon_count(),
+        .first_vertex     = 0,
+        .first_triangle   = 0
+    };
+    Build_context serial_context{*this, all_polygons};
+    serial_context.build_polygon_range(all_polygons, false);
+
+    ERHE_VERIFY(std::equal(parallel_vertex_data.begin(),              parallel_vertex_data.end(),              vertex_writer.vertex_data_span.begin()));
+    ERHE_VERIFY(std::equal(parallel_corner_point_index_data.begin(),  parallel_corner_point_index_data.end(),  index_writer.corner_point_index_data_span.begin()));
+    ERHE_VERIFY(std::equal(parallel_triangle_fill_index_data.begin(), parallel_triangle_fill_index_data.end(), index_writer.triangle_fill_index_data_span.begin()));
+}
+#endif
+
+void Build_context::put_polygon_properties(const Polygon_range& polygon_range)
+{
+    // Polygon index is same as polygon id, see build_polygon_range()
+    uint32_t corner_vertex_index = polygon_range.first_vertex;
+    for (
+        Polygon_id range_polygon_id = polygon_range.first_polygon_id;
+        range_polygon_id < polygon_range.end_polygon_id;
+        ++range_polygon_id
+    )
+    {
+        const Polygon& polygon = root.geometry.polygons[range_polygon_id];
+
+        if (property_maps.polygon_ids_uint32 != nullptr)
+        {
+            property_maps.polygon_ids_uint32->put(range_polygon_id, range_polygon_id);
+        }
+
+        if (property_maps.polygon_ids_vector3 != nullptr)
+        {
+            property_maps.polygon_ids_vector3->put(range_polygon_id, erhe::toolkit::vec3_from_uint(range_polygon_id));
+        }
+
+        const Polygon_corner_id polygon_corner_id_end = polygon.first_polygon_corner_id + polygon.corner_count;
+        for (
+            Polygon_corner_id range_polygon_corner_id = polygon.first_polygon_corner_id;
+            range_polygon_corner_id < polygon_corner_id_end;
+            ++range_polygon_corner_id
+        )
+        {
+            const Corner_id range_corner_id = root.geometry.polygon_corners[range_polygon_corner_id];
+            property_maps.corner_indices->put(range_corner_id, corner_vertex_index);
+            ++corner_vertex_index;
+        }
+    }
+}
+
+void Build_context::build_polygon_range(
+    const Polygon_range& polygon_range,
+    const bool           put_properties
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    for (
+        polygon_id = polygon_range.first_polygon_id;
+        polygon_id < polygon_range.end_polygon_id;
+        ++polygon_id
+    )
     {
         const Polygon& polygon = root.geometry.polygons[polygon_id];
         first_index    = vertex_index;
         previous_index = first_index;
 
-        if (property_maps.polygon_ids_uint32 != nullptr)
+        if (put_properties && (property_maps.polygon_ids_uint32 != nullptr))
         {
             property_maps.polygon_ids_uint32->put(polygon_id, polygon_index);
         }
 
-        if (property_maps.polygon_ids_vector3 != nullptr)
+        if (put_properties && (property_maps.polygon_ids_vector3 != nullptr))
         {
             property_maps.polygon_ids_vector3->put(polygon_id, erhe::toolkit::vec3_from_uint(polygon_index));
         }
@@ -978,7 +1222,10 @@ void Build_context::build_polygon_fill()
             build_vertex_color    (polygon.corner_count);
 
             // Indices
-            property_maps.corner_indices->put(corner_id, vertex_index);
+            if (put_properties)
+            {
+                property_maps.corner_indices->put(corner_id, vertex_index);
+            }
 
             build_corner_point_index();
             build_triangle_fill_index();
@@ -989,7 +1236,10 @@ void Build_context::build_polygon_fill()
 
         ++polygon_index;
     }
+}
 
+void Build_context::log_fallbacks() const
+{
     if (used_fallback_smooth_normal)
     {
         log_primitive_builder->warn("Warning: Used fallback smooth normal");
@@ -1095,14 +1345,47 @@ void Build_context_root::allocate_index_range(
 }
 
 
+void prepare_geometry(
+    erhe::geometry::Geometry& geometry,
+    const Format_info&        format_info
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    using erhe::geometry::Derived;
+
+    const auto& features = format_info.features;
+    if (features.edge_lines)
+    {
+        geometry.ensure(Derived::edges);
+    }
+    if (features.normal || features.normal_flat)
+    {
+        geometry.ensure(Derived::polygon_normals);
+    }
+    if (features.normal_smooth)
+    {
+        geometry.ensure(Derived::point_normals_smooth);
+    }
+    if (features.centroid_points)
+    {
+        geometry.ensure(Derived::polygon_centroids);
+    }
+    if (features.tangent || features.bitangent)
+    {
+        geometry.ensure(Derived::tangents);
+    }
+}
+
 auto make_primitive(
-    const erhe::geometry::Geometry& geometry,
-    Build_info&                     build_info,
-    const Normal_style              normal_style
+    const erhe::geometry::Geometry&      geometry,
+    Build_info&                          build_info,
+    const Normal_style                   normal_style,
+    erhe::concurrency::Concurrent_queue* queue
 ) -> Primitive_geometry
 {
     Primitive_builder builder{geometry, build_info, normal_style};
-    return builder.build();
+    return builder.build(queue);
 }
 
 } // namespace erhe::primitive
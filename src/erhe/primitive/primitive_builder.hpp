@@ -21,6 +21,12 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
+
+namespace erhe::concurrency
+{
+    class Concurrent_queue;
+}
 
 namespace erhe::graphics
 {
@@ -37,6 +43,11 @@ class Material;
 class Vertex_attributes
 {
 public:
+    Vertex_attributes() = default;
+
+    // Finds attributes from vertex format of build info
+    explicit Vertex_attributes(const Build_info& build_info);
+
     Vertex_attribute_info position         ;
     Vertex_attribute_info normal           ;
     Vertex_attribute_info normal_flat      ;
@@ -81,6 +92,17 @@ public:
     std::size_t                     total_index_count {0};
 };
 
+// Range of polygons, with precomputed first output vertex and first
+// output triangle, so that ranges can be built independently.
+class Polygon_range
+{
+public:
+    erhe::geometry::Polygon_id first_polygon_id{0};
+    erhe::geometry::Polygon_id end_polygon_id  {0};
+    uint32_t                   first_vertex    {0};
+    uint32_t                   first_triangle  {0};
+};
+
 class Build_context
 {
 public:
@@ -90,15 +112,32 @@ public:
         const Normal_style              normal_style,
         Primitive_geometry*             primitive_geometry
     );
+
+    // Creates context for building a range of polygons of parent context.
+    // Writes go directly to vertex and index data of the parent context.
+    Build_context(
+        const Build_context& parent,
+        const Polygon_range& polygon_range
+    );
     ~Build_context() noexcept;
 
-    void build_polygon_fill   ();
-    void build_edge_lines     ();
-    void build_centroid_points();
+    void build_polygon_fill         ();
+    void build_polygon_fill_parallel(erhe::concurrency::Concurrent_queue& queue);
+    void build_edge_lines           ();
+    void build_centroid_points      ();
+
+    [[nodiscard]] auto make_polygon_ranges(const std::size_t polygon_range_size) const -> std::vector<Polygon_range>;
 
     Build_context_root root;
 
 private:
+    void prepare_polygon_fill    ();
+    void build_polygon_range     (const Polygon_range& polygon_range, const bool put_properties);
+    void put_polygon_properties  (const Polygon_range& polygon_range);
+#if !defined(NDEBUG)
+    void verify_polygon_fill     ();
+#endif
+    void log_fallbacks           () const;
     void build_polygon_id        ();
 
     [[nodiscard]] auto get_polygon_normal() -> glm::vec3;
@@ -130,6 +169,8 @@ private:
     Index_buffer_writer               index_writer;
     Property_maps                     property_maps;
 
+    bool any_normal_feature         {false};
+    bool is_range_context           {false};
     bool used_fallback_smooth_normal{false};
     bool used_fallback_tangent      {false};
     bool used_fallback_bitangent    {false};
@@ -151,22 +192,42 @@ public:
 
     ~Primitive_builder() noexcept;
 
-    [[nodiscard]] auto build() -> Primitive_geometry;
+    // When queue is provided and geometry is large enough, polygon fill
+    // is built in polygon ranges using the queue. Output is identical
+    // to serial build.
+    [[nodiscard]] auto build(
+        erhe::concurrency::Concurrent_queue* queue = nullptr
+    ) -> Primitive_geometry;
 
-    void build(Primitive_geometry* primitive_geometry);
+    void build(
+        Primitive_geometry*                  primitive_geometry,
+        erhe::concurrency::Concurrent_queue* queue = nullptr
+    );
 
     static void prepare_vertex_format(Build_info& build_info);
 
+    static constexpr std::size_t s_parallel_polygon_range_size = 16384;
+
 private:
     const erhe::geometry::Geometry& m_geometry;
     Build_info&                     m_build_info;
     Normal_style                    m_normal_style;
 };
 
+// Ensures derived geometry data which is used by format, such as edges
+// when edge lines are requested. make_primitive() itself only reads
+// geometry, so this is called before it for geometry which may not
+// have derived data yet.
+void prepare_geometry(
+    erhe::geometry::Geometry& geometry,
+    const Format_info&        format_info
+);
+
 [[nodiscard]] auto make_primitive(
-    const erhe::geometry::Geometry& geometry,
-    Build_info&                     build_info,
-    const Normal_style              normal_style = Normal_style::corner_normals
+    const erhe::geometry::Geometry&      geometry,
+    Build_info&                          build_info,
+    const Normal_style                   normal_style = Normal_style::corner_normals,
+    erhe::concurrency::Concurrent_queue* queue        = nullptr
 ) -> Primitive_geometry;
 
 } // namespace erhe::primitive
@@ -139,4 +139,28 @@ Property_maps::Property_maps(
     corner_indices = corner_attributes.create<unsigned int>(erhe::geometry::c_corner_indices);
 }
 
+auto Property_maps::borrow() const -> Property_maps
+{
+    Property_maps result;
+    result.polygon_ids_vector3  = polygon_ids_vector3;
+    result.polygon_ids_uint32   = polygon_ids_uint32;
+    result.polygon_normals      = polygon_normals;
+    result.polygon_centroids    = polygon_centroids;
+    result.polygon_colors       = polygon_colors;
+    result.corner_normals       = corner_normals;
+    result.corner_tangents      = corner_tangents;
+    result.corner_bitangents    = corner_bitangents;
+    result.corner_texcoords     = corner_texcoords;
+    result.corner_colors        = corner_colors;
+    result.corner_indices       = corner_indices;
+    result.point_locations      = point_locations;
+    result.point_normals        = point_normals;
+    result.point_normals_smooth = point_normals_smooth;
+    result.point_tangents       = point_tangents;
+    result.point_bitangents     = point_bitangents;
+    result.point_texcoords      = point_texcoords;
+    result.point_colors         = point_colors;
+    return result;
+}
+
 } // namespace erhe::primitive
@@ -32,6 +32,11 @@ public:
         const Format_info&              format_info
     );
 
+    // Returns Property_maps which points to the same property maps as this,
+    // without owning any of them. Lifetime of this must exceed the returned
+    // Property_maps.
+    [[nodiscard]] auto borrow() const -> Property_maps;
+
     template <typename Key_type, typename Value_type>
     [[nodiscard]] auto find_or_create(
         const erhe::geometry::Property_map_collection<Key_type>& geometry_attributes,
@@ -72,6 +77,9 @@ public:
     erhe::geometry::Property_map<erhe::geometry::Point_id, glm::vec4>*   point_bitangents    {nullptr};
     erhe::geometry::Property_map<erhe::geometry::Point_id, glm::vec2>*   point_texcoords     {nullptr};
     erhe::geometry::Property_map<erhe::geometry::Point_id, glm::vec4>*   point_colors        {nullptr};
+
+private:
+    Property_maps() = default;
 };
 
 } // namespace erhe::primitive
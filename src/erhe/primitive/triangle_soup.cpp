@@ -0,0 +1,625 @@
+#include "erhe/primitive/triangle_soup.hpp"
+#include "erhe/primitive/buffer_sink.hpp"
+#include "erhe/primitive/buffer_writer.hpp"
+#include "erhe/primitive/primitive_builder.hpp"
+#include "erhe/primitive/primitive_log.hpp"
+#include "erhe/geometry/geometry.hpp"
+#include "erhe/gl/gl.hpp"
+#include "erhe/graphics/configuration.hpp"
+#include "erhe/graphics/vertex_format.hpp"
+#include "erhe/toolkit/math_util.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <optional>
+
+namespace erhe::primitive
+{
+
+using erhe::geometry::Corner_id;
+using erhe::geometry::Point_id;
+using erhe::geometry::Polygon_id;
+using glm::vec2;
+using glm::vec3;
+using glm::vec4;
+
+namespace
+{
+
+// Position as bit pattern; -0 is turned into +0
+auto position_bits(const vec3 position) -> std::array<uint32_t, 3>
+{
+    const vec3 p = position + vec3{0.0f};
+    std::array<uint32_t, 3> bits;
+    std::memcpy(&bits[0], &p[0], sizeof(bits));
+    return bits;
+}
+
+class Triangle_soup_point_source
+    : public erhe::toolkit::Point_source
+{
+public:
+    explicit Triangle_soup_point_source(const gsl::span<const vec3> positions)
+        : m_positions{positions}
+    {
+    }
+
+    auto point_count() const -> std::size_t override
+    {
+        return m_positions.size();
+    }
+
+    auto get_point(std::size_t index) const -> std::optional<glm::vec3> override
+    {
+        return m_positions[index];
+    }
+
+private:
+    gsl::span<const vec3> m_positions;
+};
+
+// Triangle normals, and area weighted vertex normals if there are no
+// vertex normals
+class Soup_normals
+{
+public:
+    Soup_normals(
+        const std::vector<uint32_t>& indices,
+        const gsl::span<const vec3>  positions,
+        const gsl::span<const vec3>  normals
+    )
+    {
+        const std::size_t triangle_count = indices.size() / 3;
+        triangle_normals.resize(triangle_count);
+        if (normals.empty())
+        {
+            vertex_normals.resize(positions.size(), vec3{0.0f});
+        }
+        for (std::size_t triangle = 0; triangle < triangle_count; ++triangle)
+        {
+            const uint32_t v0 = indices[3 * triangle    ];
+            const uint32_t v1 = indices[3 * triangle + 1];
+            const uint32_t v2 = indices[3 * triangle + 2];
+            const vec3     n  = glm::cross(positions[v1] - positions[v0], positions[v2] - positions[v0]);
+            const float    l  = glm::length(n);
+            triangle_normals[triangle] = (l > 0.0f) ? n / l : vec3{0.0f, 1.0f, 0.0f};
+            if (!vertex_normals.empty())
+            {
+                vertex_normals[v0] += n;
+                vertex_normals[v1] += n;
+                vertex_normals[v2] += n;
+            }
+        }
+        for (vec3& n : vertex_normals)
+        {
+            const float l = glm::length(n);
+            n = (l > 0.0f) ? n / l : vec3{0.0f, 1.0f, 0.0f};
+        }
+    }
+
+    std::vector<vec3> triangle_normals;
+    std::vector<vec3> vertex_normals;
+};
+
+// Writes one vertex per corner, followed by one vertex per triangle if
+// centroid points are used. Positions and normals are given separately
+// so that skinned values can be used instead of those in triangle soup.
+void write_vertices(
+    const Triangle_soup&        triangle_soup,
+    const gsl::span<const vec3> positions,
+    const gsl::span<const vec3> normals,
+    const Soup_normals*         soup_normals,
+    Vertex_buffer_writer&       vertex_writer,
+    const Build_info&           build_info,
+    const Normal_style          normal_style
+)
+{
+    const auto&       features       = build_info.format.features;
+    const auto&       indices        = triangle_soup.indices;
+    const auto&       tangents       = triangle_soup.tangents;
+    const auto&       texcoords      = triangle_soup.texcoords;
+    const auto&       colors         = triangle_soup.colors;
+    const uint32_t    triangle_count = static_cast<uint32_t>(triangle_soup.triangle_count());
+    const uint32_t    corner_count   = 3 * triangle_count;
+    const std::size_t vertex_stride  = build_info.buffer.vertex_format->stride();
+    Vertex_attributes attributes{build_info};
+
+    const bool any_normal_feature  = features.normal || features.normal_flat || features.normal_smooth;
+    const bool write_id_uint =
+        features.id &&
+        erhe::graphics::Instance::info.use_integer_polygon_ids &&
+        attributes.attribute_id_uint.is_valid();
+    const bool write_id_vec3       = features.id            && attributes.id_vec3      .is_valid();
+    const bool write_position      = features.position      && attributes.position     .is_valid();
+    const bool write_normal        = any_normal_feature     && attributes.normal       .is_valid() && (normal_style != Normal_style::none);
+    const bool write_normal_flat   = features.normal_flat   && attributes.normal_flat  .is_valid();
+    const bool write_normal_smooth = features.normal_smooth && attributes.normal_smooth.is_valid();
+    const bool write_tangent       = features.tangent       && attributes.tangent      .is_valid();
+    const bool write_bitangent     = features.bitangent     && attributes.bitangent    .is_valid();
+    const bool write_texcoord      = features.texcoord      && attributes.texcoord     .is_valid();
+    const bool write_color         = features.color         && attributes.color        .is_valid();
+
+    ERHE_VERIFY((soup_normals != nullptr) || !(any_normal_feature || features.centroid_points));
+
+    for (uint32_t corner = 0; corner < corner_count; ++corner)
+    {
+        const uint32_t vertex   = indices[corner];
+        const uint32_t triangle = corner / 3;
+
+        if (write_id_uint)
+        {
+            vertex_writer.write(attributes.attribute_id_uint, triangle);
+        }
+        if (write_id_vec3)
+        {
+            vertex_writer.write(attributes.id_vec3, erhe::toolkit::vec3_from_uint(triangle));
+        }
+        if (write_position)
+        {
+            vertex_writer.write(attributes.position, positions[vertex]);
+        }
+
+        const vec3 vertex_normal = !normals.empty()
+            ? normals[vertex]
+            : ((soup_normals != nullptr) && !soup_normals->vertex_normals.empty())
+                ? soup_normals->vertex_normals[vertex]
+                : vec3{0.0f, 1.0f, 0.0f};
+        if (write_normal)
+        {
+            vertex_writer.write(
+                attributes.normal,
+                (normal_style == Normal_style::polygon_normals) ? soup_normals->triangle_normals[triangle] : vertex_normal
+            );
+        }
+        if (write_normal_flat)
+        {
+            vertex_writer.write(attributes.normal_flat, soup_normals->triangle_normals[triangle]);
+        }
+        if (write_normal_smooth)
+        {
+            vertex_writer.write(attributes.normal_smooth, vertex_normal);
+        }
+
+        const vec4 tangent = !tangents.empty() ? tangents[vertex] : vec4{1.0f, 0.0f, 0.0f, 1.0f};
+        if (write_tangent)
+        {
+            vertex_writer.write(attributes.tangent, tangent);
+        }
+        if (write_bitangent)
+        {
+            const vec4 bitangent = !tangents.empty()
+                ? vec4{glm::cross(vertex_normal, vec3{tangent}) * tangent.w, 1.0f}
+                : vec4{0.0f, 0.0f, 1.0f, 1.0f};
+            vertex_writer.write(attributes.bitangent, bitangent);
+        }
+        if (write_texcoord)
+        {
+            vertex_writer.write(attributes.texcoord, !texcoords.empty() ? texcoords[vertex] : vec2{0.0f});
+        }
+        if (write_color)
+        {
+            vertex_writer.write(attributes.color, !colors.empty() ? colors[vertex] : build_info.format.constant_color);
+        }
+
+        vertex_writer.move(vertex_stride);
+    }
+
+    if (!features.centroid_points)
+    {
+        return;
+    }
+    for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+    {
+        if (write_position)
+        {
+            const vec3 centroid =
+                (
+                    positions[indices[3 * triangle    ]] +
+                    positions[indices[3 * triangle + 1]] +
+                    positions[indices[3 * triangle + 2]]
+                ) / 3.0f;
+            vertex_writer.write(attributes.position, centroid);
+        }
+        if (any_normal_feature && attributes.normal.is_valid())
+        {
+            vertex_writer.write(attributes.normal, soup_normals->triangle_normals[triangle]);
+        }
+        if (write_normal_flat)
+        {
+            vertex_writer.write(attributes.normal_flat, soup_normals->triangle_normals[triangle]);
+        }
+        vertex_writer.move(vertex_stride);
+    }
+}
+
+} // anonymous namespace
+
+Triangle_soup::Triangle_soup(const std::string_view name)
+    : name{name}
+{
+}
+
+auto Triangle_soup::vertex_count() const -> std::size_t
+{
+    return positions.size();
+}
+
+auto Triangle_soup::triangle_count() const -> std::size_t
+{
+    return indices.size() / 3;
+}
+
+auto Triangle_soup::get_geometry() -> std::shared_ptr<erhe::geometry::Geometry>
+{
+    const std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (!m_geometry)
+    {
+        m_geometry = make_geometry();
+    }
+    return m_geometry;
+}
+
+void weld_vertex_positions(
+    const gsl::span<const uint32_t>  indices,
+    const uint32_t                   base_vertex,
+    const gsl::span<const glm::vec3> positions,
+    std::vector<uint32_t>&           point_from_vertex,
+    std::vector<uint32_t>&           vertex_from_point
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Used vertices in order of first use
+    point_from_vertex.assign(positions.size(), c_unused_vertex);
+    vertex_from_point.clear();
+    std::vector<uint32_t> used_vertices;
+    used_vertices.reserve(positions.size());
+    for (const uint32_t index : indices)
+    {
+        const uint32_t vertex = index - base_vertex;
+        ERHE_VERIFY(vertex < positions.size());
+        if (point_from_vertex[vertex] == c_unused_vertex)
+        {
+            point_from_vertex[vertex] = 0;
+            used_vertices.push_back(vertex);
+        }
+    }
+
+    // Stable sort keeps first used vertex first among equal positions
+    std::vector<uint32_t> sorted_vertices = used_vertices;
+    std::stable_sort(
+        sorted_vertices.begin(),
+        sorted_vertices.end(),
+        [&positions](const uint32_t lhs, const uint32_t rhs)
+        {
+            return position_bits(positions[lhs]) < position_bits(positions[rhs]);
+        }
+    );
+    std::vector<uint32_t> first_vertex(positions.size(), c_unused_vertex);
+    for (std::size_t i = 0, end = sorted_vertices.size(); i < end; ++i)
+    {
+        const uint32_t vertex = sorted_vertices[i];
+        const bool     same   = (i > 0) && (position_bits(positions[vertex]) == position_bits(positions[sorted_vertices[i - 1]]));
+        first_vertex[vertex] = same ? first_vertex[sorted_vertices[i - 1]] : vertex;
+    }
+
+    // First used vertex of position is visited before others
+    for (const uint32_t vertex : used_vertices)
+    {
+        const uint32_t first = first_vertex[vertex];
+        if (first == vertex)
+        {
+            point_from_vertex[vertex] = static_cast<uint32_t>(vertex_from_point.size());
+            vertex_from_point.push_back(vertex);
+        }
+        else
+        {
+            point_from_vertex[vertex] = point_from_vertex[first];
+        }
+    }
+}
+
+auto Triangle_soup::make_geometry() const -> std::shared_ptr<erhe::geometry::Geometry>
+{
+    ERHE_PROFILE_FUNCTION
+
+    auto geometry = std::make_shared<erhe::geometry::Geometry>(name);
+
+    // Vertices which share position share point
+    std::vector<uint32_t> point_from_vertex;
+    std::vector<uint32_t> vertex_from_point;
+    weld_vertex_positions(indices, 0, positions, point_from_vertex, vertex_from_point);
+
+    auto* const point_locations = geometry->point_attributes().create<vec3>(erhe::geometry::c_point_locations);
+    geometry->reserve_points(vertex_from_point.size());
+    for (const uint32_t vertex : vertex_from_point)
+    {
+        const Point_id point_id = geometry->make_point();
+        point_locations->put(point_id, positions[vertex]);
+    }
+
+    auto& corner_attributes = geometry->corner_attributes();
+    auto* const corner_normals   = normals  .empty() ? nullptr : corner_attributes.create<vec3>(erhe::geometry::c_corner_normals  );
+    auto* const corner_tangents  = tangents .empty() ? nullptr : corner_attributes.create<vec4>(erhe::geometry::c_corner_tangents );
+    auto* const corner_texcoords = texcoords.empty() ? nullptr : corner_attributes.create<vec2>(erhe::geometry::c_corner_texcoords);
+    auto* const corner_colors    = colors   .empty() ? nullptr : corner_attributes.create<vec4>(erhe::geometry::c_corner_colors   );
+
+    geometry->reserve_polygons(triangle_count());
+    for (std::size_t triangle = 0, end = triangle_count(); triangle < end; ++triangle)
+    {
+        const Polygon_id polygon_id = geometry->make_polygon();
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            const uint32_t  vertex    = indices[3 * triangle + i];
+            const Corner_id corner_id = geometry->make_polygon_corner(polygon_id, point_from_vertex[vertex]);
+            if (corner_normals   != nullptr) corner_normals  ->put(corner_id, normals  [vertex]);
+            if (corner_tangents  != nullptr) corner_tangents ->put(corner_id, tangents [vertex]);
+            if (corner_texcoords != nullptr) corner_texcoords->put(corner_id, texcoords[vertex]);
+            if (corner_colors    != nullptr) corner_colors   ->put(corner_id, colors   [vertex]);
+        }
+    }
+
+    geometry->make_point_corners();
+    geometry->build_edges();
+    geometry->compute_polygon_normals();
+    geometry->compute_polygon_centroids();
+    geometry->generate_polygon_texture_coordinates();
+
+    log_primitive_builder->trace(
+        "Made geometry {} from triangle soup: {} vertices, {} points, {} triangles",
+        name,
+        vertex_count(),
+        geometry->get_point_count(),
+        triangle_count()
+    );
+    return geometry;
+}
+
+auto make_primitive(
+    const Triangle_soup& triangle_soup,
+    Build_info&          build_info,
+    const Normal_style   normal_style
+) -> Primitive_geometry
+{
+    ERHE_PROFILE_FUNCTION
+
+    Primitive_geometry primitive_geometry;
+
+    const auto&          features       = build_info.format.features;
+    const auto&          indices        = triangle_soup.indices;
+    const auto&          positions      = triangle_soup.positions;
+    const uint32_t       triangle_count = static_cast<uint32_t>(triangle_soup.triangle_count());
+    const uint32_t       corner_count   = 3 * triangle_count;
+    const std::size_t    vertex_stride  = build_info.buffer.vertex_format->stride();
+    Buffer_sink* const   buffer_sink    = build_info.buffer.buffer_sink;
+    if (corner_count == 0)
+    {
+        log_primitive_builder->warn("Triangle soup {} has no triangles", triangle_soup.name);
+        return primitive_geometry;
+    }
+
+    const Triangle_soup_point_source point_source{positions};
+    erhe::toolkit::calculate_bounding_volume(
+        point_source,
+        primitive_geometry.bounding_box,
+        primitive_geometry.bounding_sphere
+    );
+
+    const bool any_normal_feature = features.normal || features.normal_flat || features.normal_smooth;
+    std::optional<Soup_normals> soup_normals;
+    if (any_normal_feature || features.centroid_points)
+    {
+        soup_normals.emplace(indices, positions, triangle_soup.normals);
+    }
+
+    // Edges connect first corners of vertices
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    std::vector<uint32_t>                      first_corner_of_vertex;
+    if (features.edge_lines)
+    {
+        edges.reserve(corner_count);
+        first_corner_of_vertex.resize(positions.size(), std::numeric_limits<uint32_t>::max());
+        for (uint32_t corner = 0; corner < corner_count; ++corner)
+        {
+            const uint32_t a = indices[corner];
+            const uint32_t b = indices[(corner % 3 == 2) ? corner - 2 : corner + 1];
+            if (first_corner_of_vertex[a] == std::numeric_limits<uint32_t>::max())
+            {
+                first_corner_of_vertex[a] = corner;
+            }
+            if (a != b)
+            {
+                edges.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    }
+
+    // Index ranges are in same order as in Build_context_root
+    std::size_t index_count{0};
+    const auto allocate_index_range = [&index_count](
+        const gl::Primitive_type primitive_type,
+        const std::size_t        range_index_count,
+        Index_range&             out_range
+    )
+    {
+        out_range.primitive_type = primitive_type;
+        out_range.first_index    = index_count;
+        out_range.index_count    = range_index_count;
+        index_count += range_index_count;
+    };
+    if (features.fill_triangles)
+    {
+        allocate_index_range(gl::Primitive_type::triangles, corner_count, primitive_geometry.triangle_fill_indices);
+        primitive_geometry.primitive_id_to_polygon_id.resize(triangle_count);
+        std::iota(
+            primitive_geometry.primitive_id_to_polygon_id.begin(),
+            primitive_geometry.primitive_id_to_polygon_id.end(),
+            0
+        );
+    }
+    if (features.edge_lines)
+    {
+        allocate_index_range(gl::Primitive_type::lines, 2 * edges.size(), primitive_geometry.edge_line_indices);
+    }
+    if (features.corner_points)
+    {
+        allocate_index_range(gl::Primitive_type::points, corner_count, primitive_geometry.corner_point_indices);
+    }
+    if (features.centroid_points)
+    {
+        allocate_index_range(gl::Primitive_type::points, triangle_count, primitive_geometry.polygon_centroid_indices);
+    }
+
+    const std::size_t vertex_count = corner_count + (features.centroid_points ? triangle_count : 0);
+    primitive_geometry.vertex_buffer_range = buffer_sink->allocate_vertex_buffer(vertex_count, vertex_stride);
+    primitive_geometry.index_buffer_range  = buffer_sink->allocate_index_buffer(
+        index_count,
+        gl::size_of_type(build_info.buffer.index_type)
+    );
+
+    {
+        Vertex_buffer_writer vertex_writer{primitive_geometry, buffer_sink};
+        write_vertices(
+            triangle_soup,
+            positions,
+            triangle_soup.normals,
+            soup_normals.has_value() ? &soup_normals.value() : nullptr,
+            vertex_writer,
+            build_info,
+            normal_style
+        );
+    }
+
+    {
+        Index_buffer_writer index_writer{primitive_geometry, buffer_sink, build_info.buffer.index_type};
+        for (uint32_t corner = 0; corner < corner_count; ++corner)
+        {
+            if (features.corner_points)
+            {
+                index_writer.write_corner(corner);
+            }
+
+            // Same winding as Build_context::build_triangle_fill_index()
+            if (features.fill_triangles && (corner % 3 == 2))
+            {
+                index_writer.write_triangle(corner - 2, corner, corner - 1);
+            }
+        }
+
+        for (const auto& [a, b] : edges)
+        {
+            index_writer.write_edge(first_corner_of_vertex[a], first_corner_of_vertex[b]);
+        }
+
+        // Centroid vertices follow corner vertices
+        if (features.centroid_points)
+        {
+            for (uint32_t triangle = 0; triangle < triangle_count; ++triangle)
+            {
+                index_writer.write_centroid(corner_count + triangle);
+            }
+        }
+    }
+
+    return primitive_geometry;
+}
+
+void update_vertices(
+    const Triangle_soup&         triangle_soup,
+    const gsl::span<const vec3>  positions,
+    const gsl::span<const vec3>  normals,
+    Primitive_geometry&          primitive_geometry,
+    const Build_info&            build_info,
+    const Normal_style           normal_style
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    Expects(positions.size() == triangle_soup.positions.size());
+    Expects(normals.empty() || (normals.size() == positions.size()));
+
+    const auto& features = build_info.format.features;
+    if (triangle_soup.triangle_count() == 0)
+    {
+        return;
+    }
+
+    const Triangle_soup_point_source point_source{positions};
+    erhe::toolkit::calculate_bounding_volume(
+        point_source,
+        primitive_geometry.bounding_box,
+        primitive_geometry.bounding_sphere
+    );
+
+    const bool any_normal_feature = features.normal || features.normal_flat || features.normal_smooth;
+    std::optional<Soup_normals> soup_normals;
+    if (any_normal_feature || features.centroid_points)
+    {
+        soup_normals.emplace(triangle_soup.indices, positions, normals);
+    }
+
+    Vertex_buffer_writer vertex_writer{primitive_geometry, build_info.buffer.buffer_sink};
+    write_vertices(
+        triangle_soup,
+        positions,
+        normals,
+        soup_normals.has_value() ? &soup_normals.value() : nullptr,
+        vertex_writer,
+        build_info,
+        normal_style
+    );
+}
+
+void skin_vertices(
+    const Triangle_soup&             triangle_soup,
+    const gsl::span<const glm::mat4> joint_matrices,
+    std::vector<vec3>&               out_positions,
+    std::vector<vec3>&               out_normals
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto&       positions    = triangle_soup.positions;
+    const auto&       normals      = triangle_soup.normals;
+    const auto&       joints       = triangle_soup.joints;
+    const auto&       weights      = triangle_soup.weights;
+    const std::size_t vertex_count = positions.size();
+    Expects(joints .size() == vertex_count);
+    Expects(weights.size() == vertex_count);
+
+    out_positions.resize(vertex_count);
+    out_normals  .resize(normals.empty() ? 0 : vertex_count);
+    for (std::size_t vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        const glm::uvec4 j = joints [vertex];
+        const vec4       w = weights[vertex];
+        glm::mat4 m{0.0f};
+        for (glm::uvec4::length_type i = 0; i < 4; ++i)
+        {
+            if ((w[i] != 0.0f) && (j[i] < joint_matrices.size()))
+            {
+                m += w[i] * joint_matrices[j[i]];
+            }
+        }
+        out_positions[vertex] = vec3{m * vec4{positions[vertex], 1.0f}};
+        if (!normals.empty())
+        {
+            // Joint matrices are assumed to be free of non-uniform scale
+            const vec3  n = glm::mat3{m} * normals[vertex];
+            const float l = glm::length(n);
+            out_normals[vertex] = (l > 0.0f) ? n / l : normals[vertex];
+        }
+    }
+}
+
+} // namespace erhe::primitive
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "erhe/primitive/build_info.hpp"
+#include "erhe/primitive/enums.hpp"
+#include "erhe/primitive/primitive_geometry.hpp"
+
+#include <glm/glm.hpp>
+#include <gsl/span>
+
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace erhe::geometry
+{
+    class Geometry;
+}
+
+namespace erhe::primitive
+{
+
+/// Indexed triangles with per vertex attributes, as found in glTF.
+///
+/// Triangle soup can be written to vertex and index buffers without
+/// building erhe::geometry::Geometry. Geometry is made on first request,
+/// for operations which need polygon connectivity. Attribute vectors
+/// are either empty or have one value per vertex.
+class Triangle_soup
+{
+public:
+    explicit Triangle_soup(const std::string_view name);
+
+    [[nodiscard]] auto vertex_count  () const -> std::size_t;
+    [[nodiscard]] auto triangle_count() const -> std::size_t;
+
+    // Makes geometry on first call; safe to call from several threads.
+    // Polygon i of geometry is made from triangle i, and vertices which
+    // share position share point.
+    [[nodiscard]] auto get_geometry() -> std::shared_ptr<erhe::geometry::Geometry>;
+
+    std::string             name;
+    std::vector<uint32_t>   indices;
+    std::vector<glm::vec3>  positions;
+    std::vector<glm::vec3>  normals;
+    std::vector<glm::vec4>  tangents;
+    std::vector<glm::vec2>  texcoords;
+    std::vector<glm::vec4>  colors;
+    std::vector<glm::uvec4> joints;  // skin joint indices, if skinned
+    std::vector<glm::vec4>  weights; // skin joint weights, if skinned
+
+private:
+    [[nodiscard]] auto make_geometry() const -> std::shared_ptr<erhe::geometry::Geometry>;
+
+    std::mutex                                m_mutex;
+    std::shared_ptr<erhe::geometry::Geometry> m_geometry;
+};
+
+// Finds indexed vertices which share position, for making geometry
+// points. Positions are compared as bit patterns, with -0 equal to +0.
+// Vertex is index - base_vertex, and positions has one value per vertex.
+// Fills point_from_vertex with point for each vertex, or
+// c_unused_vertex for vertices not used by indices, and vertex_from_point
+// with first used vertex of each point. Points are numbered in order of
+// first use.
+static constexpr uint32_t c_unused_vertex = std::numeric_limits<uint32_t>::max();
+
+void weld_vertex_positions(
+    const gsl::span<const uint32_t>  indices,
+    const uint32_t                   base_vertex,
+    const gsl::span<const glm::vec3> positions,
+    std::vector<uint32_t>&           point_from_vertex,
+    std::vector<uint32_t>&           vertex_from_point
+);
+
+// Builds vertex and index buffers directly from triangle soup. Like
+// make_primitive() for geometry, each corner gets its own vertex and
+// polygon ids are triangle indices. Edge lines connect vertices, so
+// edges along texture seams are drawn twice.
+[[nodiscard]] auto make_primitive(
+    const Triangle_soup& triangle_soup,
+    Build_info&          build_info,
+    const Normal_style   normal_style = Normal_style::corner_normals
+) -> Primitive_geometry;
+
+// Rewrites vertex buffer range of primitive geometry previously made
+// with make_primitive() from same triangle soup, using given positions
+// and normals instead of those in triangle soup. Index buffer is not
+// touched. Bounding volume is updated.
+void update_vertices(
+    const Triangle_soup&              triangle_soup,
+    const gsl::span<const glm::vec3>  positions,
+    const gsl::span<const glm::vec3>  normals,
+    Primitive_geometry&               primitive_geometry,
+    const Build_info&                 build_info,
+    const Normal_style                normal_style = Normal_style::corner_normals
+);
+
+// Linear blend skinning on CPU. Joint matrices map from mesh space in
+// bind pose to mesh space in current pose. Out normals are left empty
+// if triangle soup has no normals. Tangents are not skinned.
+void skin_vertices(
+    const Triangle_soup&             triangle_soup,
+    const gsl::span<const glm::mat4> joint_matrices,
+    std::vector<glm::vec3>&          out_positions,
+    std::vector<glm::vec3>&          out_normals
+);
+
+} // namespace erhe::primitive
@@ -93,7 +93,8 @@ auto intersect(
     for (auto& primitive : mesh.mesh_data.primitives)
     {
         //const auto& primitive_geometry = primitive.gl_primitive_geometry;
-        auto* geometry = primitive.source_geometry.get();
+        const auto  shared_geometry = primitive.get_geometry();
+        auto* const geometry        = shared_geometry.get();
         if (geometry == nullptr)
         {
             continue;
@@ -0,0 +1,294 @@
+#include "erhe/scene/animation.hpp"
+#include "erhe/scene/node.hpp"
+#include "erhe/scene/transform.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace erhe::scene
+{
+
+auto c_str(const Animation_path path) -> const char*
+{
+    switch (path)
+    {
+        case Animation_path::invalid:     return "invalid";
+        case Animation_path::translation: return "translation";
+        case Animation_path::rotation:    return "rotation";
+        case Animation_path::scale:       return "scale";
+        default: return "?";
+    }
+}
+
+auto c_str(const Animation_interpolation_mode interpolation_mode) -> const char*
+{
+    switch (interpolation_mode)
+    {
+        case Animation_interpolation_mode::step:         return "step";
+        case Animation_interpolation_mode::linear:       return "linear";
+        case Animation_interpolation_mode::cubic_spline: return "cubic_spline";
+        default: return "?";
+    }
+}
+
+auto Animation_sampler::get(const std::size_t float_offset) const -> glm::vec4
+{
+    glm::vec4 result{0.0f};
+    for (std::size_t i = 0; i < component_count; ++i)
+    {
+        result[static_cast<glm::vec4::length_type>(i)] = data[float_offset + i];
+    }
+    return result;
+}
+
+auto Animation_sampler::get_value(const std::size_t key) const -> glm::vec4
+{
+    return (interpolation_mode == Animation_interpolation_mode::cubic_spline)
+        ? get((3 * key + 1) * component_count)
+        : get(key * component_count);
+}
+
+auto Animation_sampler::get_in_tangent(const std::size_t key) const -> glm::vec4
+{
+    return get(3 * key * component_count);
+}
+
+auto Animation_sampler::get_out_tangent(const std::size_t key) const -> glm::vec4
+{
+    return get((3 * key + 2) * component_count);
+}
+
+auto Animation_sampler::seek(const float time, std::size_t& cursor) const -> std::size_t
+{
+    const std::size_t key_count = timestamps.size();
+    if ((cursor >= key_count) || (time < timestamps[cursor]))
+    {
+        // Time went backwards, usually because animation looped
+        cursor = 0;
+    }
+    while ((cursor + 1 < key_count) && (timestamps[cursor + 1] <= time))
+    {
+        ++cursor;
+    }
+    return cursor;
+}
+
+auto Animation_sampler::evaluate(
+    const float          time,
+    std::size_t&         cursor,
+    const Animation_path path
+) const -> glm::vec4
+{
+    const std::size_t key_count = timestamps.size();
+    if (key_count == 0)
+    {
+        return glm::vec4{0.0f};
+    }
+
+    const std::size_t k0 = seek(time, cursor);
+    if ((k0 + 1 >= key_count) || (time <= timestamps[k0]))
+    {
+        return get_value(k0);
+    }
+
+    const std::size_t k1 = k0 + 1;
+    const float       dt = timestamps[k1] - timestamps[k0];
+    const float       s  = (dt > 0.0f) ? std::clamp((time - timestamps[k0]) / dt, 0.0f, 1.0f) : 0.0f;
+    switch (interpolation_mode)
+    {
+        case Animation_interpolation_mode::step:
+        {
+            return get_value(k0);
+        }
+
+        case Animation_interpolation_mode::linear:
+        {
+            const glm::vec4 v0 = get_value(k0);
+            const glm::vec4 v1 = get_value(k1);
+            if (path == Animation_path::rotation)
+            {
+                const glm::quat q0{v0.w, v0.x, v0.y, v0.z};
+                const glm::quat q1{v1.w, v1.x, v1.y, v1.z};
+                const glm::quat q = glm::slerp(q0, q1, s);
+                return glm::vec4{q.x, q.y, q.z, q.w};
+            }
+            return glm::mix(v0, v1, s);
+        }
+
+        case Animation_interpolation_mode::cubic_spline:
+        {
+            // Hermite spline, tangents are scaled by key interval
+            const float s2 = s * s;
+            const float s3 = s2 * s;
+            const glm::vec4 v =
+                ( 2.0f * s3 - 3.0f * s2 + 1.0f) * get_value      (k0) +
+                (        s3 - 2.0f * s2 + s   ) * get_out_tangent(k0) * dt +
+                (-2.0f * s3 + 3.0f * s2       ) * get_value      (k1) +
+                (        s3 -        s2       ) * get_in_tangent (k1) * dt;
+            return (path == Animation_path::rotation) ? glm::normalize(v) : v;
+        }
+
+        default:
+        {
+            return get_value(k0);
+        }
+    }
+}
+
+auto Animation_sampler::duration() const -> float
+{
+    return timestamps.empty() ? 0.0f : timestamps.back();
+}
+
+void Animation_pose::resize(const std::size_t target_count)
+{
+    translations.resize(target_count, glm::vec3{0.0f});
+    rotations   .resize(target_count, glm::quat{1.0f, 0.0f, 0.0f, 0.0f});
+    scales      .resize(target_count, glm::vec3{1.0f});
+}
+
+Animation::Animation(const std::string_view name)
+    : name{name}
+{
+}
+
+auto Animation::duration() const -> float
+{
+    float result{0.0f};
+    for (const auto& sampler : samplers)
+    {
+        result = std::max(result, sampler.duration());
+    }
+    return result;
+}
+
+Animation_player::Animation_player(const std::shared_ptr<Animation>& animation)
+    : m_animation{animation}
+{
+    Expects(animation);
+
+    const std::size_t target_count = animation->targets.size();
+    m_duration = animation->duration();
+    m_cursors.resize(animation->samplers.size(), 0);
+
+    // Properties without channel keep rest pose values
+    m_pose = animation->rest_pose;
+    m_pose.resize(target_count);
+    m_parent_from_node.resize(target_count, glm::mat4{1.0f});
+    m_node_from_parent.resize(target_count, glm::mat4{1.0f});
+    evaluate();
+}
+
+void Animation_player::set_time(const float time)
+{
+    m_time = time;
+    evaluate();
+}
+
+auto Animation_player::time() const -> float
+{
+    return m_time;
+}
+
+auto Animation_player::animation() const -> const std::shared_ptr<Animation>&
+{
+    return m_animation;
+}
+
+void Animation_player::update(const float delta_time)
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    m_time += delta_time * speed;
+    if (m_duration > 0.0f)
+    {
+        if (loop)
+        {
+            m_time = std::fmod(m_time, m_duration);
+            if (m_time < 0.0f)
+            {
+                m_time += m_duration;
+            }
+        }
+        else
+        {
+            m_time = std::clamp(m_time, 0.0f, m_duration);
+        }
+    }
+    evaluate();
+}
+
+void Animation_player::evaluate()
+{
+    ERHE_PROFILE_FUNCTION
+
+    const Animation& animation = *m_animation.get();
+
+    for (const auto& channel : animation.channels)
+    {
+        const auto&     sampler = animation.samplers.at(channel.sampler_index);
+        const glm::vec4 value   = sampler.evaluate(m_time, m_cursors[channel.sampler_index], channel.path);
+        const auto      target  = channel.target_index;
+        switch (channel.path)
+        {
+            case Animation_path::translation: m_pose.translations[target] = glm::vec3{value}; break;
+            case Animation_path::rotation:    m_pose.rotations   [target] = glm::quat{value.w, value.x, value.y, value.z}; break;
+            case Animation_path::scale:       m_pose.scales      [target] = glm::vec3{value}; break;
+            default: break;
+        }
+    }
+
+    // parent_from_node = T * R * S, node_from_parent = S^-1 * R^T * T^-1
+    const std::size_t target_count = animation.targets.size();
+    for (std::size_t i = 0; i < target_count; ++i)
+    {
+        const glm::vec3 t = m_pose.translations[i];
+        const glm::mat3 r = glm::mat3_cast(m_pose.rotations[i]);
+        const glm::vec3 s = m_pose.scales[i];
+        const glm::vec3 inverse_s{
+            (s.x != 0.0f) ? 1.0f / s.x : 0.0f,
+            (s.y != 0.0f) ? 1.0f / s.y : 0.0f,
+            (s.z != 0.0f) ? 1.0f / s.z : 0.0f
+        };
+
+        glm::mat4& m = m_parent_from_node[i];
+        m[0] = glm::vec4{r[0] * s.x, 0.0f};
+        m[1] = glm::vec4{r[1] * s.y, 0.0f};
+        m[2] = glm::vec4{r[2] * s.z, 0.0f};
+        m[3] = glm::vec4{t,          1.0f};
+
+        const glm::mat3 rt = glm::transpose(r);
+        const glm::mat3 a{
+            rt[0] * inverse_s,
+            rt[1] * inverse_s,
+            rt[2] * inverse_s
+        };
+        glm::mat4& inverse_m = m_node_from_parent[i];
+        inverse_m[0] = glm::vec4{a[0],   0.0f};
+        inverse_m[1] = glm::vec4{a[1],   0.0f};
+        inverse_m[2] = glm::vec4{a[2],   0.0f};
+        inverse_m[3] = glm::vec4{-(a * t), 1.0f};
+    }
+}
+
+void Animation_player::apply() const
+{
+    ERHE_PROFILE_FUNCTION
+
+    const auto& targets = m_animation->targets;
+    for (std::size_t i = 0, end = targets.size(); i < end; ++i)
+    {
+        const auto node = targets[i].lock();
+        if (node)
+        {
+            node->set_parent_from_node(Transform{m_parent_from_node[i], m_node_from_parent[i]});
+        }
+    }
+}
+
+} // namespace erhe::scene
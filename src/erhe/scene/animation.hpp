@@ -0,0 +1,131 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace erhe::scene
+{
+
+class Node;
+
+enum class Animation_path : unsigned int
+{
+    invalid     = 0,
+    translation = 1,
+    rotation    = 2,
+    scale       = 3
+};
+
+enum class Animation_interpolation_mode : unsigned int
+{
+    step         = 0,
+    linear       = 1,
+    cubic_spline = 2
+};
+
+[[nodiscard]] auto c_str(const Animation_path path) -> const char*;
+[[nodiscard]] auto c_str(const Animation_interpolation_mode interpolation_mode) -> const char*;
+
+// Keyframes of one animated property, laid out as in glTF.
+//
+// Data has component_count floats per key; for cubic spline, each
+// key has in-tangent, value and out-tangent in that order. Rotations
+// are quaternions in x, y, z, w order.
+class Animation_sampler
+{
+public:
+    // Returns key index i so that timestamps[i] <= time < timestamps[i + 1],
+    // clamped to first and last key. Cursor is key index of previous
+    // call. Since time usually advances by less than one key interval
+    // per frame, search continues linearly from cursor instead of doing
+    // binary search over all keys.
+    [[nodiscard]] auto seek    (const float time, std::size_t& cursor) const -> std::size_t;
+    [[nodiscard]] auto evaluate(const float time, std::size_t& cursor, const Animation_path path) const -> glm::vec4;
+    [[nodiscard]] auto duration() const -> float;
+
+    Animation_interpolation_mode interpolation_mode{Animation_interpolation_mode::linear};
+    std::size_t                  component_count   {0};
+    std::vector<float>           timestamps;
+    std::vector<float>           data;
+
+private:
+    [[nodiscard]] auto get_value      (const std::size_t key) const -> glm::vec4;
+    [[nodiscard]] auto get_in_tangent (const std::size_t key) const -> glm::vec4;
+    [[nodiscard]] auto get_out_tangent(const std::size_t key) const -> glm::vec4;
+    [[nodiscard]] auto get            (const std::size_t float_offset) const -> glm::vec4;
+};
+
+class Animation_channel
+{
+public:
+    Animation_path path         {Animation_path::invalid};
+    std::size_t    sampler_index{0};
+    std::size_t    target_index {0}; // index to Animation::targets
+};
+
+// Node local transforms as separate arrays, one entry per target
+class Animation_pose
+{
+public:
+    void resize(const std::size_t target_count);
+
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+};
+
+class Animation
+{
+public:
+    explicit Animation(const std::string_view name);
+
+    [[nodiscard]] auto duration() const -> float;
+
+    std::string                       name;
+    std::vector<Animation_sampler>    samplers;
+    std::vector<Animation_channel>    channels;
+    std::vector<std::weak_ptr<Node>>  targets;
+    Animation_pose                    rest_pose; // used for properties which have no channel
+};
+
+// Plays one animation.
+//
+// update() evaluates samplers and computes parent from node transforms
+// of targets without touching nodes, so players can be updated from
+// several threads. apply() writes the transforms to target nodes and
+// must be called from the thread which owns the scene.
+class Animation_player
+{
+public:
+    explicit Animation_player(const std::shared_ptr<Animation>& animation);
+
+    void update(const float delta_time);
+    void apply () const;
+
+    void set_time(const float time);
+
+    [[nodiscard]] auto time     () const -> float;
+    [[nodiscard]] auto animation() const -> const std::shared_ptr<Animation>&;
+
+    bool  enabled{true};
+    bool  loop   {true};
+    float speed  {1.0f};
+
+private:
+    void evaluate();
+
+    std::shared_ptr<Animation> m_animation;
+    float                      m_time    {0.0f};
+    float                      m_duration{0.0f};
+    std::vector<std::size_t>   m_cursors; // one per sampler
+    Animation_pose             m_pose;
+    std::vector<glm::mat4>     m_parent_from_node;
+    std::vector<glm::mat4>     m_node_from_parent;
+};
+
+} // namespace erhe::scene
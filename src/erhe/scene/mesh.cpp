@@ -2,6 +2,7 @@
 
 #include "erhe/primitive/primitive_geometry.hpp"
 #include "erhe/geometry/geometry.hpp"
+#include "erhe/toolkit/math_util.hpp"
 
 namespace erhe::scene
 {
@@ -83,5 +84,24 @@ auto as_mesh(const std::shared_ptr<Node>& node) -> std::shared_ptr<Mesh>
     return std::dynamic_pointer_cast<Mesh>(node);
 }
 
+auto get_world_bounding_box(const Mesh& mesh) -> erhe::toolkit::Bounding_box
+{
+    erhe::toolkit::Bounding_box local_box;
+    for (const auto& primitive : mesh.mesh_data.primitives)
+    {
+        const auto& primitive_box = primitive.gl_primitive_geometry.bounding_box;
+        if (primitive_box.is_valid())
+        {
+            local_box.include(primitive_box);
+        }
+    }
+    if (!local_box.is_valid())
+    {
+        local_box.min = glm::vec3{0.0f};
+        local_box.max = glm::vec3{0.0f};
+    }
+    return erhe::toolkit::transform_bounding_box(mesh.world_from_node(), local_box);
+}
+
 
 }
@@ -6,6 +6,7 @@
 
 #include <glm/glm.hpp>
 
+#include <memory>
 #include <vector>
 
 namespace erhe::geometry
@@ -16,10 +17,13 @@ namespace erhe::geometry
 namespace erhe::scene
 {
 
+class Skin;
+
 class Mesh_data
 {
 public:
     std::vector<erhe::primitive::Primitive> primitives;
+    std::shared_ptr<Skin>                   skin; // set for skinned meshes
     float                                   point_size{3.0f};
     float                                   line_width{1.0f};
 };
@@ -47,4 +51,8 @@ public:
 [[nodiscard]] auto as_mesh(Node* const node) -> Mesh*;
 [[nodiscard]] auto as_mesh(const std::shared_ptr<Node>& node) -> std::shared_ptr<Mesh>;
 
+// World space axis aligned box of all mesh primitives.
+// Mesh without primitive bounds is represented by its world position.
+[[nodiscard]] auto get_world_bounding_box(const Mesh& mesh) -> erhe::toolkit::Bounding_box;
+
 }
@@ -453,6 +453,10 @@ auto Node::detach(
 void Node::set_parent(const std::weak_ptr<Node>& new_parent_node)
 {
     node_data.parent = new_parent_node;
+    if (node_data.transform_handle.is_valid())
+    {
+        node_data.transform_handle.hierarchy->set_structure_changed();
+    }
 }
 
 void Node::on_attached()
@@ -800,34 +804,48 @@ auto Node::transform_direction_from_world_to_local(const glm::vec3 d) const -> g
     return glm::vec3{node_from_world() * glm::vec4{d, 0.0f}};
 }
 
-void Node::set_parent_from_node(const glm::mat4 m)
+void Node::on_parent_from_node_changed()
 {
-    node_data.transforms.parent_from_node.set(m);
     node_data.last_transform_update_serial = 0;
+    const Transform_handle& handle = node_data.transform_handle;
+    if (handle.is_valid())
+    {
+        // Marks node and its subtree dirty. on_transform_changed() will be
+        // called when world transforms are updated in the hierarchy.
+        handle.hierarchy->set_parent_from_node(
+            handle.index,
+            node_data.transforms.parent_from_node.matrix(),
+            node_data.transforms.parent_from_node.inverse_matrix()
+        );
+        return;
+    }
     on_transform_changed();
 }
 
+void Node::set_parent_from_node(const glm::mat4 m)
+{
+    node_data.transforms.parent_from_node.set(m);
+    on_parent_from_node_changed();
+}
+
 void Node::set_parent_from_node(const Transform& transform)
 {
     ERHE_PROFILE_FUNCTION
 
     node_data.transforms.parent_from_node = transform;
-    node_data.last_transform_update_serial = 0;
-    on_transform_changed();
+    on_parent_from_node_changed();
 }
 
 void Node::set_node_from_parent(const glm::mat4 matrix)
 {
     node_data.transforms.parent_from_node.set(glm::inverse(matrix), matrix);
-    node_data.last_transform_update_serial = 0;
-    on_transform_changed();
+    on_parent_from_node_changed();
 }
 
 void Node::set_node_from_parent(const Transform& transform)
 {
     node_data.transforms.parent_from_node = Transform::inverse(transform);
-    node_data.last_transform_update_serial = 0;
-    on_transform_changed();
+    on_parent_from_node_changed();
 }
 
 void Node::set_world_from_node(const glm::mat4 matrix)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "erhe/scene/transform.hpp"
+#include "erhe/scene/transform_hierarchy.hpp"
 #include "erhe/toolkit/optional.hpp"
 #include "erhe/toolkit/unique_id.hpp"
 
@@ -77,6 +78,7 @@ class Node_data
 {
 public:
     Node_transforms                                transforms;
+    Transform_handle                               transform_handle;
     std::uint64_t                                  last_transform_update_serial{0};
     std::weak_ptr<Node>                            parent         {};
     std::vector<std::shared_ptr<Node>>             children;
@@ -158,6 +160,8 @@ public:
     Node_data                      node_data;
 
 protected:
+    void on_parent_from_node_changed();
+
     erhe::toolkit::Unique_id<Node> m_id;
 };
 
@@ -134,6 +134,8 @@ void Scene::sort_transform_nodes()
         }
     );
     nodes_sorted = true;
+
+    transform_hierarchy.rebuild(flat_node_vector);
 }
 
 auto Scene::transform_update_serial() -> uint64_t
@@ -141,20 +143,30 @@ auto Scene::transform_update_serial() -> uint64_t
     return ++m_transform_update_serial;
 }
 
-void Scene::update_node_transforms()
+auto Scene::transform_change_journal() const -> const std::vector<Node*>&
+{
+    return transform_hierarchy.change_journal();
+}
+
+void Scene::update_node_transforms(erhe::concurrency::Concurrent_queue* queue)
 {
     ERHE_PROFILE_FUNCTION
 
-    if (!nodes_sorted)
+    if (!nodes_sorted || transform_hierarchy.is_structure_changed())
     {
         sort_transform_nodes();
     }
 
     const auto serial = transform_update_serial();
 
-    for (auto& node : flat_node_vector)
+    transform_hierarchy.update(serial, queue);
+
+    for (const auto& layer : mesh_layers)
     {
-        node->update_transform(serial);
+        if (layer->spatial_index)
+        {
+            layer->spatial_index->update(*layer.get(), transform_hierarchy.change_journal());
+        }
     }
 }
 
@@ -163,6 +175,15 @@ Scene::Scene()
 {
 }
 
+Scene::~Scene() noexcept
+{
+    for (const auto& node : flat_node_vector)
+    {
+        node->node_data.transform_handle = Transform_handle{};
+    }
+    transform_hierarchy.clear();
+}
+
 void Scene::add_node(
     const std::shared_ptr<erhe::scene::Node>& node
 )
@@ -182,6 +203,7 @@ void Scene::add_node(
 
         flat_node_vector.push_back(node);
         nodes_sorted = false;
+        transform_hierarchy.set_structure_changed();
     }
 
     if (node->parent().expired())
@@ -212,6 +234,10 @@ void Scene::add_to_mesh_layer(
 #endif
     {
         meshes.push_back(mesh);
+        if (layer.spatial_index)
+        {
+            layer.spatial_index->set_items_changed();
+        }
     }
 
     add_node(mesh);
@@ -285,6 +311,10 @@ void Scene::remove_from_mesh_layer(
     else
     {
         meshes.erase(i, meshes.end());
+        if (layer.spatial_index)
+        {
+            layer.spatial_index->set_items_changed();
+        }
     }
 }
 
@@ -300,6 +330,8 @@ void Scene::remove_node(
     else
     {
         flat_node_vector.erase(i, flat_node_vector.end());
+        node->node_data.transform_handle = Transform_handle{};
+        transform_hierarchy.set_structure_changed();
     }
 }
 
@@ -314,6 +346,10 @@ void Scene::remove(
         if (i != meshes.end())
         {
             meshes.erase(i, meshes.end());
+            if (layer->spatial_index)
+            {
+                layer->spatial_index->set_items_changed();
+            }
         }
     }
 
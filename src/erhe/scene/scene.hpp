@@ -1,5 +1,7 @@
 #pragma once
 
+#include "erhe/scene/spatial_index.hpp"
+#include "erhe/scene/transform_hierarchy.hpp"
 #include "erhe/toolkit/unique_id.hpp"
 
 #include <glm/glm.hpp>
@@ -9,6 +11,11 @@
 #include <string_view>
 #include <vector>
 
+namespace erhe::concurrency
+{
+    class Concurrent_queue;
+}
+
 namespace erhe::scene
 {
 
@@ -29,9 +36,10 @@ public:
         const erhe::toolkit::Unique_id<Node>::id_type id
     ) const -> std::shared_ptr<Mesh>;
 
-    std::vector<std::shared_ptr<Mesh>> meshes;
-    std::string                        name;
-    uint64_t                           flags{0};
+    std::vector<std::shared_ptr<Mesh>>  meshes;
+    std::string                         name;
+    uint64_t                            flags{0};
+    std::unique_ptr<Mesh_spatial_index> spatial_index; // Optional, updated by Scene::update_node_transforms()
 };
 
 class Light_layer
@@ -53,10 +61,11 @@ class Scene
 {
 public:
     Scene();
+    ~Scene() noexcept;
 
     void sanity_check          () const;
     void sort_transform_nodes  ();
-    void update_node_transforms();
+    void update_node_transforms(erhe::concurrency::Concurrent_queue* queue = nullptr);
 
     //[[nodiscard]] auto get_node_by_id         (const erhe::toolkit::Unique_id<Node>::id_type id) const -> std::shared_ptr<Node>;
     [[nodiscard]] auto get_mesh_by_id         (const erhe::toolkit::Unique_id<Node>::id_type id) const -> std::shared_ptr<Mesh>;
@@ -64,6 +73,9 @@ public:
     [[nodiscard]] auto get_camera_by_id       (const erhe::toolkit::Unique_id<Node>::id_type id) const -> std::shared_ptr<Camera>;
     [[nodiscard]] auto transform_update_serial() -> uint64_t;
 
+    // Nodes whose world transform changed in latest update_node_transforms()
+    [[nodiscard]] auto transform_change_journal() const -> const std::vector<Node*>&;
+
     void add_node(
         const std::shared_ptr<erhe::scene::Node>& node
     );
@@ -113,6 +125,7 @@ public:
     std::vector<std::shared_ptr<Mesh_layer>>  mesh_layers;
     std::vector<std::shared_ptr<Light_layer>> light_layers;
     std::vector<std::shared_ptr<Camera>>      cameras;
+    Transform_hierarchy                       transform_hierarchy;
 
     bool nodes_sorted{false};
 
@@ -0,0 +1,34 @@
+#include "erhe/scene/skin.hpp"
+#include "erhe/scene/node.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+namespace erhe::scene
+{
+
+Skin::Skin(const std::string_view name)
+    : name{name}
+{
+}
+
+void Skin::update_joint_matrices(
+    const Node&             mesh_node,
+    std::vector<glm::mat4>& joint_matrices
+) const
+{
+    ERHE_PROFILE_FUNCTION
+
+    Expects(inverse_bind_matrices.size() == joints.size());
+
+    const glm::mat4 node_from_world = mesh_node.node_from_world();
+    joint_matrices.resize(joints.size());
+    for (std::size_t i = 0, end = joints.size(); i < end; ++i)
+    {
+        const auto joint = joints[i].lock();
+        joint_matrices[i] = joint
+            ? node_from_world * joint->world_from_node() * inverse_bind_matrices[i]
+            : glm::mat4{1.0f};
+    }
+}
+
+} // namespace erhe::scene
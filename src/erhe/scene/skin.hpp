@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace erhe::scene
+{
+
+class Node;
+
+// Joints and inverse bind matrices of a skinned mesh, as in glTF
+class Skin
+{
+public:
+    explicit Skin(const std::string_view name);
+
+    // Computes matrices which map mesh space positions in bind pose to
+    // mesh space positions in current pose:
+    //
+    //   joint_matrices[j] = mesh node_from_world * joint j world_from_node * inverse_bind_matrices[j]
+    //
+    // World transforms of joints and mesh must be up to date.
+    void update_joint_matrices(
+        const Node&             mesh_node,
+        std::vector<glm::mat4>& joint_matrices
+    ) const;
+
+    std::string                      name;
+    std::vector<std::weak_ptr<Node>> joints;
+    std::vector<glm::mat4>           inverse_bind_matrices; // one per joint
+};
+
+} // namespace erhe::scene
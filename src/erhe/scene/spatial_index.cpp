@@ -0,0 +1,310 @@
+#include "erhe/scene/spatial_index.hpp"
+#include "erhe/scene/mesh.hpp"
+#include "erhe/scene/scene.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace erhe::scene
+{
+
+using erhe::toolkit::Bounding_box;
+
+void Mesh_spatial_index::set_items_changed()
+{
+    m_items_changed = true;
+}
+
+auto Mesh_spatial_index::is_items_changed() const -> bool
+{
+    return m_items_changed;
+}
+
+auto Mesh_spatial_index::item_count() const -> std::size_t
+{
+    return m_item_bounding_boxes.size();
+}
+
+auto Mesh_spatial_index::item_bounding_box(const uint32_t mesh_index) const -> const Bounding_box&
+{
+    return m_item_bounding_boxes[mesh_index];
+}
+
+void Mesh_spatial_index::update(
+    const Mesh_layer&         layer,
+    const std::vector<Node*>& transform_change_journal
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    if (m_items_changed || (layer.meshes.size() != m_item_bounding_boxes.size()))
+    {
+        rebuild(layer);
+        return;
+    }
+
+    std::size_t changed_count{0};
+    for (Node* node : transform_change_journal)
+    {
+        const Mesh* mesh = as_mesh(node);
+        if (mesh == nullptr)
+        {
+            continue;
+        }
+        const auto i = m_mesh_indices.find(mesh);
+        if (i == m_mesh_indices.end())
+        {
+            continue;
+        }
+        const uint32_t mesh_index = i->second;
+        m_item_bounding_boxes[mesh_index] = get_world_bounding_box(*mesh);
+        m_item_centers       [mesh_index] = m_item_bounding_boxes[mesh_index].center();
+        ++changed_count;
+    }
+
+    if (changed_count == 0)
+    {
+        return;
+    }
+
+    // Refitting keeps the tree structure, which degrades when many items
+    // move. Rebuild instead when a large part of items have moved.
+    if (changed_count > m_item_bounding_boxes.size() / 4)
+    {
+        rebuild(layer);
+    }
+    else
+    {
+        refit();
+    }
+}
+
+void Mesh_spatial_index::rebuild(const Mesh_layer& layer)
+{
+    ERHE_PROFILE_FUNCTION
+
+    const std::size_t count = layer.meshes.size();
+    ERHE_VERIFY(count < std::numeric_limits<uint32_t>::max());
+
+    m_item_bounding_boxes.resize(count);
+    m_item_centers       .resize(count);
+    m_item_indices       .resize(count);
+    m_mesh_indices       .clear();
+    m_nodes              .clear();
+    m_items_changed = false;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const Mesh* mesh = layer.meshes[i].get();
+        m_item_bounding_boxes[i] = get_world_bounding_box(*mesh);
+        m_item_centers       [i] = m_item_bounding_boxes[i].center();
+        m_item_indices       [i] = i;
+        m_mesh_indices[mesh] = i;
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    m_nodes.reserve(2 * count);
+    m_nodes.emplace_back();
+    build_node(0, 0, static_cast<uint32_t>(count));
+}
+
+void Mesh_spatial_index::build_node(
+    const uint32_t node_index,
+    const uint32_t first_item,
+    const uint32_t item_count
+)
+{
+    if (item_count <= s_max_leaf_item_count)
+    {
+        m_nodes[node_index].first      = first_item;
+        m_nodes[node_index].item_count = item_count;
+        update_bounds(m_nodes[node_index]);
+        return;
+    }
+
+    // Median split along longest axis of item centers
+    Bounding_box center_box;
+    for (uint32_t i = first_item, end = first_item + item_count; i < end; ++i)
+    {
+        center_box.include(m_item_centers[m_item_indices[i]]);
+    }
+    const glm::vec3 extent = center_box.diagonal();
+    const int axis =
+        (extent.x >= extent.y) && (extent.x >= extent.z)
+            ? 0
+            : (extent.y >= extent.z)
+                ? 1
+                : 2;
+
+    const uint32_t left_count = item_count / 2;
+    const auto     begin      = m_item_indices.begin() + first_item;
+    std::nth_element(
+        begin,
+        begin + left_count,
+        begin + item_count,
+        [this, axis](const uint32_t lhs, const uint32_t rhs)
+        {
+            return m_item_centers[lhs][axis] < m_item_centers[rhs][axis];
+        }
+    );
+
+    const uint32_t left_node_index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes.emplace_back();
+    m_nodes[node_index].first      = left_node_index;
+    m_nodes[node_index].item_count = 0;
+
+    build_node(left_node_index,     first_item,              left_count);
+    build_node(left_node_index + 1, first_item + left_count, item_count - left_count);
+    update_bounds(m_nodes[node_index]);
+}
+
+void Mesh_spatial_index::update_bounds(Bvh_node& node) const
+{
+    Bounding_box bounding_box;
+    if (node.is_leaf())
+    {
+        for (uint32_t i = node.first, end = node.first + node.item_count; i < end; ++i)
+        {
+            bounding_box.include(m_item_bounding_boxes[m_item_indices[i]]);
+        }
+    }
+    else
+    {
+        bounding_box.include(m_nodes[node.first    ].bounding_box);
+        bounding_box.include(m_nodes[node.first + 1].bounding_box);
+    }
+    node.bounding_box = bounding_box;
+}
+
+void Mesh_spatial_index::refit()
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Child nodes are always stored after their parent
+    for (auto i = m_nodes.rbegin(), end = m_nodes.rend(); i != end; ++i)
+    {
+        update_bounds(*i);
+    }
+}
+
+template <typename Predicate>
+void Mesh_spatial_index::query(
+    const Predicate&       predicate,
+    std::vector<uint32_t>& out_mesh_indices
+) const
+{
+    out_mesh_indices.clear();
+    if (m_nodes.empty())
+    {
+        return;
+    }
+
+    // Median split keeps tree depth at log2(item count)
+    std::array<uint32_t, 64> stack;
+    std::size_t              stack_size{0};
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const Bvh_node& node = m_nodes[stack[--stack_size]];
+        if (!predicate(node.bounding_box))
+        {
+            continue;
+        }
+        if (node.is_leaf())
+        {
+            for (uint32_t i = node.first, end = node.first + node.item_count; i < end; ++i)
+            {
+                const uint32_t mesh_index = m_item_indices[i];
+                if ((node.item_count == 1) || predicate(m_item_bounding_boxes[mesh_index]))
+                {
+                    out_mesh_indices.push_back(mesh_index);
+                }
+            }
+        }
+        else
+        {
+            ERHE_VERIFY(stack_size + 2 <= stack.size());
+            stack[stack_size++] = node.first + 1;
+            stack[stack_size++] = node.first;
+        }
+    }
+}
+
+void Mesh_spatial_index::query_frustum(
+    const erhe::toolkit::Frustum& frustum,
+    std::vector<uint32_t>&        out_mesh_indices
+) const
+{
+    ERHE_PROFILE_FUNCTION
+
+    query(
+        [&frustum](const Bounding_box& bounding_box)
+        {
+            return frustum.intersects(bounding_box);
+        },
+        out_mesh_indices
+    );
+}
+
+void Mesh_spatial_index::query_sphere(
+    const glm::vec3        center,
+    const float            radius,
+    std::vector<uint32_t>& out_mesh_indices
+) const
+{
+    ERHE_PROFILE_FUNCTION
+
+    query(
+        [center, radius](const Bounding_box& bounding_box)
+        {
+            return erhe::toolkit::intersect_box_sphere(bounding_box, center, radius);
+        },
+        out_mesh_indices
+    );
+}
+
+void Mesh_spatial_index::query_box(
+    const Bounding_box&    bounding_box,
+    std::vector<uint32_t>& out_mesh_indices
+) const
+{
+    ERHE_PROFILE_FUNCTION
+
+    query(
+        [&bounding_box](const Bounding_box& node_bounding_box)
+        {
+            return erhe::toolkit::intersect_box_box(node_bounding_box, bounding_box);
+        },
+        out_mesh_indices
+    );
+}
+
+void Mesh_spatial_index::query_ray(
+    const glm::vec3        origin,
+    const glm::vec3        direction,
+    const float            max_distance,
+    std::vector<uint32_t>& out_mesh_indices
+) const
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Division by zero gives infinity, which the slab test handles
+    const glm::vec3 inverse_direction = 1.0f / direction;
+    query(
+        [origin, inverse_direction, max_distance](const Bounding_box& bounding_box)
+        {
+            return erhe::toolkit::intersect_box_ray(bounding_box, origin, inverse_direction, max_distance);
+        },
+        out_mesh_indices
+    );
+}
+
+} // namespace erhe::scene
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "erhe/toolkit/math_util.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace erhe::scene
+{
+
+class Mesh;
+class Mesh_layer;
+class Node;
+
+// Bounding volume hierarchy over world space bounds of Mesh_layer meshes.
+//
+// Query results are indices to Mesh_layer::meshes. The hierarchy is
+// rebuilt when layer meshes change, and refitted when mesh transforms
+// change, based on the transform change journal of the scene.
+class Mesh_spatial_index
+{
+public:
+    static constexpr uint32_t s_max_leaf_item_count = 4;
+
+    // Call when layer meshes or mesh primitives have been modified.
+    // Layer mesh count changes are also detected by update().
+    void set_items_changed();
+
+    void update(
+        const Mesh_layer&         layer,
+        const std::vector<Node*>& transform_change_journal
+    );
+
+    // Queries clear out_mesh_indices, and then add indices of meshes
+    // which have bounding box intersecting the query volume.
+    void query_frustum(
+        const erhe::toolkit::Frustum& frustum,
+        std::vector<uint32_t>&        out_mesh_indices
+    ) const;
+
+    void query_sphere(
+        const glm::vec3        center,
+        const float            radius,
+        std::vector<uint32_t>& out_mesh_indices
+    ) const;
+
+    void query_box(
+        const erhe::toolkit::Bounding_box& bounding_box,
+        std::vector<uint32_t>&             out_mesh_indices
+    ) const;
+
+    void query_ray(
+        const glm::vec3        origin,
+        const glm::vec3        direction,
+        const float            max_distance,
+        std::vector<uint32_t>& out_mesh_indices
+    ) const;
+
+    // Items are changed until next update()
+    [[nodiscard]] auto is_items_changed () const -> bool;
+    [[nodiscard]] auto item_count       () const -> std::size_t;
+    [[nodiscard]] auto item_bounding_box(const uint32_t mesh_index) const -> const erhe::toolkit::Bounding_box&;
+
+private:
+    class Bvh_node
+    {
+    public:
+        [[nodiscard]] auto is_leaf() const -> bool { return item_count > 0; }
+
+        erhe::toolkit::Bounding_box bounding_box;
+        uint32_t                    first     {0}; // First item for leaf, left child node for interior node
+        uint32_t                    item_count{0}; // Right child node is first + 1
+    };
+
+    void rebuild      (const Mesh_layer& layer);
+    void refit        ();
+    void build_node   (const uint32_t node_index, const uint32_t first_item, const uint32_t item_count);
+    void update_bounds(Bvh_node& node) const;
+
+    template <typename Predicate>
+    void query(
+        const Predicate&       predicate,
+        std::vector<uint32_t>& out_mesh_indices
+    ) const;
+
+    std::vector<Bvh_node>                       m_nodes;
+    std::vector<uint32_t>                       m_item_indices; // Mesh indices, ordered by leaf
+    std::vector<erhe::toolkit::Bounding_box>    m_item_bounding_boxes;
+    std::vector<glm::vec3>                      m_item_centers;
+    std::unordered_map<const Mesh*, uint32_t>   m_mesh_indices;
+    bool                                        m_items_changed{true};
+};
+
+} // namespace erhe::scene
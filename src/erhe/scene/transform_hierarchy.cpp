@@ -0,0 +1,281 @@
+#include "erhe/scene/transform_hierarchy.hpp"
+#include "erhe/scene/node.hpp"
+#include "erhe/concurrency/concurrent_queue.hpp"
+#include "erhe/toolkit/profile.hpp"
+#include "erhe/toolkit/verify.hpp"
+
+#include <algorithm>
+
+namespace erhe::scene
+{
+
+Transform_hierarchy::Transform_hierarchy()
+{
+}
+
+Transform_hierarchy::~Transform_hierarchy() noexcept
+{
+}
+
+void Transform_hierarchy::rebuild(
+    const std::vector<std::shared_ptr<Node>>& depth_sorted_nodes
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    const std::size_t count = depth_sorted_nodes.size();
+    ERHE_VERIFY(count < c_no_parent);
+
+    m_nodes           .resize(count);
+    m_external_parents.resize(count);
+    m_parent_indices  .resize(count);
+    m_parent_from_node.resize(count);
+    m_node_from_parent.resize(count);
+    m_world_from_node .resize(count);
+    m_node_from_world .resize(count);
+    m_dirty           .resize(count);
+
+    // First pass assigns handles, so that parents can be found in second pass
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Node* const node = depth_sorted_nodes[i].get();
+        node->node_data.transform_handle = Transform_handle{
+            .hierarchy = this,
+            .index     = i
+        };
+        m_nodes[i] = node;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Node* const node = m_nodes[i];
+        const auto& parent = node->parent().lock();
+        const Transform_handle parent_handle = parent
+            ? parent->node_data.transform_handle
+            : Transform_handle{};
+        if (parent_handle.hierarchy == this)
+        {
+            ERHE_VERIFY(parent_handle.index < i);
+            m_parent_indices  [i] = parent_handle.index;
+            m_external_parents[i] = nullptr;
+        }
+        else
+        {
+            m_parent_indices  [i] = c_no_parent;
+            m_external_parents[i] = parent.get();
+        }
+        const auto& parent_from_node = node->parent_from_node_transform();
+        m_parent_from_node[i] = parent_from_node.matrix();
+        m_node_from_parent[i] = parent_from_node.inverse_matrix();
+        m_dirty           [i] = 1;
+    }
+
+    m_level_offsets.clear();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if ((i == 0) || (m_nodes[i]->depth() != m_nodes[i - 1]->depth()))
+        {
+            m_level_offsets.push_back(i);
+        }
+    }
+    m_level_offsets.push_back(static_cast<uint32_t>(count));
+
+    m_change_journal.clear();
+    m_first_dirty_index = (count > 0) ? 0 : c_invalid_index;
+    m_structure_changed = false;
+}
+
+void Transform_hierarchy::clear()
+{
+    m_nodes           .clear();
+    m_external_parents.clear();
+    m_parent_indices  .clear();
+    m_parent_from_node.clear();
+    m_node_from_parent.clear();
+    m_world_from_node .clear();
+    m_node_from_world .clear();
+    m_dirty           .clear();
+    m_level_offsets   .clear();
+    m_change_journal  .clear();
+    m_first_dirty_index = c_invalid_index;
+    m_structure_changed = true;
+}
+
+void Transform_hierarchy::set_parent_from_node(
+    const uint32_t  index,
+    const glm::mat4 parent_from_node,
+    const glm::mat4 node_from_parent
+)
+{
+    ERHE_VERIFY(index < m_nodes.size());
+
+    m_parent_from_node[index] = parent_from_node;
+    m_node_from_parent[index] = node_from_parent;
+    m_dirty           [index] = 1;
+    m_first_dirty_index = std::min(m_first_dirty_index, index);
+}
+
+void Transform_hierarchy::set_structure_changed()
+{
+    m_structure_changed = true;
+}
+
+auto Transform_hierarchy::change_journal() const -> const std::vector<Node*>&
+{
+    return m_change_journal;
+}
+
+auto Transform_hierarchy::size() const -> std::size_t
+{
+    return m_nodes.size();
+}
+
+auto Transform_hierarchy::is_structure_changed() const -> bool
+{
+    return m_structure_changed;
+}
+
+auto Transform_hierarchy::world_from_node(const uint32_t index) const -> const glm::mat4&
+{
+    return m_world_from_node[index];
+}
+
+auto Transform_hierarchy::node_from_world(const uint32_t index) const -> const glm::mat4&
+{
+    return m_node_from_world[index];
+}
+
+void Transform_hierarchy::update_world_transforms(
+    const std::size_t begin,
+    const std::size_t end
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const uint32_t parent_index = m_parent_indices[i];
+        if (parent_index != c_no_parent)
+        {
+            m_dirty[i] |= m_dirty[parent_index];
+            if (m_dirty[i] == 0)
+            {
+                continue;
+            }
+            m_world_from_node[i] = m_world_from_node[parent_index] * m_parent_from_node[i];
+            m_node_from_world[i] = m_node_from_parent[i] * m_node_from_world[parent_index];
+        }
+        else
+        {
+            if (m_dirty[i] == 0)
+            {
+                continue;
+            }
+            const Node* const external_parent = m_external_parents[i];
+            if (external_parent != nullptr)
+            {
+                m_world_from_node[i] = external_parent->world_from_node() * m_parent_from_node[i];
+                m_node_from_world[i] = m_node_from_parent[i] * external_parent->node_from_world();
+            }
+            else
+            {
+                m_world_from_node[i] = m_parent_from_node[i];
+                m_node_from_world[i] = m_node_from_parent[i];
+            }
+        }
+    }
+}
+
+void Transform_hierarchy::update_world_transforms_parallel(
+    erhe::concurrency::Concurrent_queue& queue
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    // Levels must be processed in order, as each level reads parent slots
+    // from previous levels. Slots within a level are independent.
+    for (std::size_t level = 0, end = m_level_offsets.size() - 1; level < end; ++level)
+    {
+        const std::size_t level_begin = std::max<std::size_t>(m_level_offsets[level], m_first_dirty_index);
+        const std::size_t level_end   = m_level_offsets[level + 1];
+        if (level_begin >= level_end)
+        {
+            continue;
+        }
+
+        if (level_end - level_begin < 2 * s_parallel_update_range_size)
+        {
+            update_world_transforms(level_begin, level_end);
+            continue;
+        }
+
+        for (
+            std::size_t range_begin = level_begin;
+            range_begin < level_end;
+            range_begin += s_parallel_update_range_size
+        )
+        {
+            const std::size_t range_end = std::min(range_begin + s_parallel_update_range_size, level_end);
+            queue.enqueue(
+                [this, range_begin, range_end]()
+                {
+                    update_world_transforms(range_begin, range_end);
+                }
+            );
+        }
+        queue.wait();
+    }
+}
+
+void Transform_hierarchy::update(
+    const uint64_t                       serial,
+    erhe::concurrency::Concurrent_queue* queue
+)
+{
+    ERHE_PROFILE_FUNCTION
+
+    ERHE_VERIFY(!m_structure_changed);
+
+    m_change_journal.clear();
+
+    if (m_first_dirty_index == c_invalid_index)
+    {
+        return;
+    }
+
+    const std::size_t count = m_nodes.size();
+    if (
+        (queue != nullptr) &&
+        (count - m_first_dirty_index >= s_parallel_update_min_node_count)
+    )
+    {
+        update_world_transforms_parallel(*queue);
+    }
+    else
+    {
+        update_world_transforms(m_first_dirty_index, count);
+    }
+
+    for (std::size_t i = m_first_dirty_index; i < count; ++i)
+    {
+        if (m_dirty[i] == 0)
+        {
+            continue;
+        }
+        m_dirty[i] = 0;
+        Node* const node = m_nodes[i];
+        node->node_data.transforms.world_from_node.set(m_world_from_node[i], m_node_from_world[i]);
+        node->node_data.last_transform_update_serial = serial;
+        m_change_journal.push_back(node);
+    }
+    m_first_dirty_index = c_invalid_index;
+
+    // Notifications are sent after all slots have been updated. Transform
+    // changes made by notification handlers are picked up by next update().
+    for (Node* node : m_change_journal)
+    {
+        node->on_transform_changed();
+    }
+}
+
+} // namespace erhe::scene
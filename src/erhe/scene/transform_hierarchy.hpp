@@ -0,0 +1,115 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace erhe::concurrency
+{
+    class Concurrent_queue;
+}
+
+namespace erhe::scene
+{
+
+class Node;
+class Transform_hierarchy;
+
+class Transform_handle
+{
+public:
+    [[nodiscard]] auto is_valid() const -> bool { return hierarchy != nullptr; }
+
+    Transform_hierarchy* hierarchy{nullptr};
+    uint32_t             index    {0};
+};
+
+// Packed store of node transforms, ordered by node depth.
+//
+// Parent slots always precede child slots, so world transforms
+// can be updated with a single linear pass over contiguous arrays.
+// Only slots which are dirty, or which have a dirty parent, are
+// recomputed. Since parents precede children, the pass starts from
+// the first dirty slot, and is skipped when nothing is dirty.
+//
+// Nodes refer to their slot with Transform_handle. Node keeps its
+// own copy of transforms for the public Node API; local transform
+// changes are written through to the hierarchy, and updated world
+// transforms are written back to dirty nodes by update().
+//
+// Nodes whose world transform was changed by the latest update() are
+// recorded in the change journal, so that consumers can process only
+// nodes that moved.
+//
+// Slots of one depth level depend only on slots of previous levels.
+// When a queue is given to update() and the hierarchy is large enough,
+// wide levels are split into ranges which are updated concurrently.
+class Transform_hierarchy
+{
+public:
+    static constexpr uint32_t    c_no_parent     = 0xffffffffu;
+    static constexpr uint32_t    c_invalid_index = 0xffffffffu;
+    static constexpr std::size_t s_parallel_update_min_node_count = 4096;
+    static constexpr std::size_t s_parallel_update_range_size     = 1024;
+
+    Transform_hierarchy ();
+    ~Transform_hierarchy() noexcept;
+    Transform_hierarchy (const Transform_hierarchy&) = delete;
+    void operator=      (const Transform_hierarchy&) = delete;
+    Transform_hierarchy (Transform_hierarchy&&)      = delete;
+    void operator=      (Transform_hierarchy&&)      = delete;
+
+    // Nodes must be sorted by depth. Assigns transform handles to nodes.
+    void rebuild(const std::vector<std::shared_ptr<Node>>& depth_sorted_nodes);
+
+    // Nodes are not accessed, as they may already have been destroyed.
+    // Caller is responsible for resetting transform handles of nodes.
+    void clear();
+
+    void set_parent_from_node(
+        const uint32_t  index,
+        const glm::mat4 parent_from_node,
+        const glm::mat4 node_from_parent
+    );
+
+    // Called when node is reparented, or added to / removed from the hierarchy.
+    // Hierarchy must be rebuilt before next update().
+    void set_structure_changed();
+
+    // Updates world transforms for dirty slots, writes them back to nodes,
+    // and notifies changed nodes with Node::on_transform_changed().
+    // Node notifications are always sent from the calling thread.
+    void update(
+        const uint64_t                       serial,
+        erhe::concurrency::Concurrent_queue* queue = nullptr
+    );
+
+    // Nodes whose world transform changed in latest update(),
+    // in depth order. Valid until next update() or rebuild().
+    [[nodiscard]] auto change_journal      () const -> const std::vector<Node*>&;
+    [[nodiscard]] auto size                () const -> std::size_t;
+    [[nodiscard]] auto is_structure_changed() const -> bool;
+    [[nodiscard]] auto world_from_node     (const uint32_t index) const -> const glm::mat4&;
+    [[nodiscard]] auto node_from_world     (const uint32_t index) const -> const glm::mat4&;
+
+private:
+    void update_world_transforms         (const std::size_t begin, const std::size_t end);
+    void update_world_transforms_parallel(erhe::concurrency::Concurrent_queue& queue);
+
+    std::vector<Node*>     m_nodes;
+    std::vector<Node*>     m_external_parents; // Parent which is not in this hierarchy, like Scene::root_node
+    std::vector<uint32_t>  m_parent_indices;
+    std::vector<glm::mat4> m_parent_from_node;
+    std::vector<glm::mat4> m_node_from_parent;
+    std::vector<glm::mat4> m_world_from_node;
+    std::vector<glm::mat4> m_node_from_world;
+    std::vector<uint8_t>   m_dirty;
+    std::vector<uint32_t>  m_level_offsets;    // First slot of each depth level, and slot count
+    std::vector<Node*>     m_change_journal;
+    uint32_t               m_first_dirty_index{c_invalid_index};
+    bool                   m_structure_changed{true};
+};
+
+} // namespace erhe::scene
@@ -0,0 +1,146 @@
+#include "erhe/toolkit/mapped_file.hpp"
+#include "erhe/toolkit/file.hpp"
+#include "erhe/toolkit/toolkit_log.hpp"
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace erhe::toolkit
+{
+
+Mapped_file::Mapped_file(const fs::path& path)
+{
+    try
+    {
+        if (
+            !fs::exists(path) ||
+            !fs::is_regular_file(path) ||
+            fs::is_empty(path)
+        )
+        {
+            return;
+        }
+    }
+    catch (...)
+    {
+        log_file->error("Error accessing file '{}'", path.string());
+        return;
+    }
+
+#if defined(_WIN32)
+    m_file_handle = ::CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+    if (m_file_handle == INVALID_HANDLE_VALUE)
+    {
+        m_file_handle = nullptr;
+    }
+    else
+    {
+        LARGE_INTEGER file_size;
+        if (::GetFileSizeEx(m_file_handle, &file_size) && (file_size.QuadPart > 0))
+        {
+            m_mapping_handle = ::CreateFileMappingW(m_file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping_handle != nullptr)
+            {
+                const void* view = ::MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0);
+                if (view != nullptr)
+                {
+                    m_data = static_cast<const char*>(view);
+                    m_size = static_cast<std::size_t>(file_size.QuadPart);
+                    return;
+                }
+            }
+        }
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat file_stat;
+        if ((::fstat(fd, &file_stat) == 0) && (file_stat.st_size > 0))
+        {
+            void* const view = ::mmap(nullptr, static_cast<std::size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+            {
+                ::madvise(view, static_cast<std::size_t>(file_stat.st_size), MADV_SEQUENTIAL);
+                m_data = static_cast<const char*>(view);
+                m_size = static_cast<std::size_t>(file_stat.st_size);
+            }
+        }
+        ::close(fd); // mapping stays valid
+        if (m_data != nullptr)
+        {
+            return;
+        }
+    }
+#endif
+
+    log_file->warn("Could not map file '{}', reading it instead", path.string());
+    auto opt_text = read(path);
+    if (opt_text.has_value())
+    {
+        m_fallback = std::move(opt_text.value());
+        m_data     = m_fallback.data();
+        m_size     = m_fallback.size();
+    }
+}
+
+Mapped_file::~Mapped_file() noexcept
+{
+    const bool is_mapped = (m_data != nullptr) && (m_data != m_fallback.data());
+#if defined(_WIN32)
+    if (is_mapped)
+    {
+        ::UnmapViewOfFile(m_data);
+    }
+    if (m_mapping_handle != nullptr)
+    {
+        ::CloseHandle(m_mapping_handle);
+    }
+    if (m_file_handle != nullptr)
+    {
+        ::CloseHandle(m_file_handle);
+    }
+#else
+    if (is_mapped)
+    {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+}
+
+auto Mapped_file::is_valid() const -> bool
+{
+    return m_data != nullptr;
+}
+
+auto Mapped_file::size() const -> std::size_t
+{
+    return m_size;
+}
+
+auto Mapped_file::text() const -> std::string_view
+{
+    return std::string_view{m_data, m_size};
+}
+
+} // namespace erhe::toolkit
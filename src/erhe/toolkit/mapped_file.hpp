@@ -0,0 +1,40 @@
+#pragma once
+
+#include "erhe/toolkit/filesystem.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace erhe::toolkit
+{
+
+// Read-only view of file contents.
+//
+// File is memory mapped when the platform supports it, so that pages
+// are read on demand and no copy is made. If mapping fails, contents
+// are read to memory instead. View is empty if file does not exist,
+// is not regular file, or is empty.
+class Mapped_file
+{
+public:
+    explicit Mapped_file(const fs::path& path);
+    ~Mapped_file() noexcept;
+    Mapped_file (const Mapped_file&) = delete;
+    auto operator=(const Mapped_file&) -> Mapped_file& = delete;
+
+    [[nodiscard]] auto is_valid() const -> bool;
+    [[nodiscard]] auto size    () const -> std::size_t;
+    [[nodiscard]] auto text    () const -> std::string_view;
+
+private:
+    const char* m_data{nullptr};
+    std::size_t m_size{0};
+    std::string m_fallback; // used if file could not be mapped
+#if defined(_WIN32)
+    void*       m_file_handle   {nullptr};
+    void*       m_mapping_handle{nullptr};
+#endif
+};
+
+} // namespace erhe::toolkit
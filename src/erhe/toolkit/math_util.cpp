@@ -516,6 +516,123 @@ auto spherical_to_cartesian_iso(const float theta, const float phi) -> vec3
         };
 }
 
+auto transform_bounding_box(
+    const mat4&         transform,
+    const Bounding_box& bounding_box
+) -> Bounding_box
+{
+    // Arvo: project each axis extent of the source box separately
+    const vec3 center     = vec3{transform * vec4{bounding_box.center(), 1.0f}};
+    const vec3 half_size  = bounding_box.diagonal() * 0.5f;
+    const vec3 extent{
+        std::abs(transform[0][0]) * half_size.x + std::abs(transform[1][0]) * half_size.y + std::abs(transform[2][0]) * half_size.z,
+        std::abs(transform[0][1]) * half_size.x + std::abs(transform[1][1]) * half_size.y + std::abs(transform[2][1]) * half_size.z,
+        std::abs(transform[0][2]) * half_size.x + std::abs(transform[1][2]) * half_size.y + std::abs(transform[2][2]) * half_size.z
+    };
+    return Bounding_box{
+        .min = center - extent,
+        .max = center + extent
+    };
+}
+
+auto intersect_box_box(
+    const Bounding_box& lhs,
+    const Bounding_box& rhs
+) -> bool
+{
+    return
+        (lhs.min.x <= rhs.max.x) && (lhs.max.x >= rhs.min.x) &&
+        (lhs.min.y <= rhs.max.y) && (lhs.max.y >= rhs.min.y) &&
+        (lhs.min.z <= rhs.max.z) && (lhs.max.z >= rhs.min.z);
+}
+
+auto intersect_box_sphere(
+    const Bounding_box& bounding_box,
+    const vec3          center,
+    const float         radius
+) -> bool
+{
+    const vec3 closest = glm::clamp(center, bounding_box.min, bounding_box.max);
+    const vec3 d       = closest - center;
+    return glm::dot(d, d) <= radius * radius;
+}
+
+auto intersect_box_ray(
+    const Bounding_box& bounding_box,
+    const vec3          origin,
+    const vec3          inverse_direction,
+    const float         max_distance
+) -> bool
+{
+    const vec3 t0    = (bounding_box.min - origin) * inverse_direction;
+    const vec3 t1    = (bounding_box.max - origin) * inverse_direction;
+    const vec3 t_min = glm::min(t0, t1);
+    const vec3 t_max = glm::max(t0, t1);
+    const float t_enter = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+    const float t_exit  = std::min(std::min(t_max.x, t_max.y), std::min(t_max.z, max_distance));
+    return t_enter <= t_exit;
+}
+
+Frustum::Frustum()
+{
+    for (auto& plane : planes)
+    {
+        plane = vec4{0.0f};
+    }
+}
+
+Frustum::Frustum(const mat4& clip_from_world)
+{
+    // Gribb & Hartmann
+    const vec4 row_x{clip_from_world[0][0], clip_from_world[1][0], clip_from_world[2][0], clip_from_world[3][0]};
+    const vec4 row_y{clip_from_world[0][1], clip_from_world[1][1], clip_from_world[2][1], clip_from_world[3][1]};
+    const vec4 row_z{clip_from_world[0][2], clip_from_world[1][2], clip_from_world[2][2], clip_from_world[3][2]};
+    const vec4 row_w{clip_from_world[0][3], clip_from_world[1][3], clip_from_world[2][3], clip_from_world[3][3]};
+    planes[0] = row_w + row_x; // left
+    planes[1] = row_w - row_x; // right
+    planes[2] = row_w + row_y; // bottom
+    planes[3] = row_w - row_y; // top
+    planes[4] = row_z;         // near or far with reverse depth
+    planes[5] = row_w - row_z; // far or near with reverse depth
+    for (auto& plane : planes)
+    {
+        const float length = glm::length(vec3{plane});
+        plane = (length > 0.0f)
+            ? plane / length
+            : vec4{0.0f}; // Degenerate plane, for example infinite far plane
+    }
+}
+
+auto Frustum::intersects(const Bounding_box& bounding_box) const -> bool
+{
+    for (const auto& plane : planes)
+    {
+        // Box corner furthest along plane normal
+        const vec3 p{
+            (plane.x >= 0.0f) ? bounding_box.max.x : bounding_box.min.x,
+            (plane.y >= 0.0f) ? bounding_box.max.y : bounding_box.min.y,
+            (plane.z >= 0.0f) ? bounding_box.max.z : bounding_box.min.z
+        };
+        if (glm::dot(vec3{plane}, p) + plane.w < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto Frustum::intersects(const vec3 center, const float radius) const -> bool
+{
+    for (const auto& plane : planes)
+    {
+        if (glm::dot(vec3{plane}, center) + plane.w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 void calculate_bounding_volume(
     const Point_source& point_source,
     Bounding_box&       bounding_box,
@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
+#include <array>
 #include <cstdint>
 #include <tuple>
 
@@ -727,6 +728,20 @@ public:
         const auto d = diagonal();
         return d.x * d.y * d.z;
     }
+    [[nodiscard]] auto is_valid() const -> bool
+    {
+        return (min.x <= max.x) && (min.y <= max.y) && (min.z <= max.z);
+    }
+    void include(const glm::vec3 point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    void include(const Bounding_box& other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
 
     glm::vec3 min{std::numeric_limits<float>::max()}; // bounding box
     glm::vec3 max{std::numeric_limits<float>::lowest()};
@@ -745,6 +760,47 @@ public:
     float     radius{0.0f};
 };
 
+// Returns axis aligned box enclosing the transformed box
+[[nodiscard]] auto transform_bounding_box(
+    const glm::mat4&    transform,
+    const Bounding_box& bounding_box
+) -> Bounding_box;
+
+[[nodiscard]] auto intersect_box_box(
+    const Bounding_box& lhs,
+    const Bounding_box& rhs
+) -> bool;
+
+[[nodiscard]] auto intersect_box_sphere(
+    const Bounding_box& bounding_box,
+    const glm::vec3     center,
+    const float         radius
+) -> bool;
+
+// Returns true if ray hits box within [0, max_distance]
+// inverse_direction is 1.0 / direction for each component
+[[nodiscard]] auto intersect_box_ray(
+    const Bounding_box& bounding_box,
+    const glm::vec3     origin,
+    const glm::vec3     inverse_direction,
+    const float         max_distance
+) -> bool;
+
+// Planes extracted from clip from world matrix, with zero to one clip depth.
+// Plane normals point inside the frustum.
+class Frustum
+{
+public:
+    Frustum();
+    explicit Frustum(const glm::mat4& clip_from_world);
+
+    // Conservative; boxes near frustum corners may be reported as visible
+    [[nodiscard]] auto intersects(const Bounding_box& bounding_box) const -> bool;
+    [[nodiscard]] auto intersects(const glm::vec3 center, const float radius) const -> bool;
+
+    std::array<glm::vec4, 6> planes;
+};
+
 class Point_source
 {
 public: